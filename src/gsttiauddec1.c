@@ -59,6 +59,7 @@
 #include "gsttithreadprops.h"
 #include "gsttiquicktime_aac.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tiauddec1_debug);
@@ -74,7 +75,8 @@ enum
   PROP_NUM_OUTPUT_BUFS, /* numOutputBufs  (int)     */
   PROP_DISPLAY_BUFFER,  /* displayBuffer  (boolean) */
   PROP_GEN_TIMESTAMPS,  /* genTimeStamps  (boolean) */
-  PROP_RTCODECTHREAD    /* rtCodecThread  (boolean) */
+  PROP_RTCODECTHREAD,   /* rtCodecThread  (boolean) */
+  PROP_REUSE_CODEC      /* reuseCodec     (boolean) */
 };
 
 /* Define sink (input) pad capabilities.  Currently, AAC and MP3 are
@@ -142,6 +144,12 @@ static gboolean
     gst_tiauddec1_codec_start (GstTIAuddec1  *auddec);
 static gboolean 
     gst_tiauddec1_codec_stop (GstTIAuddec1  *auddec1);
+static gboolean
+    gst_tiauddec1_codec_park(GstTIAuddec1 *auddec1);
+static gboolean
+    gst_tiauddec1_codec_unpark(GstTIAuddec1 *auddec1);
+static void
+    gst_tiauddec1_free_parked(GstTIAuddec1 *auddec1);
 static void 
     gst_tiauddec1_init_env(GstTIAuddec1 *auddec1);
 static void
@@ -209,6 +217,8 @@ static void gst_tiauddec1_dispose(GObject * object)
         auddec1->segment = NULL;
     }
 
+    gst_tiauddec1_free_parked(auddec1);
+
     G_OBJECT_CLASS(parent_class)->dispose (object);
 }
 
@@ -292,6 +302,12 @@ static void gst_tiauddec1_class_init(GstTIAuddec1Class *klass)
         g_param_spec_boolean("genTimeStamps", "Generate Time Stamps",
             "Set timestamps on output buffers",
             TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_REUSE_CODEC,
+        g_param_spec_boolean("reuseCodec", "Reuse codec",
+            "Keep the codec and its buffers when the stream stops, and reuse "
+            "them for the next stream if it uses the same codec",
+            TRUE, G_PARAM_WRITABLE));
 }
 
 /******************************************************************************
@@ -339,6 +355,13 @@ static void gst_tiauddec1_init_env(GstTIAuddec1 *auddec1)
                     auddec1->rtCodecThread ? "TRUE" : "FALSE");
     }
 
+    if (gst_ti_env_is_defined("GST_TI_TIAuddec1_reuseCodec")) {
+        auddec1->reuseCodec = 
+                gst_ti_env_get_boolean("GST_TI_TIAuddec1_reuseCodec");
+        GST_LOG("Setting reuseCodec =%s\n", 
+                    auddec1->reuseCodec ? "TRUE" : "FALSE");
+    }
+
     GST_LOG("gst_tiauddec1_init_env - end");
 }
 
@@ -402,6 +425,14 @@ static void gst_tiauddec1_init(GstTIAuddec1 *auddec1, GstTIAuddec1Class *gclass)
     auddec1->hOutBufTab         = NULL;
     auddec1->circBuf            = NULL;
 
+    auddec1->reuseCodec         = TRUE;
+    auddec1->hParkedEngine      = NULL;
+    auddec1->hParkedAd          = NULL;
+    auddec1->parkedCircBuf      = NULL;
+    auddec1->hParkedOutBufTab   = NULL;
+    auddec1->parkedEngineName   = NULL;
+    auddec1->parkedCodecName    = NULL;
+
     auddec1->aac_header_data    = NULL;
 
     auddec1->segment            = gst_segment_new();
@@ -489,6 +520,11 @@ static void gst_tiauddec1_set_property(GObject *object, guint prop_id,
             GST_LOG("setting \"RTCodecThread\" to \"%s\"\n",
                 auddec1->rtCodecThread ? "TRUE" : "FALSE");
             break;
+        case PROP_REUSE_CODEC:
+            auddec1->reuseCodec = g_value_get_boolean(value);
+            GST_LOG("setting \"reuseCodec\" to \"%s\"\n",
+                auddec1->reuseCodec ? "TRUE" : "FALSE");
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -721,8 +757,18 @@ static gboolean gst_tiauddec1_sink_event(GstPad *pad, GstEvent *event)
             ret = gst_pad_push_event(auddec1->srcpad, event);
             break;
 
+        case GST_EVENT_FLUSH_START:
+            /* Refuse new input and unblock the decode thread */
+            gst_ticircbuffer_flush_start(auddec1->circBuf);
+
+            ret = gst_pad_push_event(auddec1->srcpad, event);
+            break;
+
         case GST_EVENT_FLUSH_STOP:
             ret = gst_pad_push_event(auddec1->srcpad, event);
+
+            /* Discard the input queued before the seek */
+            gst_ticircbuffer_flush_stop(auddec1->circBuf);
             break;
 
         /* Unhandled events */
@@ -732,7 +778,6 @@ static gboolean gst_tiauddec1_sink_event(GstPad *pad, GstEvent *event)
         case GST_EVENT_CUSTOM_DOWNSTREAM:
         case GST_EVENT_CUSTOM_DOWNSTREAM_OOB:
         case GST_EVENT_CUSTOM_UPSTREAM:
-        case GST_EVENT_FLUSH_START:
         case GST_EVENT_NAVIGATION:
         case GST_EVENT_QOS:
         case GST_EVENT_SEEK:
@@ -812,6 +857,13 @@ static GstFlowReturn gst_tiauddec1_chain(GstPad * pad, GstBuffer * buf)
 
     /* Queue up the encoded data stream into a circular buffer */
     if (!gst_ticircbuffer_queue_data(auddec1->circBuf, buf)) {
+
+        /* Input is refused while a seek flushes the pipeline */
+        if (gst_ticircbuffer_is_flushing(auddec1->circBuf)) {
+            flow = GST_FLOW_WRONG_STATE;
+            goto exit;
+        }
+
         GST_ELEMENT_ERROR(auddec1, RESOURCE, WRITE,
         ("Failed to queue input buffer into circular buffer\n"), (NULL));
         flow = GST_FLOW_UNEXPECTED;
@@ -1022,10 +1074,13 @@ static GstStateChangeReturn gst_tiauddec1_change_state(GstElement *element,
     /* Handle ramp-down state changes */
     switch (transition) {
         case GST_STATE_CHANGE_READY_TO_NULL:
-            /* Shut down any running audio decoder */
+            /* Shut down any running audio decoder, and the one kept for
+             * reuse.
+             */
             if (!gst_tiauddec1_exit_audio(auddec1)) {
                 return GST_STATE_CHANGE_FAILURE;
             }
+            gst_tiauddec1_free_parked(auddec1);
             break;
 
         case GST_STATE_CHANGE_READY_TO_PAUSED:
@@ -1051,6 +1106,11 @@ static GstStateChangeReturn gst_tiauddec1_change_state(GstElement *element,
  *****************************************************************************/
 static gboolean gst_tiauddec1_codec_stop (GstTIAuddec1  *auddec1)
 {
+    /* Keep the codec for the next stream if we can */
+    if (gst_tiauddec1_codec_park(auddec1)) {
+        return TRUE;
+    }
+
     if (auddec1->circBuf) {
         GstTICircBuffer *circBuf;
 
@@ -1075,7 +1135,7 @@ static gboolean gst_tiauddec1_codec_stop (GstTIAuddec1  *auddec1)
 
     if (auddec1->hEngine) {
         GST_LOG("closing codec engine\n");
-        Engine_close(auddec1->hEngine);
+        gst_tiengine_close(auddec1->hEngine);
         auddec1->hEngine = NULL;
     }
 
@@ -1084,57 +1144,147 @@ static gboolean gst_tiauddec1_codec_stop (GstTIAuddec1  *auddec1)
 
 
 /******************************************************************************
- * gst_tiauddec1_codec_start
- *     Initialize codec engine
+ * gst_tiauddec1_codec_park
+ *    Keep the codec, circular buffer and output BufTab for the next call to
+ *    codec_start instead of deleting them.  Returns FALSE if reuseCodec is
+ *    off.
  *****************************************************************************/
-static gboolean gst_tiauddec1_codec_start (GstTIAuddec1  *auddec1)
+static gboolean gst_tiauddec1_codec_park(GstTIAuddec1 *auddec1)
 {
-    AUDDEC1_Params          params    = Adec1_Params_DEFAULT;
-    AUDDEC1_DynamicParams   dynParams = Adec1_DynamicParams_DEFAULT;
-    Buffer_Attrs            bAttrs    = Buffer_Attrs_DEFAULT;
+    if (!auddec1->reuseCodec || !auddec1->hAd || !auddec1->circBuf ||
+        !auddec1->hOutBufTab) {
+        return FALSE;
+    }
 
-    /* Open the codec engine */
-    GST_LOG("opening codec engine \"%s\"\n", auddec1->engineName);
-    auddec1->hEngine = Engine_open((Char *) auddec1->engineName, NULL, NULL);
+    /* Only one codec is kept */
+    gst_tiauddec1_free_parked(auddec1);
 
-    if (auddec1->hEngine == NULL) {
-        GST_ELEMENT_ERROR(auddec1, RESOURCE, FAILED,
-        ("failed to open codec engine \"%s\"\n", auddec1->engineName), (NULL));
+    GST_LOG("keeping audio decoder \"%s\" for reuse\n", auddec1->codecName);
+
+    auddec1->hParkedEngine    = auddec1->hEngine;
+    auddec1->hParkedAd        = auddec1->hAd;
+    auddec1->parkedCircBuf    = auddec1->circBuf;
+    auddec1->hParkedOutBufTab = auddec1->hOutBufTab;
+    auddec1->parkedEngineName = g_strdup(auddec1->engineName);
+    auddec1->parkedCodecName  = g_strdup(auddec1->codecName);
+    gst_tiengine_park(auddec1->hParkedEngine);
+
+    auddec1->hEngine          = NULL;
+    auddec1->hAd              = NULL;
+    auddec1->circBuf          = NULL;
+    auddec1->hOutBufTab       = NULL;
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tiauddec1_codec_unpark
+ *    Take back the codec kept by codec_park if it is the same codec, and
+ *    reset it for a new stream.  Returns FALSE, after freeing the kept codec
+ *    if there was one, if codec_start has to create a new one.
+ *****************************************************************************/
+static gboolean gst_tiauddec1_codec_unpark(GstTIAuddec1 *auddec1)
+{
+    AUDDEC1_DynamicParams dynParams = Adec1_DynamicParams_DEFAULT;
+    AUDDEC1_Status        decStatus;
+
+    if (!auddec1->hParkedAd) {
         return FALSE;
     }
 
-    if (gst_tiauddec1_codec_is_aac(auddec1)) {
-        #if defined (Platform_dm365) || defined(Platform_dm368)
-        params.dataEndianness = XDM_LE_16;
-        #else
-        ; /* do nothing */
-        #endif
+    if (!auddec1->reuseCodec ||
+        strcmp(auddec1->parkedEngineName, auddec1->engineName) ||
+        strcmp(auddec1->parkedCodecName, auddec1->codecName) ||
+        !gst_tiengine_unpark(auddec1->hParkedEngine)) {
+        GST_INFO("can't reuse audio decoder \"%s\" for \"%s\"\n",
+            auddec1->parkedCodecName, auddec1->codecName);
+        gst_tiauddec1_free_parked(auddec1);
+        return FALSE;
     }
 
-    /* Initialize audio decoder */
-    GST_LOG("opening audio decoder \"%s\"\n", auddec1->codecName);
-    auddec1->hAd = Adec1_create(auddec1->hEngine, (Char*)auddec1->codecName,
-                      &params, &dynParams);
+    GST_INFO("reusing audio decoder \"%s\"\n", auddec1->codecName);
 
-    if (auddec1->hAd == NULL) {
-        GST_ELEMENT_ERROR(auddec1, STREAM, CODEC_NOT_FOUND,
-        ("failed to create audio decoder: %s\n", auddec1->codecName), (NULL));
-        GST_LOG("closing codec engine\n");
-        return FALSE;
+    auddec1->hEngine          = auddec1->hParkedEngine;
+    auddec1->hAd              = auddec1->hParkedAd;
+    auddec1->circBuf          = auddec1->parkedCircBuf;
+    auddec1->hOutBufTab       = auddec1->hParkedOutBufTab;
+
+    auddec1->hParkedEngine    = NULL;
+    auddec1->hParkedAd        = NULL;
+    auddec1->parkedCircBuf    = NULL;
+    auddec1->hParkedOutBufTab = NULL;
+    gst_tiauddec1_free_parked(auddec1);
+
+    /* Forget the last stream */
+    gst_ticircbuffer_reset(auddec1->circBuf);
+
+    decStatus.size         = sizeof(AUDDEC1_Status);
+    decStatus.data.buf     = NULL;
+    decStatus.data.bufSize = 0;
+
+    if (AUDDEC1_control(Adec1_getVisaHandle(auddec1->hAd), XDM_RESET,
+            &dynParams, &decStatus) != AUDDEC1_EOK) {
+        GST_WARNING("failed to reset audio decoder\n");
     }
 
-    /* Set up a circular input buffer capable of holding two encoded frames */
-    auddec1->circBuf = gst_ticircbuffer_new(
-                            Adec1_getInBufSize(auddec1->hAd), 30, FALSE);
+    /* There may now be too few output buffers */
+    if (BufTab_getNumBufs(GST_TIDMAIBUFTAB_BUFTAB(auddec1->hOutBufTab)) <
+        auddec1->numOutputBufs) {
+        GST_LOG("replacing output buffers\n");
+        gst_tidmaibuftab_unref(auddec1->hOutBufTab);
+        auddec1->hOutBufTab = NULL;
+    }
 
-    if (auddec1->circBuf == NULL) {
-        GST_ELEMENT_ERROR(auddec1, RESOURCE, NO_SPACE_LEFT,
-        ("failed to create circular input buffer\n"), (NULL));
-        return FALSE;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tiauddec1_free_parked
+ *    Delete the codec kept by codec_park, if any.
+ *****************************************************************************/
+static void gst_tiauddec1_free_parked(GstTIAuddec1 *auddec1)
+{
+    if (auddec1->parkedCircBuf) {
+        gst_ticircbuffer_unref(auddec1->parkedCircBuf);
+        auddec1->parkedCircBuf = NULL;
     }
 
-    /* Display buffer contents if displayBuffer=TRUE was specified */
-    gst_ticircbuffer_set_display(auddec1->circBuf, auddec1->displayBuffer);
+    if (auddec1->hParkedOutBufTab) {
+        gst_tidmaibuftab_unref(auddec1->hParkedOutBufTab);
+        auddec1->hParkedOutBufTab = NULL;
+    }
+
+    if (auddec1->hParkedAd) {
+        GST_LOG("closing kept audio decoder\n");
+        Adec1_delete(auddec1->hParkedAd);
+        auddec1->hParkedAd = NULL;
+    }
+
+    if (auddec1->hParkedEngine) {
+        gst_tiengine_close_parked(auddec1->hParkedEngine);
+        auddec1->hParkedEngine = NULL;
+    }
+
+    g_free(auddec1->parkedEngineName);
+    g_free(auddec1->parkedCodecName);
+    auddec1->parkedEngineName = NULL;
+    auddec1->parkedCodecName  = NULL;
+}
+
+
+/******************************************************************************
+ * gst_tiauddec1_codec_start
+ *     Initialize codec engine
+ *****************************************************************************/
+static gboolean gst_tiauddec1_codec_start (GstTIAuddec1  *auddec1)
+{
+    AUDDEC1_Params          params    = Adec1_Params_DEFAULT;
+    AUDDEC1_DynamicParams   dynParams = Adec1_DynamicParams_DEFAULT;
+    Buffer_Attrs            bAttrs    = Buffer_Attrs_DEFAULT;
+    GstClockTime            startTime = gst_util_get_timestamp();
+    gboolean                reused;
 
     /* Define the number of display buffers to allocate.  This number must be
      * at least 2, If this has not been set via set_property(), default to the
@@ -1144,6 +1294,58 @@ static gboolean gst_tiauddec1_codec_start (GstTIAuddec1  *auddec1)
         auddec1->numOutputBufs = 2;
     }
 
+    /* Reuse the codec kept from the last stream if there is one */
+    reused = gst_tiauddec1_codec_unpark(auddec1);
+    if (!reused) {
+
+        /* Open the codec engine */
+        GST_LOG("opening codec engine \"%s\"\n", auddec1->engineName);
+        auddec1->hEngine = gst_tiengine_open(auddec1->engineName);
+
+        if (auddec1->hEngine == NULL) {
+            GST_ELEMENT_ERROR(auddec1, RESOURCE, FAILED,
+            ("failed to open codec engine \"%s\"\n", auddec1->engineName),
+            (NULL));
+            return FALSE;
+        }
+
+        if (gst_tiauddec1_codec_is_aac(auddec1)) {
+            #if defined (Platform_dm365) || defined(Platform_dm368)
+            params.dataEndianness = XDM_LE_16;
+            #else
+            ; /* do nothing */
+            #endif
+        }
+
+        /* Initialize audio decoder */
+        GST_LOG("opening audio decoder \"%s\"\n", auddec1->codecName);
+        auddec1->hAd = Adec1_create(auddec1->hEngine,
+                          (Char*)auddec1->codecName, &params, &dynParams);
+
+        if (auddec1->hAd == NULL) {
+            GST_ELEMENT_ERROR(auddec1, STREAM, CODEC_NOT_FOUND,
+            ("failed to create audio decoder: %s\n", auddec1->codecName),
+            (NULL));
+            GST_LOG("closing codec engine\n");
+            return FALSE;
+        }
+
+        /* Set up a circular input buffer capable of holding two encoded
+         * frames
+         */
+        auddec1->circBuf = gst_ticircbuffer_new(
+                                Adec1_getInBufSize(auddec1->hAd), 30, FALSE);
+
+        if (auddec1->circBuf == NULL) {
+            GST_ELEMENT_ERROR(auddec1, RESOURCE, NO_SPACE_LEFT,
+            ("failed to create circular input buffer\n"), (NULL));
+            return FALSE;
+        }
+    }
+
+    /* Display buffer contents if displayBuffer=TRUE was specified */
+    gst_ticircbuffer_set_display(auddec1->circBuf, auddec1->displayBuffer);
+
     /* If we're still showing 0 channels, we were not able to determine the
      * number of channels from the input stream.  Default to 2 channels and
      * generate a warning.
@@ -1154,22 +1356,30 @@ static gboolean gst_tiauddec1_codec_start (GstTIAuddec1  *auddec1)
         auddec1->channels = 2;
     }
 
-    /* Create codec output buffers.  
+    /* Create codec output buffers, unless we are reusing them.
      */
-    GST_LOG("creating output buffers\n");
-      
-    /* By default, new buffers are marked as in-use by the codec */
-    bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
+    if (auddec1->hOutBufTab == NULL) {
+        GST_LOG("creating output buffers\n");
 
-    auddec1->hOutBufTab = gst_tidmaibuftab_new(auddec1->numOutputBufs, 
-        Adec1_getOutBufSize(auddec1->hAd), &bAttrs);
+        /* By default, new buffers are marked as in-use by the codec */
+        bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
 
-    if (auddec1->hOutBufTab == NULL) {
-        GST_ELEMENT_ERROR(auddec1, RESOURCE, NO_SPACE_LEFT,
-        ("failed to create output buffer\n"), (NULL));
-        return FALSE;
+        auddec1->hOutBufTab = gst_tidmaibuftab_new(auddec1->numOutputBufs, 
+            Adec1_getOutBufSize(auddec1->hAd), &bAttrs);
+        gst_tidmaibuftab_set_name(auddec1->hOutBufTab,
+            GST_ELEMENT_NAME(auddec1));
+
+        if (auddec1->hOutBufTab == NULL) {
+            GST_ELEMENT_ERROR(auddec1, RESOURCE, NO_SPACE_LEFT,
+            ("failed to create output buffer\n"), (NULL));
+            return FALSE;
+        }
     }
 
+    GST_INFO("%s audio decoder \"%s\" in %" GST_TIME_FORMAT "\n",
+        reused ? "reused" : "created", auddec1->codecName,
+        GST_TIME_ARGS(gst_util_get_timestamp() - startTime));
+
     return TRUE;
 }
 
@@ -1215,6 +1425,15 @@ static void* gst_tiauddec1_decode_thread(void *arg)
 
         /* Obtain an encoded data frame */
         encDataWindow  = gst_ticircbuffer_get_data(auddec1->circBuf);
+
+        /* A seek is flushing the pipeline.  Adec1 has no flush call and the
+         * codec picks up at the next frame header, so just wait for data
+         * from the new position.
+         */
+        if (encDataWindow == NULL) {
+            continue;
+        }
+
         encDataTime    = GST_BUFFER_TIMESTAMP(encDataWindow);
         hEncDataWindow = GST_TIDMAIBUFFERTRANSPORT_DMAIBUF(encDataWindow);
 
@@ -1291,6 +1510,15 @@ static void* gst_tiauddec1_decode_thread(void *arg)
             numSamples     = sampleDataSize / (2 * auddec1->channels) ;
             sampleDuration = GST_FRAMES_TO_CLOCK_TIME(numSamples, sampleRate);
             encDataTime    = auddec1->totalDuration;
+
+            /* Prefer the upstream timestamp of the consumed data if there
+             * was one, and continue synthesizing timestamps from there.
+             */
+            if (GST_CLOCK_TIME_IS_VALID(
+                    GST_TICIRCBUFFER_CONSUMED_TIMESTAMP(auddec1->circBuf))) {
+                encDataTime = auddec1->totalDuration =
+                    GST_TICIRCBUFFER_CONSUMED_TIMESTAMP(auddec1->circBuf);
+            }
             offset         = GST_CLOCK_TIME_TO_FRAMES(auddec1->totalDuration,
                                                     sampleRate);
 
@@ -1333,14 +1561,17 @@ static void* gst_tiauddec1_decode_thread(void *arg)
                 GST_TIME_ARGS (GST_BUFFER_TIMESTAMP(outBuf)),
                 GST_TIME_ARGS (GST_BUFFER_DURATION(outBuf)));
 
-            if (gst_pad_push(auddec1->srcpad, outBuf) != GST_FLOW_OK) {
+            /* Downstream refuses buffers while a seek is flushing */
+            if (gst_pad_push(auddec1->srcpad, outBuf) != GST_FLOW_OK &&
+                !gst_ticircbuffer_is_flushing(auddec1->circBuf)) {
                 GST_DEBUG("push to source pad failed\n");
                 goto thread_failure;
             }
         }
 
         /* Release buffers no longer in use by the codec */
-        Buffer_freeUseMask(hDstBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(auddec1->hOutBufTab, hDstBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
 thread_failure:
@@ -1357,7 +1588,8 @@ thread_exit:
     while (bufIdx-- > 0) {
         Buffer_Handle hBuf = BufTab_getBuf(
             GST_TIDMAIBUFTAB_BUFTAB(auddec1->hOutBufTab), bufIdx);
-        Buffer_freeUseMask(hBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(auddec1->hOutBufTab, hBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
     /* Release the last buffer we retrieved from the circular buffer */
@@ -89,6 +89,18 @@ struct _GstTIAuddec1
   GstTIDmaiBufTab *hOutBufTab;
   GstTICircBuffer *circBuf;
 
+  /* Codec reuse.  When reuseCodec is set, codec_stop keeps the codec, its
+   * circular buffer and output BufTab here, and codec_start reuses them if
+   * the next stream uses the same codec.
+   */
+  gboolean         reuseCodec;
+  Engine_Handle    hParkedEngine;
+  Adec1_Handle     hParkedAd;
+  GstTICircBuffer *parkedCircBuf;
+  GstTIDmaiBufTab *hParkedOutBufTab;
+  gchar           *parkedEngineName;
+  gchar           *parkedCodecName;
+
   /* AAC header (qtdemuxer) */
   GstBuffer       *aac_header_data;
 
@@ -63,6 +63,7 @@
 #include "gsttithreadprops.h"
 #include "gsttiquicktime_aac.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 
 /* Enclare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tiaudenc1_debug);
@@ -79,7 +80,8 @@ enum
   PROP_SAMPLEFREQ,      /* sample frequency (int)   */
   PROP_NUM_OUTPUT_BUFS, /* numOutputBufs    (int)     */
   PROP_DISPLAY_BUFFER,  /* displayBuffer    (boolean) */
-  PROP_GEN_TIMESTAMPS   /* genTimeStamps    (boolean) */
+  PROP_GEN_TIMESTAMPS,  /* genTimeStamps    (boolean) */
+  PROP_REUSE_CODEC      /* reuseCodec       (boolean) */
 };
 
 /* Define sink (input) pad capabilities.  Currently, RAW is
@@ -146,6 +148,13 @@ static gboolean
     gst_tiaudenc1_codec_start (GstTIAudenc1  *audenc);
 static gboolean 
     gst_tiaudenc1_codec_stop (GstTIAudenc1  *audenc1);
+static gboolean
+    gst_tiaudenc1_codec_park(GstTIAudenc1 *audenc1);
+static gboolean
+    gst_tiaudenc1_codec_unpark(GstTIAudenc1 *audenc1,
+        AUDENC1_Params *params, AUDENC1_DynamicParams *dynParams);
+static void
+    gst_tiaudenc1_free_parked(GstTIAudenc1 *audenc1);
 static void 
     gst_tiaudenc1_init_env(GstTIAudenc1 *audenc1);
 
@@ -274,6 +283,12 @@ static void gst_tiaudenc1_class_init(GstTIAudenc1Class *klass)
         g_param_spec_boolean("genTimeStamps", "Generate Time Stamps",
             "Set timestamps on output buffers",
             TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_REUSE_CODEC,
+        g_param_spec_boolean("reuseCodec", "Reuse codec",
+            "Keep the codec and its buffers when the stream stops, and reuse "
+            "them for the next stream if it uses the same codec settings",
+            TRUE, G_PARAM_WRITABLE));
 }
 
 /******************************************************************************
@@ -329,6 +344,13 @@ static void gst_tiaudenc1_init_env(GstTIAudenc1 *audenc1)
                     audenc1->genTimeStamps ? "TRUE" : "FALSE");
     }
 
+    if (gst_ti_env_is_defined("GST_TI_TIAudenc1_reuseCodec")) {
+        audenc1->reuseCodec = 
+                gst_ti_env_get_boolean("GST_TI_TIAudenc1_reuseCodec");
+        GST_LOG("Setting reuseCodec =%s\n", 
+                    audenc1->reuseCodec ? "TRUE" : "FALSE");
+    }
+
     GST_LOG("gst_tiaudenc1_init_env - end");
 }
 
@@ -392,6 +414,14 @@ static void gst_tiaudenc1_init(GstTIAudenc1 *audenc1, GstTIAudenc1Class *gclass)
     audenc1->hOutBufTab         = NULL;
     audenc1->circBuf            = NULL;
 
+    audenc1->reuseCodec         = TRUE;
+    audenc1->hParkedEngine      = NULL;
+    audenc1->hParkedAe          = NULL;
+    audenc1->parkedCircBuf      = NULL;
+    audenc1->hParkedOutBufTab   = NULL;
+    audenc1->parkedEngineName   = NULL;
+    audenc1->parkedCodecName    = NULL;
+
     gst_tiaudenc1_init_env(audenc1);
 }
 
@@ -455,6 +485,11 @@ static void gst_tiaudenc1_set_property(GObject *object, guint prop_id,
             GST_LOG("setting \"genTimeStamps\" to \"%s\"\n",
                 audenc1->genTimeStamps ? "TRUE" : "FALSE");
             break;
+        case PROP_REUSE_CODEC:
+            audenc1->reuseCodec = g_value_get_boolean(value);
+            GST_LOG("setting \"reuseCodec\" to \"%s\"\n",
+                audenc1->reuseCodec ? "TRUE" : "FALSE");
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -917,10 +952,13 @@ static GstStateChangeReturn gst_tiaudenc1_change_state(GstElement *element,
     /* Handle ramp-down state changes */
     switch (transition) {
         case GST_STATE_CHANGE_READY_TO_NULL:
-            /* Shut down any running audio encoder */
+            /* Shut down any running audio encoder, and the one kept for
+             * reuse.
+             */
             if (!gst_tiaudenc1_exit_audio(audenc1)) {
                 return GST_STATE_CHANGE_FAILURE;
             }
+            gst_tiaudenc1_free_parked(audenc1);
             break;
         default:
             break;
@@ -936,6 +974,11 @@ static GstStateChangeReturn gst_tiaudenc1_change_state(GstElement *element,
  *****************************************************************************/
 static gboolean gst_tiaudenc1_codec_stop (GstTIAudenc1  *audenc1)
 {
+    /* Keep the codec for the next stream if we can */
+    if (gst_tiaudenc1_codec_park(audenc1)) {
+        return TRUE;
+    }
+
     if (audenc1->circBuf) {
         GstTICircBuffer *circBuf;
 
@@ -960,7 +1003,7 @@ static gboolean gst_tiaudenc1_codec_stop (GstTIAudenc1  *audenc1)
 
     if (audenc1->hEngine) {
         GST_LOG("closing codec engine\n");
-        Engine_close(audenc1->hEngine);
+        gst_tiengine_close(audenc1->hEngine);
         audenc1->hEngine = NULL;
     }
 
@@ -968,6 +1011,141 @@ static gboolean gst_tiaudenc1_codec_stop (GstTIAudenc1  *audenc1)
 }
 
 
+/******************************************************************************
+ * gst_tiaudenc1_codec_park
+ *    Keep the codec, circular buffer and output BufTab for the next call to
+ *    codec_start instead of deleting them.  Returns FALSE if reuseCodec is
+ *    off.
+ *****************************************************************************/
+static gboolean gst_tiaudenc1_codec_park(GstTIAudenc1 *audenc1)
+{
+    if (!audenc1->reuseCodec || !audenc1->hAe || !audenc1->circBuf ||
+        !audenc1->hOutBufTab) {
+        return FALSE;
+    }
+
+    /* Only one codec is kept */
+    gst_tiaudenc1_free_parked(audenc1);
+
+    GST_LOG("keeping audio encoder \"%s\" for reuse\n", audenc1->codecName);
+
+    audenc1->hParkedEngine    = audenc1->hEngine;
+    audenc1->hParkedAe        = audenc1->hAe;
+    audenc1->parkedCircBuf    = audenc1->circBuf;
+    audenc1->hParkedOutBufTab = audenc1->hOutBufTab;
+    audenc1->parkedEngineName = g_strdup(audenc1->engineName);
+    audenc1->parkedCodecName  = g_strdup(audenc1->codecName);
+    gst_tiengine_park(audenc1->hParkedEngine);
+
+    audenc1->hEngine          = NULL;
+    audenc1->hAe              = NULL;
+    audenc1->circBuf          = NULL;
+    audenc1->hOutBufTab       = NULL;
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tiaudenc1_codec_unpark
+ *    Take back the codec kept by codec_park if it was created with the same
+ *    codec and parameters, and reset it for a new stream.  Returns FALSE,
+ *    after freeing the kept codec if there was one, if codec_start has to
+ *    create a new one.
+ *****************************************************************************/
+static gboolean gst_tiaudenc1_codec_unpark(GstTIAudenc1 *audenc1,
+                    AUDENC1_Params *params, AUDENC1_DynamicParams *dynParams)
+{
+    AUDENC1_Status encStatus;
+
+    if (!audenc1->hParkedAe) {
+        return FALSE;
+    }
+
+    if (!audenc1->reuseCodec ||
+        strcmp(audenc1->parkedEngineName, audenc1->engineName) ||
+        strcmp(audenc1->parkedCodecName, audenc1->codecName) ||
+        params->sampleRate  != audenc1->codecParams.sampleRate ||
+        params->bitRate     != audenc1->codecParams.bitRate ||
+        params->channelMode != audenc1->codecParams.channelMode ||
+        !gst_tiengine_unpark(audenc1->hParkedEngine)) {
+        GST_INFO("can't reuse audio encoder \"%s\"\n",
+            audenc1->parkedCodecName);
+        gst_tiaudenc1_free_parked(audenc1);
+        return FALSE;
+    }
+
+    GST_INFO("reusing audio encoder \"%s\"\n", audenc1->codecName);
+
+    audenc1->hEngine          = audenc1->hParkedEngine;
+    audenc1->hAe              = audenc1->hParkedAe;
+    audenc1->circBuf          = audenc1->parkedCircBuf;
+    audenc1->hOutBufTab       = audenc1->hParkedOutBufTab;
+
+    audenc1->hParkedEngine    = NULL;
+    audenc1->hParkedAe        = NULL;
+    audenc1->parkedCircBuf    = NULL;
+    audenc1->hParkedOutBufTab = NULL;
+    gst_tiaudenc1_free_parked(audenc1);
+
+    /* Forget the last stream */
+    gst_ticircbuffer_reset(audenc1->circBuf);
+
+    encStatus.size         = sizeof(AUDENC1_Status);
+    encStatus.data.buf     = NULL;
+    encStatus.data.bufSize = 0;
+
+    if (AUDENC1_control(Aenc1_getVisaHandle(audenc1->hAe), XDM_RESET,
+            dynParams, &encStatus) != AUDENC1_EOK) {
+        GST_WARNING("failed to reset audio encoder\n");
+    }
+
+    /* There may now be too few output buffers */
+    if (BufTab_getNumBufs(GST_TIDMAIBUFTAB_BUFTAB(audenc1->hOutBufTab)) <
+        audenc1->numOutputBufs) {
+        GST_LOG("replacing output buffers\n");
+        gst_tidmaibuftab_unref(audenc1->hOutBufTab);
+        audenc1->hOutBufTab = NULL;
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tiaudenc1_free_parked
+ *    Delete the codec kept by codec_park, if any.
+ *****************************************************************************/
+static void gst_tiaudenc1_free_parked(GstTIAudenc1 *audenc1)
+{
+    if (audenc1->parkedCircBuf) {
+        gst_ticircbuffer_unref(audenc1->parkedCircBuf);
+        audenc1->parkedCircBuf = NULL;
+    }
+
+    if (audenc1->hParkedOutBufTab) {
+        gst_tidmaibuftab_unref(audenc1->hParkedOutBufTab);
+        audenc1->hParkedOutBufTab = NULL;
+    }
+
+    if (audenc1->hParkedAe) {
+        GST_LOG("closing kept audio encoder\n");
+        Aenc1_delete(audenc1->hParkedAe);
+        audenc1->hParkedAe = NULL;
+    }
+
+    if (audenc1->hParkedEngine) {
+        gst_tiengine_close_parked(audenc1->hParkedEngine);
+        audenc1->hParkedEngine = NULL;
+    }
+
+    g_free(audenc1->parkedEngineName);
+    g_free(audenc1->parkedCodecName);
+    audenc1->parkedEngineName = NULL;
+    audenc1->parkedCodecName  = NULL;
+}
+
+
 /******************************************************************************
  * gst_tiaudenc1_codec_start
  *     Initialize codec engine
@@ -977,6 +1155,8 @@ static gboolean gst_tiaudenc1_codec_start (GstTIAudenc1  *audenc1)
     AUDENC1_Params          params    = Aenc1_Params_DEFAULT;
     AUDENC1_DynamicParams   dynParams = Aenc1_DynamicParams_DEFAULT;
     Buffer_Attrs            bAttrs    = Buffer_Attrs_DEFAULT;
+    GstClockTime            startTime = gst_util_get_timestamp();
+    gboolean                reused;
 
     /* Override the default parameters to use the defaults specified or the
      * user settings.
@@ -997,73 +1177,91 @@ static gboolean gst_tiaudenc1_codec_start (GstTIAudenc1  *audenc1)
     dynParams.bitRate = params.bitRate;
     dynParams.channelMode = params.channelMode;
 
-    /* Open the codec engine */
-    GST_LOG("opening codec engine \"%s\"\n", audenc1->engineName);
-    audenc1->hEngine = Engine_open((Char *) audenc1->engineName, NULL, NULL);
-
-    if (audenc1->hEngine == NULL) {
-        GST_ELEMENT_ERROR(audenc1, RESOURCE, READ,
-        ("Failed to open codec engine \"%s\"\n", audenc1->engineName), (NULL));
-        return FALSE;
+    /* Define the number of display buffers to allocate.  This number must be
+     * at least 2, If this has not been set via set_property(), default to the
+     * minimal value.
+      */
+    if (audenc1->numOutputBufs == 0) {
+        audenc1->numOutputBufs = 2;
     }
 
-    /* Initialize audio encoder */
-    GST_LOG("opening audio encoder \"%s\"\n", audenc1->codecName);
-    audenc1->hAe = Aenc1_create(audenc1->hEngine, (Char*)audenc1->codecName,
-                      &params, &dynParams);
+    /* Reuse the codec kept from the last stream if there is one */
+    reused = gst_tiaudenc1_codec_unpark(audenc1, &params, &dynParams);
+    if (!reused) {
 
-    if (audenc1->hAe == NULL) {
-        GST_ELEMENT_ERROR(audenc1, RESOURCE, FAILED,
-        ("Failed to create audio encoder: %s\n", audenc1->codecName), (NULL));
-        GST_ELEMENT_ERROR(audenc1, RESOURCE, FAILED,
-        ("This may be caused by specifying channels/bitrate "
-         "combinations that are too high for your codec.  Please "
-         "make sure that channels * bitrate does not exceed the max "
-         "bitrate supported by your codec.  Current settings are:\n"
-         "\tbitrate = %d\n\tchannels = %d\n\ttotal bitrate = %d\n",
-         audenc1->bitrate, audenc1->channels,
-         audenc1->bitrate * audenc1->channels), (NULL));
-        GST_LOG("closing codec engine\n");
-        return FALSE;
-    }
+        /* Open the codec engine */
+        GST_LOG("opening codec engine \"%s\"\n", audenc1->engineName);
+        audenc1->hEngine = gst_tiengine_open(audenc1->engineName);
 
-    /* Set up a circular input buffer capable of holding 3 RAW frames */
-    audenc1->circBuf = gst_ticircbuffer_new(
-                            Aenc1_getInBufSize(audenc1->hAe), 3, FALSE);
+        if (audenc1->hEngine == NULL) {
+            GST_ELEMENT_ERROR(audenc1, RESOURCE, READ,
+            ("Failed to open codec engine \"%s\"\n", audenc1->engineName),
+            (NULL));
+            return FALSE;
+        }
 
-    if (audenc1->circBuf == NULL) {
-        GST_ELEMENT_ERROR(audenc1, RESOURCE, NO_SPACE_LEFT,
-        ("Failed to create circular input buffer\n"), (NULL));
-        return FALSE;
+        /* Initialize audio encoder */
+        GST_LOG("opening audio encoder \"%s\"\n", audenc1->codecName);
+        audenc1->hAe = Aenc1_create(audenc1->hEngine,
+                          (Char*)audenc1->codecName, &params, &dynParams);
+
+        if (audenc1->hAe == NULL) {
+            GST_ELEMENT_ERROR(audenc1, RESOURCE, FAILED,
+            ("Failed to create audio encoder: %s\n", audenc1->codecName),
+            (NULL));
+            GST_ELEMENT_ERROR(audenc1, RESOURCE, FAILED,
+            ("This may be caused by specifying channels/bitrate "
+             "combinations that are too high for your codec.  Please "
+             "make sure that channels * bitrate does not exceed the max "
+             "bitrate supported by your codec.  Current settings are:\n"
+             "\tbitrate = %d\n\tchannels = %d\n\ttotal bitrate = %d\n",
+             audenc1->bitrate, audenc1->channels,
+             audenc1->bitrate * audenc1->channels), (NULL));
+            GST_LOG("closing codec engine\n");
+            return FALSE;
+        }
+
+        /* Remember how the codec was created, for codec_unpark */
+        audenc1->codecParams = params;
+
+        /* Set up a circular input buffer capable of holding 3 RAW frames */
+        audenc1->circBuf = gst_ticircbuffer_new(
+                                Aenc1_getInBufSize(audenc1->hAe), 3, FALSE);
+
+        if (audenc1->circBuf == NULL) {
+            GST_ELEMENT_ERROR(audenc1, RESOURCE, NO_SPACE_LEFT,
+            ("Failed to create circular input buffer\n"), (NULL));
+            return FALSE;
+        }
     }
 
     /* Display buffer contents if displayBuffer=TRUE was specified */
     gst_ticircbuffer_set_display(audenc1->circBuf, audenc1->displayBuffer);
 
-    /* Define the number of display buffers to allocate.  This number must be
-     * at least 2, If this has not been set via set_property(), default to the
-     * minimal value.
-      */
-    if (audenc1->numOutputBufs == 0) {
-        audenc1->numOutputBufs = 2;
-    }
-
-    /* Create codec output buffers.  
+    /* Create codec output buffers, unless we are reusing them.
      */
-    GST_LOG("creating output buffers\n");
-      
-    /* By default, new buffers are marked as in-use by the codec */
-    bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
+    if (audenc1->hOutBufTab == NULL) {
+        GST_LOG("creating output buffers\n");
 
-    audenc1->hOutBufTab = gst_tidmaibuftab_new(audenc1->numOutputBufs, 
-        Aenc1_getOutBufSize(audenc1->hAe), &bAttrs);
+        /* By default, new buffers are marked as in-use by the codec */
+        bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
 
-    if (audenc1->hOutBufTab == NULL) {
-        GST_ELEMENT_ERROR(audenc1, RESOURCE, NO_SPACE_LEFT,
-        ("Failed to create output buffer\n"), (NULL));
-        return FALSE;
+        audenc1->hOutBufTab = gst_tidmaibuftab_new(audenc1->numOutputBufs, 
+            Aenc1_getOutBufSize(audenc1->hAe), &bAttrs);
+        gst_tidmaibuftab_set_name(audenc1->hOutBufTab,
+            GST_ELEMENT_NAME(audenc1));
+
+        if (audenc1->hOutBufTab == NULL) {
+            GST_ELEMENT_ERROR(audenc1, RESOURCE, NO_SPACE_LEFT,
+            ("Failed to create output buffer\n"), (NULL));
+            return FALSE;
+        }
     }
 
+    GST_INFO("%s audio encoder \"%s\" in %" GST_TIME_FORMAT "\n",
+        reused ? "reused" : "created", audenc1->codecName,
+        GST_TIME_ARGS(gst_util_get_timestamp() - startTime));
+
     return TRUE;
 }
 
@@ -1211,7 +1409,8 @@ static void* gst_tiaudenc1_encode_thread(void *arg)
         }
 
         /* Release buffers no longer in use by the codec */
-        Buffer_freeUseMask(hDstBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(audenc1->hOutBufTab, hDstBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
 thread_failure:
@@ -1228,7 +1427,8 @@ thread_exit:
     while (bufIdx-- > 0) {
         Buffer_Handle hBuf = BufTab_getBuf(
             GST_TIDMAIBUFTAB_BUFTAB(audenc1->hOutBufTab), bufIdx);
-        Buffer_freeUseMask(hBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(audenc1->hOutBufTab, hBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
     /* Release the last buffer we retrieved from the circular buffer */
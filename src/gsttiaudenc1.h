@@ -98,6 +98,19 @@ struct _GstTIAudenc1
   GstTIDmaiBufTab  *hOutBufTab;
   GstTICircBuffer  *circBuf;
 
+  /* Codec reuse.  When reuseCodec is set, codec_stop keeps the codec, its
+   * circular buffer and output BufTab here, and codec_start reuses them if
+   * the next stream uses the same codec and creation parameters.
+   */
+  gboolean          reuseCodec;
+  Engine_Handle     hParkedEngine;
+  Aenc1_Handle      hParkedAe;
+  GstTICircBuffer  *parkedCircBuf;
+  GstTIDmaiBufTab  *hParkedOutBufTab;
+  gchar            *parkedEngineName;
+  gchar            *parkedCodecName;
+  AUDENC1_Params    codecParams;       /* params the codec was created with */
+
   /* AAC header (qtdemuxer) */
   GstBuffer       *aac_header_data;
 };
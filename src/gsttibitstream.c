@@ -0,0 +1,743 @@
+/*
+ * gsttibitstream.c
+ *
+ * This file defines helper functions for scanning encoded elementary
+ * streams (H.264, MPEG-4 part 2, MPEG-2 video).
+ *
+ * The start code scanner looks at 16 bytes at a time using NEON on ARM or
+ * SSE2 on x86 when the compiler targets them, and falls back to a byte-wise
+ * scan otherwise.  Both paths return exactly the same offsets.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define GST_TI_SIMD_SCAN
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#  define GST_TI_SIMD_SCAN
+#endif
+
+#include "gsttibitstream.h"
+
+/* Number of bytes checked by each vector step */
+#define SCAN_BLOCK 16
+
+/* Classification of a start code by the access unit framers.  A unit that
+ * can begin an access unit ends the current one once the current one has
+ * seen its picture data.
+ */
+#define FRAME_START   0x1
+#define FRAME_PICTURE 0x2
+
+/* Largest H.264 sequence parameter set payload examined for the picture
+ * size.  The fields needed come well before the end of any real SPS.
+ */
+#define SPS_MAX_BYTES 256
+
+/* Reads big-endian bit fields.  Reads past the end return zeros and set
+ * overrun.
+ */
+typedef struct _GstTIBitReader {
+    const guint8 *data;
+    gint          size;
+    gint          bit;
+    gboolean      overrun;
+} GstTIBitReader;
+
+/* Local function declarations */
+static gint gst_ti_find_start_code_c(const guint8 *data, gint offset,
+                gint size);
+static gint gst_ti_frame_scan(const guint8 *data, gint size,
+                GstTIFrameState *state, gint (*classify)(const guint8 *code));
+static gint gst_ti_classify_h264(const guint8 *code);
+static gint gst_ti_classify_mpeg4(const guint8 *code);
+static gint gst_ti_classify_mpeg2(const guint8 *code);
+static guint32 gst_ti_read_bits(GstTIBitReader *br, gint n);
+static guint32 gst_ti_read_ue(GstTIBitReader *br);
+static gint32 gst_ti_read_se(GstTIBitReader *br);
+static gboolean gst_ti_parse_sps(const guint8 *data, gint size, gint *width,
+                    gint *height);
+static gboolean gst_ti_parse_vol(const guint8 *data, gint size, gint *width,
+                    gint *height);
+
+#ifdef GST_TI_SIMD_SCAN
+/******************************************************************************
+ * gst_ti_scan_block
+ *    Return TRUE if a 00 00 01 prefix starts at any of the SCAN_BLOCK
+ *    positions beginning at p.  Reads SCAN_BLOCK + 2 bytes.
+ ******************************************************************************/
+static inline gboolean gst_ti_scan_block(const guint8 *p)
+{
+#if defined(__ARM_NEON__)
+    uint8x16_t zero = vdupq_n_u8(0);
+    uint8x16_t one  = vdupq_n_u8(1);
+    uint8x16_t hit;
+    uint64x2_t hit64;
+
+    hit = vandq_u8(vandq_u8(vceqq_u8(vld1q_u8(p), zero),
+                            vceqq_u8(vld1q_u8(p + 1), zero)),
+                   vceqq_u8(vld1q_u8(p + 2), one));
+    hit64 = vreinterpretq_u64_u8(hit);
+
+    return (vgetq_lane_u64(hit64, 0) | vgetq_lane_u64(hit64, 1)) != 0;
+#else
+    __m128i zero = _mm_setzero_si128();
+    __m128i one  = _mm_set1_epi8(1);
+    __m128i hit;
+
+    hit = _mm_and_si128(_mm_and_si128(
+              _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), zero),
+              _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 1)), zero)),
+              _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + 2)), one));
+
+    return _mm_movemask_epi8(hit) != 0;
+#endif
+}
+#endif /* GST_TI_SIMD_SCAN */
+
+
+/******************************************************************************
+ * gst_ti_find_start_code_c
+ *    Byte-wise scan.  Looks at the third byte of each candidate first, which
+ *    lets it skip three bytes at a time through most of the payload.
+ ******************************************************************************/
+static gint gst_ti_find_start_code_c(const guint8 *data, gint offset,
+                gint size)
+{
+    while (offset + 2 < size) {
+        if (data[offset + 2] > 1) {
+            offset += 3;
+        }
+        else if (data[offset + 2] == 1) {
+            if (data[offset] == 0 && data[offset + 1] == 0) {
+                return offset;
+            }
+            offset += 3;
+        }
+        else {
+            offset++;
+        }
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * gst_ti_find_start_code
+ ******************************************************************************/
+gint gst_ti_find_start_code(const guint8 *data, gint offset, gint size)
+{
+#ifdef GST_TI_SIMD_SCAN
+    /* Skip whole blocks that can't contain a start code, then let the
+     * byte-wise scan find the exact position inside the block that does.
+     */
+    while (offset + SCAN_BLOCK + 2 <= size) {
+        if (gst_ti_scan_block(data + offset)) {
+            return gst_ti_find_start_code_c(data, offset,
+                       offset + SCAN_BLOCK + 2);
+        }
+        offset += SCAN_BLOCK;
+    }
+#endif
+
+    return gst_ti_find_start_code_c(data, offset, size);
+}
+
+
+/******************************************************************************
+ * gst_ti_find_start_code4
+ ******************************************************************************/
+gint gst_ti_find_start_code4(const guint8 *data, gint offset, gint size)
+{
+    gint pos = offset;
+
+    while ((pos = gst_ti_find_start_code(data, pos + 1, size)) < size) {
+        if (data[pos - 1] == 0) {
+            return pos - 1;
+        }
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * gst_ti_frame_scan
+ *    Walk the start codes after state->scanned until one begins the next
+ *    access unit.  Each start code is classified exactly once, so a framer
+ *    can be called again with more data without rescanning.
+ ******************************************************************************/
+static gint gst_ti_frame_scan(const guint8 *data, gint size,
+                GstTIFrameState *state, gint (*classify)(const guint8 *code))
+{
+    gint pos    = state->scanned;
+    gint flags;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) < size) {
+
+        /* The classifiers look at two bytes past the prefix */
+        if (pos + 5 > size) {
+            state->scanned = pos;
+            return -1;
+        }
+
+        flags = classify(data + pos + 3);
+
+        if ((flags & FRAME_START) && state->seenPicture) {
+            /* The zero byte of a 4-byte start code goes with the next unit */
+            if (data[pos - 1] == 0) {
+                pos--;
+            }
+            return pos;
+        }
+
+        if (flags & FRAME_PICTURE) {
+            state->seenPicture = TRUE;
+        }
+
+        pos += 3;
+        state->scanned = pos;
+    }
+
+    /* A prefix may be cut off by the end of the data */
+    state->scanned = MAX(state->scanned, size - 2);
+    return -1;
+}
+
+
+/******************************************************************************
+ * gst_ti_classify_h264
+ *    A new access unit starts with an AUD, SEI, SPS, PPS or prefix NAL unit,
+ *    or with a slice whose first_mb_in_slice is zero (ITU-T H.264 7.4.1.2.3).
+ ******************************************************************************/
+static gint gst_ti_classify_h264(const guint8 *code)
+{
+    switch (code[0] & 0x1f) {
+        case 1:
+        case 5:
+            /* first_mb_in_slice is ue(v), which is 0 iff its first bit is 1 */
+            return FRAME_PICTURE | ((code[1] & 0x80) ? FRAME_START : 0);
+        case 6:
+        case 7:
+        case 8:
+        case 9:
+        case 14:
+        case 15:
+        case 16:
+        case 17:
+        case 18:
+            return FRAME_START;
+        default:
+            return 0;
+    }
+}
+
+
+/******************************************************************************
+ * gst_ti_classify_mpeg4
+ *    Visual object sequence, visual object, video object, VOL and GOV headers
+ *    belong to the VOP that follows them.
+ ******************************************************************************/
+static gint gst_ti_classify_mpeg4(const guint8 *code)
+{
+    if (code[0] == 0xb6) {
+        return FRAME_START | FRAME_PICTURE;
+    }
+
+    if (code[0] <= 0x2f || code[0] == 0xb0 || code[0] == 0xb3 ||
+        code[0] == 0xb5) {
+        return FRAME_START;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************
+ * gst_ti_classify_mpeg2
+ *    Sequence and GOP headers belong to the picture that follows them.
+ ******************************************************************************/
+static gint gst_ti_classify_mpeg2(const guint8 *code)
+{
+    if (code[0] == 0x00) {
+        return FRAME_START | FRAME_PICTURE;
+    }
+
+    if (code[0] == 0xb3 || code[0] == 0xb8) {
+        return FRAME_START;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************
+ * gst_ti_frame_h264
+ ******************************************************************************/
+gint gst_ti_frame_h264(const guint8 *data, gint size, GstTIFrameState *state)
+{
+    return gst_ti_frame_scan(data, size, state, gst_ti_classify_h264);
+}
+
+
+/******************************************************************************
+ * gst_ti_frame_mpeg4
+ ******************************************************************************/
+gint gst_ti_frame_mpeg4(const guint8 *data, gint size, GstTIFrameState *state)
+{
+    return gst_ti_frame_scan(data, size, state, gst_ti_classify_mpeg4);
+}
+
+
+/******************************************************************************
+ * gst_ti_frame_mpeg2
+ ******************************************************************************/
+gint gst_ti_frame_mpeg2(const guint8 *data, gint size, GstTIFrameState *state)
+{
+    return gst_ti_frame_scan(data, size, state, gst_ti_classify_mpeg2);
+}
+
+
+/******************************************************************************
+ * gst_ti_find_keyframe_h264
+ ******************************************************************************/
+gint gst_ti_find_keyframe_h264(const guint8 *data, gint offset, gint size)
+{
+    gint pos  = offset;
+    gint type;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 3 < size) {
+        type = data[pos + 3] & 0x1f;
+        if (type == 5 || type == 7) {
+            return pos;
+        }
+        pos += 3;
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * gst_ti_find_keyframe_mpeg4
+ ******************************************************************************/
+gint gst_ti_find_keyframe_mpeg4(const guint8 *data, gint offset, gint size)
+{
+    gint pos = offset;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 4 < size) {
+
+        /* VOL or GOV header */
+        if ((data[pos + 3] >= 0x20 && data[pos + 3] <= 0x2f) ||
+            data[pos + 3] == 0xb3) {
+            return pos;
+        }
+
+        /* VOP with vop_coding_type I */
+        if (data[pos + 3] == 0xb6 && (data[pos + 4] >> 6) == 0) {
+            return pos;
+        }
+        pos += 3;
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * gst_ti_find_keyframe_mpeg2
+ ******************************************************************************/
+gint gst_ti_find_keyframe_mpeg2(const guint8 *data, gint offset, gint size)
+{
+    gint pos = offset;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 5 < size) {
+
+        /* Sequence or GOP header */
+        if (data[pos + 3] == 0xb3 || data[pos + 3] == 0xb8) {
+            return pos;
+        }
+
+        /* Picture with picture_coding_type I, which follows the 10 bit
+         * temporal_reference.
+         */
+        if (data[pos + 3] == 0x00 && ((data[pos + 5] >> 3) & 0x7) == 1) {
+            return pos;
+        }
+        pos += 3;
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * gst_ti_is_droppable_h264
+ ******************************************************************************/
+gboolean gst_ti_is_droppable_h264(const guint8 *data, gint size)
+{
+    gint pos = 0;
+    gint type;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 3 < size) {
+        type = data[pos + 3] & 0x1f;
+        if (type == 1 || type == 5) {
+            return (data[pos + 3] & 0x60) == 0;
+        }
+        pos += 3;
+    }
+
+    return FALSE;
+}
+
+
+/******************************************************************************
+ * gst_ti_is_droppable_mpeg4
+ ******************************************************************************/
+gboolean gst_ti_is_droppable_mpeg4(const guint8 *data, gint size)
+{
+    gint pos = 0;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 4 < size) {
+        if (data[pos + 3] == 0xb6) {
+            return (data[pos + 4] >> 6) == 2;
+        }
+        pos += 3;
+    }
+
+    return FALSE;
+}
+
+
+/******************************************************************************
+ * gst_ti_is_droppable_mpeg2
+ ******************************************************************************/
+gboolean gst_ti_is_droppable_mpeg2(const guint8 *data, gint size)
+{
+    gint pos = 0;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 5 < size) {
+        if (data[pos + 3] == 0x00) {
+            return ((data[pos + 5] >> 3) & 0x7) == 3;
+        }
+        pos += 3;
+    }
+
+    return FALSE;
+}
+
+
+/******************************************************************************
+ * gst_ti_read_bits
+ *    Read an n-bit unsigned field, n <= 32.
+ ******************************************************************************/
+static guint32 gst_ti_read_bits(GstTIBitReader *br, gint n)
+{
+    guint32 value = 0;
+
+    while (n-- > 0) {
+        value <<= 1;
+        if (br->bit < br->size * 8) {
+            value |= (br->data[br->bit >> 3] >> (7 - (br->bit & 7))) & 1;
+        }
+        else {
+            br->overrun = TRUE;
+        }
+        br->bit++;
+    }
+
+    return value;
+}
+
+
+/******************************************************************************
+ * gst_ti_read_ue
+ *    Read an unsigned Exp-Golomb code.
+ ******************************************************************************/
+static guint32 gst_ti_read_ue(GstTIBitReader *br)
+{
+    gint zeros = 0;
+
+    while (gst_ti_read_bits(br, 1) == 0) {
+        if (br->overrun || ++zeros > 31) {
+            br->overrun = TRUE;
+            return 0;
+        }
+    }
+
+    return ((1U << zeros) - 1) + gst_ti_read_bits(br, zeros);
+}
+
+
+/******************************************************************************
+ * gst_ti_read_se
+ *    Read a signed Exp-Golomb code.
+ ******************************************************************************/
+static gint32 gst_ti_read_se(GstTIBitReader *br)
+{
+    guint32 code = gst_ti_read_ue(br);
+
+    return (code & 1) ? (gint32) ((code + 1) / 2) : -(gint32) (code / 2);
+}
+
+
+/******************************************************************************
+ * gst_ti_parse_sps
+ *    Read the cropped picture size from an H.264 sequence parameter set.
+ *    data starts after the NAL header and still holds emulation prevention
+ *    bytes.
+ ******************************************************************************/
+static gboolean gst_ti_parse_sps(const guint8 *data, gint size, gint *width,
+                    gint *height)
+{
+    guint8          rbsp[SPS_MAX_BYTES];
+    GstTIBitReader  br       = { rbsp, 0, 0, FALSE };
+    gint            zeros    = 0;
+    guint32         profile;
+    guint32         chroma   = 1;
+    guint32         frameMbsOnly;
+    guint32         widthMbs, heightMapUnits;
+    guint32         cropLeft = 0, cropRight = 0, cropTop = 0, cropBottom = 0;
+    guint32         count, last, next;
+    gint            i, j;
+
+    /* Strip the 03 from each 00 00 03 */
+    for (i = 0; i < size && br.size < SPS_MAX_BYTES; i++) {
+        if (zeros >= 2 && data[i] == 0x03) {
+            zeros = 0;
+            continue;
+        }
+        zeros = (data[i] == 0) ? zeros + 1 : 0;
+        rbsp[br.size++] = data[i];
+    }
+
+    profile = gst_ti_read_bits(&br, 8);
+    gst_ti_read_bits(&br, 16);             /* constraints, level_idc     */
+    gst_ti_read_ue(&br);                   /* seq_parameter_set_id       */
+
+    if (profile == 100 || profile == 110 || profile == 122 ||
+        profile == 244 || profile == 44  || profile == 83  ||
+        profile == 86  || profile == 118 || profile == 128) {
+        chroma = gst_ti_read_ue(&br);
+        if (chroma == 3) {
+            gst_ti_read_bits(&br, 1);      /* separate_colour_plane_flag */
+        }
+        gst_ti_read_ue(&br);               /* bit_depth_luma_minus8      */
+        gst_ti_read_ue(&br);               /* bit_depth_chroma_minus8    */
+        gst_ti_read_bits(&br, 1);          /* qpprime_y_zero_transform.. */
+
+        if (gst_ti_read_bits(&br, 1)) {    /* seq_scaling_matrix_present */
+            for (i = 0; i < ((chroma != 3) ? 8 : 12); i++) {
+                if (!gst_ti_read_bits(&br, 1)) {
+                    continue;
+                }
+                last = next = 8;
+                for (j = 0; j < ((i < 6) ? 16 : 64) && next != 0; j++) {
+                    next = (last + gst_ti_read_se(&br) + 256) % 256;
+                    last = (next == 0) ? last : next;
+                }
+            }
+        }
+    }
+
+    gst_ti_read_ue(&br);                   /* log2_max_frame_num_minus4  */
+
+    switch (gst_ti_read_ue(&br)) {         /* pic_order_cnt_type         */
+        case 0:
+            gst_ti_read_ue(&br);
+            break;
+        case 1:
+            gst_ti_read_bits(&br, 1);
+            gst_ti_read_se(&br);
+            gst_ti_read_se(&br);
+            count = gst_ti_read_ue(&br);
+            for (i = 0; i < (gint) count && !br.overrun; i++) {
+                gst_ti_read_se(&br);
+            }
+            break;
+        default:
+            break;
+    }
+
+    gst_ti_read_ue(&br);                   /* max_num_ref_frames         */
+    gst_ti_read_bits(&br, 1);              /* gaps_in_frame_num_allowed  */
+
+    widthMbs       = gst_ti_read_ue(&br) + 1;
+    heightMapUnits = gst_ti_read_ue(&br) + 1;
+    frameMbsOnly   = gst_ti_read_bits(&br, 1);
+
+    if (!frameMbsOnly) {
+        gst_ti_read_bits(&br, 1);          /* mb_adaptive_frame_field    */
+    }
+    gst_ti_read_bits(&br, 1);              /* direct_8x8_inference_flag  */
+
+    if (gst_ti_read_bits(&br, 1)) {        /* frame_cropping_flag        */
+        cropLeft   = gst_ti_read_ue(&br);
+        cropRight  = gst_ti_read_ue(&br);
+        cropTop    = gst_ti_read_ue(&br);
+        cropBottom = gst_ti_read_ue(&br);
+    }
+
+    if (br.overrun) {
+        return FALSE;
+    }
+
+    /* Crop offsets are in chroma samples, and in field lines if interlaced */
+    *width  = widthMbs * 16 -
+              (cropLeft + cropRight) * ((chroma == 1 || chroma == 2) ? 2 : 1);
+    *height = heightMapUnits * 16 * (2 - frameMbsOnly) -
+              (cropTop + cropBottom) * ((chroma == 1) ? 2 : 1) *
+              (2 - frameMbsOnly);
+
+    return *width > 0 && *height > 0;
+}
+
+
+/******************************************************************************
+ * gst_ti_parse_vol
+ *    Read the picture size from an MPEG-4 video object layer header.  data
+ *    starts after the start code.  Only rectangular shapes have one.
+ ******************************************************************************/
+static gboolean gst_ti_parse_vol(const guint8 *data, gint size, gint *width,
+                    gint *height)
+{
+    GstTIBitReader  br    = { data, size, 0, FALSE };
+    guint32         verid = 1;
+    guint32         shape;
+    guint32         resolution;
+    gint            bits;
+
+    gst_ti_read_bits(&br, 9);              /* random_accessible, type    */
+
+    if (gst_ti_read_bits(&br, 1)) {        /* is_object_layer_identifier */
+        verid = gst_ti_read_bits(&br, 4);
+        gst_ti_read_bits(&br, 3);
+    }
+
+    if (gst_ti_read_bits(&br, 4) == 15) {  /* aspect_ratio_info          */
+        gst_ti_read_bits(&br, 16);
+    }
+
+    if (gst_ti_read_bits(&br, 1)) {        /* vol_control_parameters     */
+        gst_ti_read_bits(&br, 3);          /* chroma_format, low_delay   */
+        if (gst_ti_read_bits(&br, 1)) {    /* vbv_parameters             */
+            gst_ti_read_bits(&br, 32);
+            gst_ti_read_bits(&br, 32);
+            gst_ti_read_bits(&br, 15);
+        }
+    }
+
+    shape = gst_ti_read_bits(&br, 2);
+    if (shape == 3 && verid != 1) {
+        gst_ti_read_bits(&br, 4);          /* video_object_layer_shape_ex */
+    }
+
+    gst_ti_read_bits(&br, 1);
+    resolution = gst_ti_read_bits(&br, 16);
+    gst_ti_read_bits(&br, 1);
+
+    if (gst_ti_read_bits(&br, 1)) {        /* fixed_vop_rate             */
+        for (bits = 1; bits < 16 && (1U << bits) < resolution; bits++);
+        gst_ti_read_bits(&br, bits);
+    }
+
+    if (shape != 0) {
+        return FALSE;
+    }
+
+    gst_ti_read_bits(&br, 1);
+    *width  = gst_ti_read_bits(&br, 13);
+    gst_ti_read_bits(&br, 1);
+    *height = gst_ti_read_bits(&br, 13);
+
+    return !br.overrun && *width > 0 && *height > 0;
+}
+
+
+/******************************************************************************
+ * gst_ti_parse_size_h264
+ ******************************************************************************/
+gint gst_ti_parse_size_h264(const guint8 *data, gint size, gint *width,
+         gint *height)
+{
+    gint pos = 0;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 3 < size) {
+        if ((data[pos + 3] & 0x1f) == 7) {
+            return gst_ti_parse_sps(data + pos + 4, size - pos - 4, width,
+                       height) ? pos : -1;
+        }
+        pos += 3;
+    }
+
+    return -1;
+}
+
+
+/******************************************************************************
+ * gst_ti_parse_size_mpeg4
+ ******************************************************************************/
+gint gst_ti_parse_size_mpeg4(const guint8 *data, gint size, gint *width,
+         gint *height)
+{
+    gint pos = 0;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 3 < size) {
+        if ((data[pos + 3] & 0xf0) == 0x20) {
+            return gst_ti_parse_vol(data + pos + 4, size - pos - 4, width,
+                       height) ? pos : -1;
+        }
+        pos += 3;
+    }
+
+    return -1;
+}
+
+
+/******************************************************************************
+ * gst_ti_parse_size_mpeg2
+ ******************************************************************************/
+gint gst_ti_parse_size_mpeg2(const guint8 *data, gint size, gint *width,
+         gint *height)
+{
+    gint pos = 0;
+
+    while ((pos = gst_ti_find_start_code(data, pos, size)) + 6 < size) {
+        if (data[pos + 3] == 0xb3) {
+            *width  = (data[pos + 4] << 4) | (data[pos + 5] >> 4);
+            *height = ((data[pos + 5] & 0x0f) << 8) | data[pos + 6];
+            return (*width > 0 && *height > 0) ? pos : -1;
+        }
+        pos += 3;
+    }
+
+    return -1;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
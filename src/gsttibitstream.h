@@ -0,0 +1,117 @@
+/*
+ * gsttibitstream.h
+ *
+ * This file declares helper functions for scanning encoded elementary
+ * streams (H.264, MPEG-4 part 2, MPEG-2 video).
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TIBITSTREAM_H__
+#define __GST_TIBITSTREAM_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Scan progress a framer keeps between calls while the end of an access unit
+ * has not been seen yet.  Zero it before framing a new access unit.
+ */
+typedef struct _GstTIFrameState {
+    gint      scanned;
+    gboolean  seenPicture;
+} GstTIFrameState;
+
+/* Return the size of the complete access unit at the start of data, or -1 if
+ * the start of the following one is not within the first size bytes.
+ */
+typedef gint (*GstTIFramer)(const guint8 *data, gint size,
+                 GstTIFrameState *state);
+
+/* Return the offset of the first point at or after offset where a decoder
+ * can resynchronize, or size if there is none.
+ */
+typedef gint (*GstTISyncFinder)(const guint8 *data, gint offset, gint size);
+
+/* Return TRUE if no other frame references the access unit in data */
+typedef gboolean (*GstTIDroppableCheck)(const guint8 *data, gint size);
+
+/* Find the first sequence header in data and store the picture size it
+ * declares.  Return its offset, or -1 if there is none or it can't be read.
+ */
+typedef gint (*GstTISizeParser)(const guint8 *data, gint size, gint *width,
+                 gint *height);
+
+/* External function declarations */
+
+/* Return the offset of the first 00 00 01 start code prefix at or after
+ * offset, or size if there is none.
+ */
+gint     gst_ti_find_start_code(const guint8 *data, gint offset, gint size);
+
+/* Return the offset of the first 00 00 00 01 start code at or after offset,
+ * or size if there is none.
+ */
+gint     gst_ti_find_start_code4(const guint8 *data, gint offset, gint size);
+
+/* Access unit framers for H.264 byte-stream, MPEG-4 part 2 and MPEG-2 video */
+gint     gst_ti_frame_h264(const guint8 *data, gint size,
+             GstTIFrameState *state);
+gint     gst_ti_frame_mpeg4(const guint8 *data, gint size,
+             GstTIFrameState *state);
+gint     gst_ti_frame_mpeg2(const guint8 *data, gint size,
+             GstTIFrameState *state);
+
+/* Return the offset of the start code of the next random access point (IDR
+ * or SPS, VOL/GOV or I-VOP, sequence/GOP header or I-picture) at or after
+ * offset, or size if there is none.  These are GstTISyncFinders, as is
+ * gst_ti_find_start_code.
+ */
+gint     gst_ti_find_keyframe_h264(const guint8 *data, gint offset, gint size);
+gint     gst_ti_find_keyframe_mpeg4(const guint8 *data, gint offset,
+             gint size);
+gint     gst_ti_find_keyframe_mpeg2(const guint8 *data, gint offset,
+             gint size);
+
+/* Check the first picture of an access unit:  an H.264 slice with
+ * nal_ref_idc 0, an MPEG-4 B-VOP or an MPEG-2 B-picture can be dropped.
+ * These are GstTIDroppableChecks.
+ */
+gboolean gst_ti_is_droppable_h264(const guint8 *data, gint size);
+gboolean gst_ti_is_droppable_mpeg4(const guint8 *data, gint size);
+gboolean gst_ti_is_droppable_mpeg2(const guint8 *data, gint size);
+
+/* Read the picture size from an H.264 SPS (after cropping), an MPEG-4 VOL
+ * header or an MPEG-2 sequence header.  These are GstTISizeParsers.
+ */
+gint     gst_ti_parse_size_h264(const guint8 *data, gint size, gint *width,
+             gint *height);
+gint     gst_ti_parse_size_mpeg4(const guint8 *data, gint size, gint *width,
+             gint *height);
+gint     gst_ti_parse_size_mpeg2(const guint8 *data, gint size, gint *width,
+             gint *height);
+
+G_END_DECLS
+
+#endif /* __GST_TIBITSTREAM_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -44,6 +44,7 @@
 #include "gsttic6xcolorspace.h"
 #include "gsttidmaibuffertransport.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tic6xcolorspace_debug);
@@ -387,8 +388,8 @@ static GstFlowReturn gst_tic6xcolorspace_transform (GstBaseTransform *trans,
         GST_LOG("creating C6Accel handle engineName=%s \n", 
              c6xcolorspace->engineName);
 
-        c6xcolorspace->hEngine = Engine_open((Char*) 
-      c6xcolorspace->engineName,  NULL, NULL);
+        c6xcolorspace->hEngine =
+            gst_tiengine_open(c6xcolorspace->engineName);
 
         if (c6xcolorspace->hEngine == NULL) {
             GST_ELEMENT_ERROR(c6xcolorspace, RESOURCE, FAILED,
@@ -639,6 +640,8 @@ static gboolean gst_tic6xcolorspace_set_caps (GstBaseTransform *trans,
     c6xcolorspace->hOutBufTab = 
     gst_tidmaibuftab_new(c6xcolorspace->numOutputBufs,
         outBufSize, BufferGfx_getBufferAttrs (&gfxAttrs));
+    gst_tidmaibuftab_set_name(c6xcolorspace->hOutBufTab,
+        GST_ELEMENT_NAME(c6xcolorspace));
     if (c6xcolorspace->hOutBufTab == NULL) {
         GST_ELEMENT_ERROR(c6xcolorspace, RESOURCE, NO_SPACE_LEFT,
         ("failed to create output bufTab\n"), (NULL));
@@ -696,7 +699,7 @@ static gboolean gst_tic6xcolorspace_exit_colorspace(GstTIC6xColorspace *c6xcolor
     /* Shut down remaining items */
     if (c6xcolorspace->hEngine) {
         GST_LOG("freeing engine handle\n");
-        Engine_close(c6xcolorspace->hEngine);
+        gst_tiengine_close(c6xcolorspace->hEngine);
         c6xcolorspace->hEngine = NULL;
     }
 
@@ -21,11 +21,15 @@
  */
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 #include <ti/sdo/dmai/Dmai.h>
 #include <ti/sdo/dmai/Buffer.h>
 #include <ti/sdo/dmai/BufferGfx.h>
 #include <ti/sdo/dmai/Framecopy.h>
+#include <ti/sdo/ce/osal/Memory.h>
 
 #include "gstticircbuffer.h"
 #include "gsttidmaibuffertransport.h"
@@ -48,23 +52,91 @@ static void      gst_ticircbuffer_broadcast_producer(GstTICircBuffer *circBuf);
 static void      gst_ticircbuffer_wait_on_consumer(GstTICircBuffer *circBuf,
                                                    Int32 bytesNeeded);
 static void      gst_ticircbuffer_broadcast_consumer(GstTICircBuffer *circBuf);
+static gboolean  gst_ticircbuffer_consumer_caught_up(GstTICircBuffer *circBuf);
+static gboolean  gst_ticircbuffer_hold_buffer(GstTICircBuffer *circBuf,
+                                              GstBuffer *buf);
+static GstBuffer* gst_ticircbuffer_get_held_window(GstTICircBuffer *circBuf);
+static GstBuffer* gst_ticircbuffer_get_mirrored_window(
+                      GstTICircBuffer *circBuf, Int32 bufSize);
+static void      gst_ticircbuffer_release_held(GstTICircBuffer *circBuf,
+                                               Int32 bytesConsumed);
+static void      gst_ticircbuffer_record_timestamp(GstTICircBuffer *circBuf,
+                     GstBuffer *buf);
+static void      gst_ticircbuffer_lookup_timestamp(GstTICircBuffer *circBuf,
+                     Int32 bytesConsumed);
 static gboolean  gst_ticircbuffer_shift_data(GstTICircBuffer *circBuf);
+static void      gst_ticircbuffer_advance_write_ptr(GstTICircBuffer *circBuf,
+                                                    Int32 bytes);
+static void      gst_ticircbuffer_advance_read_ptr(GstTICircBuffer *circBuf,
+                                                   Int32 bytes);
 static Int32     gst_ticircbuffer_reset_read_pointer(GstTICircBuffer *circBuf);
 static gboolean  gst_ticircbuffer_window_available(GstTICircBuffer *circBuf);
+static gboolean  gst_ticircbuffer_frame_available(GstTICircBuffer *circBuf);
+static void      gst_ticircbuffer_reset_frame(GstTICircBuffer *circBuf);
 static Int32     gst_ticircbuffer_data_available(GstTICircBuffer *circBuf);
 static Int32     gst_ticircbuffer_data_size(GstTICircBuffer *circBuf);
 static Int32     gst_ticircbuffer_write_space(GstTICircBuffer *circBuf);
 static Int32     gst_ticircbuffer_is_empty(GstTICircBuffer *circBuf);
 static void      gst_ticircbuffer_display(GstTICircBuffer *circBuf);
+static void      gst_ticircbuffer_wait_flush_stop(GstTICircBuffer *circBuf);
+static void      gst_ticircbuffer_clear_timestamps(GstTICircBuffer *circBuf);
+static void      gst_ticircbuffer_rewind(GstTICircBuffer *circBuf);
 
 /* Useful macros */
+#define gst_ticircbuffer_mirrored(circBuf) ((circBuf)->mirrorPtr != NULL)
+#define gst_ticircbuffer_start(circBuf) \
+            (gst_ticircbuffer_mirrored(circBuf) ? (circBuf)->mirrorPtr : \
+             (Int8*)Buffer_getUserPtr((circBuf)->hBuf))
 #define gst_ticircbuffer_first_window_free(circBuf) \
-            ((circBuf)->readPtr - Buffer_getUserPtr((circBuf)->hBuf) >= \
+            (!gst_ticircbuffer_mirrored(circBuf) && \
+             gst_ticircbuffer_read_ptr(circBuf) - \
+             Buffer_getUserPtr((circBuf)->hBuf) >= \
              ((circBuf)->windowSize + (circBuf)->readAheadSize))
 
+/* The read and write pointers are shared between the producer and consumer
+ * threads without a lock.  These accessors make sure the data copied into the
+ * buffer is visible before the pointer that publishes it.
+ */
+#define gst_ticircbuffer_read_ptr(circBuf) \
+            ((Int8*)g_atomic_pointer_get((volatile gpointer*) \
+                &(circBuf)->readPtr))
+#define gst_ticircbuffer_write_ptr(circBuf) \
+            ((Int8*)g_atomic_pointer_get((volatile gpointer*) \
+                &(circBuf)->writePtr))
+#define gst_ticircbuffer_set_read_ptr(circBuf, ptr) \
+            g_atomic_pointer_set((volatile gpointer*)&(circBuf)->readPtr, \
+                (gpointer)(ptr))
+#define gst_ticircbuffer_set_write_ptr(circBuf, ptr) \
+            g_atomic_pointer_set((volatile gpointer*)&(circBuf)->writePtr, \
+                (gpointer)(ptr))
+#define gst_ticircbuffer_contiguous(circBuf) \
+            g_atomic_int_get(&(circBuf)->contiguousData)
+#define gst_ticircbuffer_set_contiguous(circBuf, val) \
+            g_atomic_int_set(&(circBuf)->contiguousData, (val))
+#define gst_ticircbuffer_held_buf(circBuf) \
+            ((GstBuffer*)g_atomic_pointer_get((volatile gpointer*) \
+                &(circBuf)->heldBuf))
+#define gst_ticircbuffer_flushing(circBuf) \
+            g_atomic_int_get(&(circBuf)->flushing)
+
+/* TRUE when queued data would never be read */
+#define gst_ticircbuffer_rejecting(circBuf) \
+            (g_atomic_int_get(&(circBuf)->consumerAborted) || \
+             gst_ticircbuffer_flushing(circBuf))
+
 /* Constants */
 #define DISP_SIZE 77
 
+/* Device used to map the physical pages of a CMEM buffer a second time */
+#define MIRROR_DEVICE "/dev/cmem"
+
+/* Entry in the timestamp map */
+typedef struct _GstTICircBufferTimeStamp {
+    guint64       offset;
+    GstClockTime  timestamp;
+    GstClockTime  duration;
+} GstTICircBufferTimeStamp;
+
 /******************************************************************************
  * gst_ticircbuffer_get_type
  *    Defines function pointers for initialization routines for this object.
@@ -132,18 +204,36 @@ static void gst_ticircbuffer_finalize(GstTICircBuffer* circBuf)
     }
 
     GST_LOG("Maximum bytes consumed:  %lu\n", circBuf->maxConsumed);
+    GST_LOG("input blocked %d times, output blocked %d times\n",
+        circBuf->waitOnConsumer.numParked, circBuf->waitOnProducer.numParked);
+    GST_LOG("buffers passed without copying: %ld, copied: %ld\n",
+        circBuf->numHeld, circBuf->numCopied);
+    GST_LOG("wrapped windows copied: %ld\n", circBuf->numWrapped);
+
+    if (circBuf->heldBuf) {
+        gst_buffer_unref(circBuf->heldBuf);
+    }
 
-    if (circBuf->hBuf) {
-        Buffer_delete(circBuf->hBuf);
+    if (circBuf->timeStamps) {
+        gst_ticircbuffer_clear_timestamps(circBuf);
+        g_queue_free(circBuf->timeStamps);
     }
+    pthread_mutex_destroy(&circBuf->timeStampMutex);
 
-    if (circBuf->waitOnProducer) {
-        Rendezvous_delete(circBuf->waitOnProducer);
+    if (circBuf->mirrorPtr) {
+        munmap(circBuf->mirrorPtr, circBuf->mirrorSize << 1);
     }
 
-    if (circBuf->waitOnConsumer) {
-        Rendezvous_delete(circBuf->waitOnConsumer);
+    if (circBuf->hWrapBuf) {
+        Buffer_delete(circBuf->hWrapBuf);
     }
+
+    if (circBuf->hBuf) {
+        Buffer_delete(circBuf->hBuf);
+    }
+
+    gst_tieventcount_destroy(&circBuf->waitOnProducer);
+    gst_tieventcount_destroy(&circBuf->waitOnConsumer);
 }
 
 /******************************************************************************
@@ -154,7 +244,6 @@ static void gst_ticircbuffer_init(GTypeInstance *instance,
                 gpointer g_class)
 {
     GstTICircBuffer   *circBuf  = GST_TICIRCBUFFER(instance);
-    Rendezvous_Attrs   rzvAttrs = Rendezvous_Attrs_DEFAULT;
 
     GST_LOG("begin init");
 
@@ -165,8 +254,6 @@ static void gst_ticircbuffer_init(GTypeInstance *instance,
     circBuf->dataDuration    = 0ULL;
     circBuf->windowSize      = 0UL;
     circBuf->readAheadSize   = 0UL;
-    circBuf->waitOnProducer  = Rendezvous_create(100, &rzvAttrs);
-    circBuf->waitOnConsumer  = Rendezvous_create(100, &rzvAttrs);
     circBuf->drain           = FALSE;
     circBuf->bytesNeeded     = 0UL;
     circBuf->maxConsumed     = 0UL;
@@ -174,8 +261,32 @@ static void gst_ticircbuffer_init(GTypeInstance *instance,
     circBuf->contiguousData  = TRUE;
     circBuf->fixedBlockSize  = FALSE;
     circBuf->consumerAborted = FALSE;
+    circBuf->flushing        = FALSE;
+    circBuf->consumerFlushed = FALSE;
+    circBuf->flushReturned   = FALSE;
+    circBuf->mirrorPtr       = NULL;
+    circBuf->mirrorSize      = 0UL;
+    circBuf->hWrapBuf        = NULL;
+    circBuf->numWrapped      = 0;
+    circBuf->bytesQueued     = 0;
+    circBuf->zeroCopy        = FALSE;
+    circBuf->heldBuf         = NULL;
+    circBuf->heldOffset      = 0;
+    circBuf->numHeld         = 0;
+    circBuf->numCopied       = 0;
+    circBuf->framer          = NULL;
+    gst_ticircbuffer_reset_frame(circBuf);
+    circBuf->timeStamps      = g_queue_new();
+    circBuf->streamBytesIn   = 0ULL;
+    circBuf->streamBytesOut  = 0ULL;
+    circBuf->consumedTimeStamp = GST_CLOCK_TIME_NONE;
+    circBuf->consumedDuration  = GST_CLOCK_TIME_NONE;
+    pthread_mutex_init(&circBuf->timeStampMutex, NULL);
     circBuf->userCopy       = NULL;
 
+    gst_tieventcount_init(&circBuf->waitOnProducer);
+    gst_tieventcount_init(&circBuf->waitOnConsumer);
+
     GST_LOG("end init");
 }
 
@@ -231,6 +342,117 @@ GstTICircBuffer* gst_ticircbuffer_new(Int32 windowSize, Int32 numWindows,
     return circBuf;
 }
 
+
+/******************************************************************************
+ * gst_ticircbuffer_new_mirrored
+ *     Create a circular buffer whose physical pages are mapped twice back to
+ *     back in virtual memory, so a window that runs past the end of the buffer
+ *     continues at its beginning.  No read ahead or data shifting is needed,
+ *     so two windows are enough.
+ *
+ *     A window that wraps is contiguous only in virtual memory, while DSP
+ *     codecs address their input physically.  Such windows are copied into
+ *     a separate contiguous buffer before they are handed out; all others
+ *     are returned in place.  If the pages cannot be double-mapped, a
+ *     regular circular buffer is returned instead.
+ ******************************************************************************/
+GstTICircBuffer* gst_ticircbuffer_new_mirrored(Int32 windowSize,
+                     Int32 numWindows)
+{
+    GstTICircBuffer *circBuf;
+    Buffer_Attrs     bAttrs   = Buffer_Attrs_DEFAULT;
+    Int32            pageSize = sysconf(_SC_PAGESIZE);
+    Int32            bufSize;
+    Int8            *mirror   = MAP_FAILED;
+    Int              fd       = -1;
+    off_t            physAddr;
+
+    if (numWindows < 2) {
+        numWindows = 2;
+    }
+
+    /* Both mappings must start on a page boundary */
+    bufSize = ((numWindows * windowSize) + pageSize - 1) & ~(pageSize - 1);
+
+    circBuf = (GstTICircBuffer*)gst_mini_object_new(GST_TYPE_TICIRCBUFFER);
+
+    g_return_val_if_fail(circBuf != NULL, NULL);
+
+    GST_INFO("requested windowSize:  %ld\n", windowSize);
+    circBuf->windowSize     = windowSize;
+    circBuf->fixedBlockSize = FALSE;
+    circBuf->readAheadSize  = 0;
+
+    GST_LOG("creating mirrored circular input buffer of size %lu\n", bufSize);
+    circBuf->hBuf = Buffer_create(bufSize, &bAttrs);
+
+    if (circBuf->hBuf == NULL) {
+        GST_ERROR("failed to create buffer");
+        gst_ticircbuffer_unref(circBuf);
+        return NULL;
+    }
+
+    /* Windows that cross the wrap are copied here */
+    circBuf->hWrapBuf = Buffer_create(windowSize, &bAttrs);
+
+    if (circBuf->hWrapBuf == NULL) {
+        GST_INFO("failed to create wrap buffer\n");
+        goto fallback;
+    }
+
+    physAddr = (off_t)Buffer_getPhysicalPtr(circBuf->hBuf);
+    if (physAddr & (pageSize - 1)) {
+        GST_INFO("buffer is not page aligned\n");
+        goto fallback;
+    }
+
+    if ((fd = open(MIRROR_DEVICE, O_RDWR)) < 0) {
+        GST_INFO("failed to open %s\n", MIRROR_DEVICE);
+        goto fallback;
+    }
+
+    /* Reserve address space for both copies, then map the same physical
+     * pages over each half.
+     */
+    mirror = mmap(NULL, bufSize << 1, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1, 0);
+    if (mirror == MAP_FAILED) {
+        GST_INFO("failed to reserve %lu bytes of address space\n",
+            bufSize << 1);
+        goto fallback;
+    }
+
+    if (mmap(mirror, bufSize, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd, physAddr) == MAP_FAILED ||
+        mmap(mirror + bufSize, bufSize, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd, physAddr) == MAP_FAILED) {
+        GST_INFO("failed to double-map buffer pages\n");
+        goto fallback;
+    }
+
+    close(fd);
+
+    circBuf->mirrorPtr  = mirror;
+    circBuf->mirrorSize = bufSize;
+    circBuf->readPtr    = circBuf->writePtr = mirror;
+
+    return circBuf;
+
+fallback:
+    GST_INFO("mirrored mapping unavailable; using a regular buffer\n");
+
+    if (mirror != MAP_FAILED) {
+        munmap(mirror, bufSize << 1);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    gst_ticircbuffer_unref(circBuf);
+    return gst_ticircbuffer_new(windowSize, MAX(numWindows, 3), FALSE);
+}
+
 /******************************************************************************
  * gst_ticircbuffer_copy_config
  *  This function configures circular buffer to use user defined copy routine.
@@ -267,16 +489,39 @@ gboolean gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf, GstBuffer *buf)
         goto exit_fail;
     }
 
-    /* Reset our mutex condition so a call to wait_on_consumer will block */
-    Rendezvous_reset(circBuf->waitOnConsumer);
-
-    /* If the consumer aborted, abort the buffer queuing.  We don't want to
-     * queue buffers that no one will read.
+    /* If the consumer aborted or we are flushing, abort the buffer queuing.
+     * We don't want to queue buffers that no one will read.
      */
-    if (circBuf->consumerAborted) {
+    if (gst_ticircbuffer_rejecting(circBuf)) {
         goto exit_fail;
     }
 
+    /* Data queued behind a held buffer has to wait until the consumer is
+     * done with it, since any bytes it leaves behind go first.
+     */
+    while (gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        GST_LOG("blocking input until held buffer is released\n");
+        gst_ticircbuffer_wait_on_consumer(circBuf, GST_BUFFER_SIZE(buf));
+        GST_LOG("unblocking input\n");
+
+        if (gst_ticircbuffer_rejecting(circBuf)) {
+            goto exit_fail;
+        }
+    }
+
+    /* In zero-copy mode, try to hand the buffer to the consumer as-is */
+    if (gst_ticircbuffer_hold_buffer(circBuf, buf)) {
+        if (!GST_CLOCK_TIME_IS_VALID(GST_BUFFER_DURATION(buf))) {
+            circBuf->dataDuration = GST_CLOCK_TIME_NONE;
+        }
+        else if (GST_CLOCK_TIME_IS_VALID(circBuf->dataDuration)) {
+            circBuf->dataDuration += GST_BUFFER_DURATION(buf);
+        }
+
+        gst_ticircbuffer_broadcast_producer(circBuf);
+        goto exit;
+    }
+
     /* If we run out of space, we need to move the data from the last buffer
      * window to the first window and continue queuing new data in the second
      * window.  If the consumer isn't done with the first window yet, we need
@@ -289,7 +534,7 @@ gboolean gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf, GstBuffer *buf)
          * the first window is free.  If it is, we may be able to shift the
          * data without blocking.
          */
-        if (circBuf->contiguousData &&
+        if (gst_ticircbuffer_contiguous(circBuf) &&
             gst_ticircbuffer_first_window_free(circBuf)) {
 
             if (gst_ticircbuffer_shift_data(circBuf)) {
@@ -338,13 +583,10 @@ gboolean gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf, GstBuffer *buf)
         gst_ticircbuffer_wait_on_consumer(circBuf, GST_BUFFER_SIZE(buf));
         GST_LOG("unblocking input\n");
 
-        /* Reset our mutex condition so calling wait_on_consumer will block */
-        Rendezvous_reset(circBuf->waitOnConsumer);
-
-        /* If the consumer aborted, abort the buffer queuing.  We don't want to
-         * queue buffers that no one will read.
+        /* If the consumer aborted or we are flushing, abort the buffer
+         * queuing.  We don't want to queue buffers that no one will read.
          */
-        if (circBuf->consumerAborted) {
+        if (gst_ticircbuffer_rejecting(circBuf)) {
             goto exit_fail;
         }
 
@@ -360,6 +602,9 @@ gboolean gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf, GstBuffer *buf)
         GST_LOG("buffer received:  no timestamp available\n");
     }
 
+    /* Remember where this buffer's timestamp applies in the stream */
+    gst_ticircbuffer_record_timestamp(circBuf, buf);
+
     /* Copy the buffer using user defined function */
     if (circBuf->userCopy) {
         GST_LOG("copying input buffer using user provided copy fxn\n");
@@ -372,7 +617,8 @@ gboolean gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf, GstBuffer *buf)
     else {        
         memcpy(circBuf->writePtr, GST_BUFFER_DATA(buf), GST_BUFFER_SIZE(buf));
     }
-    circBuf->writePtr += GST_BUFFER_SIZE(buf);
+    circBuf->numCopied++;
+    gst_ticircbuffer_advance_write_ptr(circBuf, GST_BUFFER_SIZE(buf));
 
     /* Copy new data to the end of the buffer */
     GST_LOG("queued %u bytes of data\n", GST_BUFFER_SIZE(buf));
@@ -395,9 +641,11 @@ gboolean gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf, GstBuffer *buf)
 
     /* If our buffer got low, some consuming threads may have blocked waiting
      * for more data.  If there is at least a window and our specified read
-     * ahead available in the buffer, unblock any threads.
+     * ahead available in the buffer, unblock any threads.  A consumer waiting
+     * for an access unit may be able to use any new data.
      */
-    if (gst_ticircbuffer_data_size(circBuf) >=
+    if (circBuf->framer != NULL ||
+        gst_ticircbuffer_data_size(circBuf) >=
         circBuf->windowSize + circBuf->readAheadSize) {
         gst_ticircbuffer_broadcast_producer(circBuf);
     }
@@ -411,6 +659,145 @@ exit:
 }
 
 
+/******************************************************************************
+ * gst_ticircbuffer_queue_datav
+ *     Append several pieces of data to the end of the circular buffer as one
+ *     unit.  When there is room for all of them, the free space is checked
+ *     once, the data is published once, and the consumer is woken once.
+ *     The timestamp applies to the first byte queued.
+ ******************************************************************************/
+gboolean gst_ticircbuffer_queue_datav(GstTICircBuffer *circBuf,
+             const GstTICircBufferSegment *segments, guint numSegments,
+             GstClockTime timestamp, GstClockTime duration)
+{
+    Int32 remaining = 0;
+    Int32 writeSpace;
+    Int32 copySize;
+    guint segIdx    = 0;
+    guint segOffset = 0;
+    guint i;
+
+    /* If the circular buffer doesn't exist, do nothing */
+    if (circBuf == NULL) {
+        return FALSE;
+    }
+
+    /* A user copy function works on whole GstBuffers; queue each segment
+     * separately.
+     */
+    if (circBuf->userCopy) {
+        gst_ticircbuffer_mark_timestamp(circBuf, timestamp, duration);
+
+        for (i = 0; i < numSegments; i++) {
+            GstBuffer *segBuf = gst_buffer_new();
+            gboolean   result;
+
+            GST_BUFFER_DATA(segBuf) = (guint8*)segments[i].data;
+            GST_BUFFER_SIZE(segBuf) = segments[i].size;
+            result = gst_ticircbuffer_queue_data(circBuf, segBuf);
+            gst_buffer_unref(segBuf);
+
+            if (!result) {
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    for (i = 0; i < numSegments; i++) {
+        remaining += segments[i].size;
+    }
+
+    if (gst_ticircbuffer_rejecting(circBuf)) {
+        return FALSE;
+    }
+
+    /* Wait for the consumer to release any held buffer (see queue_data) */
+    while (gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        gst_ticircbuffer_wait_on_consumer(circBuf, remaining);
+
+        if (gst_ticircbuffer_rejecting(circBuf)) {
+            return FALSE;
+        }
+    }
+
+    gst_ticircbuffer_mark_timestamp(circBuf, timestamp, duration);
+
+    while (remaining > 0) {
+
+        /* Same space handling as queue_data:  shift if possible, otherwise
+         * queue as much as fits so the write pointer reaches the end of the
+         * buffer, and only block when there is no space at all.
+         */
+        writeSpace = gst_ticircbuffer_write_space(circBuf);
+
+        if (writeSpace < remaining) {
+            if (gst_ticircbuffer_contiguous(circBuf) &&
+                gst_ticircbuffer_first_window_free(circBuf) &&
+                gst_ticircbuffer_shift_data(circBuf)) {
+                continue;
+            }
+
+            if (writeSpace == 0) {
+                GST_LOG("blocking input until processing thread catches up\n");
+                gst_ticircbuffer_wait_on_consumer(circBuf, remaining);
+                GST_LOG("unblocking input\n");
+
+                if (gst_ticircbuffer_rejecting(circBuf)) {
+                    return FALSE;
+                }
+
+                gst_ticircbuffer_shift_data(circBuf);
+                continue;
+            }
+        }
+
+        /* Gather as many segments as fit into the free space */
+        copySize = MIN(writeSpace, remaining);
+        for (i = 0; i < copySize; ) {
+            guint chunk = MIN(segments[segIdx].size - segOffset, copySize - i);
+
+            memcpy(circBuf->writePtr + i, segments[segIdx].data + segOffset,
+                chunk);
+            i         += chunk;
+            segOffset += chunk;
+
+            if (segOffset == segments[segIdx].size) {
+                segIdx++;
+                segOffset = 0;
+            }
+        }
+
+        gst_ticircbuffer_advance_write_ptr(circBuf, copySize);
+        circBuf->streamBytesIn += copySize;
+        circBuf->numCopied++;
+        remaining -= copySize;
+
+        GST_LOG("queued %lu bytes of data from %u segments\n", copySize,
+            numSegments);
+
+        if (circBuf->displayBuffer) {
+            gst_ticircbuffer_display(circBuf);
+        }
+
+        if (circBuf->framer != NULL ||
+            gst_ticircbuffer_data_size(circBuf) >=
+            circBuf->windowSize + circBuf->readAheadSize) {
+            gst_ticircbuffer_broadcast_producer(circBuf);
+        }
+    }
+
+    if (!GST_CLOCK_TIME_IS_VALID(duration)) {
+        circBuf->dataDuration = GST_CLOCK_TIME_NONE;
+    }
+    else if (GST_CLOCK_TIME_IS_VALID(circBuf->dataDuration)) {
+        circBuf->dataDuration += duration;
+    }
+
+    return TRUE;
+}
+
+
 /******************************************************************************
  * gst_ticircbuffer_data_consumed
  ******************************************************************************/
@@ -441,9 +828,20 @@ gboolean gst_ticircbuffer_data_consumed(
     /* Release the reference buffer */
     gst_buffer_unref(buf);
 
+    /* Find the input timestamp covered by the consumed data */
+    gst_ticircbuffer_lookup_timestamp(circBuf, bytesConsumed);
+
+    /* Frame again from the new read pointer */
+    gst_ticircbuffer_reset_frame(circBuf);
+
     /* Update the read pointer */
     GST_LOG("%ld bytes consumed\n", bytesConsumed);
-    circBuf->readPtr  += bytesConsumed;
+    if (gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        gst_ticircbuffer_release_held(circBuf, bytesConsumed);
+    }
+    else {
+        gst_ticircbuffer_advance_read_ptr(circBuf, bytesConsumed);
+    }
 
     /* Update the max bytes consumed statistic */
     if (bytesConsumed > circBuf->maxConsumed) {
@@ -487,8 +885,133 @@ gboolean gst_ticircbuffer_time_consumed(GstTICircBuffer *circBuf,
 }
 
 
+/*****************************************************************************
+ * gst_ticircbuffer_mark_timestamp
+ *    Record a timestamp for the next byte to be queued.  Used when the data
+ *    for a timestamped buffer is queued in pieces that don't carry it.
+ *****************************************************************************/
+void gst_ticircbuffer_mark_timestamp(GstTICircBuffer *circBuf,
+         GstClockTime timestamp, GstClockTime duration)
+{
+    GstTICircBufferTimeStamp *entry;
+
+    if (circBuf == NULL || !GST_CLOCK_TIME_IS_VALID(timestamp)) {
+        return;
+    }
+
+    entry            = g_slice_new(GstTICircBufferTimeStamp);
+    entry->offset    = circBuf->streamBytesIn;
+    entry->timestamp = timestamp;
+    entry->duration  = duration;
+
+    pthread_mutex_lock(&circBuf->timeStampMutex);
+    g_queue_push_tail(circBuf->timeStamps, entry);
+    pthread_mutex_unlock(&circBuf->timeStampMutex);
+}
+
+
+/*****************************************************************************
+ * gst_ticircbuffer_record_timestamp
+ *    Add a queued buffer to the timestamp map and advance the input offset.
+ *****************************************************************************/
+static void gst_ticircbuffer_record_timestamp(GstTICircBuffer *circBuf,
+                GstBuffer *buf)
+{
+    gst_ticircbuffer_mark_timestamp(circBuf, GST_BUFFER_TIMESTAMP(buf),
+        GST_BUFFER_DURATION(buf));
+    circBuf->streamBytesIn += GST_BUFFER_SIZE(buf);
+}
+
+
+/*****************************************************************************
+ * gst_ticircbuffer_clear_timestamps
+ *    Empty the timestamp map.
+ *****************************************************************************/
+static void gst_ticircbuffer_clear_timestamps(GstTICircBuffer *circBuf)
+{
+    GstTICircBufferTimeStamp *entry;
+
+    pthread_mutex_lock(&circBuf->timeStampMutex);
+    while ((entry = g_queue_pop_head(circBuf->timeStamps)) != NULL) {
+        g_slice_free(GstTICircBufferTimeStamp, entry);
+    }
+    pthread_mutex_unlock(&circBuf->timeStampMutex);
+}
+
+
+/*****************************************************************************
+ * gst_ticircbuffer_peek_timestamp
+ *    Return the first input timestamp whose offset lies in the next size
+ *    bytes to be consumed, or GST_CLOCK_TIME_NONE.  Nothing is consumed.
+ *    Called by the consumer.
+ *****************************************************************************/
+GstClockTime gst_ticircbuffer_peek_timestamp(GstTICircBuffer *circBuf,
+                 Int32 size)
+{
+    GstTICircBufferTimeStamp *entry;
+    GstClockTime              result = GST_CLOCK_TIME_NONE;
+
+    if (circBuf == NULL || size <= 0) {
+        return result;
+    }
+
+    pthread_mutex_lock(&circBuf->timeStampMutex);
+    entry = g_queue_peek_head(circBuf->timeStamps);
+    if (entry && entry->offset < circBuf->streamBytesOut + size) {
+        result = entry->timestamp;
+    }
+    pthread_mutex_unlock(&circBuf->timeStampMutex);
+
+    return result;
+}
+
+
+/*****************************************************************************
+ * gst_ticircbuffer_lookup_timestamp
+ *    Set consumedTimeStamp to the first input timestamp whose offset lies in
+ *    the consumed range, and discard every entry the range covers.
+ *****************************************************************************/
+static void gst_ticircbuffer_lookup_timestamp(GstTICircBuffer *circBuf,
+                Int32 bytesConsumed)
+{
+    GstTICircBufferTimeStamp *entry;
+    guint64                   endOffset;
+
+    circBuf->consumedTimeStamp = GST_CLOCK_TIME_NONE;
+    circBuf->consumedDuration  = GST_CLOCK_TIME_NONE;
+
+    if (bytesConsumed <= 0) {
+        return;
+    }
+
+    endOffset = circBuf->streamBytesOut + bytesConsumed;
+
+    pthread_mutex_lock(&circBuf->timeStampMutex);
+    while ((entry = g_queue_peek_head(circBuf->timeStamps)) != NULL &&
+           entry->offset < endOffset) {
+
+        if (!GST_CLOCK_TIME_IS_VALID(circBuf->consumedTimeStamp)) {
+            circBuf->consumedTimeStamp = entry->timestamp;
+            circBuf->consumedDuration  = entry->duration;
+        }
+
+        g_queue_pop_head(circBuf->timeStamps);
+        g_slice_free(GstTICircBufferTimeStamp, entry);
+    }
+    pthread_mutex_unlock(&circBuf->timeStampMutex);
+
+    circBuf->streamBytesOut = endOffset;
+
+    GST_LOG("consumed data has timestamp %" GST_TIME_FORMAT "\n",
+        GST_TIME_ARGS(circBuf->consumedTimeStamp));
+}
+
+
 /******************************************************************************
  * gst_ticircbuffer_get_data
+ *    Return the next window of data.  During a flush, NULL is returned once
+ *    so the consumer can reset its own state; the following call blocks
+ *    until the flush is complete.
  ******************************************************************************/
 GstBuffer* gst_ticircbuffer_get_data(GstTICircBuffer *circBuf)
 {
@@ -501,25 +1024,44 @@ GstBuffer* gst_ticircbuffer_get_data(GstTICircBuffer *circBuf)
         return NULL;
     }
 
-    /* Reset our mutex condition so calling wait_on_consumer will block */
-    Rendezvous_reset(circBuf->waitOnProducer);
-
     /* Reset the read pointer to the beginning of the buffer when we're
      * approaching the buffer's end (see function definition for reset
      * conditions).
      */
     gst_ticircbuffer_reset_read_pointer(circBuf);
 
-    /* Don't return any data util we have a full window available */
-    while (!circBuf->drain && !gst_ticircbuffer_window_available(circBuf)) {
+    /* Don't return any data util we have a full window or, when framing,
+     * a complete access unit available.
+     */
+    while (TRUE) {
+
+        if (gst_ticircbuffer_flushing(circBuf)) {
+            if (!circBuf->flushReturned) {
+                GST_LOG("flushing: returning no data\n");
+                circBuf->flushReturned = TRUE;
+                return NULL;
+            }
+
+            gst_ticircbuffer_wait_flush_stop(circBuf);
+            circBuf->flushReturned = FALSE;
+            continue;
+        }
+
+        if (g_atomic_int_get(&circBuf->drain) ||
+            gst_ticircbuffer_frame_available(circBuf) ||
+            gst_ticircbuffer_window_available(circBuf)) {
+            break;
+        }
 
         GST_LOG("blocking output until a full window is available\n");
         gst_ticircbuffer_wait_on_producer(circBuf);
         GST_LOG("unblocking output\n");
         gst_ticircbuffer_reset_read_pointer(circBuf);
+    }
 
-        /* Reset our mutex condition so calling wait_on_consumer will block */
-        Rendezvous_reset(circBuf->waitOnProducer);
+    /* A buffer queued in zero-copy mode is returned directly */
+    if (gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        return gst_ticircbuffer_get_held_window(circBuf);
     }
 
     /* Set the size of the buffer to be no larger than the window size.  Some
@@ -532,6 +1074,16 @@ GstBuffer* gst_ticircbuffer_get_data(GstTICircBuffer *circBuf)
         bufSize = circBuf->windowSize;
     }
 
+    /* Hand out exactly one access unit when its end is known */
+    if (gst_ticircbuffer_frame_available(circBuf)) {
+        GST_LOG("returning %ld byte access unit\n", circBuf->frameSize);
+        bufSize = circBuf->frameSize;
+    }
+
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return gst_ticircbuffer_get_mirrored_window(circBuf, bufSize);
+    }
+
     /* Return a reference buffer that points to the area of the circular
      * buffer we want to decode.
      */
@@ -544,7 +1096,7 @@ GstBuffer* gst_ticircbuffer_get_data(GstTICircBuffer *circBuf)
     Buffer_setNumBytesUsed(hCircBufWindow, bufSize);
 
     GST_LOG("returning data at offset %u\n", circBuf->readPtr - 
-        Buffer_getUserPtr(circBuf->hBuf));
+        gst_ticircbuffer_start(circBuf));
 
     result = (GstBuffer*)(gst_tidmaibuffertransport_new(hCircBufWindow, NULL));
     GST_BUFFER_TIMESTAMP(result) = circBuf->dataTimeStamp;
@@ -553,13 +1105,211 @@ GstBuffer* gst_ticircbuffer_get_data(GstTICircBuffer *circBuf)
 }
 
 
+/******************************************************************************
+ * gst_ticircbuffer_get_mirrored_window
+ *    Return a reference buffer for the next window of a mirrored buffer.
+ *    The window is described through the original CMEM mapping so that its
+ *    physical address can be looked up.  A window that crosses the end of the
+ *    buffer is not physically contiguous, so it is copied into hWrapBuf.
+ *    Only one window is outstanding at a time, so one copy buffer is enough.
+ *
+ *    The producer writes through the mirror alias.  On a VIVT data cache
+ *    (ARM926) a cache writeback of the CMEM mapping doesn't reach lines
+ *    dirtied under the alias, so the window is written back and invalidated
+ *    under the alias here, and invalidated under the CMEM mapping so ARM
+ *    readers of the window don't see stale lines either.
+ ******************************************************************************/
+static GstBuffer* gst_ticircbuffer_get_mirrored_window(
+                      GstTICircBuffer *circBuf, Int32 bufSize)
+{
+    Buffer_Handle  hCircBufWindow;
+    Buffer_Attrs   bAttrs;
+    GstBuffer     *result;
+    Int32          offset;
+    Int32          wrapped;
+    Int8          *windowPtr;
+
+    offset  = circBuf->readPtr - circBuf->mirrorPtr;
+    wrapped = offset + bufSize - circBuf->mirrorSize;
+
+    /* Bytes before the end were written under the first half of the alias.
+     * Bytes past it may have been written under either half, depending on
+     * where the write that queued them started.
+     */
+    if (wrapped > 0) {
+        Memory_cacheWbInv(circBuf->mirrorPtr + offset, bufSize - wrapped);
+        Memory_cacheWbInv(circBuf->mirrorPtr, wrapped);
+        Memory_cacheWbInv(circBuf->mirrorPtr + circBuf->mirrorSize, wrapped);
+    }
+    else {
+        Memory_cacheWbInv(circBuf->mirrorPtr + offset, bufSize);
+    }
+
+    if (wrapped <= 0) {
+        windowPtr = Buffer_getUserPtr(circBuf->hBuf) + offset;
+        Memory_cacheInv(windowPtr, bufSize);
+    }
+    else {
+        GST_LOG("copying %ld byte window that wraps at offset %ld\n",
+            bufSize, offset);
+        windowPtr = Buffer_getUserPtr(circBuf->hWrapBuf);
+        memcpy(windowPtr, circBuf->readPtr, bufSize);
+        circBuf->numWrapped++;
+    }
+
+    Buffer_getAttrs(circBuf->hBuf, &bAttrs);
+    bAttrs.reference = TRUE;
+
+    hCircBufWindow = Buffer_create(bufSize, &bAttrs);
+
+    Buffer_setUserPtr(hCircBufWindow, windowPtr);
+    Buffer_setNumBytesUsed(hCircBufWindow, bufSize);
+
+    GST_LOG("returning data at offset %ld\n", offset);
+
+    result = (GstBuffer*)(gst_tidmaibuffertransport_new(hCircBufWindow, NULL));
+    GST_BUFFER_TIMESTAMP(result) = circBuf->dataTimeStamp;
+    GST_BUFFER_DURATION(result)  = GST_CLOCK_TIME_NONE;
+    return result;
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_hold_buffer
+ *    Keep a reference to a queued DMAI buffer instead of copying it.  This is
+ *    only possible when nothing else is queued ahead of it.
+ ******************************************************************************/
+static gboolean gst_ticircbuffer_hold_buffer(GstTICircBuffer *circBuf,
+                                             GstBuffer *buf)
+{
+    if (!circBuf->zeroCopy || circBuf->fixedBlockSize || circBuf->userCopy) {
+        return FALSE;
+    }
+
+    if (!GST_IS_TIDMAIBUFFERTRANSPORT(buf) || GST_BUFFER_SIZE(buf) == 0) {
+        return FALSE;
+    }
+
+    /* Only the producer adds data, so once the buffer is seen empty it stays
+     * empty until we queue something.
+     */
+    if (!gst_ticircbuffer_is_empty(circBuf)) {
+        return FALSE;
+    }
+
+    GST_LOG("holding %u byte DMAI buffer without copying\n",
+        GST_BUFFER_SIZE(buf));
+
+    gst_ticircbuffer_record_timestamp(circBuf, buf);
+
+    circBuf->heldOffset = 0;
+    circBuf->numHeld++;
+    g_atomic_pointer_set((volatile gpointer*)&circBuf->heldBuf,
+        gst_buffer_ref(buf));
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_get_held_window
+ *    Return a reference buffer pointing at the unconsumed part of the held
+ *    buffer.
+ ******************************************************************************/
+static GstBuffer* gst_ticircbuffer_get_held_window(GstTICircBuffer *circBuf)
+{
+    GstBuffer     *heldBuf = gst_ticircbuffer_held_buf(circBuf);
+    Buffer_Handle  hHeldWindow;
+    Buffer_Attrs   bAttrs  = Buffer_Attrs_DEFAULT;
+    GstBuffer     *result;
+    Int32          bufSize;
+
+    bufSize = GST_BUFFER_SIZE(heldBuf) - circBuf->heldOffset;
+    if (bufSize > circBuf->windowSize) {
+        bufSize = circBuf->windowSize;
+    }
+
+    /* The held buffer may be a graphics buffer, so describe the window as a
+     * plain reference buffer rather than copying its attributes.
+     */
+    bAttrs.reference = TRUE;
+
+    hHeldWindow = Buffer_create(bufSize, &bAttrs);
+
+    Buffer_setUserPtr(hHeldWindow,
+        (Int8*)GST_BUFFER_DATA(heldBuf) + circBuf->heldOffset);
+    Buffer_setNumBytesUsed(hHeldWindow, bufSize);
+
+    GST_LOG("returning held data at offset %ld\n", circBuf->heldOffset);
+
+    result = (GstBuffer*)(gst_tidmaibuffertransport_new(hHeldWindow, NULL));
+    GST_BUFFER_TIMESTAMP(result) = circBuf->dataTimeStamp;
+    GST_BUFFER_DURATION(result)  = GST_CLOCK_TIME_NONE;
+    return result;
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_release_held
+ *    Account for data consumed from the held buffer.  If the consumer left
+ *    less than a window behind, copy the remainder into the (empty) circular
+ *    buffer so it is joined with the data queued after it.
+ ******************************************************************************/
+static void gst_ticircbuffer_release_held(GstTICircBuffer *circBuf,
+                                          Int32 bytesConsumed)
+{
+    GstBuffer *heldBuf = circBuf->heldBuf;
+    Int32      remaining;
+
+    circBuf->heldOffset += bytesConsumed;
+    remaining = GST_BUFFER_SIZE(heldBuf) - circBuf->heldOffset;
+
+    if (remaining >= circBuf->windowSize) {
+        return;
+    }
+
+    /* The producer doesn't touch the circular buffer while a buffer is held,
+     * so it is safe to rewind the empty buffer and write into it from here.
+     */
+    if (remaining > 0) {
+        GST_LOG("copying %ld bytes left in held buffer\n", remaining);
+        gst_ticircbuffer_set_read_ptr(circBuf, gst_ticircbuffer_start(circBuf));
+        gst_ticircbuffer_set_write_ptr(circBuf,
+            gst_ticircbuffer_start(circBuf));
+        gst_ticircbuffer_set_contiguous(circBuf, TRUE);
+
+        memcpy(circBuf->writePtr,
+            GST_BUFFER_DATA(heldBuf) + circBuf->heldOffset, remaining);
+        gst_ticircbuffer_advance_write_ptr(circBuf, remaining);
+        circBuf->numCopied++;
+    }
+
+    g_atomic_pointer_set((volatile gpointer*)&circBuf->heldBuf, NULL);
+    gst_buffer_unref(heldBuf);
+}
+
+
 /******************************************************************************
  * gst_ticircbuffer_wait_on_producer
  *    Wait for a producer to process data
  ******************************************************************************/
 static void gst_ticircbuffer_wait_on_producer(GstTICircBuffer *circBuf)
 {
-    Rendezvous_meet(circBuf->waitOnProducer);
+    gint key = gst_tieventcount_prepare_wait(&circBuf->waitOnProducer);
+
+    /* Re-check the wait condition now that any later notify from the
+     * producer will wake us; it may have queued the data we need in the
+     * meantime.
+     */
+    gst_ticircbuffer_reset_read_pointer(circBuf);
+    if (g_atomic_int_get(&circBuf->drain) ||
+        gst_ticircbuffer_flushing(circBuf) ||
+        gst_ticircbuffer_frame_available(circBuf) ||
+        gst_ticircbuffer_window_available(circBuf)) {
+        return;
+    }
+
+    gst_tieventcount_wait(&circBuf->waitOnProducer, key);
 }
 
 
@@ -570,7 +1320,7 @@ static void gst_ticircbuffer_wait_on_producer(GstTICircBuffer *circBuf)
 static void gst_ticircbuffer_broadcast_producer(GstTICircBuffer *circBuf)
 {
     GST_LOG("broadcast_producer: output unblocked\n");
-    Rendezvous_force(circBuf->waitOnProducer);
+    gst_tieventcount_notify(&circBuf->waitOnProducer);
 }
 
 
@@ -581,37 +1331,62 @@ static void gst_ticircbuffer_broadcast_producer(GstTICircBuffer *circBuf)
 static void gst_ticircbuffer_wait_on_consumer(GstTICircBuffer *circBuf,
                                               Int32 bytesNeeded)
 {
-    circBuf->bytesNeeded = bytesNeeded;
-    Rendezvous_meet(circBuf->waitOnConsumer);
+    gint key;
+
+    g_atomic_int_set(&circBuf->bytesNeeded, bytesNeeded);
+    key = gst_tieventcount_prepare_wait(&circBuf->waitOnConsumer);
+
+    /* Re-check the wait condition now that any later notify from the
+     * consumer will wake us; it may have released the space we need in the
+     * meantime.
+     */
+    if (gst_ticircbuffer_consumer_caught_up(circBuf)) {
+        return;
+    }
+
+    gst_tieventcount_wait(&circBuf->waitOnConsumer, key);
 }
 
+
 /******************************************************************************
- * gst_ticircbuffer_broadcast_consumer
- *    Broadcast when consumer has processed some data
+ * gst_ticircbuffer_consumer_caught_up
+ *    Return TRUE if a producer blocked on the consumer can make progress.
  ******************************************************************************/
-static void gst_ticircbuffer_broadcast_consumer(GstTICircBuffer *circBuf)
+static gboolean gst_ticircbuffer_consumer_caught_up(GstTICircBuffer *circBuf)
 {
-    gboolean canUnblock = FALSE;
+    if (gst_ticircbuffer_rejecting(circBuf)) {
+        return TRUE;
+    }
+
+    /* Nothing can be queued until a held buffer is released */
+    if (gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        return FALSE;
+    }
 
     /* If the write pointer is at the end of the buffer and the first window
-     * is free, unblock so the queue thread can shift data to the beginning
-     * and continue.
+     * is free, the queue thread can shift data to the beginning and continue.
      */
-    if (circBuf->contiguousData &&
+    if (gst_ticircbuffer_contiguous(circBuf) &&
         gst_ticircbuffer_first_window_free(circBuf)) {
-            canUnblock = TRUE;
+        return TRUE;
     }
 
     /* Otherwise, we can unblock if there is now enough space to queue the
      * next input buffer.
      */
-    else if (gst_ticircbuffer_write_space(circBuf) >= circBuf->bytesNeeded) {
-        canUnblock = TRUE;
-    }
+    return gst_ticircbuffer_write_space(circBuf) >=
+           g_atomic_int_get(&circBuf->bytesNeeded);
+}
 
-    if (canUnblock) {
+/******************************************************************************
+ * gst_ticircbuffer_broadcast_consumer
+ *    Broadcast when consumer has processed some data
+ ******************************************************************************/
+static void gst_ticircbuffer_broadcast_consumer(GstTICircBuffer *circBuf)
+{
+    if (gst_ticircbuffer_consumer_caught_up(circBuf)) {
         GST_LOG("broadcast_consumer: input unblocked\n");
-        Rendezvous_force(circBuf->waitOnConsumer);
+        gst_tieventcount_notify(&circBuf->waitOnConsumer);
     }
 }
 
@@ -627,8 +1402,155 @@ void gst_ticircbuffer_consumer_aborted(GstTICircBuffer *circBuf)
         return;
     }
 
-    circBuf->consumerAborted = TRUE;
-    Rendezvous_force(circBuf->waitOnConsumer);
+    g_atomic_int_set(&circBuf->consumerAborted, TRUE);
+    gst_tieventcount_notify(&circBuf->waitOnConsumer);
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_flush_start
+ *    Stop accepting data and wake both sides.  Blocked producers return
+ *    FALSE and the consumer gets NULL from get_data.
+ ******************************************************************************/
+void gst_ticircbuffer_flush_start(GstTICircBuffer *circBuf)
+{
+    if (circBuf == NULL) {
+        return;
+    }
+
+    GST_LOG("flush started\n");
+    g_atomic_int_set(&circBuf->flushing, TRUE);
+    gst_tieventcount_notify(&circBuf->waitOnConsumer);
+    gst_tieventcount_notify(&circBuf->waitOnProducer);
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_flush_stop
+ *    Wait for the consumer to park, discard all queued data and timestamps,
+ *    and resume.  Must be called from the producer thread (or while it is
+ *    known not to be queueing).
+ ******************************************************************************/
+void gst_ticircbuffer_flush_stop(GstTICircBuffer *circBuf)
+{
+    gint key;
+
+    if (circBuf == NULL) {
+        return;
+    }
+
+    if (!gst_ticircbuffer_flushing(circBuf)) {
+        gst_ticircbuffer_flush_start(circBuf);
+    }
+
+    /* A consumer that aborted or drained to EOS is not coming back */
+    while (!g_atomic_int_get(&circBuf->consumerFlushed) &&
+           !g_atomic_int_get(&circBuf->consumerAborted) &&
+           !g_atomic_int_get(&circBuf->drain)) {
+
+        key = gst_tieventcount_prepare_wait(&circBuf->waitOnConsumer);
+        if (g_atomic_int_get(&circBuf->consumerFlushed) ||
+            g_atomic_int_get(&circBuf->consumerAborted) ||
+            g_atomic_int_get(&circBuf->drain)) {
+            break;
+        }
+        gst_tieventcount_wait(&circBuf->waitOnConsumer, key);
+    }
+
+    /* Neither side is touching the buffer now */
+    gst_ticircbuffer_rewind(circBuf);
+
+    GST_LOG("flush stopped\n");
+
+    /* Publish the reset state before letting the consumer go */
+    g_atomic_int_set(&circBuf->consumerFlushed, FALSE);
+    g_atomic_int_set(&circBuf->flushing, FALSE);
+    gst_tieventcount_notify(&circBuf->waitOnProducer);
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_reset
+ *    Return a circular buffer whose producer and consumer have both gone
+ *    away to the state it was created in, so it can be used for a new
+ *    stream without being re-allocated.
+ ******************************************************************************/
+void gst_ticircbuffer_reset(GstTICircBuffer *circBuf)
+{
+    if (circBuf == NULL) {
+        return;
+    }
+
+    gst_ticircbuffer_rewind(circBuf);
+
+    circBuf->drain           = FALSE;
+    circBuf->bytesNeeded     = 0UL;
+    circBuf->consumerAborted = FALSE;
+    circBuf->flushing        = FALSE;
+    circBuf->consumerFlushed = FALSE;
+    circBuf->flushReturned   = FALSE;
+    circBuf->framer          = NULL;
+    circBuf->userCopy        = NULL;
+    circBuf->userCopyData    = NULL;
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_rewind
+ *    Discard all queued data and timestamps.  Neither the producer nor the
+ *    consumer may be using the buffer.
+ ******************************************************************************/
+static void gst_ticircbuffer_rewind(GstTICircBuffer *circBuf)
+{
+    if (circBuf->heldBuf) {
+        gst_buffer_unref(circBuf->heldBuf);
+        circBuf->heldBuf = NULL;
+    }
+
+    circBuf->readPtr        = gst_ticircbuffer_start(circBuf);
+    circBuf->writePtr       = gst_ticircbuffer_start(circBuf);
+    circBuf->contiguousData = TRUE;
+    circBuf->bytesQueued    = 0;
+    circBuf->dataTimeStamp  = 0ULL;
+    circBuf->dataDuration   = 0ULL;
+    circBuf->streamBytesIn  = 0ULL;
+    circBuf->streamBytesOut = 0ULL;
+    circBuf->consumedTimeStamp = GST_CLOCK_TIME_NONE;
+    circBuf->consumedDuration  = GST_CLOCK_TIME_NONE;
+    gst_ticircbuffer_clear_timestamps(circBuf);
+    gst_ticircbuffer_reset_frame(circBuf);
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_is_flushing
+ ******************************************************************************/
+gboolean gst_ticircbuffer_is_flushing(GstTICircBuffer *circBuf)
+{
+    return circBuf != NULL && gst_ticircbuffer_flushing(circBuf);
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_wait_flush_stop
+ *    Tell flush_stop the consumer is done with its data, and park until the
+ *    flush is complete.
+ ******************************************************************************/
+static void gst_ticircbuffer_wait_flush_stop(GstTICircBuffer *circBuf)
+{
+    gint key;
+
+    GST_LOG("consumer waiting for flush to complete\n");
+    g_atomic_int_set(&circBuf->consumerFlushed, TRUE);
+    gst_tieventcount_notify(&circBuf->waitOnConsumer);
+
+    while (gst_ticircbuffer_flushing(circBuf)) {
+        key = gst_tieventcount_prepare_wait(&circBuf->waitOnProducer);
+        if (!gst_ticircbuffer_flushing(circBuf)) {
+            break;
+        }
+        gst_tieventcount_wait(&circBuf->waitOnProducer, key);
+    }
 }
 
 
@@ -643,13 +1565,58 @@ void gst_ticircbuffer_drain(GstTICircBuffer *circBuf, gboolean status)
         return;
     }
 
-    circBuf->drain = status;
+    g_atomic_int_set(&circBuf->drain, status);
 
     if (status == TRUE) {
         gst_ticircbuffer_broadcast_producer(circBuf);
     }
 }
 
+/******************************************************************************
+ * gst_ticircbuffer_advance_write_ptr
+ *    Publish bytes the producer has just copied to the write pointer.
+ ******************************************************************************/
+static void gst_ticircbuffer_advance_write_ptr(GstTICircBuffer *circBuf,
+                                               Int32 bytes)
+{
+    Int8 *writePtr = circBuf->writePtr + bytes;
+
+    if (!gst_ticircbuffer_mirrored(circBuf)) {
+        gst_ticircbuffer_set_write_ptr(circBuf, writePtr);
+        return;
+    }
+
+    /* Anything written past the end landed in the mirror of the beginning */
+    if (writePtr >= circBuf->mirrorPtr + circBuf->mirrorSize) {
+        writePtr -= circBuf->mirrorSize;
+    }
+    gst_ticircbuffer_set_write_ptr(circBuf, writePtr);
+    g_atomic_int_add(&circBuf->bytesQueued, bytes);
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_advance_read_ptr
+ *    Release bytes the consumer is done with.
+ ******************************************************************************/
+static void gst_ticircbuffer_advance_read_ptr(GstTICircBuffer *circBuf,
+                                              Int32 bytes)
+{
+    Int8 *readPtr = circBuf->readPtr + bytes;
+
+    if (!gst_ticircbuffer_mirrored(circBuf)) {
+        gst_ticircbuffer_set_read_ptr(circBuf, readPtr);
+        return;
+    }
+
+    if (readPtr >= circBuf->mirrorPtr + circBuf->mirrorSize) {
+        readPtr -= circBuf->mirrorSize;
+    }
+    gst_ticircbuffer_set_read_ptr(circBuf, readPtr);
+    g_atomic_int_add(&circBuf->bytesQueued, -bytes);
+}
+
+
 /******************************************************************************
  * gst_ticircbuffer_shift_data
  *    Look for uncopied data in the last window and move it to the first one.
@@ -663,6 +1630,11 @@ static gboolean gst_ticircbuffer_shift_data(GstTICircBuffer *circBuf)
     Int32     bytesToCopy   = 0;
     gboolean  writePtrReset = FALSE;
 
+    /* A mirrored buffer never needs its data shifted */
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return FALSE;
+    }
+
     /* In fixedBlockSize mode, just wait until the write poitner reaches the
      * end of the buffer and then reset it to the beginning (no copying).
      */
@@ -670,8 +1642,9 @@ static gboolean gst_ticircbuffer_shift_data(GstTICircBuffer *circBuf)
         if (circBuf->writePtr == firstWindow + Buffer_getSize(circBuf->hBuf)) {
             GST_LOG("resetting write pointer (%lu->0)\n",
                 (UInt32)(circBuf->writePtr - firstWindow));
-            circBuf->writePtr       = Buffer_getUserPtr(circBuf->hBuf);
-            circBuf->contiguousData = FALSE;
+            gst_ticircbuffer_set_write_ptr(circBuf,
+                Buffer_getUserPtr(circBuf->hBuf));
+            gst_ticircbuffer_set_contiguous(circBuf, FALSE);
         }
         return TRUE;
     }
@@ -697,9 +1670,10 @@ static gboolean gst_ticircbuffer_shift_data(GstTICircBuffer *circBuf)
             (UInt32)(circBuf->writePtr - firstWindow),
             (UInt32)(circBuf->writePtr - (lastWindow - firstWindow) -
                      firstWindow));
-        circBuf->writePtr       -= (lastWindow - firstWindow);
-        circBuf->contiguousData  = FALSE;
-        writePtrReset            = TRUE;
+        gst_ticircbuffer_set_write_ptr(circBuf,
+            circBuf->writePtr - (lastWindow - firstWindow));
+        gst_ticircbuffer_set_contiguous(circBuf, FALSE);
+        writePtrReset = TRUE;
 
         /* The queue function will not unblock the consumer until there is
          * at least windowSize + readAhead available, but if the read pointer
@@ -727,15 +1701,21 @@ static Int32 gst_ticircbuffer_reset_read_pointer(GstTICircBuffer *circBuf)
     Int8  *lastWindow    = circBufStart + lastWinOffset;
     Int32  resetDelta    = lastWindow - circBufStart;
 
+    /* A mirrored buffer wraps the read pointer as data is consumed */
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return FALSE;
+    }
+
     /* In fixedBlockSize mode, just wait until the read poitner reaches the
      * end of the buffer and then reset it to the beginning.
      */
-    if (circBuf->fixedBlockSize && !circBuf->contiguousData) {
+    if (circBuf->fixedBlockSize && !gst_ticircbuffer_contiguous(circBuf)) {
         if (circBuf->readPtr == circBufStart + Buffer_getSize(circBuf->hBuf)) {
             GST_LOG("resetting read pointer (%lu->0)\n",
                 (UInt32)(circBuf->readPtr - circBufStart));
-            circBuf->readPtr        = Buffer_getUserPtr(circBuf->hBuf);
-            circBuf->contiguousData = TRUE;
+            gst_ticircbuffer_set_read_ptr(circBuf,
+                Buffer_getUserPtr(circBuf->hBuf));
+            gst_ticircbuffer_set_contiguous(circBuf, TRUE);
         }
         return 0;
     }
@@ -743,15 +1723,15 @@ static Int32 gst_ticircbuffer_reset_read_pointer(GstTICircBuffer *circBuf)
     /* Otherwise, reset it when the read pointer reaches the last window and
      * the last window has already been copied back to the first window.
      */
-    if (!circBuf->contiguousData                           &&
-         circBuf->readPtr              >  lastWindow       &&
-         circBuf->readPtr - resetDelta <= circBuf->writePtr) {
+    if (!gst_ticircbuffer_contiguous(circBuf)                         &&
+         circBuf->readPtr              >  lastWindow                  &&
+         circBuf->readPtr - resetDelta <= gst_ticircbuffer_write_ptr(circBuf)) {
 
         GST_LOG("resetting read pointer (%lu->%lu)\n",
             (UInt32)(circBuf->readPtr - circBufStart),
             (UInt32)(circBuf->readPtr - resetDelta - circBufStart));
-        circBuf->readPtr        -= resetDelta;
-        circBuf->contiguousData  = TRUE;
+        gst_ticircbuffer_set_read_ptr(circBuf, circBuf->readPtr - resetDelta);
+        gst_ticircbuffer_set_contiguous(circBuf, TRUE);
         return TRUE;
     }
 
@@ -767,6 +1747,11 @@ static gboolean gst_ticircbuffer_window_available(GstTICircBuffer *circBuf)
 {
     gboolean result;
 
+    /* A held buffer is always presented, whatever its size */
+    if (gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        return TRUE;
+    }
+
     /* Otherwise, return TRUE if the data available satisifies the specified
      * window size.
      */
@@ -780,12 +1765,68 @@ static gboolean gst_ticircbuffer_window_available(GstTICircBuffer *circBuf)
 }
 
 
+/******************************************************************************
+ * gst_ticircbuffer_frame_available
+ *    Return TRUE if the framer found a complete access unit at the read
+ *    pointer.  Only called by the consumer.  Access units larger than a
+ *    window are never found and fall back to being passed a window at a time.
+ ******************************************************************************/
+static gboolean gst_ticircbuffer_frame_available(GstTICircBuffer *circBuf)
+{
+    Int32 avail;
+
+    if (circBuf->framer == NULL ||
+        gst_ticircbuffer_held_buf(circBuf) != NULL) {
+        return FALSE;
+    }
+
+    if (circBuf->frameSize > 0) {
+        return TRUE;
+    }
+
+    avail = gst_ticircbuffer_data_available(circBuf);
+    if (avail > circBuf->windowSize) {
+        avail = circBuf->windowSize;
+    }
+
+    /* The scan resumes where the last call stopped, which is only valid
+     * while the data it covered is still at the read pointer.
+     */
+    if (circBuf->frameState.scanned > avail) {
+        gst_ticircbuffer_reset_frame(circBuf);
+    }
+
+    circBuf->frameSize = circBuf->framer(
+        (const guint8*)gst_ticircbuffer_read_ptr(circBuf), avail,
+        &circBuf->frameState);
+
+    return circBuf->frameSize > 0;
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_reset_frame
+ *    Forget any framing progress, e.g. after the read pointer moves.
+ ******************************************************************************/
+static void gst_ticircbuffer_reset_frame(GstTICircBuffer *circBuf)
+{
+    circBuf->frameSize               = -1;
+    circBuf->frameState.scanned      = 0;
+    circBuf->frameState.seenPicture  = FALSE;
+}
+
+
 /******************************************************************************
  * gst_ticircbuffer_data_available
  *    Return how much contiguous data is available at the read pointer.
  ******************************************************************************/
 static Int32 gst_ticircbuffer_data_available(GstTICircBuffer *circBuf)
 {
+    /* All data in a mirrored buffer is contiguous */
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return g_atomic_int_get(&circBuf->bytesQueued);
+    }
+
     /* First check if the buffer is empty, in which case return 0. */
     if (gst_ticircbuffer_is_empty(circBuf)) {
         return 0;
@@ -794,8 +1835,9 @@ static Int32 gst_ticircbuffer_data_available(GstTICircBuffer *circBuf)
     /* If the write pointer is now ahead of the read pointer, make sure there
      * is a window available.
      */
-    if (circBuf->contiguousData) {
-        return (circBuf->writePtr - circBuf->readPtr);
+    if (gst_ticircbuffer_contiguous(circBuf)) {
+        return (gst_ticircbuffer_write_ptr(circBuf) -
+                gst_ticircbuffer_read_ptr(circBuf));
     }
 
     /* Otherwise, there needs to be enough data between the read pointer and
@@ -803,7 +1845,7 @@ static Int32 gst_ticircbuffer_data_available(GstTICircBuffer *circBuf)
      */
     else {
        return (Buffer_getUserPtr(circBuf->hBuf) +
-               Buffer_getSize(circBuf->hBuf)) - circBuf->readPtr;
+               Buffer_getSize(circBuf->hBuf)) - gst_ticircbuffer_read_ptr(circBuf);
     }
 
     return 0;
@@ -817,13 +1859,20 @@ static Int32 gst_ticircbuffer_data_available(GstTICircBuffer *circBuf)
  ******************************************************************************/
 static Int32 gst_ticircbuffer_data_size(GstTICircBuffer *circBuf)
 {
+    Int8 *readPtr  = gst_ticircbuffer_read_ptr(circBuf);
+    Int8 *writePtr = gst_ticircbuffer_write_ptr(circBuf);
+
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return g_atomic_int_get(&circBuf->bytesQueued);
+    }
+
     if (gst_ticircbuffer_is_empty(circBuf)) {
         return 0;
     }
 
-    return (circBuf->contiguousData) ?
-        (circBuf->writePtr - circBuf->readPtr) :
-        Buffer_getSize(circBuf->hBuf) - (circBuf->readPtr - circBuf->writePtr);
+    return gst_ticircbuffer_contiguous(circBuf) ?
+        (writePtr - readPtr) :
+        Buffer_getSize(circBuf->hBuf) - (readPtr - writePtr);
 }
 
 
@@ -834,12 +1883,18 @@ static Int32 gst_ticircbuffer_data_size(GstTICircBuffer *circBuf)
  ******************************************************************************/
 static Int32 gst_ticircbuffer_write_space(GstTICircBuffer *circBuf)
 {
-    if (circBuf->contiguousData) {
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return circBuf->mirrorSize - g_atomic_int_get(&circBuf->bytesQueued);
+    }
+
+    if (gst_ticircbuffer_contiguous(circBuf)) {
         return (Buffer_getUserPtr(circBuf->hBuf) +
-                Buffer_getSize(circBuf->hBuf)) - circBuf->writePtr;
+                Buffer_getSize(circBuf->hBuf)) -
+               gst_ticircbuffer_write_ptr(circBuf);
     }
 
-    return circBuf->readPtr - circBuf->writePtr;
+    return gst_ticircbuffer_read_ptr(circBuf) -
+           gst_ticircbuffer_write_ptr(circBuf);
 }
 
 
@@ -853,12 +1908,43 @@ void gst_ticircbuffer_set_display(GstTICircBuffer *circBuf, gboolean disp)
 }
 
 
+/******************************************************************************
+ * gst_ticircbuffer_set_zero_copy
+ *     Enable or disable passing queued DMAI buffers to the consumer without
+ *     copying them.  Only enable this if each queued buffer holds whole units
+ *     the codec can process on its own (e.g. complete frames).
+ ******************************************************************************/
+void gst_ticircbuffer_set_zero_copy(GstTICircBuffer *circBuf, gboolean enable)
+{
+    circBuf->zeroCopy = enable;
+}
+
+
+/******************************************************************************
+ * gst_ticircbuffer_set_framer
+ *     Set the function used to find access unit boundaries in the queued
+ *     data, or NULL to hand out whole windows.  Must be called before data
+ *     is queued.
+ ******************************************************************************/
+void gst_ticircbuffer_set_framer(GstTICircBuffer *circBuf, GstTIFramer framer)
+{
+    circBuf->framer = framer;
+    gst_ticircbuffer_reset_frame(circBuf);
+}
+
+
 /******************************************************************************
  * gst_ticircbuffer_is_empty
  ******************************************************************************/
 static Int32 gst_ticircbuffer_is_empty(GstTICircBuffer *circBuf)
 {
-    return (circBuf->contiguousData && circBuf->readPtr == circBuf->writePtr);
+    if (gst_ticircbuffer_mirrored(circBuf)) {
+        return g_atomic_int_get(&circBuf->bytesQueued) == 0;
+    }
+
+    return (gst_ticircbuffer_contiguous(circBuf) &&
+            gst_ticircbuffer_read_ptr(circBuf) ==
+            gst_ticircbuffer_write_ptr(circBuf));
 }
 
 
@@ -884,7 +1970,7 @@ static void gst_ticircbuffer_display(GstTICircBuffer *circBuf)
     static Char   buffer[DISP_SIZE + 3];
     static Int32  lastReadBufOffset  = -1;
     static Int32  lastWriteBufOffset = -1;
-    Int8*         circBufStart       = Buffer_getUserPtr(circBuf->hBuf);
+    Int8*         circBufStart       = gst_ticircbuffer_start(circBuf);
     Int32         readOffset         = circBuf->readPtr  - circBufStart;
     Int32         writeOffset        = circBuf->writePtr - circBufStart;
     Int32         winBufOffset       = ((double)circBuf->windowSize /
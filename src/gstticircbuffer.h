@@ -23,17 +23,22 @@
 #ifndef __GST_CIRCBUFFER_H__
 #define __GST_CIRCBUFFER_H__
 
+#include <pthread.h>
+
 #include <gst/gst.h>
 
 #include <ti/sdo/dmai/Dmai.h>
 #include <ti/sdo/dmai/Buffer.h>
 #include <ti/sdo/dmai/BufferGfx.h>
-#include <ti/sdo/dmai/Rendezvous.h>
 #include <ti/sdo/dmai/Framecopy.h>
 
+#include "gsttieventcount.h"
+#include "gsttibitstream.h"
+
 G_BEGIN_DECLS
 
 typedef struct _GstTICircBuffer GstTICircBuffer;
+typedef struct _GstTICircBufferSegment GstTICircBufferSegment;
 
 /* Standard macros for manipulating transport objects */
 #define GST_TYPE_TICIRCBUFFER (gst_ticircbuffer_get_type())
@@ -45,10 +50,21 @@ typedef struct _GstTICircBuffer GstTICircBuffer;
 #define GST_TICIRCBUFFER_TIMESTAMP(obj)  (GST_TICIRCBUFFER(obj)->dataTimeStamp)
 #define GST_TICIRCBUFFER_DURATION(obj)   (GST_TICIRCBUFFER(obj)->dataDuration)
 #define GST_TICIRCBUFFER_WINDOWSIZE(obj) (GST_TICIRCBUFFER(obj)->windowSize)
+#define GST_TICIRCBUFFER_FRAME_SIZE(obj) (GST_TICIRCBUFFER(obj)->frameSize)
+#define GST_TICIRCBUFFER_CONSUMED_TIMESTAMP(obj) \
+    (GST_TICIRCBUFFER(obj)->consumedTimeStamp)
+#define GST_TICIRCBUFFER_CONSUMED_DURATION(obj) \
+    (GST_TICIRCBUFFER(obj)->consumedDuration)
 
 #define gst_ticircbuffer_unref(buf) \
             gst_mini_object_unref(GST_MINI_OBJECT_CAST(buf))
 
+/* Piece of data passed to gst_ticircbuffer_queue_datav */
+struct _GstTICircBufferSegment {
+    const guint8      *data;
+    guint              size;
+};
+
 /* _GstTICircBuffer object */
 struct _GstTICircBuffer {
 
@@ -61,25 +77,83 @@ struct _GstTICircBuffer {
     Int8              *writePtr;
     Int32              readAheadSize;
     gboolean           fixedBlockSize;
-    gboolean           contiguousData;
-    gboolean           consumerAborted;
+    volatile gboolean  contiguousData;
+    volatile gboolean  consumerAborted;
+
+    /* Mirrored Mapping.  When the allocator allows it, the buffer is mapped
+     * twice back to back at mirrorPtr so reads and writes past the end wrap
+     * to the beginning without any data being shifted.  The wrap is only
+     * virtual: the pages are not physically contiguous across it, so a
+     * window that crosses it is copied into hWrapBuf before a codec that
+     * addresses memory physically (such as a DSP codec) can read it.  The
+     * alias is mapped cached, so every window is written back from it
+     * before it is handed out.
+     */
+    Int8              *mirrorPtr;
+    Int32              mirrorSize;
+    Buffer_Handle      hWrapBuf;
+    Int32              numWrapped;
+    volatile gint      bytesQueued;
+
+    /* Zero-copy Queueing.  A DMAI buffer queued while the circular buffer is
+     * empty is held by reference and handed to the consumer directly.  Only
+     * the bytes the consumer leaves behind are copied into hBuf.
+     */
+    gboolean           zeroCopy;
+    GstBuffer         *heldBuf;
+    Int32              heldOffset;
+
+    /* Access Unit Framing.  With a framer set, get_data returns one complete
+     * access unit as soon as the start of the next one has been queued,
+     * instead of waiting for a full window.  frameState and frameSize are
+     * only used by the consumer; until data_consumed is called, a positive
+     * frameSize means the last window returned is exactly one access unit.
+     */
+    GstTIFramer        framer;
+    GstTIFrameState    frameState;
+    Int32              frameSize;
 
     /* Timestamp Management */
     GstClockTime       dataTimeStamp;
     GstClockTime       dataDuration;
 
+    /* Input timestamps indexed by stream byte offset.  The producer adds an
+     * entry for every timestamped buffer it queues, and data_consumed sets
+     * consumedTimeStamp/consumedDuration to the first entry that falls in the
+     * consumed range (GST_CLOCK_TIME_NONE if there is none).
+     */
+    GQueue            *timeStamps;
+    pthread_mutex_t    timeStampMutex;
+    guint64            streamBytesIn;
+    guint64            streamBytesOut;
+    GstClockTime       consumedTimeStamp;
+    GstClockTime       consumedDuration;
+
+    /* Flushing.  While flushing is set, queueing fails and get_data returns
+     * NULL once so the consumer can reset its codec; the consumer's next
+     * get_data call parks until flush_stop has emptied the buffer.
+     */
+    volatile gboolean  flushing;
+    volatile gboolean  consumerFlushed;
+    gboolean           flushReturned;
+
     /* Input Thresholds */
     Int32              windowSize;
-    gboolean           drain;
-    Int32              bytesNeeded;
+    volatile gboolean  drain;
+    volatile Int32     bytesNeeded;
 
-    /* Blocking Conditions to Throttle I/O */
-    Rendezvous_Handle  waitOnConsumer;
-    Rendezvous_Handle  waitOnProducer;
+    /* Blocking Conditions to Throttle I/O.  The read pointer is only ever
+     * advanced by the consumer and the write pointer only by the producer, so
+     * each side only needs to park when the buffer is empty or full.
+     */
+    GstTIEventCount    waitOnConsumer;
+    GstTIEventCount    waitOnProducer;
 
     /* Debug / Stats */
     gboolean           displayBuffer;
     Int32              maxConsumed;
+    Int32              numHeld;
+    Int32              numCopied;
 
     /* Define user copy function */
     void               *userCopyData;
@@ -90,17 +164,34 @@ struct _GstTICircBuffer {
 GType            gst_ticircbuffer_get_type(void);
 GstTICircBuffer* gst_ticircbuffer_new(Int32 windowSize, Int32 numWindows,
                      Bool fixedBlockSize);
+GstTICircBuffer* gst_ticircbuffer_new_mirrored(Int32 windowSize,
+                     Int32 numWindows);
 gboolean         gst_ticircbuffer_queue_data(GstTICircBuffer *circBuf,
                      GstBuffer *buf);
+gboolean         gst_ticircbuffer_queue_datav(GstTICircBuffer *circBuf,
+                     const GstTICircBufferSegment *segments, guint numSegments,
+                     GstClockTime timestamp, GstClockTime duration);
 gboolean         gst_ticircbuffer_data_consumed(GstTICircBuffer *circBuf,
                      GstBuffer* buf, Int32 bytesConsumed);
 gboolean         gst_ticircbuffer_time_consumed(
                      GstTICircBuffer *circBuf, GstClockTime timeConsumed);
+void             gst_ticircbuffer_mark_timestamp(GstTICircBuffer *circBuf,
+                     GstClockTime timestamp, GstClockTime duration);
+GstClockTime     gst_ticircbuffer_peek_timestamp(GstTICircBuffer *circBuf,
+                     Int32 size);
 GstBuffer*       gst_ticircbuffer_get_data(GstTICircBuffer *circBuf);
 void             gst_ticircbuffer_drain(GstTICircBuffer *circBuf,
                      gboolean status);
 void             gst_ticircbuffer_set_display(GstTICircBuffer *circBuf,
                      gboolean disp);
+void             gst_ticircbuffer_set_zero_copy(GstTICircBuffer *circBuf,
+                     gboolean enable);
+void             gst_ticircbuffer_set_framer(GstTICircBuffer *circBuf,
+                     GstTIFramer framer);
+void             gst_ticircbuffer_flush_start(GstTICircBuffer *circBuf);
+void             gst_ticircbuffer_flush_stop(GstTICircBuffer *circBuf);
+void             gst_ticircbuffer_reset(GstTICircBuffer *circBuf);
+gboolean         gst_ticircbuffer_is_flushing(GstTICircBuffer *circBuf);
 void             gst_ticircbuffer_consumer_aborted(GstTICircBuffer *circBuf);
 gboolean         gst_ticircbuffer_copy_config (GstTICircBuffer *circBuf,
                   Int (*userCopy) (Int8* dst, GstBuffer* src, void *data), 
@@ -35,6 +35,7 @@
 
 #include "gsttiauddec1.h"
 #include "gsttividdec2.h"
+#include "gsttimultividdec2.h"
 #include "gsttiimgenc1.h"
 #include "gsttiimgdec1.h"
 #include "gsttidmaivideosink.h"
@@ -77,6 +78,14 @@ TICodecPlugin_init (GstPlugin * TICodecPlugin)
         GST_TYPE_TIVIDDEC2))
         return FALSE;
 
+    /* Only used by name; it has no always sink pad for autopluggers */
+    env_value = getenv("GST_TI_TIMultiViddec2_DISABLE");
+
+    if ((!env_value || strcmp(env_value,"1")) && !gst_element_register(
+        TICodecPlugin, "TIMultiViddec2", GST_RANK_NONE,
+        GST_TYPE_TIMULTIVIDDEC2))
+        return FALSE;
+
     env_value = getenv("GST_TI_TIImgenc1_DISABLE");
 
     if ((!env_value || strcmp(env_value,"1")) && !gst_element_register(
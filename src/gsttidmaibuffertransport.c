@@ -10,6 +10,10 @@
  * DMAI buffer is part of a BufTab, it will be released for re-use.
  * DMAI buffers no part of a BufTab will be deleted when no longer referenced.
  *
+ * Transport buffers of a GstTIDmaiBufTab's buffers are not freed either: the
+ * finalize function keeps them in the GstTIDmaiBufTab, and the next
+ * transport buffer created for the same DMAI buffer reuses them.
+ *
  * Downstream elements may use the GST_IS_TIDMAIBUFFERTRANSPORT() macro to
  * check to see if a gStreamer buffer encapsulates a DMAI buffer.  When passed
  * an element of this type, elements can take advantage of the fact that the
@@ -39,7 +43,6 @@
 #include <ti/sdo/dmai/Dmai.h>
 #include <ti/sdo/dmai/Buffer.h>
 #include <ti/sdo/dmai/BufTab.h>
-#include <ti/sdo/dmai/Rendezvous.h>
 
 #include "gsttidmaibuffertransport.h"
 
@@ -59,6 +62,8 @@ static void
     gst_tidmaibuffertransport_class_init(GstTIDmaiBufferTransportClass *klass);
 static void
     gst_tidmaibuffertransport_finalize(GstBuffer *gstbuffer);
+static void
+    gst_tidmaibuffertransport_reset(GstBuffer *gstbuffer);
 
 /* Define GST_TYPE_TIDMAIBUFFERTRANSPORT */
 G_DEFINE_TYPE_WITH_CODE (GstTIDmaiBufferTransport, gst_tidmaibuffertransport, \
@@ -119,45 +124,64 @@ static void gst_tidmaibuffertransport_class_init(
 static void gst_tidmaibuffertransport_finalize(GstBuffer *gstbuffer)
 {
     GstTIDmaiBufferTransport *self = GST_TIDMAIBUFFERTRANSPORT(gstbuffer);
+    Buffer_Handle             hBuf  = self->dmaiBuffer;
+    GstTIDmaiBufTab          *owner = self->owner;
+    gboolean                  kept  = FALSE;
 
     GST_LOG("begin finalize\n");
 
-    /* If we're part of a a GstTIDmaiBufTab object, we need to make sure that
-     * changing the useMask and calling Rendezvous_force is done as a single
-     * step, or the condition mutex that waits for an available buffer may
-     * not work properly.
-     */
-    if (self->owner) {
-        pthread_mutex_lock(GST_TIDMAIBUFTAB_GETBUF_MUTEX(self->owner));
-    }
+    self->dmaiBuffer = NULL;
+    self->owner      = NULL;
 
-    /* If the DMAI buffer is part of a BufTab, free it for re-use.  Otherwise,
-     * destroy the buffer.
+    /* If the DMAI buffer is part of a BufTab, or is an extra buffer of an
+     * elastic GstTIDmaiBufTab, free it for re-use.  Otherwise, destroy the
+     * buffer.  A cached transport buffer that is freed with its
+     * GstTIDmaiBufTab has no DMAI buffer.
      */
-    if (Buffer_getBufTab(self->dmaiBuffer) != NULL) {
+    if (hBuf == NULL) {
+        GST_LOG("freeing cached transport buffer\n");
+    }
+    else if (Buffer_getBufTab(hBuf) != NULL || owner) {
         GST_LOG("clearing GStreamer useMask bit\n");
-        Buffer_freeUseMask(self->dmaiBuffer, gst_tidmaibuffer_GST_FREE);
-        Buffer_freeUseMask(self->dmaiBuffer, gst_tidmaibuffer_VIDEOSINK_FREE);
+        gst_tidmaibuftab_free_use_mask(owner, hBuf,
+            gst_tidmaibuffer_GST_FREE | gst_tidmaibuffer_VIDEOSINK_FREE);
     } else {
         GST_LOG("calling Buffer_delete()\n");
-        Buffer_delete(self->dmaiBuffer);
+        Buffer_delete(hBuf);
     }
 
-    /* If a GstTIDmaiBufTab object is blocked waiting for a buffer to be freed,
-     * wake it up.
+    /* Offer ourselves to the GstTIDmaiBufTab for the next transport buffer
+     * of this DMAI buffer, once it is released.  The core still holds a
+     * reference on us until we return, so the table only hands us out
+     * again after it dropped it (see gst_tidmaibuftab_take_transport), and
+     * we must not touch ourselves once we are in its cache.  Only recycle
+     * buffers whose memory we know about, and only on cores that let
+     * finalize keep a mini object alive (0.10.24 and later).
      */
-    if (self->owner) {
-        Rendezvous_force(GST_TIDMAIBUFTAB_BUFAVAIL_RV(self->owner));
-        pthread_mutex_unlock(GST_TIDMAIBUFTAB_GETBUF_MUTEX(self->owner));
+#if GST_CHECK_VERSION(0, 10, 24)
+    if (owner && hBuf && GST_BUFFER_MALLOCDATA(gstbuffer) == NULL) {
+        gst_caps_replace(&GST_BUFFER_CAPS(gstbuffer), NULL);
+        kept = gst_tidmaibuftab_keep_transport(owner, hBuf, gstbuffer);
     }
+#endif
 
-    /* Remove reference to the GstTIDmaiBufTab object that owns us, if any */
-    if (self->owner) {
-        gst_tidmaibuftab_unref(self->owner);
+    /* If a thread is blocked waiting for a buffer of the GstTIDmaiBufTab
+     * object that owns us to be freed, wake it up.  Then remove our reference
+     * to it.
+     */
+    if (owner) {
+        gst_tidmaibuftab_buf_released(owner);
+        gst_tidmaibuftab_unref(owner);
     }
 
-    self->dmaiBuffer = NULL;
-    self->owner      = NULL;
+    /* The cache's reference keeps us alive.  If it was dropped already,
+     * because the unref above finalized the GstTIDmaiBufTab, the core frees
+     * us without our base class' finalize, which has nothing left to free.
+     */
+    if (kept) {
+        GST_LOG("end finalize (cached)\n");
+        return;
+    }
 
     /* Call GstBuffer's finalize routine, so our base class can do it's cleanup
      * as well.  If we don't do this, we'll have a memory leak that is very
@@ -170,6 +194,21 @@ static void gst_tidmaibuffertransport_finalize(GstBuffer *gstbuffer)
 }
 
 
+/******************************************************************************
+ * gst_tidmaibuffertransport_reset
+ *    Clear what the last user of a cached transport buffer left in it.
+ ******************************************************************************/
+static void gst_tidmaibuffertransport_reset(GstBuffer *gstbuffer)
+{
+    GST_MINI_OBJECT_FLAGS(gstbuffer)  = 0;
+    GST_BUFFER_TIMESTAMP(gstbuffer)   = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DURATION(gstbuffer)    = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_OFFSET(gstbuffer)      = GST_BUFFER_OFFSET_NONE;
+    GST_BUFFER_OFFSET_END(gstbuffer)  = GST_BUFFER_OFFSET_NONE;
+    gst_caps_replace(&GST_BUFFER_CAPS(gstbuffer), NULL);
+}
+
+
 /******************************************************************************
  * gst_tidmaibuffertransport_new
  *    Create a new DMAI buffer transport object.
@@ -177,10 +216,23 @@ static void gst_tidmaibuffertransport_finalize(GstBuffer *gstbuffer)
 GstBuffer* gst_tidmaibuffertransport_new(
                Buffer_Handle dmaiBuffer, GstTIDmaiBufTab *owner)
 {
-    GstTIDmaiBufferTransport *tdt_buf;
+    GstTIDmaiBufferTransport *tdt_buf = NULL;
+
+    /* Reuse the transport buffer this DMAI buffer had last time, if its
+     * GstTIDmaiBufTab kept it.
+     */
+    if (owner) {
+        tdt_buf = (GstTIDmaiBufferTransport*)
+                  gst_tidmaibuftab_take_transport(owner, dmaiBuffer);
+    }
 
-    tdt_buf = (GstTIDmaiBufferTransport*)
-              gst_mini_object_new(GST_TYPE_TIDMAIBUFFERTRANSPORT);
+    if (tdt_buf) {
+        gst_tidmaibuffertransport_reset(GST_BUFFER(tdt_buf));
+    }
+    else {
+        tdt_buf = (GstTIDmaiBufferTransport*)
+                  gst_mini_object_new(GST_TYPE_TIDMAIBUFFERTRANSPORT);
+    }
 
     g_return_val_if_fail(tdt_buf != NULL, NULL);
 
@@ -203,12 +255,12 @@ GstBuffer* gst_tidmaibuffertransport_new(
         gst_tidmaibuftab_ref(tdt_buf->owner);
     }
 
-    /* If the DMAI buffer is part of a BufTab, mark it as being in use by the
-     * GStreamer pipeline.
+    /* If the DMAI buffer is part of a BufTab, or is an extra buffer of an
+     * elastic GstTIDmaiBufTab, mark it as being in use by the GStreamer
+     * pipeline.
      */
-    if (Buffer_getBufTab(tdt_buf->dmaiBuffer) != NULL) {
-        Buffer_setUseMask(tdt_buf->dmaiBuffer,
-            Buffer_getUseMask(tdt_buf->dmaiBuffer) |
+    if (Buffer_getBufTab(tdt_buf->dmaiBuffer) != NULL || tdt_buf->owner) {
+        gst_tidmaibuftab_set_use_mask(tdt_buf->owner, tdt_buf->dmaiBuffer,
             gst_tidmaibuffer_GST_FREE);
     }
 
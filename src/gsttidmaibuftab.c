@@ -5,6 +5,11 @@
  * of a GstMiniObjects.  The allows us to postpone deleting a BufTab until all
  * of its buffers have been unrefed, even if the element that created the
  * BufTab no longer needs it.
+ *
+ * It also lets adjacent TI elements share one table: an element answering
+ * the custom query returned by gst_tidmaibuftab_query_type hands out
+ * transport buffers of its table from buffer_alloc, and the element upstream
+ * writes its output into them instead of into a table of its own.
  * 
  * Original Author:
  *     Don Darling, Texas Instruments, Inc.
@@ -23,13 +28,16 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <ti/sdo/dmai/Dmai.h>
 #include <ti/sdo/dmai/BufTab.h>
 #include <ti/sdo/dmai/Buffer.h>
-#include <ti/sdo/dmai/Rendezvous.h>
+#include <ti/sdo/dmai/BufferGfx.h>
 
 #include "gsttidmaibuftab.h"
+#include "gsttidmaibuffertransport.h"
+#include "gstticommonutils.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tidmaibuftab_debug);
@@ -38,6 +46,41 @@ GST_DEBUG_CATEGORY_STATIC (gst_tidmaibuftab_debug);
 /* Declare a global pointer to our buffer base class */
 static GstMiniObjectClass *parent_class;
 
+/* A buffer created by an elastic GstTIDmaiBufTab outside of its BufTab */
+typedef struct _GstTIDmaiBufTabExtra {
+    Buffer_Handle hBuf;
+    GstClockTime  lastUsed;
+} GstTIDmaiBufTabExtra;
+
+/* Use mask tracing.  For each buffer the trace keeps the time each use mask
+ * bit was set, and when a bit is cleared it adds the time the buffer was
+ * held to a histogram for that bit.  Bucket i counts holds shorter than
+ * 2^i ms; the last bucket counts the rest.
+ */
+#define GST_TIDMAIBUFTAB_TRACE_BITS     4
+#define GST_TIDMAIBUFTAB_TRACE_BUCKETS  12
+
+typedef struct _GstTIDmaiBufTabTraceBuf {
+    UInt16        useMask;
+    GstClockTime  since[GST_TIDMAIBUFTAB_TRACE_BITS];
+} GstTIDmaiBufTabTraceBuf;
+
+struct _GstTIDmaiBufTabTrace {
+    pthread_mutex_t  mutex;
+    GHashTable      *bufs;
+    guint64          holds[GST_TIDMAIBUFTAB_TRACE_BITS]
+                          [GST_TIDMAIBUFTAB_TRACE_BUCKETS];
+    GstClockTime     maxHold[GST_TIDMAIBUFTAB_TRACE_BITS];
+};
+
+/* Who holds a buffer while each use mask bit is set */
+static const gchar *gst_tidmaibuftab_holders[GST_TIDMAIBUFTAB_TRACE_BITS] = {
+    "pipeline",      /* gst_tidmaibuffer_GST_FREE       */
+    "codec",         /* gst_tidmaibuffer_CODEC_FREE     */
+    "video sink",    /* gst_tidmaibuffer_VIDEOSINK_FREE */
+    "display"        /* gst_tidmaibuffer_DISPLAY_FREE   */
+};
+
 /* Static Function Declarations */
 static void
     gst_tidmaibuftab_init(GstTIDmaiBufTab *self);
@@ -47,6 +90,24 @@ static void
     gst_tidmaibuftab_class_init(GstTIDmaiBufTabClass *klass);
 static void
     gst_tidmaibuftab_finalize(GstTIDmaiBufTab *self);
+static Buffer_Handle
+    gst_tidmaibuftab_get_free_buf(GstTIDmaiBufTab *self);
+static Buffer_Handle
+    gst_tidmaibuftab_grow(GstTIDmaiBufTab *self);
+static void
+    gst_tidmaibuftab_trim(GstTIDmaiBufTab *self);
+static GstTIDmaiBufTabTraceBuf*
+    gst_tidmaibuftab_trace_buf(GstTIDmaiBufTabTrace *trace,
+        Buffer_Handle hBuf);
+static void
+    gst_tidmaibuftab_trace_set(GstTIDmaiBufTab *self, Buffer_Handle hBuf,
+        UInt16 mask, gboolean acquired);
+static void
+    gst_tidmaibuftab_trace_free(GstTIDmaiBufTab *self, Buffer_Handle hBuf,
+        UInt16 mask);
+static void
+    gst_tidmaibuftab_drop_transport(GstTIDmaiBufTab *self,
+        Buffer_Handle hBuf);
 
 /* Define GST_TYPE_TIDMAIBUFTAB */
 G_DEFINE_TYPE_WITH_CODE (GstTIDmaiBufTab, gst_tidmaibuftab, \
@@ -72,9 +133,24 @@ static void gst_tidmaibuftab_init(GstTIDmaiBufTab *self)
 {
     GST_LOG("begin init\n");
 
-    self->hBufTab     = NULL;
-    self->hBufAvailRv = NULL;
-    self->blocking    = TRUE;
+    self->hBufTab      = NULL;
+    self->blocking     = TRUE;
+    self->releaseEvent = NULL;
+    self->maxBufs      = 0;
+    self->idleTimeout  = GST_CLOCK_TIME_NONE;
+    self->extraSize    = 0;
+    self->extraBufs    = NULL;
+    self->numExtraBufs = 0;
+    self->name         = NULL;
+    self->trace        = NULL;
+    self->peakBufs     = 0;
+    self->numBlocked   = 0;
+    self->transports   = NULL;
+    self->numTransportsNew    = 0;
+    self->numTransportsReused = 0;
+
+    pthread_mutex_init(&self->cacheMutex, NULL);
+    gst_tieventcount_init(&self->bufAvail);
 
     GST_LOG("end init\n");
 }
@@ -109,19 +185,54 @@ static void gst_tidmaibuftab_class_init(
  ******************************************************************************/
 static void gst_tidmaibuftab_finalize(GstTIDmaiBufTab *self)
 {
+    GstTIDmaiBufTabExtra *extra;
+    GList                *item;
+
     GST_LOG("begin finalize\n");
 
+    /* The cached transport buffers don't hold a reference on us; drop them
+     * before the buffers they point to go away.
+     */
+    if (self->transports) {
+        g_hash_table_destroy(self->transports);
+        self->transports = NULL;
+    }
+
+    GST_INFO("%s: created %" G_GUINT64_FORMAT " transport buffers, reused "
+        "%" G_GUINT64_FORMAT "\n", self->name, self->numTransportsNew,
+        self->numTransportsReused);
+
+    /* Transport buffers in use hold a reference on us, so no extra buffer is
+     * in use by now.
+     */
+    for (item = self->extraBufs; item; item = g_list_next(item)) {
+        extra = item->data;
+        Buffer_delete(extra->hBuf);
+        g_free(extra);
+    }
+    g_list_free(self->extraBufs);
+    self->extraBufs = NULL;
+
     if (self->hBufTab) {
         BufTab_delete(self->hBufTab);
         self->hBufTab = NULL;
     }
 
-    if (self->hBufAvailRv) {
-        Rendezvous_delete(self->hBufAvailRv);
-        self->hBufAvailRv = NULL;
+    GST_LOG("waited for a free buffer %u times, peak of %d buffers\n",
+        self->numBlocked, self->peakBufs);
+
+    if (self->trace) {
+        gst_tidmaibuftab_dump(self);
+        g_hash_table_destroy(self->trace->bufs);
+        pthread_mutex_destroy(&self->trace->mutex);
+        g_free(self->trace);
+        self->trace = NULL;
     }
+    g_free(self->name);
 
+    gst_tieventcount_destroy(&self->bufAvail);
     pthread_mutex_destroy(&self->hGetBufMutex);
+    pthread_mutex_destroy(&self->cacheMutex);
 
     /* Call GstMiniObject's finalize routine, so our base class can do its
      * cleanup as well.  If we don't do this, we could end up with a memory
@@ -140,33 +251,170 @@ static void gst_tidmaibuftab_finalize(GstTIDmaiBufTab *self)
 Buffer_Handle gst_tidmaibuftab_get_buf(GstTIDmaiBufTab *self)
 {
     Buffer_Handle hFreeBuf = NULL;
+    gboolean      blocked  = FALSE;
+    gint          key;
 
-    /* Get a free buffer from the BufTab */
+    /* Get a free buffer from the BufTab, or make one in elastic mode */
     pthread_mutex_lock(&self->hGetBufMutex);
-    hFreeBuf = BufTab_getFreeBuf(self->hBufTab);
+    hFreeBuf = gst_tidmaibuftab_get_free_buf(self);
+
+    if (!hFreeBuf && BufTab_getNumBufs(self->hBufTab) + self->numExtraBufs <
+            self->maxBufs) {
+        hFreeBuf = gst_tidmaibuftab_grow(self);
+    }
 
     /* If we are configured to block until we have a buffer, wait until a
-     * buffer is available
+     * buffer is released.  Look again after announcing the wait, so a
+     * release in between isn't missed, and keep waiting while the released
+     * buffers are still in use by someone else.
      */
-    if (self->blocking && !hFreeBuf) {
-        Rendezvous_reset(self->hBufAvailRv);
+    while (self->blocking && !hFreeBuf) {
+        key      = gst_tieventcount_prepare_wait(&self->bufAvail);
+        hFreeBuf = gst_tidmaibuftab_get_free_buf(self);
+
+        if (hFreeBuf) {
+            break;
+        }
+
+        if (!blocked) {
+            self->numBlocked++;
+            blocked = TRUE;
+
+            /* Show who is holding the buffers, without flooding the log
+             * when the table runs dry on every frame.
+             */
+            if (self->trace &&
+                (self->numBlocked & (self->numBlocked - 1)) == 0) {
+                GST_INFO("%s: out of buffers (%u times so far)\n",
+                    self->name, self->numBlocked);
+                gst_tidmaibuftab_dump(self);
+            }
+        }
 
         pthread_mutex_unlock(&self->hGetBufMutex);
-        Rendezvous_meet(self->hBufAvailRv);
+        gst_tieventcount_wait(&self->bufAvail, key);
         pthread_mutex_lock(&self->hGetBufMutex);
 
-        hFreeBuf = BufTab_getFreeBuf(self->hBufTab);
+        hFreeBuf = gst_tidmaibuftab_get_free_buf(self);
+    }
+
+    if (self->extraBufs) {
+        gst_tidmaibuftab_trim(self);
     }
     pthread_mutex_unlock(&self->hGetBufMutex);
 
-    if (self->blocking && !hFreeBuf) {
-        GST_ERROR("Failed to get a buffer from the GstTIDmaiBufTab object");
+    if (hFreeBuf && self->trace) {
+        gst_tidmaibuftab_trace_set(self, hFreeBuf, Buffer_getUseMask(hFreeBuf),
+            TRUE);
     }
 
     return hFreeBuf;
 }
 
 
+/******************************************************************************
+ * gst_tidmaibuftab_get_free_buf
+ *    Return a free buffer from the BufTab, or else an extra buffer.  Called
+ *    with hGetBufMutex held.
+ ******************************************************************************/
+static Buffer_Handle gst_tidmaibuftab_get_free_buf(GstTIDmaiBufTab *self)
+{
+    GstTIDmaiBufTabExtra *extra;
+    Buffer_Handle         hFreeBuf;
+    GList                *item;
+
+    if ((hFreeBuf = BufTab_getFreeBuf(self->hBufTab))) {
+        return hFreeBuf;
+    }
+
+    for (item = self->extraBufs; item; item = g_list_next(item)) {
+        extra = item->data;
+
+        if (!Buffer_inUse(extra->hBuf)) {
+            Buffer_resetUseMask(extra->hBuf);
+            extra->lastUsed = gst_util_get_timestamp();
+            return extra->hBuf;
+        }
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_grow
+ *    Create an extra buffer like the ones in the BufTab.  Called with
+ *    hGetBufMutex held.
+ ******************************************************************************/
+static Buffer_Handle gst_tidmaibuftab_grow(GstTIDmaiBufTab *self)
+{
+    GstTIDmaiBufTabExtra *extra;
+    Buffer_Handle         hBuf;
+    gint                  numBufs;
+
+    hBuf = Buffer_create(self->extraSize,
+               BufferGfx_getBufferAttrs(&self->extraAttrs));
+
+    if (hBuf == NULL) {
+        GST_WARNING("failed to create an extra buffer; waiting for one to "
+            "be released\n");
+        return NULL;
+    }
+
+    Buffer_resetUseMask(hBuf);
+
+    extra           = g_new(GstTIDmaiBufTabExtra, 1);
+    extra->hBuf     = hBuf;
+    extra->lastUsed = gst_util_get_timestamp();
+
+    self->extraBufs = g_list_prepend(self->extraBufs, extra);
+    self->numExtraBufs++;
+
+    numBufs        = BufTab_getNumBufs(self->hBufTab) + self->numExtraBufs;
+    self->peakBufs = MAX(self->peakBufs, numBufs);
+
+    GST_DEBUG("grew to %d buffers\n", numBufs);
+    return hBuf;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_trim
+ *    Delete the extra buffers that were not used for idleTimeout.  Called
+ *    with hGetBufMutex held.
+ ******************************************************************************/
+static void gst_tidmaibuftab_trim(GstTIDmaiBufTab *self)
+{
+    GstTIDmaiBufTabExtra *extra;
+    GstClockTime          now;
+    GList                *item;
+    GList                *next;
+
+    if (!GST_CLOCK_TIME_IS_VALID(self->idleTimeout)) {
+        return;
+    }
+
+    now = gst_util_get_timestamp();
+
+    for (item = self->extraBufs; item; item = next) {
+        next  = g_list_next(item);
+        extra = item->data;
+
+        if (!Buffer_inUse(extra->hBuf) &&
+            now - extra->lastUsed >= self->idleTimeout) {
+            gst_tidmaibuftab_drop_transport(self, extra->hBuf);
+            Buffer_delete(extra->hBuf);
+            g_free(extra);
+            self->extraBufs = g_list_delete_link(self->extraBufs, item);
+            self->numExtraBufs--;
+
+            GST_DEBUG("trimmed to %d buffers\n",
+                BufTab_getNumBufs(self->hBufTab) + self->numExtraBufs);
+        }
+    }
+}
+
+
 /******************************************************************************
  * gst_tidmaibuftab_set_blocking
  ******************************************************************************/
@@ -176,6 +424,482 @@ void gst_tidmaibuftab_set_blocking(GstTIDmaiBufTab *self, gboolean blocking)
 }
 
 
+/******************************************************************************
+ * gst_tidmaibuftab_set_release_event
+ *    Notify ec whenever a transport buffer gives a buffer back, for callers
+ *    that poll several BufTabs without blocking.  Pass NULL to stop before
+ *    ec is destroyed.
+ ******************************************************************************/
+void gst_tidmaibuftab_set_release_event(GstTIDmaiBufTab *self,
+         GstTIEventCount *ec)
+{
+    pthread_mutex_lock(&self->hGetBufMutex);
+    self->releaseEvent = ec;
+    pthread_mutex_unlock(&self->hGetBufMutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_buf_released
+ *    Called after clearing use mask bits of one of our buffers, to wake a
+ *    thread waiting for a free buffer.  The table's mutex is only taken when
+ *    a release event is set, so it can't be destroyed while we notify it.
+ ******************************************************************************/
+void gst_tidmaibuftab_buf_released(GstTIDmaiBufTab *self)
+{
+    gst_tieventcount_notify(&self->bufAvail);
+
+    if (g_atomic_pointer_get(&self->releaseEvent)) {
+        pthread_mutex_lock(&self->hGetBufMutex);
+        if (self->releaseEvent) {
+            gst_tieventcount_notify(self->releaseEvent);
+        }
+        pthread_mutex_unlock(&self->hGetBufMutex);
+    }
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_set_elastic
+ *    Let the table grow to max_bufs buffers when a buffer is needed and none
+ *    is free, and delete the added buffers after idle_timeout without use
+ *    (GST_CLOCK_TIME_NONE to keep them).  Only for tables that are not given
+ *    to a codec with Vdec2_setBufTab, as the codec would not know the added
+ *    buffers.
+ ******************************************************************************/
+void gst_tidmaibuftab_set_elastic(GstTIDmaiBufTab *self, gint max_bufs,
+         GstClockTime idle_timeout)
+{
+    pthread_mutex_lock(&self->hGetBufMutex);
+    self->maxBufs     = max_bufs;
+    self->idleTimeout = idle_timeout;
+    pthread_mutex_unlock(&self->hGetBufMutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_get_stats
+ *    Return the current and peak number of buffers, and how many times a
+ *    caller of gst_tidmaibuftab_get_buf had to wait for one.
+ ******************************************************************************/
+void gst_tidmaibuftab_get_stats(GstTIDmaiBufTab *self, gint *num_bufs,
+         gint *peak_bufs, guint *num_blocked)
+{
+    pthread_mutex_lock(&self->hGetBufMutex);
+    *num_bufs      = BufTab_getNumBufs(self->hBufTab) + self->numExtraBufs;
+    self->peakBufs = MAX(self->peakBufs, *num_bufs);
+    *peak_bufs     = self->peakBufs;
+    *num_blocked   = self->numBlocked;
+    pthread_mutex_unlock(&self->hGetBufMutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_set_name
+ *    Name the element owning the table, for use mask traces.
+ ******************************************************************************/
+void gst_tidmaibuftab_set_name(GstTIDmaiBufTab *self, const gchar *name)
+{
+    if (self == NULL) {
+        return;
+    }
+
+    g_free(self->name);
+    self->name = g_strdup(name);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_set_use_mask
+ *    Mark one of our buffers as in use by the holders in mask.  self may be
+ *    NULL for buffers that don't belong to a GstTIDmaiBufTab.
+ ******************************************************************************/
+void gst_tidmaibuftab_set_use_mask(GstTIDmaiBufTab *self, Buffer_Handle hBuf,
+         UInt16 mask)
+{
+    Buffer_setUseMask(hBuf, Buffer_getUseMask(hBuf) | mask);
+
+    if (self && self->trace) {
+        gst_tidmaibuftab_trace_set(self, hBuf, mask, FALSE);
+    }
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_free_use_mask
+ *    Mark one of our buffers as no longer in use by the holders in mask.
+ *    self may be NULL for buffers that don't belong to a GstTIDmaiBufTab.
+ ******************************************************************************/
+void gst_tidmaibuftab_free_use_mask(GstTIDmaiBufTab *self, Buffer_Handle hBuf,
+         UInt16 mask)
+{
+    if (self && self->trace) {
+        gst_tidmaibuftab_trace_free(self, hBuf, mask);
+    }
+
+    Buffer_freeUseMask(hBuf, mask);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_take_transport
+ *    Return the cached transport buffer of hBuf, or NULL if there is none and
+ *    the caller has to create one.  The caller gets the cache's reference.
+ *    A transport buffer is cached from its finalize function, and the core
+ *    drops its own reference only after that returns; until then it is
+ *    left in the cache, since handing it out would leave the new user's
+ *    unref without a finalize.
+ ******************************************************************************/
+GstBuffer* gst_tidmaibuftab_take_transport(GstTIDmaiBufTab *self,
+               Buffer_Handle hBuf)
+{
+    GstBuffer *transport = NULL;
+
+    pthread_mutex_lock(&self->cacheMutex);
+
+    if (self->transports) {
+        transport = g_hash_table_lookup(self->transports, hBuf);
+        if (transport &&
+            GST_MINI_OBJECT_REFCOUNT_VALUE(GST_MINI_OBJECT(transport)) == 1) {
+            g_hash_table_steal(self->transports, hBuf);
+        }
+        else {
+            transport = NULL;
+        }
+    }
+
+    if (transport) {
+        self->numTransportsReused++;
+    }
+    else {
+        self->numTransportsNew++;
+    }
+
+    pthread_mutex_unlock(&self->cacheMutex);
+
+    return transport;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_keep_transport
+ *    Cache the transport buffer of hBuf when it is released, so the next
+ *    transport buffer for hBuf doesn't have to be allocated.  Returns TRUE
+ *    if the cache took a reference on transport.
+ ******************************************************************************/
+gboolean gst_tidmaibuftab_keep_transport(GstTIDmaiBufTab *self,
+             Buffer_Handle hBuf, GstBuffer *transport)
+{
+    gboolean kept = FALSE;
+
+    pthread_mutex_lock(&self->cacheMutex);
+
+    /* A buffer wrapped twice at once only keeps one transport buffer */
+    if (self->transports &&
+        g_hash_table_lookup(self->transports, hBuf) == NULL) {
+        g_hash_table_insert(self->transports, hBuf,
+            gst_mini_object_ref(GST_MINI_OBJECT(transport)));
+        kept = TRUE;
+    }
+
+    pthread_mutex_unlock(&self->cacheMutex);
+
+    return kept;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_drop_transport
+ *    Free the cached transport buffer of an extra buffer being deleted.
+ ******************************************************************************/
+static void gst_tidmaibuftab_drop_transport(GstTIDmaiBufTab *self,
+                Buffer_Handle hBuf)
+{
+    pthread_mutex_lock(&self->cacheMutex);
+    if (self->transports) {
+        g_hash_table_remove(self->transports, hBuf);
+    }
+    pthread_mutex_unlock(&self->cacheMutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_dump
+ *    Log who holds each buffer that is in use, and for how long, followed by
+ *    the hold time histograms, at the INFO level.
+ ******************************************************************************/
+void gst_tidmaibuftab_dump(GstTIDmaiBufTab *self)
+{
+    GstTIDmaiBufTabTraceBuf *buf;
+    GstTIDmaiBufTabTrace    *trace = self->trace;
+    GHashTableIter           iter;
+    GstClockTime             now;
+    GString                 *histogram;
+    gpointer                 hBuf;
+    guint64                  numHolds;
+    gint                     bit;
+    gint                     bucket;
+
+    if (trace == NULL) {
+        GST_INFO("use mask tracing is off; set GST_TI_BufTabTrace=TRUE\n");
+        return;
+    }
+
+    pthread_mutex_lock(&trace->mutex);
+    now = gst_util_get_timestamp();
+
+    GST_INFO("%s: %d buffers, %u waits for a free one\n", self->name,
+        BufTab_getNumBufs(self->hBufTab) + self->numExtraBufs,
+        self->numBlocked);
+
+    g_hash_table_iter_init(&iter, trace->bufs);
+    while (g_hash_table_iter_next(&iter, &hBuf, (gpointer*)&buf)) {
+        for (bit = 0; bit < GST_TIDMAIBUFTAB_TRACE_BITS; bit++) {
+            if (buf->useMask & (1 << bit)) {
+                GST_INFO("%s: buffer %p held by the %s for %" GST_TIME_FORMAT
+                    "\n", self->name, hBuf, gst_tidmaibuftab_holders[bit],
+                    GST_TIME_ARGS(now - buf->since[bit]));
+            }
+        }
+    }
+
+    for (bit = 0; bit < GST_TIDMAIBUFTAB_TRACE_BITS; bit++) {
+        numHolds = 0;
+        for (bucket = 0; bucket < GST_TIDMAIBUFTAB_TRACE_BUCKETS; bucket++) {
+            numHolds += trace->holds[bit][bucket];
+        }
+        if (numHolds == 0) {
+            continue;
+        }
+
+        histogram = g_string_new(NULL);
+        for (bucket = 0; bucket < GST_TIDMAIBUFTAB_TRACE_BUCKETS; bucket++) {
+            if (bucket < GST_TIDMAIBUFTAB_TRACE_BUCKETS - 1) {
+                g_string_append_printf(histogram, " <%dms:%" G_GUINT64_FORMAT,
+                    1 << bucket, trace->holds[bit][bucket]);
+            }
+            else {
+                g_string_append_printf(histogram, " more:%" G_GUINT64_FORMAT,
+                    trace->holds[bit][bucket]);
+            }
+        }
+
+        GST_INFO("%s: %s hold times (max %" GST_TIME_FORMAT "):%s\n",
+            self->name, gst_tidmaibuftab_holders[bit],
+            GST_TIME_ARGS(trace->maxHold[bit]), histogram->str);
+        g_string_free(histogram, TRUE);
+    }
+
+    pthread_mutex_unlock(&trace->mutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_trace_buf
+ *    Return the trace record of a buffer.  Called with the trace mutex held.
+ ******************************************************************************/
+static GstTIDmaiBufTabTraceBuf* gst_tidmaibuftab_trace_buf(
+                                    GstTIDmaiBufTabTrace *trace,
+                                    Buffer_Handle hBuf)
+{
+    GstTIDmaiBufTabTraceBuf *buf = g_hash_table_lookup(trace->bufs, hBuf);
+
+    if (buf == NULL) {
+        buf = g_new0(GstTIDmaiBufTabTraceBuf, 1);
+        g_hash_table_insert(trace->bufs, hBuf, buf);
+    }
+
+    return buf;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_trace_set
+ *    Record the time the bits in mask were set.  A buffer just acquired
+ *    from the table was free, whatever the trace saw before.
+ ******************************************************************************/
+static void gst_tidmaibuftab_trace_set(GstTIDmaiBufTab *self,
+                Buffer_Handle hBuf, UInt16 mask, gboolean acquired)
+{
+    GstTIDmaiBufTabTraceBuf *buf;
+    GstClockTime             now = gst_util_get_timestamp();
+    gint                     bit;
+
+    pthread_mutex_lock(&self->trace->mutex);
+    buf = gst_tidmaibuftab_trace_buf(self->trace, hBuf);
+
+    if (acquired) {
+        buf->useMask = 0;
+    }
+
+    for (bit = 0; bit < GST_TIDMAIBUFTAB_TRACE_BITS; bit++) {
+        if ((mask & (1 << bit)) && !(buf->useMask & (1 << bit))) {
+            buf->since[bit] = now;
+        }
+    }
+    buf->useMask |= mask;
+
+    pthread_mutex_unlock(&self->trace->mutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_trace_free
+ *    Add the time the bits in mask were held to their histograms.
+ ******************************************************************************/
+static void gst_tidmaibuftab_trace_free(GstTIDmaiBufTab *self,
+                Buffer_Handle hBuf, UInt16 mask)
+{
+    GstTIDmaiBufTabTraceBuf *buf;
+    GstTIDmaiBufTabTrace    *trace = self->trace;
+    GstClockTime             now   = gst_util_get_timestamp();
+    GstClockTime             held;
+    gint                     bit;
+    gint                     bucket;
+
+    pthread_mutex_lock(&trace->mutex);
+    buf = gst_tidmaibuftab_trace_buf(trace, hBuf);
+
+    for (bit = 0; bit < GST_TIDMAIBUFTAB_TRACE_BITS; bit++) {
+        if (!(mask & buf->useMask & (1 << bit))) {
+            continue;
+        }
+
+        held   = now - buf->since[bit];
+        bucket = 0;
+        while (bucket < GST_TIDMAIBUFTAB_TRACE_BUCKETS - 1 &&
+               held >= ((GstClockTime)1 << bucket) * GST_MSECOND) {
+            bucket++;
+        }
+
+        trace->holds[bit][bucket]++;
+        trace->maxHold[bit] = MAX(trace->maxHold[bit], held);
+    }
+    buf->useMask &= ~mask;
+
+    pthread_mutex_unlock(&trace->mutex);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_query_type
+ *    Return the custom query a TI element sends downstream to ask whether
+ *    the peer hands out the buffers of a GstTIDmaiBufTab through pad
+ *    allocation, so it can write its output into them instead of
+ *    allocating a table of its own.
+ ******************************************************************************/
+GstQueryType gst_tidmaibuftab_query_type(void)
+{
+    static GstQueryType type = GST_QUERY_NONE;
+
+    /* Registering again returns the same type, so a race here is harmless */
+    if (type == GST_QUERY_NONE) {
+        type = gst_query_type_register("tidmaibuftab",
+                   "Shared TI DMAI buffer table");
+    }
+
+    return type;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_query_peer
+ *    Ask downstream of srcpad whether it shares its buffers, telling it we
+ *    hold up to num_needed of them at a time.  On success, num_bufs is the
+ *    number of buffers it has for us, or 0 if it doesn't know yet.
+ ******************************************************************************/
+gboolean gst_tidmaibuftab_query_peer(GstPad *srcpad, gint num_needed,
+             gint *num_bufs)
+{
+    GstStructure *structure;
+    GstQuery     *query;
+    gboolean      shared;
+
+    structure = gst_structure_new("GstTIDmaiBufTabQuery",
+                    "num-bufs-needed", G_TYPE_INT, num_needed, (gchar*) NULL);
+    query     = gst_query_new_application(gst_tidmaibuftab_query_type(),
+                    structure);
+
+    shared = gst_pad_peer_query(srcpad, query) &&
+             gst_structure_get_int(gst_query_get_structure(query),
+                 "num-bufs", num_bufs);
+
+    gst_query_unref(query);
+
+    GST_DEBUG("downstream %s its buffers\n", shared ? "shares" :
+        "does not share");
+
+    return shared;
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_query_needed
+ *    Return how many buffers the element that sent a query from
+ *    gst_tidmaibuftab_query_peer holds at a time, or 0 if it didn't say.
+ ******************************************************************************/
+gint gst_tidmaibuftab_query_needed(GstQuery *query)
+{
+    gint num_needed;
+
+    if (!gst_structure_get_int(gst_query_get_structure(query),
+             "num-bufs-needed", &num_needed)) {
+        return 0;
+    }
+
+    return MAX(num_needed, 0);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_answer_query
+ *    Answer gst_tidmaibuftab_query_peer from a pad whose element hands out
+ *    num_bufs buffers of its GstTIDmaiBufTab from buffer_alloc.
+ ******************************************************************************/
+void gst_tidmaibuftab_answer_query(GstQuery *query, gint num_bufs)
+{
+    gst_structure_set(gst_query_get_structure(query), "num-bufs", G_TYPE_INT,
+        num_bufs, (gchar*) NULL);
+}
+
+
+/******************************************************************************
+ * gst_tidmaibuftab_pad_alloc
+ *    Allocate an output buffer from downstream of srcpad, after
+ *    gst_tidmaibuftab_query_peer said it shares its buffers.  If what comes
+ *    back is not a transport buffer owned by a GstTIDmaiBufTab, of at least
+ *    size bytes and with the caps we asked for, *buf is left NULL and the
+ *    caller should fall back to its own buffers.
+ ******************************************************************************/
+GstFlowReturn gst_tidmaibuftab_pad_alloc(GstPad *srcpad, guint size,
+                  GstCaps *caps, GstBuffer **buf)
+{
+    GstBuffer     *padBuf = NULL;
+    GstFlowReturn  ret;
+
+    *buf = NULL;
+
+    ret = gst_pad_alloc_buffer(srcpad, GST_BUFFER_OFFSET_NONE, size, caps,
+              &padBuf);
+    if (ret != GST_FLOW_OK) {
+        return ret;
+    }
+
+    if (!GST_IS_TIDMAIBUFFERTRANSPORT(padBuf) ||
+        GST_TIDMAIBUFFERTRANSPORT(padBuf)->owner == NULL ||
+        Buffer_getSize(GST_TIDMAIBUFFERTRANSPORT_DMAIBUF(padBuf)) < size ||
+        GST_BUFFER_CAPS(padBuf) == NULL ||
+        !gst_caps_is_equal(GST_BUFFER_CAPS(padBuf), caps)) {
+        GST_DEBUG("downstream gave a buffer we can't write into\n");
+        gst_buffer_unref(padBuf);
+        return GST_FLOW_OK;
+    }
+
+    *buf = padBuf;
+    return GST_FLOW_OK;
+}
+
+
 /******************************************************************************
  * gst_tidmaibuftab_new
  *    Create a new DMAI BufTab object.
@@ -183,7 +907,6 @@ void gst_tidmaibuftab_set_blocking(GstTIDmaiBufTab *self, gboolean blocking)
 GstTIDmaiBufTab* gst_tidmaibuftab_new(gint num_bufs, gint32 size,
                      Buffer_Attrs *attrs)
 {
-    Rendezvous_Attrs  rzvAttrs = Rendezvous_Attrs_DEFAULT;
     GstTIDmaiBufTab  *self;
 
     GST_LOG("begin new\n");
@@ -191,17 +914,48 @@ GstTIDmaiBufTab* gst_tidmaibuftab_new(gint num_bufs, gint32 size,
     self = (GstTIDmaiBufTab*)gst_mini_object_new(GST_TYPE_TIDMAIBUFTAB);
     g_return_val_if_fail(self != NULL, NULL);
 
-    self->hBufTab     = BufTab_create(num_bufs, size, attrs);
-    self->hBufAvailRv = Rendezvous_create(Rendezvous_INFINITE, &rzvAttrs);
+    self->hBufTab = BufTab_create(num_bufs, size, attrs);
 
     pthread_mutex_init(&self->hGetBufMutex, NULL);
 
-    if (!self->hBufTab || !self->hBufAvailRv) {
+    if (!self->hBufTab) {
         GST_ERROR("Failed to create a new GstTIDmaiBufTab object");
         gst_mini_object_unref(GST_MINI_OBJECT(self));
         return NULL;
     }
 
+    /* Keep what is needed to create extra buffers in elastic mode */
+    if (attrs->type == Buffer_Type_GRAPHICS) {
+        memcpy(&self->extraAttrs, attrs, sizeof(BufferGfx_Attrs));
+    }
+    else {
+        memcpy(BufferGfx_getBufferAttrs(&self->extraAttrs), attrs,
+            sizeof(Buffer_Attrs));
+    }
+    self->extraSize = size;
+    self->peakBufs  = num_bufs;
+
+    /* Trace use mask transitions if asked to.  Elements name the table
+     * after themselves with gst_tidmaibuftab_set_name.
+     */
+    self->name = g_strdup("BufTab");
+
+    if (gst_ti_env_is_defined("GST_TI_BufTabTrace") &&
+        gst_ti_env_get_boolean("GST_TI_BufTabTrace")) {
+        self->trace       = g_new0(GstTIDmaiBufTabTrace, 1);
+        self->trace->bufs = g_hash_table_new_full(g_direct_hash,
+                                g_direct_equal, NULL, g_free);
+        pthread_mutex_init(&self->trace->mutex, NULL);
+    }
+
+    /* Reuse transport buffers unless told not to */
+    if (!gst_ti_env_is_defined("GST_TI_BufTabRecycle") ||
+        gst_ti_env_get_boolean("GST_TI_BufTabRecycle")) {
+        self->transports = g_hash_table_new_full(g_direct_hash,
+                               g_direct_equal, NULL,
+                               (GDestroyNotify) gst_mini_object_unref);
+    }
+
     return self;
 }
 
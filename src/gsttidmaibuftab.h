@@ -32,7 +32,9 @@
 #include <ti/sdo/dmai/Dmai.h>
 #include <ti/sdo/dmai/BufTab.h>
 #include <ti/sdo/dmai/Buffer.h>
-#include <ti/sdo/dmai/Rendezvous.h>
+#include <ti/sdo/dmai/BufferGfx.h>
+
+#include "gsttieventcount.h"
 
 G_BEGIN_DECLS
 
@@ -56,21 +58,59 @@ G_BEGIN_DECLS
 /* Utility macros */
 #define GST_TIDMAIBUFTAB_BUFTAB(obj) \
     ((obj) ? GST_TIDMAIBUFTAB(obj)->hBufTab : NULL)
-#define GST_TIDMAIBUFTAB_BUFAVAIL_RV(obj) \
-    ((obj) ? GST_TIDMAIBUFTAB(obj)->hBufAvailRv : NULL)
 #define GST_TIDMAIBUFTAB_GETBUF_MUTEX(obj) \
     &(GST_TIDMAIBUFTAB(obj)->hGetBufMutex)
 
 typedef struct _GstTIDmaiBufTab      GstTIDmaiBufTab;
 typedef struct _GstTIDmaiBufTabClass GstTIDmaiBufTabClass;
+typedef struct _GstTIDmaiBufTabTrace GstTIDmaiBufTabTrace;
 
-/* _GstTIDmaiBufTab object */
+/* _GstTIDmaiBufTab object.  hGetBufMutex serializes the threads taking
+ * buffers from or resizing the table; releasing a buffer doesn't take it.
+ * bufAvail is notified on every release, which costs one atomic increment
+ * unless a thread is waiting in gst_tidmaibuftab_get_buf.
+ *
+ * In elastic mode (maxBufs larger than the table), get_buf creates extra
+ * buffers with the table's attributes instead of blocking, and deletes
+ * extra buffers that stayed free for idleTimeout.  The table itself can't
+ * shrink, so its size is the minimum.  The extra buffers and counters are
+ * protected by hGetBufMutex.
+ */
 struct _GstTIDmaiBufTab {
     GstMiniObject     parent_instance;
     BufTab_Handle     hBufTab;
-    Rendezvous_Handle hBufAvailRv;
+    GstTIEventCount   bufAvail;
     pthread_mutex_t   hGetBufMutex;
     gboolean          blocking;
+    GstTIEventCount  *releaseEvent;
+
+    /* Elastic mode */
+    gint              maxBufs;
+    GstClockTime      idleTimeout;
+    BufferGfx_Attrs   extraAttrs;
+    gint32            extraSize;
+    GList            *extraBufs;
+
+    /* Statistics */
+    gint              numExtraBufs;
+    gint              peakBufs;
+    guint             numBlocked;
+
+    /* Use mask tracing, enabled by setting GST_TI_BufTabTrace=TRUE.  name
+     * is the element that owns the table.
+     */
+    gchar                *name;
+    GstTIDmaiBufTabTrace *trace;
+
+    /* Transport buffers of our buffers that were released, keyed by
+     * Buffer_Handle, for gst_tidmaibuffertransport_new to reuse.  NULL when
+     * GST_TI_BufTabRecycle=FALSE.  The table and the counters are protected
+     * by cacheMutex, which is never held while taking hGetBufMutex.
+     */
+    pthread_mutex_t   cacheMutex;
+    GHashTable       *transports;
+    guint64           numTransportsNew;
+    guint64           numTransportsReused;
 };
 
 struct _GstTIDmaiBufTabClass {
@@ -84,6 +124,32 @@ GstTIDmaiBufTab* gst_tidmaibuftab_new(gint num_bufs, gint32 size,
 Buffer_Handle    gst_tidmaibuftab_get_buf(GstTIDmaiBufTab *self);
 void             gst_tidmaibuftab_set_blocking(GstTIDmaiBufTab *self,
                      gboolean blocking);
+void             gst_tidmaibuftab_set_release_event(GstTIDmaiBufTab *self,
+                     GstTIEventCount *ec);
+void             gst_tidmaibuftab_buf_released(GstTIDmaiBufTab *self);
+void             gst_tidmaibuftab_set_elastic(GstTIDmaiBufTab *self,
+                     gint max_bufs, GstClockTime idle_timeout);
+void             gst_tidmaibuftab_get_stats(GstTIDmaiBufTab *self,
+                     gint *num_bufs, gint *peak_bufs, guint *num_blocked);
+void             gst_tidmaibuftab_set_name(GstTIDmaiBufTab *self,
+                     const gchar *name);
+void             gst_tidmaibuftab_set_use_mask(GstTIDmaiBufTab *self,
+                     Buffer_Handle hBuf, UInt16 mask);
+void             gst_tidmaibuftab_free_use_mask(GstTIDmaiBufTab *self,
+                     Buffer_Handle hBuf, UInt16 mask);
+GstBuffer*       gst_tidmaibuftab_take_transport(GstTIDmaiBufTab *self,
+                     Buffer_Handle hBuf);
+gboolean         gst_tidmaibuftab_keep_transport(GstTIDmaiBufTab *self,
+                     Buffer_Handle hBuf, GstBuffer *transport);
+void             gst_tidmaibuftab_dump(GstTIDmaiBufTab *self);
+GstQueryType     gst_tidmaibuftab_query_type(void);
+gboolean         gst_tidmaibuftab_query_peer(GstPad *srcpad, gint num_needed,
+                     gint *num_bufs);
+gint             gst_tidmaibuftab_query_needed(GstQuery *query);
+void             gst_tidmaibuftab_answer_query(GstQuery *query,
+                     gint num_bufs);
+GstFlowReturn    gst_tidmaibuftab_pad_alloc(GstPad *srcpad, guint size,
+                     GstCaps *caps, GstBuffer **buf);
 void             gst_tidmaibuftab_ref(GstTIDmaiBufTab *self);
 void             gst_tidmaibuftab_unref(GstTIDmaiBufTab *self);
 
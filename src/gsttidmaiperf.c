@@ -72,6 +72,7 @@
 #include <gst/video/video.h>
 #include <ti/sdo/dmai/Dmai.h>
 #include "gsttidmaiperf.h"
+#include "gsttiengine.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_dmaiperf_debug);
@@ -284,7 +285,7 @@ gst_dmaiperf_start (GstBaseTransform * trans)
     GST_ELEMENT_WARNING (dmaiperf, STREAM, CODEC_NOT_FOUND, (NULL),
         ("Engine name not specified, not printing DSP information"));
   } else {
-      dmaiperf->hEngine = Engine_open ((Char *) dmaiperf->engineName, NULL, NULL);
+      dmaiperf->hEngine = gst_tiengine_open (dmaiperf->engineName);
 
       if (dmaiperf->hEngine == NULL) {
         GST_ELEMENT_ERROR (dmaiperf, STREAM, CODEC_NOT_FOUND, (NULL),
@@ -332,7 +333,7 @@ gst_dmaiperf_stop (GstBaseTransform * trans)
 
   if (dmaiperf->hEngine) {
     GST_DEBUG ("closing the engine\n");
-    Engine_close (dmaiperf->hEngine);
+    gst_tiengine_close (dmaiperf->hEngine);
     dmaiperf->hEngine = NULL;
   }
 
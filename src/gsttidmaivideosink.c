@@ -155,6 +155,8 @@ static GstFlowReturn
      guint size, GstCaps * caps, GstBuffer ** buf);
 static GstFlowReturn
  gst_tidmaivideosink_preroll(GstBaseSink * bsink, GstBuffer * buffer);
+static gboolean
+ gst_tidmaivideosink_query(GstPad * pad, GstQuery * query);
 static int
  gst_tidmaivideosink_videostd_get_attrs(VideoStd_Type videoStd,
      VideoStd_Attrs * attrs);
@@ -458,9 +460,15 @@ static void gst_tidmaivideosink_init(GstTIDmaiVideoSink * dmaisink,
     dmaisink->useUserptrBufs      = FALSE;
     dmaisink->hideOSD             = FALSE;
     dmaisink->hDispBufTab         = NULL;
+    dmaisink->upstreamBufs        = 0;
 
     dmaisink->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
 
+    /* Answer the tidmaibuftab query on our sink pad */
+    dmaisink->sinkQuery = GST_PAD_QUERYFUNC(GST_BASE_SINK_PAD(dmaisink));
+    gst_pad_set_query_function(GST_BASE_SINK_PAD(dmaisink),
+        GST_DEBUG_FUNCPTR(gst_tidmaivideosink_query));
+
     /* Initialize GValue members */
     memset(&dmaisink->framerate, 0, sizeof(GValue));
     g_value_init(&dmaisink->framerate, GST_TYPE_FRACTION);
@@ -799,8 +807,9 @@ static GstFlowReturn gst_tidmaivideosink_buffer_alloc(GstBaseSink * bsink,
 
     /* Return the display buffer */
     BufferGfx_resetDimensions(hDispBuf);
-    Buffer_freeUseMask(hDispBuf, gst_tidmaibuffer_DISPLAY_FREE);
-    *buf = gst_tidmaibuffertransport_new(hDispBuf, NULL);
+    gst_tidmaibuftab_free_use_mask(dmaisink->hDispBufTab, hDispBuf,
+        gst_tidmaibuffer_DISPLAY_FREE);
+    *buf = gst_tidmaibuffertransport_new(hDispBuf, dmaisink->hDispBufTab);
     gst_buffer_set_caps(*buf, alloc_caps);
 
     /* If we allocated new caps, unref them now */
@@ -812,6 +821,57 @@ static GstFlowReturn gst_tidmaivideosink_buffer_alloc(GstBaseSink * bsink,
 }
 
 
+/******************************************************************************
+ * gst_tidmaivideosink_query
+ *    Tell an upstream TI element asking with the tidmaibuftab query that it
+ *    can write its output straight into our display buffers through
+ *    buffer_alloc, unless we already display from driver buffers or were
+ *    asked to resize or rotate, which pad allocation can't do.  The buffers
+ *    upstream says it holds are added to the display buffers when they are
+ *    allocated; V4L2 only knows the buffers it was created with, so a table
+ *    that already exists can't grow.
+ ******************************************************************************/
+static gboolean gst_tidmaivideosink_query(GstPad * pad, GstQuery * query)
+{
+    GstTIDmaiVideoSink *sink =
+        GST_TIDMAIVIDEOSINK(gst_pad_get_parent_element(pad));
+    gboolean            ret;
+    gint                needed;
+
+    if (GST_QUERY_TYPE(query) != gst_tidmaibuftab_query_type()) {
+        ret = sink->sinkQuery ? sink->sinkQuery(pad, query) :
+                  gst_pad_query_default(pad, query);
+    }
+    else if (GST_BASE_SINK_GET_CLASS(sink)->buffer_alloc == NULL ||
+             (!sink->useUserptrBufs && sink->hDisplay) ||
+             sink->resizer || sink->rotation > 0) {
+        GST_DEBUG("not sharing display buffers\n");
+        ret = FALSE;
+    }
+    else {
+        needed = gst_tidmaibuftab_query_needed(query);
+
+        if (!sink->hDispBufTab) {
+            sink->upstreamBufs = MAX(sink->upstreamBufs, needed);
+            GST_DEBUG("adding %d display buffers for upstream\n",
+                sink->upstreamBufs);
+        }
+        else if (needed > sink->upstreamBufs) {
+            GST_WARNING("display buffers already allocated; upstream asked "
+                "for %d more than we have\n", needed - sink->upstreamBufs);
+        }
+
+        gst_tidmaibuftab_answer_query(query, sink->hDispBufTab ?
+            BufTab_getNumBufs(GST_TIDMAIBUFTAB_BUFTAB(sink->hDispBufTab)) :
+            sink->numBufs > 0 ? sink->numBufs + sink->upstreamBufs : 0);
+        ret = TRUE;
+    }
+
+    gst_object_unref(sink);
+    return ret;
+}
+
+
 /******************************************************************************
  * gst_tidmaivideosink_preroll
  ******************************************************************************/
@@ -1666,7 +1726,7 @@ static GstFlowReturn gst_tidmaivideosink_render(GstBaseSink * bsink,
 
         /* Mark buffer as in-use by the display so it can't be re-used
          * until it comes back from Display_get */
-        Buffer_setUseMask(inBuf, Buffer_getUseMask(inBuf) |
+        gst_tidmaibuftab_set_use_mask(sink->hDispBufTab, inBuf,
             gst_tidmaibuffer_DISPLAY_FREE);
 
         if (Display_put(sink->hDisplay, inBuf) < 0) {
@@ -1969,7 +2029,8 @@ static gboolean gst_tidmaivideosink_alloc_display_buffers(
         return FALSE;
     }
 
-    GST_INFO("Allocating %d display buffers", sink->dAttrs.numBufs);
+    GST_INFO("Allocating %d display buffers and %d for upstream",
+        sink->dAttrs.numBufs, sink->upstreamBufs);
 
     /* Set the dimensions for the display */
     if (VideoStd_getResolution(sink->dAttrs.videoStd, &gfxAttrs.dim.width,
@@ -2006,8 +2067,10 @@ static gboolean gst_tidmaivideosink_alloc_display_buffers(
     }
 
     gfxAttrs.bAttrs.useMask = gst_tidmaibuffer_VIDEOSINK_FREE;
-    sink->hDispBufTab = gst_tidmaibuftab_new(sink->dAttrs.numBufs, bufSize,
+    sink->hDispBufTab = gst_tidmaibuftab_new(
+        sink->dAttrs.numBufs + sink->upstreamBufs, bufSize,
         BufferGfx_getBufferAttrs(&gfxAttrs));
+    gst_tidmaibuftab_set_name(sink->hDispBufTab, GST_ELEMENT_NAME(sink));
     gst_tidmaibuftab_set_blocking(sink->hDispBufTab, FALSE);
 
     return TRUE;
@@ -97,9 +97,15 @@ struct _GstTIDmaiVideoSink {
   Display_Handle    hOsd;
   Display_Handle    hOsdAttrs;
 
-  /* User-allocated Display Buffers */
-  gboolean          useUserptrBufs;
-  GstTIDmaiBufTab  *hDispBufTab;
+  /* User-allocated Display Buffers.  With buffer_alloc, they are shared
+   * with upstream elements that ask for them with the tidmaibuftab query;
+   * upstreamBufs is how many they asked for on top of the display queue.
+   * sinkQuery is the query function the base class gave our sink pad.
+   */
+  gboolean             useUserptrBufs;
+  GstTIDmaiBufTab     *hDispBufTab;
+  gint                 upstreamBufs;
+  GstPadQueryFunction  sinkQuery;
 
   /* Attributes for hardware-accelerated frame-copies */
   Framecopy_Handle  hFc;
@@ -0,0 +1,386 @@
+/*
+ * gsttiengine.c
+ *
+ * This file implements a process-wide cache of Codec Engine handles.
+ * Elements that re-open an engine, such as when a pipeline is rebuilt, get
+ * the cached handle back instead of paying for another Engine_open().
+ *
+ * An Engine_Handle must not be used by several threads at once, so a handle
+ * is only shared between users on the thread that owns it.  A handle whose
+ * users have all closed it or parked it (kept it with an idle codec for a
+ * later stream) has no owner; another thread may take over an idle handle,
+ * and a parked one is owned again by whichever thread unparks it.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "gsttiengine.h"
+#include "gstticommonutils.h"
+
+/* Declare variable used to categorize GST_LOG output */
+GST_DEBUG_CATEGORY_STATIC(gst_tiengine_debug);
+#define GST_CAT_DEFAULT gst_tiengine_debug
+
+/* An open engine, used by the thread in owner if owned is set.  Of the
+ * refCount users, numParked have parked it.  idleCount is set from idleSerial
+ * every time the last user closes it, so a linger thread can tell whether the
+ * engine it is waiting on has been used since.
+ */
+typedef struct _GstTIEngineEntry {
+    gchar         *name;
+    Engine_Handle  hEngine;
+    pthread_t      owner;
+    gboolean       owned;
+    gint           refCount;
+    gint           numParked;
+    guint          idleCount;
+} GstTIEngineEntry;
+
+/* Identifies the idle period a linger thread is waiting out */
+typedef struct _GstTIEngineLinger {
+    Engine_Handle  hEngine;
+    guint          idleCount;
+} GstTIEngineLinger;
+
+/* The cache.  Everything below is protected by engineMutex. */
+static pthread_mutex_t engineMutex     = PTHREAD_MUTEX_INITIALIZER;
+static GList          *engines         = NULL;
+static gboolean        engineCacheInit = FALSE;
+static guint           lingerTime      = 0;
+static guint           idleSerial      = 0;
+
+/* Local function declarations */
+static void              gst_tiengine_init(void);
+static GstTIEngineEntry* gst_tiengine_find(const gchar *engineName);
+static GstTIEngineEntry* gst_tiengine_find_handle(Engine_Handle hEngine);
+static void              gst_tiengine_release(GstTIEngineEntry *entry);
+static void              gst_tiengine_free(GstTIEngineEntry *entry);
+static void*             gst_tiengine_linger_thread(void *arg);
+
+
+/******************************************************************************
+ * gst_tiengine_init
+ *    Set up logging and read the linger time.  Called with engineMutex held.
+ ******************************************************************************/
+static void gst_tiengine_init(void)
+{
+    if (engineCacheInit) {
+        return;
+    }
+
+    GST_DEBUG_CATEGORY_INIT(gst_tiengine_debug, "TIEngine", 0,
+        "TI Codec Engine handle cache");
+
+    if (gst_ti_env_is_defined("GST_TI_EngineCache_lingerTime")) {
+        lingerTime = gst_ti_env_get_int("GST_TI_EngineCache_lingerTime");
+        GST_LOG("Setting lingerTime=%u\n", lingerTime);
+    }
+
+    engineCacheInit = TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tiengine_find
+ *    Look up an entry for the named engine that the calling thread may use:
+ *    one it owns, or failing that one nobody is using.  Called with
+ *    engineMutex held.
+ ******************************************************************************/
+static GstTIEngineEntry* gst_tiengine_find(const gchar *engineName)
+{
+    GstTIEngineEntry *entry;
+    GstTIEngineEntry *idle = NULL;
+    GList            *item;
+
+    for (item = engines; item; item = g_list_next(item)) {
+        entry = (GstTIEngineEntry*)item->data;
+
+        if (strcmp(entry->name, engineName)) {
+            continue;
+        }
+
+        if (entry->owned && pthread_equal(entry->owner, pthread_self())) {
+            return entry;
+        }
+
+        if (entry->refCount == 0 && idle == NULL) {
+            idle = entry;
+        }
+    }
+
+    return idle;
+}
+
+
+/******************************************************************************
+ * gst_tiengine_find_handle
+ *    Look up a cache entry by handle.  Called with engineMutex held.
+ ******************************************************************************/
+static GstTIEngineEntry* gst_tiengine_find_handle(Engine_Handle hEngine)
+{
+    GstTIEngineEntry *entry;
+    GList            *item;
+
+    for (item = engines; item; item = g_list_next(item)) {
+        entry = (GstTIEngineEntry*)item->data;
+
+        if (entry->hEngine == hEngine) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tiengine_free
+ *    Close an engine nobody uses and remove it from the cache.  Called with
+ *    engineMutex held.
+ ******************************************************************************/
+static void gst_tiengine_free(GstTIEngineEntry *entry)
+{
+    GST_LOG("closing codec engine \"%s\"\n", entry->name);
+
+    engines = g_list_remove(engines, entry);
+    Engine_close(entry->hEngine);
+    g_free(entry->name);
+    g_slice_free(GstTIEngineEntry, entry);
+}
+
+
+/******************************************************************************
+ * gst_tiengine_open
+ ******************************************************************************/
+Engine_Handle gst_tiengine_open(const gchar *engineName)
+{
+    GstTIEngineEntry *entry;
+    Engine_Handle     hEngine;
+    GstClockTime      openStart;
+
+    pthread_mutex_lock(&engineMutex);
+    gst_tiengine_init();
+
+    if ((entry = gst_tiengine_find(engineName))) {
+        entry->owner = pthread_self();
+        entry->owned = TRUE;
+        entry->refCount++;
+        hEngine = entry->hEngine;
+        pthread_mutex_unlock(&engineMutex);
+
+        GST_INFO("reusing codec engine \"%s\" (%d users)\n", engineName,
+            entry->refCount);
+        return hEngine;
+    }
+
+    /* Opening under the lock keeps the cache consistent while the engine
+     * starts.
+     */
+    openStart = gst_util_get_timestamp();
+    hEngine   = Engine_open((Char *) engineName, NULL, NULL);
+
+    if (hEngine) {
+        GST_INFO("opened codec engine \"%s\" in %" GST_TIME_FORMAT "\n",
+            engineName, GST_TIME_ARGS(gst_util_get_timestamp() - openStart));
+
+        entry            = g_slice_new(GstTIEngineEntry);
+        entry->name      = g_strdup(engineName);
+        entry->hEngine   = hEngine;
+        entry->owner     = pthread_self();
+        entry->owned     = TRUE;
+        entry->refCount  = 1;
+        entry->numParked = 0;
+        entry->idleCount = 0;
+        engines = g_list_prepend(engines, entry);
+    }
+
+    pthread_mutex_unlock(&engineMutex);
+
+    return hEngine;
+}
+
+
+/******************************************************************************
+ * gst_tiengine_close
+ ******************************************************************************/
+void gst_tiengine_close(Engine_Handle hEngine)
+{
+    GstTIEngineEntry *entry;
+
+    pthread_mutex_lock(&engineMutex);
+
+    if (!(entry = gst_tiengine_find_handle(hEngine))) {
+        pthread_mutex_unlock(&engineMutex);
+        GST_WARNING("closing an engine handle that isn't cached\n");
+        Engine_close(hEngine);
+        return;
+    }
+
+    gst_tiengine_release(entry);
+    pthread_mutex_unlock(&engineMutex);
+}
+
+
+/******************************************************************************
+ * gst_tiengine_park
+ ******************************************************************************/
+void gst_tiengine_park(Engine_Handle hEngine)
+{
+    GstTIEngineEntry *entry;
+
+    pthread_mutex_lock(&engineMutex);
+
+    if ((entry = gst_tiengine_find_handle(hEngine))) {
+        /* The thread may exit and its ID be reused by an unrelated one */
+        if (++entry->numParked == entry->refCount) {
+            entry->owned = FALSE;
+        }
+    }
+
+    pthread_mutex_unlock(&engineMutex);
+}
+
+
+/******************************************************************************
+ * gst_tiengine_unpark
+ ******************************************************************************/
+gboolean gst_tiengine_unpark(Engine_Handle hEngine)
+{
+    GstTIEngineEntry *entry;
+    gboolean          ret = FALSE;
+
+    pthread_mutex_lock(&engineMutex);
+
+    entry = gst_tiengine_find_handle(hEngine);
+    if (entry && entry->numParked > 0 &&
+        (!entry->owned || pthread_equal(entry->owner, pthread_self()))) {
+        entry->numParked--;
+        entry->owner = pthread_self();
+        entry->owned = TRUE;
+        ret = TRUE;
+    }
+
+    pthread_mutex_unlock(&engineMutex);
+
+    if (!ret) {
+        GST_INFO("parked codec engine is in use by another thread\n");
+    }
+
+    return ret;
+}
+
+
+/******************************************************************************
+ * gst_tiengine_close_parked
+ ******************************************************************************/
+void gst_tiengine_close_parked(Engine_Handle hEngine)
+{
+    GstTIEngineEntry *entry;
+
+    pthread_mutex_lock(&engineMutex);
+
+    if (!(entry = gst_tiengine_find_handle(hEngine))) {
+        pthread_mutex_unlock(&engineMutex);
+        GST_WARNING("closing an engine handle that isn't cached\n");
+        Engine_close(hEngine);
+        return;
+    }
+
+    entry->numParked--;
+    gst_tiengine_release(entry);
+    pthread_mutex_unlock(&engineMutex);
+}
+
+
+/******************************************************************************
+ * gst_tiengine_release
+ *    Drop one user of an engine, and close it, or leave it to linger, when
+ *    it was the last.  Called with engineMutex held.
+ ******************************************************************************/
+static void gst_tiengine_release(GstTIEngineEntry *entry)
+{
+    GstTIEngineLinger *linger;
+    pthread_t          lingerThread;
+
+    /* Nobody left on the owning thread */
+    if (--entry->refCount == entry->numParked) {
+        entry->owned = FALSE;
+    }
+
+    if (entry->refCount > 0) {
+        return;
+    }
+
+    entry->idleCount = ++idleSerial;
+
+    /* Keep the engine open for a while in case another element needs it,
+     * such as when a pipeline is rebuilt.
+     */
+    if (lingerTime > 0) {
+        linger            = g_slice_new(GstTIEngineLinger);
+        linger->hEngine   = entry->hEngine;
+        linger->idleCount = entry->idleCount;
+
+        if (pthread_create(&lingerThread, NULL, gst_tiengine_linger_thread,
+                (void*)linger) == 0) {
+            pthread_detach(lingerThread);
+            return;
+        }
+
+        GST_WARNING("failed to create engine linger thread\n");
+        g_slice_free(GstTIEngineLinger, linger);
+    }
+
+    gst_tiengine_free(entry);
+}
+
+
+/******************************************************************************
+ * gst_tiengine_linger_thread
+ *    Close an idle engine once the linger time has passed, unless it has
+ *    been re-opened in the meantime.
+ ******************************************************************************/
+static void* gst_tiengine_linger_thread(void *arg)
+{
+    GstTIEngineLinger *linger = (GstTIEngineLinger*)arg;
+    GstTIEngineEntry  *entry;
+
+    usleep(lingerTime * 1000);
+
+    pthread_mutex_lock(&engineMutex);
+    entry = gst_tiengine_find_handle(linger->hEngine);
+    if (entry && entry->refCount == 0 &&
+        entry->idleCount == linger->idleCount) {
+        gst_tiengine_free(entry);
+    }
+    pthread_mutex_unlock(&engineMutex);
+
+    g_slice_free(GstTIEngineLinger, linger);
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
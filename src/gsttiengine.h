@@ -0,0 +1,74 @@
+/*
+ * gsttiengine.h
+ *
+ * This file declares a process-wide cache of Codec Engine handles.  A handle
+ * is only shared between users on the same thread.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TIENGINE_H__
+#define __GST_TIENGINE_H__
+
+#include <gst/gst.h>
+
+#include <xdc/std.h>
+#include <ti/sdo/ce/Engine.h>
+
+G_BEGIN_DECLS
+
+/* External function declarations */
+
+/* Return a handle to the named engine, opening it unless the calling thread
+ * has it open already or an idle handle is cached, or NULL on failure.  The
+ * handle is never given to another thread while it is in use.  Every
+ * successful call must be matched by a call to gst_tiengine_close().
+ */
+Engine_Handle gst_tiengine_open(const gchar *engineName);
+
+/* Drop a reference to an engine handle returned by gst_tiengine_open().  The
+ * engine is closed when the last user is gone, or after the linger time set
+ * with the GST_TI_EngineCache_lingerTime environment variable (in
+ * milliseconds) if it isn't re-opened by then.
+ */
+void          gst_tiengine_close(Engine_Handle hEngine);
+
+/* Tell the cache that the caller keeps its reference to hEngine for a later
+ * stream but stops using it.  When every user of a handle has parked it, the
+ * handle no longer belongs to any thread.
+ */
+void          gst_tiengine_park(Engine_Handle hEngine);
+
+/* Take back a parked handle for use by the calling thread.  Returns FALSE if
+ * another thread is using the handle, in which case it stays parked and must
+ * be released with gst_tiengine_close_parked().
+ */
+gboolean      gst_tiengine_unpark(Engine_Handle hEngine);
+
+/* Drop a parked reference, as gst_tiengine_close() does for one in use */
+void          gst_tiengine_close_parked(Engine_Handle hEngine);
+
+G_END_DECLS
+
+#endif /* __GST_TIENGINE_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,134 @@
+/*
+ * gsttieventcount.c
+ *
+ * This file defines the "GstTIEventCount" object, a lightweight wait/notify
+ * primitive used to hand off work between a producer and a consumer thread
+ * without a system call when neither side is blocked.
+ *
+ * Usage pattern for the waiting side:
+ *
+ *     while (!condition) {
+ *         key = gst_tieventcount_prepare_wait(ec);
+ *         if (condition) {
+ *             break;
+ *         }
+ *         gst_tieventcount_wait(ec, key);
+ *     }
+ *
+ * and for the notifying side:
+ *
+ *     <update shared state>
+ *     gst_tieventcount_notify(ec);
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include "gsttieventcount.h"
+
+/******************************************************************************
+ * gst_tieventcount_init
+ *    Initialize an event count embedded in another object.
+ ******************************************************************************/
+void gst_tieventcount_init(GstTIEventCount *ec)
+{
+    ec->sequence   = 0;
+    ec->sleepers   = 0;
+    ec->numParked  = 0;
+    ec->numWakeups = 0;
+
+    pthread_mutex_init(&ec->mutex, NULL);
+    pthread_cond_init(&ec->cond, NULL);
+}
+
+
+/******************************************************************************
+ * gst_tieventcount_destroy
+ ******************************************************************************/
+void gst_tieventcount_destroy(GstTIEventCount *ec)
+{
+    pthread_cond_destroy(&ec->cond);
+    pthread_mutex_destroy(&ec->mutex);
+}
+
+
+/******************************************************************************
+ * gst_tieventcount_prepare_wait
+ *    Return the key for a wait.  The caller must re-check its wait condition
+ *    after this call, and only pass the key to gst_tieventcount_wait() if it
+ *    still has to wait; a notify after this point makes that wait return.
+ ******************************************************************************/
+gint gst_tieventcount_prepare_wait(GstTIEventCount *ec)
+{
+    return g_atomic_int_get(&ec->sequence);
+}
+
+
+/******************************************************************************
+ * gst_tieventcount_wait
+ *    Park the calling thread until a notify happens after the matching
+ *    prepare_wait call.
+ ******************************************************************************/
+void gst_tieventcount_wait(GstTIEventCount *ec, gint key)
+{
+    pthread_mutex_lock(&ec->mutex);
+
+    while (g_atomic_int_get(&ec->sequence) == key) {
+        /* Count ourselves before the final check.  Notify bumps the sequence
+         * before it looks for sleepers, so one of us sees the other.  It
+         * resets the count when it wakes everyone up.
+         */
+        g_atomic_int_inc(&ec->sleepers);
+        if (g_atomic_int_get(&ec->sequence) != key) {
+            break;
+        }
+
+        g_atomic_int_inc(&ec->numParked);
+        pthread_cond_wait(&ec->cond, &ec->mutex);
+    }
+
+    pthread_mutex_unlock(&ec->mutex);
+}
+
+
+/******************************************************************************
+ * gst_tieventcount_notify
+ *    Wake any thread parked on the event count.  When no thread went to sleep
+ *    since the last wakeup, this is a single atomic increment.
+ ******************************************************************************/
+void gst_tieventcount_notify(GstTIEventCount *ec)
+{
+    g_atomic_int_inc(&ec->sequence);
+
+    if (g_atomic_int_get(&ec->sleepers) == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&ec->mutex);
+    if (g_atomic_int_get(&ec->sleepers) > 0) {
+        g_atomic_int_set(&ec->sleepers, 0);
+        g_atomic_int_inc(&ec->numWakeups);
+        pthread_cond_broadcast(&ec->cond);
+    }
+    pthread_mutex_unlock(&ec->mutex);
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,77 @@
+/*
+ * gsttieventcount.h
+ *
+ * This file declares the "GstTIEventCount" object, a lightweight wait/notify
+ * primitive used to hand off work between exactly one producer thread and
+ * one consumer thread.
+ *
+ * A thread that needs to wait for a condition first calls
+ * gst_tieventcount_prepare_wait(), re-checks the condition, and only then
+ * calls gst_tieventcount_wait().  A thread that changes the condition calls
+ * gst_tieventcount_notify(), which only enters the kernel if another thread
+ * is actually parked.  In the common case where neither side needs to block,
+ * no mutex is taken and no system call is made.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TIEVENTCOUNT_H__
+#define __GST_TIEVENTCOUNT_H__
+
+#include <pthread.h>
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstTIEventCount GstTIEventCount;
+
+/* _GstTIEventCount object */
+struct _GstTIEventCount {
+
+    /* Incremented on every notify; waiters sleep until it changes */
+    volatile gint      sequence;
+
+    /* Number of threads that went to sleep since the last wakeup */
+    volatile gint      sleepers;
+
+    /* Only used when a thread actually has to park */
+    pthread_mutex_t    mutex;
+    pthread_cond_t     cond;
+
+    /* Statistics */
+    volatile gint      numParked;
+    volatile gint      numWakeups;
+};
+
+/* External function declarations */
+void     gst_tieventcount_init(GstTIEventCount *ec);
+void     gst_tieventcount_destroy(GstTIEventCount *ec);
+gint     gst_tieventcount_prepare_wait(GstTIEventCount *ec);
+void     gst_tieventcount_wait(GstTIEventCount *ec, gint key);
+void     gst_tieventcount_notify(GstTIEventCount *ec);
+
+G_END_DECLS
+
+#endif /* __GST_TIEVENTCOUNT_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -45,6 +45,7 @@
 #include "gstticodecs.h"
 #include "gsttithreadprops.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tiimgdec1_debug);
@@ -717,8 +718,18 @@ static gboolean gst_tiimgdec1_sink_event(GstPad *pad, GstEvent *event)
             ret = gst_pad_push_event(imgdec1->srcpad, event);
             break;
 
+        case GST_EVENT_FLUSH_START:
+            /* Refuse new input and unblock the decode thread */
+            gst_ticircbuffer_flush_start(imgdec1->circBuf);
+
+            ret = gst_pad_push_event(imgdec1->srcpad, event);
+            break;
+
         case GST_EVENT_FLUSH_STOP:
             ret = gst_pad_push_event(imgdec1->srcpad, event);
+
+            /* Discard the input queued before the seek */
+            gst_ticircbuffer_flush_stop(imgdec1->circBuf);
             break;
 
         /* Unhandled events */
@@ -728,7 +739,6 @@ static gboolean gst_tiimgdec1_sink_event(GstPad *pad, GstEvent *event)
         case GST_EVENT_CUSTOM_DOWNSTREAM:
         case GST_EVENT_CUSTOM_DOWNSTREAM_OOB:
         case GST_EVENT_CUSTOM_UPSTREAM:
-        case GST_EVENT_FLUSH_START:
         case GST_EVENT_NAVIGATION:
         case GST_EVENT_QOS:
         case GST_EVENT_SEEK:
@@ -798,6 +808,13 @@ static GstFlowReturn gst_tiimgdec1_chain(GstPad * pad, GstBuffer * buf)
 
     /* Queue up the encoded data stream into a circular buffer */
     if (!gst_ticircbuffer_queue_data(imgdec1->circBuf, buf)) {
+
+        /* Input is refused while a seek flushes the pipeline */
+        if (gst_ticircbuffer_is_flushing(imgdec1->circBuf)) {
+            flow = GST_FLOW_WRONG_STATE;
+            goto exit;
+        }
+
         GST_ELEMENT_ERROR(imgdec1, RESOURCE, WRITE,
         ("Failed to queue input buffer into circular buffer\n"), (NULL));
         flow = GST_FLOW_UNEXPECTED;
@@ -1188,7 +1205,7 @@ static gboolean gst_tiimgdec1_codec_stop (GstTIImgdec1  *imgdec1)
 
     if (imgdec1->hEngine) {
         GST_LOG("closing codec engine\n");
-        Engine_close(imgdec1->hEngine);
+        gst_tiengine_close(imgdec1->hEngine);
         imgdec1->hEngine = NULL;
     }
 
@@ -1206,7 +1223,7 @@ static gboolean gst_tiimgdec1_codec_start (GstTIImgdec1  *imgdec1)
 
     /* Open the codec engine */
     GST_LOG("opening codec engine \"%s\"\n", imgdec1->engineName);
-    imgdec1->hEngine = Engine_open((Char *) imgdec1->engineName, NULL, NULL);
+    imgdec1->hEngine = gst_tiengine_open(imgdec1->engineName);
 
     if (imgdec1->hEngine == NULL) {
         GST_ELEMENT_ERROR(imgdec1, RESOURCE, FAILED,
@@ -1271,6 +1288,7 @@ static gboolean gst_tiimgdec1_codec_start (GstTIImgdec1  *imgdec1)
     imgdec1->hOutBufTab = gst_tidmaibuftab_new(imgdec1->numOutputBufs,
         Idec1_getOutBufSize(imgdec1->hIe),
         BufferGfx_getBufferAttrs(&gfxAttrs));
+    gst_tidmaibuftab_set_name(imgdec1->hOutBufTab, GST_ELEMENT_NAME(imgdec1));
 
     if (imgdec1->hOutBufTab == NULL) {
         GST_ELEMENT_ERROR(imgdec1, RESOURCE, NO_SPACE_LEFT,
@@ -1326,6 +1344,14 @@ static void* gst_tiimgdec1_decode_thread(void *arg)
 
         /* Obtain an encoded data frame */
         encDataWindow  = gst_ticircbuffer_get_data(imgdec1->circBuf);
+
+        /* A seek is flushing the pipeline.  Each image is decoded on its
+         * own, so just wait for data from the new position.
+         */
+        if (encDataWindow == NULL) {
+            continue;
+        }
+
         encDataTime    = GST_BUFFER_TIMESTAMP(encDataWindow);
         hEncDataWindow = GST_TIDMAIBUFFERTRANSPORT_DMAIBUF(encDataWindow);
 
@@ -1447,13 +1473,16 @@ static void* gst_tiimgdec1_decode_thread(void *arg)
         /* Push the transport buffer to the source pad */
         GST_LOG("pushing display buffer to source pad\n");
 
-        if (gst_pad_push(imgdec1->srcpad, outBuf) != GST_FLOW_OK) {
+        /* Downstream refuses buffers while a seek is flushing */
+        if (gst_pad_push(imgdec1->srcpad, outBuf) != GST_FLOW_OK &&
+            !gst_ticircbuffer_is_flushing(imgdec1->circBuf)) {
             GST_DEBUG("push to source pad failed\n");
             goto thread_failure;
         }
 
         /* Release buffers no longer in use by the codec */
-        Buffer_freeUseMask(hDstBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(imgdec1->hOutBufTab, hDstBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
 thread_failure:
@@ -1470,7 +1499,8 @@ thread_exit:
     while (bufIdx-- > 0) {
         Buffer_Handle hBuf = BufTab_getBuf(
             GST_TIDMAIBUFTAB_BUFTAB(imgdec1->hOutBufTab), bufIdx);
-        Buffer_freeUseMask(hBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(imgdec1->hOutBufTab, hBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
     /* Release the last buffer we retrieved from the circular buffer */
@@ -49,6 +49,7 @@
 #include "gstticodecs.h"
 #include "gsttithreadprops.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tiimgenc1_debug);
@@ -1494,7 +1495,7 @@ static gboolean gst_tiimgenc1_codec_stop (GstTIImgenc1  *imgenc1)
 
     if (imgenc1->hEngine) {
         GST_LOG("closing codec engine\n");
-        Engine_close(imgenc1->hEngine);
+        gst_tiengine_close(imgenc1->hEngine);
         imgenc1->hEngine = NULL;
     }
 
@@ -1513,7 +1514,7 @@ static gboolean gst_tiimgenc1_codec_start (GstTIImgenc1  *imgenc1)
 
     /* Open the codec engine */
     GST_LOG("opening codec engine \"%s\"\n", imgenc1->engineName);
-    imgenc1->hEngine = Engine_open((Char *) imgenc1->engineName, NULL, NULL);
+    imgenc1->hEngine = gst_tiengine_open(imgenc1->engineName);
 
     if (imgenc1->hEngine == NULL) {
         GST_ELEMENT_ERROR(imgenc1, RESOURCE, FAILED,
@@ -1587,6 +1588,7 @@ static gboolean gst_tiimgenc1_codec_start (GstTIImgenc1  *imgenc1)
     imgenc1->hOutBufTab = gst_tidmaibuftab_new(imgenc1->numOutputBufs,
         Ienc1_getOutBufSize(imgenc1->hIe),
         BufferGfx_getBufferAttrs(&gfxAttrs));
+    gst_tidmaibuftab_set_name(imgenc1->hOutBufTab, GST_ELEMENT_NAME(imgenc1));
 
     if (imgenc1->hOutBufTab == NULL) {
         GST_ELEMENT_ERROR(imgenc1, RESOURCE, NO_SPACE_LEFT,
@@ -1766,7 +1768,8 @@ static void* gst_tiimgenc1_encode_thread(void *arg)
         }
 
         /* Release buffers no longer in use by the codec */
-        Buffer_freeUseMask(hDstBuf, gst_tidmaibuffer_CODEC_FREE);
+        gst_tidmaibuftab_free_use_mask(imgenc1->hOutBufTab, hDstBuf,
+            gst_tidmaibuffer_CODEC_FREE);
     }
 
 thread_failure:
@@ -1785,7 +1788,8 @@ thread_exit:
         while (bufIdx-- > 0) {
             Buffer_Handle hBuf = BufTab_getBuf(
                 GST_TIDMAIBUFTAB_BUFTAB(imgenc1->hOutBufTab), bufIdx);
-            Buffer_freeUseMask(hBuf, gst_tidmaibuffer_CODEC_FREE);
+            gst_tidmaibuftab_free_use_mask(imgenc1->hOutBufTab, hBuf,
+                gst_tidmaibuffer_CODEC_FREE);
         }
     }
 
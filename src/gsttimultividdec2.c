@@ -0,0 +1,2373 @@
+/*
+ * gsttimultividdec2.c
+ *
+ * This file defines the "TIMultiViddec2" element, which decodes several
+ * xDM 1.2 video streams with one Codec Engine handle and one decode thread.
+ *
+ * Each requested sink pad "sink_%d" is a channel with its own codec instance
+ * and a matching source pad "src_%d".  A single decode thread serves every
+ * channel, choosing the next one either in turn or by the earliest running
+ * time, so a box decoding many small camera streams doesn't pay for a
+ * thread, circular buffer and BufTab per stream.  Channels decoding the same
+ * picture size can share one output BufTab.
+ *
+ * Example usage:
+ *     gst-launch TIMultiViddec2 name=dec
+ *         rtspsrc location=<camera 1> ! rtph264depay ! dec.sink_0
+ *         rtspsrc location=<camera 2> ! rtph264depay ! dec.sink_1
+ *         dec.src_0 ! queue ! <sink 1>
+ *         dec.src_1 ! queue ! <sink 2>
+ *
+ * Notes:
+ *  * Every input buffer must hold exactly one frame, such as the output of a
+ *    depayloader or demuxer.  H.264 must be in byte-stream format.
+ *  * Pushing a frame blocks the decode thread, and so every channel.  Put a
+ *    queue after each source pad.
+ *  * Per-channel statistics are available from the "channelStats" property,
+ *    and are posted as a "channel-stats" element message when a channel
+ *    reaches the end of its stream.
+ *  * There is no host benchmark of how the element scales with the number
+ *    of channels.  With a stub codec it would only time the scheduler.
+ *    Measure on the target instead, adding channels one at a time and
+ *    comparing "busyTime" with the time the streams played.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#include <ti/sdo/dmai/Dmai.h>
+#include <ti/sdo/dmai/VideoStd.h>
+#include <ti/sdo/dmai/Cpu.h>
+#include <ti/sdo/dmai/Buffer.h>
+#include <ti/sdo/dmai/BufferGfx.h>
+#include <ti/sdo/dmai/BufTab.h>
+#include <ti/sdo/dmai/ce/Vdec2.h>
+
+#include "gsttimultividdec2.h"
+#include "gsttidmaibuffertransport.h"
+#include "gstticodecs.h"
+#include "gsttithreadprops.h"
+#include "gstticommonutils.h"
+#include "gsttiengine.h"
+
+/* Declare variable used to categorize GST_LOG output */
+GST_DEBUG_CATEGORY_STATIC (gst_timultividdec2_debug);
+#define GST_CAT_DEFAULT gst_timultividdec2_debug
+
+/* Element property identifiers */
+enum
+{
+  PROP_0,
+  PROP_ENGINE_NAME,     /* engineName     (string)  */
+  PROP_CODEC_NAME,      /* codecName      (string)  */
+  PROP_NUM_OUTPUT_BUFS, /* numOutputBufs  (int)     */
+  PROP_SCHEDULE,        /* schedule       (int)     */
+  PROP_SHARE_POOLS,     /* sharePools     (boolean) */
+  PROP_QUEUE_LENGTH,    /* queueLength    (int)     */
+  PROP_GEN_TIMESTAMPS,  /* genTimeStamps  (boolean) */
+  PROP_RTCODECTHREAD,   /* rtCodecThread  (boolean) */
+  PROP_CHANNEL_STATS,   /* channelStats   (string)  */
+  PROP_BUSY_TIME        /* busyTime       (uint64)  */
+};
+
+/* What the decode thread does next with a channel */
+typedef enum
+{
+  ACTION_NONE,
+  ACTION_RELEASE,       /* tear down a channel whose pads are released */
+  ACTION_RESET,         /* reset the codec after a flush                */
+  ACTION_START,         /* create the codec for the caps                */
+  ACTION_EVENT,         /* forward a serialized event                   */
+  ACTION_DECODE,        /* decode one frame                             */
+  ACTION_DRAIN          /* flush the codec at end-of-stream             */
+} GstTIMultiViddec2Action;
+
+/* Define sink (input) pad capabilities.  Currently, MPEG and H264 are
+ * supported.
+ */
+static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE(
+    "sink_%d",
+    GST_PAD_SINK,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS
+    ("video/mpeg, "
+     "mpegversion=(int){ 2, 4 }, "  /* MPEG versions 2 and 4 */
+         "systemstream=(boolean)false, "
+         "framerate=(fraction)[ 0, MAX ], "
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ] ;"
+     "video/x-h264, "                             /* H264                  */
+         "framerate=(fraction)[ 0, MAX ], "
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ] ;"
+     "video/x-divx, "                             /* DivX (MPEG-4 ASP)     */
+         "divxversion=(int)[ 0, MAX ], "
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ] ;"
+     "video/x-xvid, "                             /* XviD (MPEG-4 ASP)     */
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ]"
+    )
+);
+
+/* Define source (output) pad capabilities.  Source pads are added along with
+ * the sink pad of the same number.
+ */
+static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE(
+    "src_%d",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS
+    ("video/x-raw-yuv, "                        /* UYVY */
+         "format=(fourcc)UYVY, "
+         "framerate=(fraction)[ 0, MAX ], "
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ];"
+    "video/x-raw-yuv, "                        /* NV12 */
+         "format=(fourcc)NV12, "
+         "framerate=(fraction)[ 0, MAX ], "
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ];"
+    "video/x-raw-yuv, "                        /* I420 */
+         "format=(fourcc)I420, "
+         "framerate=(fraction)[ 0, MAX ], "
+         "width=(int)[ 1, MAX ], "
+         "height=(int)[ 1, MAX ];"
+    )
+);
+
+/* Declare a global pointer to our element base class */
+static GstElementClass *parent_class = NULL;
+
+/* Static Function Declarations */
+static void
+ gst_timultividdec2_base_init(gpointer g_class);
+static void
+ gst_timultividdec2_class_init(GstTIMultiViddec2Class *g_class);
+static void
+ gst_timultividdec2_init(GstTIMultiViddec2 *object,
+     GstTIMultiViddec2Class *g_class);
+static void
+ gst_timultividdec2_finalize(GObject *object);
+static void
+ gst_timultividdec2_init_env(GstTIMultiViddec2 *mvd);
+static void
+ gst_timultividdec2_set_property (GObject *object, guint prop_id,
+     const GValue *value, GParamSpec *pspec);
+static void
+ gst_timultividdec2_get_property (GObject *object, guint prop_id,
+     GValue *value, GParamSpec *pspec);
+static GstPad*
+ gst_timultividdec2_request_new_pad(GstElement *element,
+     GstPadTemplate *templ, const gchar *name);
+static void
+ gst_timultividdec2_release_pad(GstElement *element, GstPad *pad);
+static gboolean
+ gst_timultividdec2_set_sink_caps(GstPad *pad, GstCaps *caps);
+static gboolean
+ gst_timultividdec2_sink_event(GstPad *pad, GstEvent *event);
+static gboolean
+ gst_timultividdec2_src_event(GstPad *pad, GstEvent *event);
+static gboolean
+ gst_timultividdec2_src_query(GstPad *pad, GstQuery *query);
+static GstFlowReturn
+ gst_timultividdec2_chain(GstPad *pad, GstBuffer *buf);
+static GstStateChangeReturn
+ gst_timultividdec2_change_state(GstElement *element,
+     GstStateChange transition);
+static gboolean
+ gst_timultividdec2_start_thread(GstTIMultiViddec2 *mvd);
+static void
+ gst_timultividdec2_stop_thread(GstTIMultiViddec2 *mvd);
+static void*
+ gst_timultividdec2_decode_thread(void *arg);
+static GstTIMultiViddec2Action
+ gst_timultividdec2_next_action(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel **channel, GstMiniObject **item,
+     Buffer_Handle *hDstBuf);
+static GstTIMultiViddec2Channel*
+ gst_timultividdec2_next_candidate(GstTIMultiViddec2 *mvd);
+static GstClockTime
+ gst_timultividdec2_deadline(GstTIMultiViddec2Channel *channel,
+     GstMiniObject *item);
+static gboolean
+ gst_timultividdec2_channel_start(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel *channel);
+static void
+ gst_timultividdec2_channel_stop(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel *channel);
+static void
+ gst_timultividdec2_channel_reset(GstTIMultiViddec2Channel *channel);
+static void
+ gst_timultividdec2_channel_decode(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel *channel, GstBuffer *buf,
+     Buffer_Handle hDstBuf);
+static void
+ gst_timultividdec2_channel_drain(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel *channel, GstEvent *event,
+     Buffer_Handle hDstBuf);
+static void
+ gst_timultividdec2_channel_event(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel *channel, GstEvent *event);
+static void
+ gst_timultividdec2_push_display_bufs(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Channel *channel);
+static void
+ gst_timultividdec2_release_free_bufs(GstTIMultiViddec2Channel *channel);
+static void
+ gst_timultividdec2_reclaim_held_bufs(GstTIMultiViddec2Channel *channel);
+static gboolean
+ gst_timultividdec2_set_source_caps(GstTIMultiViddec2Channel *channel,
+     Buffer_Handle hBuf);
+static GstTIMultiViddec2Pool*
+ gst_timultividdec2_get_pool(GstTIMultiViddec2 *mvd, Int32 bufSize,
+     Int32 width, Int32 height, ColorSpace_Type colorSpace, Int numBufs);
+static void
+ gst_timultividdec2_put_pool(GstTIMultiViddec2 *mvd,
+     GstTIMultiViddec2Pool *pool);
+static void
+ gst_timultividdec2_grow_pool(GstTIMultiViddec2Pool *pool, Int numBufs);
+static gboolean
+ gst_timultividdec2_get_codec_params(GstTIMultiViddec2 *mvd,
+     VIDDEC2_Params *params, ColorSpace_Type *colorSpace,
+     Int *defaultNumBufs);
+static GstClockTime
+ gst_timultividdec2_frame_duration(GstTIMultiViddec2Channel *channel);
+static GstStructure*
+ gst_timultividdec2_channel_stats(GstTIMultiViddec2Channel *channel);
+static gchar*
+ gst_timultividdec2_all_stats(GstTIMultiViddec2 *mvd);
+static void
+ gst_timultividdec2_flush_queue(GstTIMultiViddec2Channel *channel);
+static void
+ gst_timultividdec2_channel_free(GstTIMultiViddec2Channel *channel);
+
+
+/******************************************************************************
+ * gst_timultividdec2_class_init_trampoline
+ *    Boiler-plate function auto-generated by "make_element" script.
+ ******************************************************************************/
+static void gst_timultividdec2_class_init_trampoline(gpointer g_class,
+                gpointer data)
+{
+    parent_class = (GstElementClass*) g_type_class_peek_parent(g_class);
+    gst_timultividdec2_class_init((GstTIMultiViddec2Class*)g_class);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_get_type
+ *    Boiler-plate function auto-generated by "make_element" script.
+ *    Defines function pointers for initialization routines for this element.
+ ******************************************************************************/
+GType gst_timultividdec2_get_type(void)
+{
+    static GType object_type = 0;
+
+    if (G_UNLIKELY(object_type == 0)) {
+        static const GTypeInfo object_info = {
+            sizeof(GstTIMultiViddec2Class),
+            gst_timultividdec2_base_init,
+            NULL,
+            gst_timultividdec2_class_init_trampoline,
+            NULL,
+            NULL,
+            sizeof(GstTIMultiViddec2),
+            0,
+            (GInstanceInitFunc) gst_timultividdec2_init
+        };
+
+        object_type = g_type_register_static((gst_element_get_type()),
+                          "GstTIMultiViddec2", &object_info, (GTypeFlags)0);
+
+        /* Initialize GST_LOG for this object */
+        GST_DEBUG_CATEGORY_INIT(gst_timultividdec2_debug, "TIMultiViddec2",
+            0, "TI xDM 1.2 Multi-Channel Video Decoder");
+
+        GST_LOG("initialized get_type\n");
+    }
+
+    return object_type;
+};
+
+
+/******************************************************************************
+ * gst_timultividdec2_base_init
+ *    Boiler-plate function auto-generated by "make_element" script.
+ *    Initializes element base class.
+ ******************************************************************************/
+static void gst_timultividdec2_base_init(gpointer gclass)
+{
+    static GstElementDetails element_details = {
+        "TI xDM 1.2 Multi-Channel Video Decoder",
+        "Codec/Decoder/Video",
+        "Decodes several video streams using xDM 1.2-based codecs on one "
+        "engine and thread",
+        "Texas Instruments, Inc."
+    };
+
+    GstElementClass *element_class = GST_ELEMENT_CLASS(gclass);
+
+    gst_element_class_add_pad_template(element_class,
+        gst_static_pad_template_get (&src_factory));
+    gst_element_class_add_pad_template(element_class,
+        gst_static_pad_template_get (&sink_factory));
+    gst_element_class_set_details(element_class, &element_details);
+
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_class_init
+ *    Boiler-plate function auto-generated by "make_element" script.
+ *    Initializes the TIMultiViddec2 class.
+ ******************************************************************************/
+static void gst_timultividdec2_class_init(GstTIMultiViddec2Class *klass)
+{
+    GObjectClass    *gobject_class;
+    GstElementClass *gstelement_class;
+
+    gobject_class    = (GObjectClass*)    klass;
+    gstelement_class = (GstElementClass*) klass;
+
+    gobject_class->set_property = gst_timultividdec2_set_property;
+    gobject_class->get_property = gst_timultividdec2_get_property;
+    gobject_class->finalize     =
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_finalize);
+
+    gstelement_class->change_state    = gst_timultividdec2_change_state;
+    gstelement_class->request_new_pad =
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_request_new_pad);
+    gstelement_class->release_pad     =
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_release_pad);
+
+    g_object_class_install_property(gobject_class, PROP_ENGINE_NAME,
+        g_param_spec_string("engineName", "Engine Name",
+            "Engine name used by Codec Engine", "unspecified",
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(gobject_class, PROP_CODEC_NAME,
+        g_param_spec_string("codecName", "Codec Name",
+            "Name of video codec used for every channel", "unspecified",
+            G_PARAM_READWRITE));
+
+    g_object_class_install_property(gobject_class, PROP_NUM_OUTPUT_BUFS,
+        g_param_spec_int("numOutputBufs",
+            "Number of Ouput Buffers",
+            "Number of output buffers to allocate for each channel",
+            2, G_MAXINT32, 3, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_SCHEDULE,
+        g_param_spec_int("schedule", "Schedule",
+            "Which channel to decode next: 0 - each in turn, 1 - the one "
+            "whose next frame has the earliest running time",
+            GST_TIMULTIVIDDEC2_SCHEDULE_ROUND_ROBIN,
+            GST_TIMULTIVIDDEC2_SCHEDULE_DEADLINE,
+            GST_TIMULTIVIDDEC2_SCHEDULE_ROUND_ROBIN, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_SHARE_POOLS,
+        g_param_spec_boolean("sharePools", "Share output pools",
+            "Let channels decoding the same picture size share output "
+            "buffers",
+            TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_QUEUE_LENGTH,
+        g_param_spec_int("queueLength", "Queue length",
+            "Number of input frames queued per channel before upstream "
+            "blocks",
+            1, G_MAXINT32, 2, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_GEN_TIMESTAMPS,
+        g_param_spec_boolean("genTimeStamps", "Generate Time Stamps",
+            "Set timestamps on output buffers",
+            TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_RTCODECTHREAD,
+        g_param_spec_boolean("RTCodecThread", "Real time codec thread",
+            "Exectue codec calls in real-time thread",
+            TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_CHANNEL_STATS,
+        g_param_spec_string("channelStats", "Channel statistics",
+            "Statistics for each channel, as \"channel-stats\" structures "
+            "separated by semicolons",
+            NULL, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_BUSY_TIME,
+        g_param_spec_uint64("busyTime", "Busy time",
+            "Nanoseconds the decode thread has spent working rather than "
+            "waiting since it started",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE));
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_init_env
+ *  Initialize element property default by reading environment variables.
+ *****************************************************************************/
+static void gst_timultividdec2_init_env(GstTIMultiViddec2 *mvd)
+{
+    GST_LOG("gst_timultividdec2_init_env - begin\n");
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_engineName")) {
+        mvd->engineName =
+            gst_ti_env_get_string("GST_TI_TIMultiViddec2_engineName");
+        GST_LOG("Setting engineName=%s\n", mvd->engineName);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_codecName")) {
+        mvd->codecName =
+            gst_ti_env_get_string("GST_TI_TIMultiViddec2_codecName");
+        GST_LOG("Setting codecName=%s\n", mvd->codecName);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_numOutputBufs")) {
+        mvd->numOutputBufs =
+            gst_ti_env_get_int("GST_TI_TIMultiViddec2_numOutputBufs");
+        GST_LOG("Setting numOutputBufs=%d\n", mvd->numOutputBufs);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_schedule")) {
+        mvd->schedule = gst_ti_env_get_int("GST_TI_TIMultiViddec2_schedule");
+        GST_LOG("Setting schedule=%d\n", mvd->schedule);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_sharePools")) {
+        mvd->sharePools =
+            gst_ti_env_get_boolean("GST_TI_TIMultiViddec2_sharePools");
+        GST_LOG("Setting sharePools=%s\n", mvd->sharePools ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_queueLength")) {
+        mvd->queueLength =
+            gst_ti_env_get_int("GST_TI_TIMultiViddec2_queueLength");
+        GST_LOG("Setting queueLength=%d\n", mvd->queueLength);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_genTimeStamps")) {
+        mvd->genTimeStamps =
+            gst_ti_env_get_boolean("GST_TI_TIMultiViddec2_genTimeStamps");
+        GST_LOG("Setting genTimeStamps=%s\n",
+            mvd->genTimeStamps ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIMultiViddec2_RTCodecThread")) {
+        mvd->rtCodecThread =
+            gst_ti_env_get_boolean("GST_TI_TIMultiViddec2_RTCodecThread");
+        GST_LOG("Setting RTCodecThread=%s\n",
+            mvd->rtCodecThread ? "TRUE" : "FALSE");
+    }
+
+    GST_LOG("gst_timultividdec2_init_env - end\n");
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_init
+ *    Initializes a new element instance.  Pads are created on request.
+ ******************************************************************************/
+static void gst_timultividdec2_init(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Class *gclass)
+{
+    mvd->engineName      = NULL;
+    mvd->autoEngine      = FALSE;
+    mvd->codecName       = NULL;
+    mvd->numOutputBufs   = 0;
+    mvd->schedule        = GST_TIMULTIVIDDEC2_SCHEDULE_ROUND_ROBIN;
+    mvd->sharePools      = TRUE;
+    mvd->queueLength     = 2;
+    mvd->genTimeStamps   = TRUE;
+    mvd->rtCodecThread   = TRUE;
+
+    pthread_mutex_init(&mvd->channelMutex, NULL);
+    mvd->channels        = NULL;
+    mvd->nextChannel     = 0;
+    mvd->lastServed      = NULL;
+
+    mvd->threadRunning   = FALSE;
+    mvd->threadStop      = FALSE;
+    gst_tieventcount_init(&mvd->workEvent);
+    gst_tieventcount_init(&mvd->spaceEvent);
+
+    mvd->hEngine         = NULL;
+    mvd->pools           = NULL;
+    mvd->busyTime        = 0;
+    mvd->threadStartTime = GST_CLOCK_TIME_NONE;
+
+    gst_timultividdec2_init_env(mvd);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_finalize
+ *    Free what is left of the channels; their pads are gone by now.
+ ******************************************************************************/
+static void gst_timultividdec2_finalize(GObject *object)
+{
+    GstTIMultiViddec2 *mvd = GST_TIMULTIVIDDEC2(object);
+
+    g_list_foreach(mvd->channels, (GFunc)gst_timultividdec2_channel_free,
+        NULL);
+    g_list_free(mvd->channels);
+    mvd->channels = NULL;
+
+    gst_tieventcount_destroy(&mvd->workEvent);
+    gst_tieventcount_destroy(&mvd->spaceEvent);
+    pthread_mutex_destroy(&mvd->channelMutex);
+
+    G_OBJECT_CLASS(parent_class)->finalize(object);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_set_property
+ *     Set element properties when requested.
+ ******************************************************************************/
+static void gst_timultividdec2_set_property(GObject *object, guint prop_id,
+                const GValue *value, GParamSpec *pspec)
+{
+    GstTIMultiViddec2 *mvd = GST_TIMULTIVIDDEC2(object);
+
+    GST_LOG("begin set_property\n");
+
+    switch (prop_id) {
+        case PROP_ENGINE_NAME:
+            if (mvd->engineName && !mvd->autoEngine) {
+                g_free((gpointer)mvd->engineName);
+            }
+            mvd->engineName =
+                (gchar*)g_malloc(strlen(g_value_get_string(value)) + 1);
+            strcpy((gchar *)mvd->engineName, g_value_get_string(value));
+            mvd->autoEngine = FALSE;
+            GST_LOG("setting \"engineName\" to \"%s\"\n", mvd->engineName);
+            break;
+        case PROP_CODEC_NAME:
+            if (mvd->codecName) {
+                g_free((gpointer)mvd->codecName);
+            }
+            mvd->codecName =
+                (gchar*)g_malloc(strlen(g_value_get_string(value)) + 1);
+            strcpy((gchar*)mvd->codecName, g_value_get_string(value));
+            GST_LOG("setting \"codecName\" to \"%s\"\n", mvd->codecName);
+            break;
+        case PROP_NUM_OUTPUT_BUFS:
+            mvd->numOutputBufs = g_value_get_int(value);
+            GST_LOG("setting \"numOutputBufs\" to \"%d\"\n",
+                mvd->numOutputBufs);
+            break;
+        case PROP_SCHEDULE:
+            mvd->schedule = g_value_get_int(value);
+            GST_LOG("setting \"schedule\" to \"%d\"\n", mvd->schedule);
+            break;
+        case PROP_SHARE_POOLS:
+            mvd->sharePools = g_value_get_boolean(value);
+            GST_LOG("setting \"sharePools\" to \"%s\"\n",
+                mvd->sharePools ? "TRUE" : "FALSE");
+            break;
+        case PROP_QUEUE_LENGTH:
+            mvd->queueLength = g_value_get_int(value);
+            GST_LOG("setting \"queueLength\" to \"%d\"\n", mvd->queueLength);
+            break;
+        case PROP_GEN_TIMESTAMPS:
+            mvd->genTimeStamps = g_value_get_boolean(value);
+            GST_LOG("setting \"genTimeStamps\" to \"%s\"\n",
+                mvd->genTimeStamps ? "TRUE" : "FALSE");
+            break;
+        case PROP_RTCODECTHREAD:
+            mvd->rtCodecThread = g_value_get_boolean(value);
+            GST_LOG("setting \"RTCodecThread\" to \"%s\"\n",
+                mvd->rtCodecThread ? "TRUE" : "FALSE");
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+
+    GST_LOG("end set_property\n");
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_get_property
+ *     Return values for requested element property.
+ ******************************************************************************/
+static void gst_timultividdec2_get_property(GObject *object, guint prop_id,
+                GValue *value, GParamSpec *pspec)
+{
+    GstTIMultiViddec2 *mvd = GST_TIMULTIVIDDEC2(object);
+
+    GST_LOG("begin get_property\n");
+
+    switch (prop_id) {
+        case PROP_ENGINE_NAME:
+            g_value_set_string(value, mvd->engineName);
+            break;
+        case PROP_CODEC_NAME:
+            g_value_set_string(value, mvd->codecName);
+            break;
+        case PROP_CHANNEL_STATS:
+            g_value_take_string(value, gst_timultividdec2_all_stats(mvd));
+            break;
+        case PROP_BUSY_TIME:
+            g_value_set_uint64(value, mvd->busyTime);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+
+    GST_LOG("end get_property\n");
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_request_new_pad
+ *     Add a channel:  a sink pad and the source pad with the same number.
+ ******************************************************************************/
+static GstPad* gst_timultividdec2_request_new_pad(GstElement *element,
+                   GstPadTemplate *templ, const gchar *name)
+{
+    GstTIMultiViddec2        *mvd = GST_TIMULTIVIDDEC2(element);
+    GstTIMultiViddec2Channel *channel;
+    gchar                    *padName;
+
+    if (templ->direction != GST_PAD_SINK) {
+        GST_WARNING("only sink pads can be requested\n");
+        return NULL;
+    }
+
+    channel = g_new0(GstTIMultiViddec2Channel, 1);
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    channel->index = mvd->nextChannel++;
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    channel->queue    = g_queue_new();
+    channel->segment  = gst_segment_new();
+    channel->lastFlow = GST_FLOW_OK;
+    gst_segment_init(channel->segment, GST_FORMAT_TIME);
+    g_value_init(&channel->framerate, GST_TYPE_FRACTION);
+    gst_value_set_fraction(&channel->framerate, 0, 1);
+
+    /* Encoded video sink pad */
+    padName = g_strdup_printf("sink_%d", channel->index);
+    channel->sinkpad = gst_pad_new_from_template(templ, padName);
+    g_free(padName);
+
+    gst_pad_set_element_private(channel->sinkpad, channel);
+    gst_pad_set_setcaps_function(channel->sinkpad,
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_set_sink_caps));
+    gst_pad_set_event_function(channel->sinkpad,
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_sink_event));
+    gst_pad_set_chain_function(channel->sinkpad,
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_chain));
+
+    /* Decoded video source pad */
+    padName = g_strdup_printf("src_%d", channel->index);
+    channel->srcpad = gst_pad_new_from_static_template(&src_factory, padName);
+    g_free(padName);
+
+    gst_pad_set_element_private(channel->srcpad, channel);
+    gst_pad_use_fixed_caps(channel->srcpad);
+    gst_pad_set_event_function(channel->srcpad,
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_src_event));
+    gst_pad_set_query_function(channel->srcpad,
+        GST_DEBUG_FUNCPTR(gst_timultividdec2_src_query));
+
+    /* A channel added while running starts out active */
+    if (GST_STATE(element) > GST_STATE_READY) {
+        gst_pad_set_active(channel->sinkpad, TRUE);
+        gst_pad_set_active(channel->srcpad, TRUE);
+    }
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    mvd->channels = g_list_append(mvd->channels, channel);
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    gst_element_add_pad(element, channel->srcpad);
+    gst_element_add_pad(element, channel->sinkpad);
+
+    GST_INFO("added channel %d\n", channel->index);
+    return channel->sinkpad;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_release_pad
+ *     Remove a channel.  If the decode thread is running, it deletes the
+ *     channel's codec; wait for that before the pads go away.
+ ******************************************************************************/
+static void gst_timultividdec2_release_pad(GstElement *element, GstPad *pad)
+{
+    GstTIMultiViddec2        *mvd     = GST_TIMULTIVIDDEC2(element);
+    GstTIMultiViddec2Channel *channel = gst_pad_get_element_private(pad);
+    gboolean                  removed;
+    gint                      key;
+
+    if (channel == NULL || pad != channel->sinkpad) {
+        return;
+    }
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    channel->flushing  = TRUE;
+    channel->releasing = TRUE;
+    gst_timultividdec2_flush_queue(channel);
+
+    if (!mvd->threadRunning) {
+        mvd->channels = g_list_remove(mvd->channels, channel);
+    }
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    gst_tieventcount_notify(&mvd->spaceEvent);
+    gst_tieventcount_notify(&mvd->workEvent);
+
+    while (TRUE) {
+        key = gst_tieventcount_prepare_wait(&mvd->spaceEvent);
+
+        pthread_mutex_lock(&mvd->channelMutex);
+        removed = (g_list_find(mvd->channels, channel) == NULL);
+        pthread_mutex_unlock(&mvd->channelMutex);
+
+        if (removed) {
+            break;
+        }
+        gst_tieventcount_wait(&mvd->spaceEvent, key);
+    }
+
+    GST_INFO("removing channel %d\n", channel->index);
+
+    gst_pad_set_active(channel->srcpad, FALSE);
+    gst_element_remove_pad(element, channel->srcpad);
+    gst_element_remove_pad(element, channel->sinkpad);
+    gst_timultividdec2_channel_free(channel);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_set_sink_caps
+ *     Negotiate the sink pad capabilities of one channel.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_set_sink_caps(GstPad *pad, GstCaps *caps)
+{
+    GstTIMultiViddec2        *mvd;
+    GstTIMultiViddec2Channel *channel;
+    GstStructure             *capStruct;
+    const gchar              *mime;
+    const gchar              *codecName;
+    const GValue             *codecData;
+    GstTICodec               *codec = NULL;
+    gint                      framerateNum;
+    gint                      framerateDen;
+    gint                      width;
+    gint                      height;
+    gchar                    *string;
+
+    mvd       = GST_TIMULTIVIDDEC2(gst_pad_get_parent(pad));
+    channel   = gst_pad_get_element_private(pad);
+    capStruct = gst_caps_get_structure(caps, 0);
+    mime      = gst_structure_get_name(capStruct);
+    codecData = gst_structure_get_value(capStruct, "codec_data");
+
+    string = gst_caps_to_string(caps);
+    GST_INFO("channel %d requested sink caps:  %s", channel->index, string);
+    g_free(string);
+
+    /* MPEG Decode */
+    if (!strcmp(mime, "video/mpeg")) {
+        gboolean  systemstream;
+        gint      mpegversion;
+
+        if (!gst_structure_get_int(capStruct, "mpegversion", &mpegversion)) {
+            mpegversion = 0;
+        }
+
+        if (!gst_structure_get_boolean(capStruct, "systemstream",
+                 &systemstream)) {
+            systemstream = FALSE;
+        }
+
+        if (!systemstream && mpegversion == 2) {
+            codec = gst_ticodec_get_codec("MPEG2 Video Decoder");
+        }
+        else if (!systemstream && mpegversion == 4) {
+            codec = gst_ticodec_get_codec("MPEG4 Video Decoder");
+        }
+        else {
+            gst_object_unref(mvd);
+            return FALSE;
+        }
+    }
+
+    /* H.264 Decode.  Packetized streams are not converted here. */
+    else if (!strcmp(mime, "video/x-h264")) {
+        if (codecData) {
+            GST_ELEMENT_ERROR(mvd, STREAM, WRONG_TYPE,
+            ("channel %d: H.264 input must be in byte-stream format\n",
+             channel->index), (NULL));
+            gst_object_unref(mvd);
+            return FALSE;
+        }
+        codec = gst_ticodec_get_codec("H.264 Video Decoder");
+    }
+
+    /* MPEG-4 ASP Decode (DivX / XviD) */
+    else if (!strcmp(mime, "video/x-divx") || !strcmp(mime, "video/x-xvid")) {
+        codec = gst_ticodec_get_codec("MPEG4 Video Decoder");
+    }
+
+    /* Mime type not supported */
+    else {
+        GST_ELEMENT_ERROR(mvd, STREAM, NOT_IMPLEMENTED,
+        ("stream type not supported"), (NULL));
+        gst_object_unref(mvd);
+        return FALSE;
+    }
+
+    /* Report if the required codec was not found */
+    if (!codec) {
+        GST_ELEMENT_ERROR(mvd, STREAM, CODEC_NOT_FOUND,
+        ("unable to find codec needed for stream"), (NULL));
+        gst_object_unref(mvd);
+        return FALSE;
+    }
+
+    /* Every channel has to use the same engine */
+    pthread_mutex_lock(&mvd->channelMutex);
+    if (!mvd->engineName) {
+        mvd->engineName = codec->CE_EngineName;
+        mvd->autoEngine = TRUE;
+    }
+    else if (mvd->autoEngine && strcmp(mvd->engineName,
+                 codec->CE_EngineName)) {
+        pthread_mutex_unlock(&mvd->channelMutex);
+        GST_ELEMENT_ERROR(mvd, STREAM, CODEC_NOT_FOUND,
+        ("channel %d needs engine \"%s\", but engine \"%s\" is in use\n",
+         channel->index, codec->CE_EngineName, mvd->engineName), (NULL));
+        gst_object_unref(mvd);
+        return FALSE;
+    }
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    codecName = mvd->codecName ? mvd->codecName : codec->CE_CodecName;
+
+    if (!gst_structure_get_int(capStruct, "width", &width)) {
+        width = 0;
+    }
+    if (!gst_structure_get_int(capStruct, "height", &height)) {
+        height = 0;
+    }
+
+    /* The decode thread picks up the new stream description with the next
+     * frame, and re-creates the codec if it changed.
+     */
+    pthread_mutex_lock(&mvd->channelMutex);
+
+    if (channel->codecName != codecName || channel->width != width ||
+        channel->height != height) {
+        channel->capsChanged = TRUE;
+    }
+    channel->codecName = codecName;
+    channel->width     = width;
+    channel->height    = height;
+
+    if (gst_structure_get_fraction(capStruct, "framerate", &framerateNum,
+            &framerateDen)) {
+        gst_value_set_fraction(&channel->framerate, framerateNum,
+            framerateDen);
+    }
+
+    /* An MPEG-4 header passed in caps is decoded ahead of the first frame */
+    if (channel->codecHeader) {
+        gst_buffer_unref(channel->codecHeader);
+        channel->codecHeader = NULL;
+    }
+    if (codecData && G_VALUE_TYPE(codecData) == GST_TYPE_BUFFER) {
+        channel->codecHeader = gst_buffer_ref(gst_value_get_buffer(codecData));
+        channel->capsChanged = TRUE;
+    }
+
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    gst_object_unref(mvd);
+
+    GST_LOG("sink caps negotiation successful\n");
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_sink_event
+ *     Serialized events wait in the channel's queue for the decode thread,
+ *     so they stay in order with the frames around them.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_sink_event(GstPad *pad, GstEvent *event)
+{
+    GstTIMultiViddec2        *mvd;
+    GstTIMultiViddec2Channel *channel;
+    gboolean                  ret = TRUE;
+
+    mvd     = GST_TIMULTIVIDDEC2(GST_OBJECT_PARENT(pad));
+    channel = gst_pad_get_element_private(pad);
+
+    GST_DEBUG("pad \"%s\" received:  %s\n", GST_PAD_NAME(pad),
+        GST_EVENT_TYPE_NAME(event));
+
+    switch (GST_EVENT_TYPE(event)) {
+
+        case GST_EVENT_FLUSH_START:
+            /* Refuse new input, drop what is queued, and wake a chain call
+             * waiting for queue space.
+             */
+            pthread_mutex_lock(&mvd->channelMutex);
+            channel->flushing = TRUE;
+            gst_timultividdec2_flush_queue(channel);
+            pthread_mutex_unlock(&mvd->channelMutex);
+            gst_tieventcount_notify(&mvd->spaceEvent);
+
+            ret = gst_pad_push_event(channel->srcpad, event);
+            break;
+
+        case GST_EVENT_FLUSH_STOP:
+            /* The decode thread resets the codec before the next frame */
+            pthread_mutex_lock(&mvd->channelMutex);
+            channel->flushing  = FALSE;
+            channel->needReset = TRUE;
+            channel->eos       = FALSE;
+            channel->lastFlow  = GST_FLOW_OK;
+            gst_segment_init(channel->segment, GST_FORMAT_TIME);
+            pthread_mutex_unlock(&mvd->channelMutex);
+            gst_tieventcount_notify(&mvd->workEvent);
+
+            ret = gst_pad_push_event(channel->srcpad, event);
+            break;
+
+        default:
+            if (!GST_EVENT_IS_SERIALIZED(event)) {
+                ret = gst_pad_push_event(channel->srcpad, event);
+                break;
+            }
+
+            pthread_mutex_lock(&mvd->channelMutex);
+            if (channel->flushing || !mvd->threadRunning) {
+                pthread_mutex_unlock(&mvd->channelMutex);
+                gst_event_unref(event);
+                ret = FALSE;
+                break;
+            }
+            if (GST_EVENT_TYPE(event) == GST_EVENT_EOS) {
+                channel->eos = TRUE;
+            }
+            g_queue_push_tail(channel->queue, event);
+            pthread_mutex_unlock(&mvd->channelMutex);
+
+            gst_tieventcount_notify(&mvd->workEvent);
+            break;
+    }
+
+    return ret;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_src_event
+ *     Send upstream events to the sink pad of the same channel only.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_src_event(GstPad *pad, GstEvent *event)
+{
+    GstTIMultiViddec2Channel *channel = gst_pad_get_element_private(pad);
+
+    return gst_pad_push_event(channel->sinkpad, event);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_src_query
+ *     Answer queries from upstream of the same channel.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_src_query(GstPad *pad, GstQuery *query)
+{
+    GstTIMultiViddec2Channel *channel = gst_pad_get_element_private(pad);
+
+    return gst_pad_peer_query(channel->sinkpad, query);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_chain
+ *    Queue one frame for the decode thread, waiting while the channel's
+ *    queue is full.
+ ******************************************************************************/
+static GstFlowReturn gst_timultividdec2_chain(GstPad *pad, GstBuffer *buf)
+{
+    GstTIMultiViddec2        *mvd = GST_TIMULTIVIDDEC2(GST_OBJECT_PARENT(pad));
+    GstTIMultiViddec2Channel *channel = gst_pad_get_element_private(pad);
+    GstFlowReturn             flow    = GST_FLOW_OK;
+    gboolean                  waited  = FALSE;
+    gint                      key;
+
+    while (TRUE) {
+        key = gst_tieventcount_prepare_wait(&mvd->spaceEvent);
+
+        pthread_mutex_lock(&mvd->channelMutex);
+
+        if (channel->flushing || !mvd->threadRunning) {
+            flow = GST_FLOW_WRONG_STATE;
+        }
+        else if (channel->lastFlow != GST_FLOW_OK) {
+            flow = channel->lastFlow;
+        }
+        else if (channel->eos) {
+            flow = GST_FLOW_UNEXPECTED;
+        }
+        else if (channel->queuedBufs < mvd->queueLength) {
+            g_queue_push_tail(channel->queue, buf);
+            channel->queuedBufs++;
+            buf = NULL;
+        }
+        else if (!waited) {
+            channel->queueWaits++;
+            waited = TRUE;
+        }
+
+        pthread_mutex_unlock(&mvd->channelMutex);
+
+        if (flow != GST_FLOW_OK || buf == NULL) {
+            break;
+        }
+        gst_tieventcount_wait(&mvd->spaceEvent, key);
+    }
+
+    if (buf) {
+        gst_buffer_unref(buf);
+        return flow;
+    }
+
+    gst_tieventcount_notify(&mvd->workEvent);
+    return flow;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_change_state
+ *     Manage state changes for the video streams.  The gStreamer documentation
+ *     states that state changes must be handled in this manner:
+ *        1) Handle ramp-up states
+ *        2) Pass state change to base class
+ *        3) Handle ramp-down states
+ ******************************************************************************/
+static GstStateChangeReturn gst_timultividdec2_change_state(
+                                GstElement *element, GstStateChange transition)
+{
+    GstStateChangeReturn  ret = GST_STATE_CHANGE_SUCCESS;
+    GstTIMultiViddec2    *mvd = GST_TIMULTIVIDDEC2(element);
+    GList                *item;
+
+    GST_LOG("begin change_state (%d)\n", transition);
+
+    /* Handle ramp-up state changes */
+    switch (transition) {
+        case GST_STATE_CHANGE_READY_TO_PAUSED:
+            if (!gst_timultividdec2_start_thread(mvd)) {
+                return GST_STATE_CHANGE_FAILURE;
+            }
+            break;
+
+        case GST_STATE_CHANGE_PAUSED_TO_READY:
+            /* Make chain calls waiting for queue space return, so the
+             * streaming threads can stop.
+             */
+            pthread_mutex_lock(&mvd->channelMutex);
+            mvd->threadStop = TRUE;
+            for (item = mvd->channels; item; item = g_list_next(item)) {
+                ((GstTIMultiViddec2Channel*)item->data)->flushing = TRUE;
+            }
+            pthread_mutex_unlock(&mvd->channelMutex);
+            gst_tieventcount_notify(&mvd->spaceEvent);
+            gst_tieventcount_notify(&mvd->workEvent);
+            break;
+
+        default:
+            break;
+    }
+
+    /* Pass state changes to base class */
+    ret = GST_ELEMENT_CLASS(parent_class)->change_state(element, transition);
+    if (ret == GST_STATE_CHANGE_FAILURE)
+        return ret;
+
+    /* Handle ramp-down state changes */
+    switch (transition) {
+        case GST_STATE_CHANGE_PAUSED_TO_READY:
+            gst_timultividdec2_stop_thread(mvd);
+            break;
+
+        default:
+            break;
+    }
+
+    GST_LOG("end change_state\n");
+    return ret;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_start_thread
+ *     Create the decode thread shared by all channels.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_start_thread(GstTIMultiViddec2 *mvd)
+{
+    struct sched_param  schedParam;
+    pthread_attr_t      attr;
+    GList              *item;
+
+    GST_LOG("begin start_thread\n");
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    for (item = mvd->channels; item; item = g_list_next(item)) {
+        GstTIMultiViddec2Channel *channel = item->data;
+
+        channel->flushing = FALSE;
+        channel->eos      = FALSE;
+        channel->lastFlow = GST_FLOW_OK;
+        gst_segment_init(channel->segment, GST_FORMAT_TIME);
+    }
+    mvd->threadStop      = FALSE;
+    mvd->threadRunning   = TRUE;
+    mvd->busyTime        = 0;
+    mvd->threadStartTime = gst_util_get_timestamp();
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    /* Initialize custom thread attributes */
+    if (pthread_attr_init(&attr)) {
+        GST_WARNING("failed to initialize thread attrs\n");
+        goto fail;
+    }
+
+    /* Force the thread to use the system scope */
+    if (pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM)) {
+        GST_WARNING("failed to set scope attribute\n");
+        goto fail;
+    }
+
+    /* Force the thread to use custom scheduling attributes */
+    if (pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)) {
+        GST_WARNING("failed to set schedule inheritance attribute\n");
+        goto fail;
+    }
+
+    /* Set the thread to be fifo real time scheduled */
+    if (pthread_attr_setschedpolicy(&attr, SCHED_FIFO)) {
+        GST_WARNING("failed to set FIFO scheduling policy\n");
+        goto fail;
+    }
+
+    /* Set the decode thread priority */
+    schedParam.sched_priority = GstTIVideoThreadPriority;
+    if (pthread_attr_setschedparam(&attr, &schedParam)) {
+        GST_WARNING("failed to set scheduler parameters\n");
+        goto fail;
+    }
+
+    /* Create decoder thread */
+    if (pthread_create(&mvd->decodeThread, mvd->rtCodecThread ? &attr : NULL,
+            gst_timultividdec2_decode_thread, (void*)mvd)) {
+        GST_ELEMENT_ERROR(mvd, RESOURCE, FAILED,
+        ("failed to create decode thread\n"), (NULL));
+        pthread_attr_destroy(&attr);
+        goto fail;
+    }
+
+    /* Destroy the custom thread attributes */
+    if (pthread_attr_destroy(&attr)) {
+        GST_WARNING("failed to destroy thread attrs\n");
+    }
+
+    GST_LOG("end start_thread\n");
+    return TRUE;
+
+fail:
+    pthread_mutex_lock(&mvd->channelMutex);
+    mvd->threadRunning = FALSE;
+    pthread_mutex_unlock(&mvd->channelMutex);
+    return FALSE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_stop_thread
+ *     Wait for the decode thread to delete the codecs and exit.  The caller
+ *     has set threadStop.
+ ******************************************************************************/
+static void gst_timultividdec2_stop_thread(GstTIMultiViddec2 *mvd)
+{
+    GList *item;
+
+    if (!mvd->threadRunning) {
+        return;
+    }
+
+    pthread_join(mvd->decodeThread, NULL);
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    mvd->threadRunning = FALSE;
+    for (item = mvd->channels; item; item = g_list_next(item)) {
+        gst_timultividdec2_flush_queue(item->data);
+    }
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    GST_INFO("decode thread was busy %" GST_TIME_FORMAT " of %"
+        GST_TIME_FORMAT "\n", GST_TIME_ARGS(mvd->busyTime),
+        GST_TIME_ARGS(gst_util_get_timestamp() - mvd->threadStartTime));
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_decode_thread
+ *     Serve every channel from one thread.  All codec calls are made here,
+ *     as some dsplink APIs (e.g. RingIO) don't support multi-threading.
+ ******************************************************************************/
+static void* gst_timultividdec2_decode_thread(void *arg)
+{
+    GstTIMultiViddec2        *mvd = GST_TIMULTIVIDDEC2(gst_object_ref(arg));
+    GstTIMultiViddec2Channel *channel;
+    GstTIMultiViddec2Action   action;
+    GstMiniObject            *item;
+    Buffer_Handle             hDstBuf;
+    GstClockTime              workStart;
+    GList                    *chanItem;
+    gint                      key;
+
+    GST_LOG("init multi-channel decode thread\n");
+
+    while (TRUE) {
+        key = gst_tieventcount_prepare_wait(&mvd->workEvent);
+
+        pthread_mutex_lock(&mvd->channelMutex);
+        if (mvd->threadStop) {
+            pthread_mutex_unlock(&mvd->channelMutex);
+            break;
+        }
+        action = gst_timultividdec2_next_action(mvd, &channel, &item,
+                     &hDstBuf);
+        pthread_mutex_unlock(&mvd->channelMutex);
+
+        /* Nothing can run until a frame arrives or a buffer is released */
+        if (action == ACTION_NONE) {
+            gst_tieventcount_wait(&mvd->workEvent, key);
+            continue;
+        }
+
+        workStart = gst_util_get_timestamp();
+
+        switch (action) {
+            case ACTION_RELEASE:
+                gst_timultividdec2_channel_stop(mvd, channel);
+
+                pthread_mutex_lock(&mvd->channelMutex);
+                mvd->channels = g_list_remove(mvd->channels, channel);
+                if (mvd->lastServed == channel) {
+                    mvd->lastServed = NULL;
+                }
+                pthread_mutex_unlock(&mvd->channelMutex);
+                break;
+
+            case ACTION_RESET:
+                gst_timultividdec2_channel_reset(channel);
+                break;
+
+            case ACTION_START:
+                if (!gst_timultividdec2_channel_start(mvd, channel)) {
+                    gst_timultividdec2_channel_stop(mvd, channel);
+
+                    pthread_mutex_lock(&mvd->channelMutex);
+                    channel->lastFlow = GST_FLOW_ERROR;
+                    gst_timultividdec2_flush_queue(channel);
+                    pthread_mutex_unlock(&mvd->channelMutex);
+                }
+                break;
+
+            case ACTION_EVENT:
+                gst_timultividdec2_channel_event(mvd, channel,
+                    GST_EVENT(item));
+                break;
+
+            case ACTION_DECODE:
+                gst_timultividdec2_channel_decode(mvd, channel,
+                    GST_BUFFER(item), hDstBuf);
+                break;
+
+            case ACTION_DRAIN:
+                gst_timultividdec2_channel_drain(mvd, channel,
+                    GST_EVENT(item), hDstBuf);
+                break;
+
+            default:
+                break;
+        }
+
+        mvd->busyTime += gst_util_get_timestamp() - workStart;
+
+        /* A chain call may be waiting for queue space */
+        gst_tieventcount_notify(&mvd->spaceEvent);
+    }
+
+    /* Delete every codec, and the engine.  Channels being released are
+     * dropped from the list here if they weren't served before the stop.
+     */
+    pthread_mutex_lock(&mvd->channelMutex);
+    chanItem = mvd->channels;
+    while (chanItem) {
+        channel  = chanItem->data;
+        chanItem = g_list_next(chanItem);
+
+        gst_timultividdec2_channel_stop(mvd, channel);
+        channel->capsChanged = TRUE;
+
+        if (channel->releasing) {
+            mvd->channels = g_list_remove(mvd->channels, channel);
+        }
+    }
+    mvd->lastServed = NULL;
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    if (mvd->hEngine) {
+        GST_LOG("closing codec engine\n");
+        gst_tiengine_close(mvd->hEngine);
+        mvd->hEngine = NULL;
+    }
+
+    /* A release_pad call may be waiting for its channel to go */
+    gst_tieventcount_notify(&mvd->spaceEvent);
+
+    gst_object_unref(mvd);
+
+    GST_LOG("exit multi-channel decode thread\n");
+    return GstTIThreadSuccess;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_next_action
+ *     Choose what the decode thread does next, and take the queued item and
+ *     output buffer it needs.  Called with channelMutex held.
+ ******************************************************************************/
+static GstTIMultiViddec2Action gst_timultividdec2_next_action(
+                                   GstTIMultiViddec2 *mvd,
+                                   GstTIMultiViddec2Channel **channel,
+                                   GstMiniObject **item,
+                                   Buffer_Handle *hDstBuf)
+{
+    GstTIMultiViddec2Channel *ch;
+    GstMiniObject            *head;
+    GList                    *chanItem;
+
+    *item    = NULL;
+    *hDstBuf = NULL;
+
+    /* Channel teardown and codec resets go first */
+    for (chanItem = mvd->channels; chanItem;
+         chanItem = g_list_next(chanItem)) {
+        ch = chanItem->data;
+        ch->skip = FALSE;
+
+        if (ch->releasing) {
+            ch->releasing = FALSE;
+            *channel = ch;
+            return ACTION_RELEASE;
+        }
+
+        if (ch->needReset) {
+            ch->needReset = FALSE;
+            *channel = ch;
+            return ACTION_RESET;
+        }
+    }
+
+    /* Pick a channel with queued input.  Frames need a free output buffer;
+     * channels without one are passed over until a buffer is released.
+     */
+    while ((ch = gst_timultividdec2_next_candidate(mvd))) {
+        head = g_queue_peek_head(ch->queue);
+
+        if (GST_IS_BUFFER(head) && (ch->hVd == NULL || ch->capsChanged)) {
+            *channel = ch;
+            return ACTION_START;
+        }
+
+        if (GST_IS_EVENT(head) && GST_EVENT_TYPE(head) != GST_EVENT_EOS) {
+            *channel      = ch;
+            *item         = g_queue_pop_head(ch->queue);
+            mvd->lastServed = ch;
+            return ACTION_EVENT;
+        }
+
+        if (ch->hVd) {
+            *hDstBuf = gst_tidmaibuftab_get_buf(ch->pool->hBufTab);
+            if (*hDstBuf == NULL) {
+                ch->outputWaits++;
+                ch->skip = TRUE;
+                continue;
+            }
+        }
+
+        *channel        = ch;
+        *item           = g_queue_pop_head(ch->queue);
+        mvd->lastServed = ch;
+
+        if (GST_IS_BUFFER(*item)) {
+            ch->queuedBufs--;
+            return ACTION_DECODE;
+        }
+        return ACTION_DRAIN;
+    }
+
+    return ACTION_NONE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_next_candidate
+ *     Return the channel to serve next according to the schedule property,
+ *     among the channels with queued input not passed over already.  Called
+ *     with channelMutex held.
+ ******************************************************************************/
+static GstTIMultiViddec2Channel* gst_timultividdec2_next_candidate(
+                                     GstTIMultiViddec2 *mvd)
+{
+    GstTIMultiViddec2Channel *ch;
+    GstTIMultiViddec2Channel *best         = NULL;
+    GstClockTime              bestDeadline = GST_CLOCK_TIME_NONE;
+    GstClockTime              deadline;
+    GList                    *start;
+    GList                    *chanItem;
+
+    if (mvd->channels == NULL) {
+        return NULL;
+    }
+
+    /* Start after the channel served last, so ties go round in turn */
+    start = mvd->lastServed ? g_list_find(mvd->channels, mvd->lastServed) :
+                              NULL;
+    start = (start && g_list_next(start)) ? g_list_next(start) :
+                                            mvd->channels;
+    chanItem = start;
+
+    do {
+        ch = chanItem->data;
+
+        if (!ch->skip && !g_queue_is_empty(ch->queue)) {
+            if (mvd->schedule == GST_TIMULTIVIDDEC2_SCHEDULE_ROUND_ROBIN) {
+                return ch;
+            }
+
+            deadline = gst_timultividdec2_deadline(ch,
+                           g_queue_peek_head(ch->queue));
+            if (best == NULL || deadline < bestDeadline) {
+                best         = ch;
+                bestDeadline = deadline;
+            }
+        }
+
+        chanItem = g_list_next(chanItem) ? g_list_next(chanItem) :
+                                           mvd->channels;
+    } while (chanItem != start);
+
+    return best;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_deadline
+ *     Return the running time by which a queued item should be handled.
+ *     Events go first; frames without a timestamp go last.
+ ******************************************************************************/
+static GstClockTime gst_timultividdec2_deadline(
+                        GstTIMultiViddec2Channel *channel,
+                        GstMiniObject *item)
+{
+    GstClockTime runningTime;
+
+    if (!GST_IS_BUFFER(item)) {
+        return 0;
+    }
+
+    if (!GST_BUFFER_TIMESTAMP_IS_VALID(GST_BUFFER(item))) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    runningTime = gst_segment_to_running_time(channel->segment,
+                      GST_FORMAT_TIME, GST_BUFFER_TIMESTAMP(GST_BUFFER(item)));
+
+    return GST_CLOCK_TIME_IS_VALID(runningTime) ? runningTime :
+                                                  GST_CLOCK_TIME_NONE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_start
+ *     Create a channel's codec, input buffer and output pool for its current
+ *     caps, replacing any it had.  The engine is opened with the first codec.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_channel_start(GstTIMultiViddec2 *mvd,
+                    GstTIMultiViddec2Channel *channel)
+{
+    VIDDEC2_Params         params      = Vdec2_Params_DEFAULT;
+    VIDDEC2_DynamicParams  dynParams   = Vdec2_DynamicParams_DEFAULT;
+    Buffer_Attrs           bAttrs      = Buffer_Attrs_DEFAULT;
+    ColorSpace_Type        colorSpace;
+    Int                    defaultNumBufs;
+    const gchar           *codecName;
+    gint                   width;
+    gint                   height;
+
+    gst_timultividdec2_channel_stop(mvd, channel);
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    codecName            = channel->codecName;
+    width                = channel->width;
+    height               = channel->height;
+    channel->capsChanged = FALSE;
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    if (!codecName || !mvd->engineName) {
+        GST_ELEMENT_ERROR(mvd, CORE, NEGOTIATION,
+        ("channel %d received data before caps\n", channel->index), (NULL));
+        return FALSE;
+    }
+
+    /* Open the codec engine shared by all channels */
+    if (mvd->hEngine == NULL) {
+        GST_LOG("opening codec engine \"%s\"\n", mvd->engineName);
+        mvd->hEngine = gst_tiengine_open(mvd->engineName);
+
+        if (mvd->hEngine == NULL) {
+            GST_ELEMENT_ERROR(mvd, RESOURCE, FAILED,
+            ("failed to open codec engine \"%s\"\n", mvd->engineName),
+            (NULL));
+            return FALSE;
+        }
+    }
+
+    /* Choose the codec parameters and output format for this device */
+    if (!gst_timultividdec2_get_codec_params(mvd, &params, &colorSpace,
+            &defaultNumBufs)) {
+        return FALSE;
+    }
+
+    if (width > 0 && height > 0) {
+        params.maxWidth  = width;
+        params.maxHeight = height;
+    }
+
+    GST_LOG("channel %d: opening video decoder \"%s\" for %dx%d\n",
+        channel->index, codecName, (gint)params.maxWidth,
+        (gint)params.maxHeight);
+    channel->hVd = Vdec2_create(mvd->hEngine, (Char*)codecName, &params,
+                       &dynParams);
+
+    if (channel->hVd == NULL) {
+        GST_ELEMENT_ERROR(mvd, STREAM, CODEC_NOT_FOUND,
+        ("failed to create video decoder: %s\n", codecName), (NULL));
+        return FALSE;
+    }
+
+    /* Frames are copied into a contiguous input buffer for the codec */
+    bAttrs.memParams.align = 128;
+    channel->hInBuf = Buffer_create(Vdec2_getInBufSize(channel->hVd),
+                          &bAttrs);
+
+    if (channel->hInBuf == NULL) {
+        GST_ELEMENT_ERROR(mvd, RESOURCE, NO_SPACE_LEFT,
+        ("failed to create input buffer\n"), (NULL));
+        return FALSE;
+    }
+
+    channel->pool = gst_timultividdec2_get_pool(mvd,
+                        Vdec2_getOutBufSize(channel->hVd), params.maxWidth,
+                        params.maxHeight, colorSpace,
+                        mvd->numOutputBufs ? mvd->numOutputBufs :
+                                             defaultNumBufs);
+
+    if (channel->pool == NULL) {
+        GST_ELEMENT_ERROR(mvd, RESOURCE, NO_SPACE_LEFT,
+        ("failed to create output buffers\n"), (NULL));
+        return FALSE;
+    }
+
+    /* Tell the Vdec module what BufTab it will be using for its output */
+    Vdec2_setBufTab(channel->hVd, GST_TIDMAIBUFTAB_BUFTAB(
+        channel->pool->hBufTab));
+
+    channel->frameTimeStamps = g_hash_table_new_full(g_direct_hash,
+                                   g_direct_equal, NULL, g_free);
+    channel->heldBufs        = g_hash_table_new(g_direct_hash,
+                                   g_direct_equal);
+    channel->firstFrame      = TRUE;
+    channel->headerSent      = FALSE;
+    channel->totalDuration   = 0;
+    channel->capsWidth       = 0;
+    channel->capsHeight      = 0;
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_stop
+ *     Delete a channel's codec and give back the output buffers it held.
+ ******************************************************************************/
+static void gst_timultividdec2_channel_stop(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Channel *channel)
+{
+    if (channel->hVd) {
+        GST_LOG("channel %d: closing video decoder\n", channel->index);
+        Vdec2_delete(channel->hVd);
+        channel->hVd = NULL;
+    }
+
+    gst_timultividdec2_reclaim_held_bufs(channel);
+
+    if (channel->hInBuf) {
+        Buffer_delete(channel->hInBuf);
+        channel->hInBuf = NULL;
+    }
+
+    if (channel->pool) {
+        gst_timultividdec2_put_pool(mvd, channel->pool);
+        channel->pool = NULL;
+    }
+
+    if (channel->frameTimeStamps) {
+        g_hash_table_destroy(channel->frameTimeStamps);
+        channel->frameTimeStamps = NULL;
+    }
+
+    if (channel->heldBufs) {
+        g_hash_table_destroy(channel->heldBufs);
+        channel->heldBufs = NULL;
+    }
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_reset
+ *     Reset a channel's codec after a flush, so it no longer references
+ *     frames from before it.
+ ******************************************************************************/
+static void gst_timultividdec2_channel_reset(GstTIMultiViddec2Channel *channel)
+{
+    VIDDEC2_DynamicParams  dynParams = Vdec2_DynamicParams_DEFAULT;
+    VIDDEC2_Status         decStatus;
+
+    if (channel->hVd == NULL) {
+        return;
+    }
+
+    GST_LOG("channel %d: resetting video decoder\n", channel->index);
+
+    decStatus.size         = sizeof(VIDDEC2_Status);
+    decStatus.data.buf     = NULL;
+    decStatus.data.bufSize = 0;
+
+    if (VIDDEC2_control(Vdec2_getVisaHandle(channel->hVd), XDM_RESET,
+            &dynParams, &decStatus) != VIDDEC2_EOK) {
+        GST_WARNING("channel %d: failed to reset video decoder\n",
+            channel->index);
+    }
+
+    gst_timultividdec2_reclaim_held_bufs(channel);
+    g_hash_table_remove_all(channel->frameTimeStamps);
+    channel->headerSent = FALSE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_decode
+ *     Decode one frame into hDstBuf and push the frames the codec releases.
+ ******************************************************************************/
+static void gst_timultividdec2_channel_decode(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Channel *channel, GstBuffer *buf,
+                Buffer_Handle hDstBuf)
+{
+    GstClockTime  decodeStart;
+    GstClockTime  decodeTime;
+    Int8         *inPtr;
+    Int32         headerSize = 0;
+    Int32         frameSize;
+    Int           numCodecBufs;
+    Int           codecRet;
+
+    /* Put the frame, and the header from caps ahead of the first one, in
+     * the codec's input buffer.
+     */
+    if (channel->codecHeader && !channel->headerSent) {
+        headerSize = GST_BUFFER_SIZE(channel->codecHeader);
+    }
+    frameSize = headerSize + GST_BUFFER_SIZE(buf);
+
+    if (frameSize > Buffer_getSize(channel->hInBuf)) {
+        GST_WARNING("channel %d: dropping a %d byte frame larger than the "
+            "codec input buffer\n", channel->index, (gint)frameSize);
+        BufTab_freeBuf(hDstBuf);
+        pthread_mutex_lock(&mvd->channelMutex);
+        channel->framesDropped++;
+        pthread_mutex_unlock(&mvd->channelMutex);
+        gst_buffer_unref(buf);
+        return;
+    }
+
+    inPtr = Buffer_getUserPtr(channel->hInBuf);
+    if (headerSize) {
+        memcpy(inPtr, GST_BUFFER_DATA(channel->codecHeader), headerSize);
+    }
+    memcpy(inPtr + headerSize, GST_BUFFER_DATA(buf), GST_BUFFER_SIZE(buf));
+    Buffer_setNumBytesUsed(channel->hInBuf, frameSize);
+
+    /* Make sure the whole buffer is used for output */
+    BufferGfx_resetDimensions(hDstBuf);
+
+    /* Invoke the video decoder */
+    decodeStart = gst_util_get_timestamp();
+    codecRet    = Vdec2_process(channel->hVd, channel->hInBuf, hDstBuf);
+    decodeTime  = gst_util_get_timestamp() - decodeStart;
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    channel->decodeTime   += decodeTime;
+    channel->maxDecodeTime = MAX(channel->maxDecodeTime, decodeTime);
+    channel->bytesDecoded += frameSize;
+    if (codecRet < 0 || codecRet == Dmai_EBITERROR) {
+        channel->framesDropped++;
+    }
+    else {
+        channel->framesDecoded++;
+    }
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    /* In the case of errors, the codec may not return the buffer via the
+     * Vdec2_getFreeBuf API, so mark it as unused now.
+     */
+    if (codecRet < 0 || codecRet == Dmai_EBITERROR) {
+        GST_WARNING("channel %d: failed to decode frame (%d)\n",
+            channel->index, codecRet);
+        BufTab_freeBuf(hDstBuf);
+        gst_buffer_unref(buf);
+        return;
+    }
+
+    /* Remember the input timestamp of the frame, for when the codec releases
+     * this buffer for display.
+     */
+    g_hash_table_insert(channel->heldBufs, hDstBuf, hDstBuf);
+    if (GST_BUFFER_TIMESTAMP_IS_VALID(buf)) {
+        GstClockTime *timestamp = g_new(GstClockTime, 1);
+
+        *timestamp = GST_BUFFER_TIMESTAMP(buf);
+        g_hash_table_insert(channel->frameTimeStamps, hDstBuf, timestamp);
+    }
+    channel->headerSent = TRUE;
+    gst_buffer_unref(buf);
+
+    /* The codec may not know how many buffers it keeps before the first
+     * frame has been decoded.
+     */
+    if (channel->firstFrame) {
+        numCodecBufs = Vdec2_getMinOutBufs(channel->hVd);
+        if (numCodecBufs > 0) {
+            gst_timultividdec2_grow_pool(channel->pool, numCodecBufs);
+        }
+        channel->firstFrame = FALSE;
+    }
+
+    gst_timultividdec2_push_display_bufs(mvd, channel);
+    gst_timultividdec2_release_free_bufs(channel);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_drain
+ *     At end-of-stream, flush the frames left in the codec, then send the
+ *     EOS downstream and report the channel's statistics.
+ ******************************************************************************/
+static void gst_timultividdec2_channel_drain(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Channel *channel, GstEvent *event,
+                Buffer_Handle hDstBuf)
+{
+    Buffer_Attrs   bAttrs = Buffer_Attrs_DEFAULT;
+    Buffer_Handle  hDummyInputBuf;
+    GstStructure  *stats;
+
+    if (channel->hVd && hDstBuf) {
+        GST_LOG("channel %d: draining video decoder\n", channel->index);
+
+        Vdec2_flush(channel->hVd);
+
+        /* After a flush the codec ignores the input buffer, but since Codec
+         * Engine still address translates the buffer, it needs to exist.
+         */
+        hDummyInputBuf = Buffer_create(1, &bAttrs);
+        Buffer_setNumBytesUsed(hDummyInputBuf, 1);
+
+        BufferGfx_resetDimensions(hDstBuf);
+        if (Vdec2_process(channel->hVd, hDummyInputBuf, hDstBuf) < 0) {
+            BufTab_freeBuf(hDstBuf);
+        }
+        else {
+            g_hash_table_insert(channel->heldBufs, hDstBuf, hDstBuf);
+        }
+        Buffer_delete(hDummyInputBuf);
+
+        gst_timultividdec2_push_display_bufs(mvd, channel);
+        gst_timultividdec2_release_free_bufs(channel);
+
+        /* A flushed codec has to be reset before it decodes again, and
+         * resetting gives back the buffers it still holds to a shared pool.
+         */
+        gst_timultividdec2_channel_reset(channel);
+    }
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    stats = gst_timultividdec2_channel_stats(channel);
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    gst_element_post_message(GST_ELEMENT(mvd),
+        gst_message_new_element(GST_OBJECT(mvd), stats));
+
+    gst_pad_push_event(channel->srcpad, event);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_event
+ *     Forward a serialized event, keeping the segment used for deadline
+ *     scheduling.
+ ******************************************************************************/
+static void gst_timultividdec2_channel_event(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Channel *channel, GstEvent *event)
+{
+    gboolean  update;
+    gdouble   rate;
+    gdouble   appliedRate;
+    GstFormat format;
+    gint64    start;
+    gint64    stop;
+    gint64    position;
+
+    if (GST_EVENT_TYPE(event) == GST_EVENT_NEWSEGMENT) {
+        gst_event_parse_new_segment_full(event, &update, &rate,
+            &appliedRate, &format, &start, &stop, &position);
+
+        if (format == GST_FORMAT_TIME) {
+            pthread_mutex_lock(&mvd->channelMutex);
+            gst_segment_set_newsegment_full(channel->segment, update, rate,
+                appliedRate, format, start, stop, position);
+            pthread_mutex_unlock(&mvd->channelMutex);
+        }
+    }
+
+    gst_pad_push_event(channel->srcpad, event);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_push_display_bufs
+ *     Push every buffer the codec has released for display to the channel's
+ *     source pad.
+ ******************************************************************************/
+static void gst_timultividdec2_push_display_bufs(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Channel *channel)
+{
+    Buffer_Handle  hBuf;
+    GstBuffer     *outBuf;
+    GstClockTime  *timestamp;
+    GstClockTime   frameDuration;
+    GstFlowReturn  flow;
+
+    frameDuration = gst_timultividdec2_frame_duration(channel);
+
+    while ((hBuf = Vdec2_getDisplayBuf(channel->hVd))) {
+
+        /* Set the source pad capabilities based on the decoded frame.  A
+         * frame that can't be described downstream is given back to the
+         * pool instead of being pushed.
+         */
+        if (!gst_timultividdec2_set_source_caps(channel, hBuf)) {
+            GST_ELEMENT_ERROR(mvd, STREAM, FORMAT,
+            ("channel %d: failed to set source caps\n", channel->index),
+            (NULL));
+            g_hash_table_remove(channel->frameTimeStamps, hBuf);
+            gst_tidmaibuftab_free_use_mask(channel->pool->hBufTab, hBuf,
+                gst_tidmaibuffer_GST_FREE | gst_tidmaibuffer_VIDEOSINK_FREE);
+
+            pthread_mutex_lock(&mvd->channelMutex);
+            channel->lastFlow = GST_FLOW_NOT_NEGOTIATED;
+            pthread_mutex_unlock(&mvd->channelMutex);
+            continue;
+        }
+
+        outBuf = gst_tidmaibuffertransport_new(hBuf, channel->pool->hBufTab);
+        gst_buffer_set_data(outBuf, GST_BUFFER_DATA(outBuf),
+            gst_ti_correct_display_bufSize(hBuf));
+        gst_buffer_set_caps(outBuf, GST_PAD_CAPS(channel->srcpad));
+
+        /* Use the upstream timestamp of the frame if there was one, and
+         * synthesize timestamps from there otherwise.
+         */
+        timestamp = g_hash_table_lookup(channel->frameTimeStamps, hBuf);
+
+        if (mvd->genTimeStamps) {
+            if (timestamp) {
+                channel->totalDuration = *timestamp;
+            }
+            GST_BUFFER_TIMESTAMP(outBuf) = channel->totalDuration;
+            GST_BUFFER_DURATION(outBuf)  = frameDuration;
+            channel->totalDuration      += frameDuration;
+        }
+        else {
+            GST_BUFFER_TIMESTAMP(outBuf) = GST_CLOCK_TIME_NONE;
+        }
+        g_hash_table_remove(channel->frameTimeStamps, hBuf);
+
+        /* Downstream refuses buffers while a seek is flushing; that is not
+         * a failure of the channel.
+         */
+        flow = gst_pad_push(channel->srcpad, outBuf);
+
+        if (flow != GST_FLOW_OK && flow != GST_FLOW_WRONG_STATE) {
+            GST_DEBUG("channel %d: push to source pad failed\n",
+                channel->index);
+            pthread_mutex_lock(&mvd->channelMutex);
+            channel->lastFlow = flow;
+            pthread_mutex_unlock(&mvd->channelMutex);
+        }
+    }
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_release_free_bufs
+ *     Give back the buffers the codec no longer uses as references.
+ ******************************************************************************/
+static void gst_timultividdec2_release_free_bufs(
+                GstTIMultiViddec2Channel *channel)
+{
+    Buffer_Handle hFreeBuf;
+
+    while ((hFreeBuf = Vdec2_getFreeBuf(channel->hVd))) {
+        gst_tidmaibuftab_free_use_mask(channel->pool->hBufTab, hFreeBuf,
+            gst_tidmaibuffer_CODEC_FREE);
+        g_hash_table_remove(channel->heldBufs, hFreeBuf);
+    }
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_reclaim_held_bufs
+ *     Take back every buffer given to the codec that it hasn't released.
+ *     Only this channel's buffers are touched, as the pool may be shared.
+ ******************************************************************************/
+static void gst_timultividdec2_reclaim_held_bufs(
+                GstTIMultiViddec2Channel *channel)
+{
+    GHashTableIter iter;
+    gpointer       hBuf;
+
+    if (channel->heldBufs == NULL) {
+        return;
+    }
+
+    g_hash_table_iter_init(&iter, channel->heldBufs);
+    while (g_hash_table_iter_next(&iter, &hBuf, NULL)) {
+        gst_tidmaibuftab_free_use_mask(channel->pool->hBufTab,
+            (Buffer_Handle)hBuf, gst_tidmaibuffer_CODEC_FREE);
+    }
+    g_hash_table_remove_all(channel->heldBufs);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_set_source_caps
+ *     Set the caps of a channel's source pad from a decoded frame, if its
+ *     size changed.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_set_source_caps(
+                    GstTIMultiViddec2Channel *channel, Buffer_Handle hBuf)
+{
+    BufferGfx_Dimensions  dim;
+    BufferGfx_Attrs       gfxAttrs = BufferGfx_Attrs_DEFAULT;
+    GstCaps              *caps;
+    guint32               fourcc;
+    gboolean              ret;
+    gchar                *string;
+
+    BufferGfx_getDimensions(hBuf, &dim);
+
+    if (dim.width == channel->capsWidth && dim.height == channel->capsHeight) {
+        return TRUE;
+    }
+
+    /* Retrieve the graphics attribute so we know the colorspace */
+    Buffer_getAttrs(hBuf, BufferGfx_getBufferAttrs(&gfxAttrs));
+
+    switch (gfxAttrs.colorSpace) {
+        case ColorSpace_UYVY:
+            fourcc = GST_MAKE_FOURCC('U','Y','V','Y');
+            break;
+        case ColorSpace_YUV420PSEMI:
+            fourcc = GST_MAKE_FOURCC('N','V','1','2');
+            break;
+        case ColorSpace_YUV420P:
+            fourcc = GST_MAKE_FOURCC('I','4','2','0');
+            break;
+        default:
+            GST_ERROR("unsupported colorspace\n");
+            return FALSE;
+    }
+
+    gst_timultividdec2_frame_duration(channel);
+
+    caps =
+        gst_caps_new_simple("video/x-raw-yuv",
+            "format",    GST_TYPE_FOURCC,   fourcc,
+            "framerate", GST_TYPE_FRACTION,
+                gst_value_get_fraction_numerator(&channel->framerate),
+                gst_value_get_fraction_denominator(&channel->framerate),
+            "width",     G_TYPE_INT,        (gint)dim.width,
+            "height",    G_TYPE_INT,        (gint)dim.height,
+            NULL);
+
+    string = gst_caps_to_string(caps);
+    GST_LOG("channel %d: setting source caps to: %s", channel->index, string);
+    g_free(string);
+
+    ret = gst_pad_set_caps(channel->srcpad, caps);
+    gst_caps_unref(caps);
+
+    if (ret) {
+        channel->capsWidth  = dim.width;
+        channel->capsHeight = dim.height;
+    }
+
+    return ret;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_get_pool
+ *     Return an output pool for a codec.  With sharePools set, a channel
+ *     joins the pool of another channel decoding the same picture size and
+ *     adds its own buffers to it.  Only called from the decode thread.
+ ******************************************************************************/
+static GstTIMultiViddec2Pool* gst_timultividdec2_get_pool(
+                                  GstTIMultiViddec2 *mvd, Int32 bufSize,
+                                  Int32 width, Int32 height,
+                                  ColorSpace_Type colorSpace, Int numBufs)
+{
+    GstTIMultiViddec2Pool *pool;
+    BufferGfx_Attrs        gfxAttrs = BufferGfx_Attrs_DEFAULT;
+    GList                 *item;
+
+    if (mvd->sharePools) {
+        for (item = mvd->pools; item; item = g_list_next(item)) {
+            pool = item->data;
+
+            if (pool->bufSize == bufSize && pool->width == width &&
+                pool->height == height && pool->colorSpace == colorSpace) {
+                gst_timultividdec2_grow_pool(pool, numBufs);
+                pool->numUsers++;
+
+                GST_INFO("sharing a %dx%d output pool between %d channels\n",
+                    (gint)width, (gint)height, pool->numUsers);
+                return pool;
+            }
+        }
+    }
+
+    GST_LOG("creating output buffer table\n");
+    gfxAttrs.colorSpace     = colorSpace;
+    gfxAttrs.dim.width      = width;
+    gfxAttrs.dim.height     = height;
+    gfxAttrs.dim.lineLength = BufferGfx_calcLineLength(gfxAttrs.dim.width,
+                                  gfxAttrs.colorSpace);
+
+    /* By default, new buffers are marked as in-use by the codec */
+    gfxAttrs.bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
+
+    pool = g_new0(GstTIMultiViddec2Pool, 1);
+    pool->hBufTab = gst_tidmaibuftab_new(numBufs, bufSize,
+                        BufferGfx_getBufferAttrs(&gfxAttrs));
+    gst_tidmaibuftab_set_name(pool->hBufTab, GST_ELEMENT_NAME(mvd));
+
+    if (pool->hBufTab == NULL) {
+        g_free(pool);
+        return NULL;
+    }
+
+    /* The decode thread serves other channels instead of blocking, and is
+     * woken when a buffer comes back.
+     */
+    gst_tidmaibuftab_set_blocking(pool->hBufTab, FALSE);
+    gst_tidmaibuftab_set_release_event(pool->hBufTab, &mvd->workEvent);
+
+    pool->bufSize    = bufSize;
+    pool->width      = width;
+    pool->height     = height;
+    pool->colorSpace = colorSpace;
+    pool->numUsers   = 1;
+
+    mvd->pools = g_list_prepend(mvd->pools, pool);
+    return pool;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_put_pool
+ *     Drop a channel's use of an output pool.  Buffers still downstream keep
+ *     the BufTab alive, but they no longer wake the decode thread.
+ ******************************************************************************/
+static void gst_timultividdec2_put_pool(GstTIMultiViddec2 *mvd,
+                GstTIMultiViddec2Pool *pool)
+{
+    if (--pool->numUsers > 0) {
+        return;
+    }
+
+    mvd->pools = g_list_remove(mvd->pools, pool);
+    gst_tidmaibuftab_set_release_event(pool->hBufTab, NULL);
+    gst_tidmaibuftab_unref(pool->hBufTab);
+    g_free(pool);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_grow_pool
+ *     Add buffers to an output pool.  Transport buffers may be giving
+ *     buffers back at the same time, so hold the BufTab's mutex.
+ ******************************************************************************/
+static void gst_timultividdec2_grow_pool(GstTIMultiViddec2Pool *pool,
+                Int numBufs)
+{
+    pthread_mutex_lock(GST_TIDMAIBUFTAB_GETBUF_MUTEX(pool->hBufTab));
+
+    if (BufTab_expand(GST_TIDMAIBUFTAB_BUFTAB(pool->hBufTab), numBufs) < 0) {
+        GST_WARNING("failed to expand BufTab with %d buffers\n", numBufs);
+    }
+
+    pthread_mutex_unlock(GST_TIDMAIBUFTAB_GETBUF_MUTEX(pool->hBufTab));
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_get_codec_params
+ *     Set the codec parameters and output format for this device, as
+ *     TIViddec2 does.
+ ******************************************************************************/
+static gboolean gst_timultividdec2_get_codec_params(GstTIMultiViddec2 *mvd,
+                    VIDDEC2_Params *params, ColorSpace_Type *colorSpace,
+                    Int *defaultNumBufs)
+{
+    Cpu_Device device;
+
+    /* Determine which device the application is running on */
+    if (Cpu_getDevice(NULL, &device) < 0) {
+        GST_ELEMENT_ERROR(mvd, RESOURCE, FAILED,
+        ("Failed to determine target board\n"), (NULL));
+        return FALSE;
+    }
+
+    /* Set up codec parameters depending on device */
+    switch(device) {
+        case Cpu_Device_DM6467:
+            #if defined(Platform_dm6467t)
+            params->forceChromaFormat = XDM_YUV_420SP;
+            params->maxFrameRate      = 60000;
+            params->maxBitRate        = 30000000;
+            #else
+            params->forceChromaFormat = XDM_YUV_420P;
+            #endif
+            params->maxWidth          = VideoStd_1080I_WIDTH;
+            params->maxHeight         = VideoStd_1080I_HEIGHT + 8;
+            *colorSpace               = ColorSpace_YUV420PSEMI;
+            *defaultNumBufs           = 5;
+            break;
+        #if defined(Platform_dm365)
+        case Cpu_Device_DM365:
+            params->forceChromaFormat = XDM_YUV_420SP;
+            params->maxWidth          = VideoStd_720P_WIDTH;
+            params->maxHeight         = VideoStd_720P_HEIGHT;
+            *colorSpace               = ColorSpace_YUV420PSEMI;
+            *defaultNumBufs           = 4;
+            break;
+        #endif
+        #if defined(Platform_dm368)
+        case Cpu_Device_DM368:
+            params->forceChromaFormat = XDM_YUV_420SP;
+            params->maxWidth          = VideoStd_720P_WIDTH;
+            params->maxHeight         = VideoStd_720P_HEIGHT;
+            *colorSpace               = ColorSpace_YUV420PSEMI;
+            *defaultNumBufs           = 4;
+            break;
+        #endif
+        #if defined(Platform_omapl138)
+        case Cpu_Device_OMAPL138:
+            params->forceChromaFormat = XDM_YUV_420P;
+            params->maxWidth          = VideoStd_D1_WIDTH;
+            params->maxHeight         = VideoStd_D1_PAL_HEIGHT;
+            *colorSpace               = ColorSpace_YUV420P;
+            *defaultNumBufs           = 3;
+            break;
+        #endif
+        #if defined(Platform_dm3730)
+        case Cpu_Device_DM3730:
+            params->maxWidth          = VideoStd_720P_WIDTH;
+            params->maxHeight         = VideoStd_720P_HEIGHT;
+            params->forceChromaFormat = XDM_YUV_422ILE;
+            *colorSpace               = ColorSpace_UYVY;
+            *defaultNumBufs           = 3;
+            break;
+        #endif
+        default:
+            params->forceChromaFormat = XDM_YUV_422ILE;
+            params->maxWidth          = VideoStd_D1_WIDTH;
+            params->maxHeight         = VideoStd_D1_PAL_HEIGHT;
+            *colorSpace               = ColorSpace_UYVY;
+            *defaultNumBufs           = 3;
+            break;
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_frame_duration
+ *    Return the duration of a single frame of a channel in nanoseconds.
+ ******************************************************************************/
+static GstClockTime gst_timultividdec2_frame_duration(
+                        GstTIMultiViddec2Channel *channel)
+{
+    /* Default to 29.97 if the frame rate was not specified */
+    if (gst_value_get_fraction_numerator(&channel->framerate) == 0) {
+        GST_WARNING("channel %d: framerate not specified; using 29.97fps",
+            channel->index);
+        gst_value_set_fraction(&channel->framerate, 30000, 1001);
+    }
+
+    return
+     ((GstClockTime) gst_value_get_fraction_denominator(&channel->framerate)) *
+     GST_SECOND /
+     ((GstClockTime) gst_value_get_fraction_numerator(&channel->framerate));
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_stats
+ *     Return a "channel-stats" structure for a channel.  Called with
+ *     channelMutex held.
+ ******************************************************************************/
+static GstStructure* gst_timultividdec2_channel_stats(
+                         GstTIMultiViddec2Channel *channel)
+{
+    return gst_structure_new("channel-stats",
+               "channel",         G_TYPE_INT,    channel->index,
+               "frames-decoded",  G_TYPE_UINT64, channel->framesDecoded,
+               "frames-dropped",  G_TYPE_UINT64, channel->framesDropped,
+               "bytes-decoded",   G_TYPE_UINT64, channel->bytesDecoded,
+               "decode-time",     G_TYPE_UINT64, channel->decodeTime,
+               "max-decode-time", G_TYPE_UINT64, channel->maxDecodeTime,
+               "queue-waits",     G_TYPE_UINT64, channel->queueWaits,
+               "output-waits",    G_TYPE_UINT64, channel->outputWaits,
+               "queued",          G_TYPE_UINT,   channel->queuedBufs,
+               NULL);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_all_stats
+ *     Return the statistics of every channel as one string.
+ ******************************************************************************/
+static gchar* gst_timultividdec2_all_stats(GstTIMultiViddec2 *mvd)
+{
+    GstStructure *stats;
+    GString      *string = g_string_new(NULL);
+    GList        *item;
+    gchar        *channelString;
+
+    pthread_mutex_lock(&mvd->channelMutex);
+    for (item = mvd->channels; item; item = g_list_next(item)) {
+        stats         = gst_timultividdec2_channel_stats(item->data);
+        channelString = gst_structure_to_string(stats);
+
+        if (string->len) {
+            g_string_append(string, "; ");
+        }
+        g_string_append(string, channelString);
+
+        g_free(channelString);
+        gst_structure_free(stats);
+    }
+    pthread_mutex_unlock(&mvd->channelMutex);
+
+    return g_string_free(string, FALSE);
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_flush_queue
+ *     Drop the items queued on a channel.  Called with channelMutex held.
+ ******************************************************************************/
+static void gst_timultividdec2_flush_queue(GstTIMultiViddec2Channel *channel)
+{
+    GstMiniObject *item;
+
+    while ((item = g_queue_pop_head(channel->queue))) {
+        gst_mini_object_unref(item);
+    }
+    channel->queuedBufs = 0;
+}
+
+
+/******************************************************************************
+ * gst_timultividdec2_channel_free
+ *     Free a channel whose codec has been deleted.
+ ******************************************************************************/
+static void gst_timultividdec2_channel_free(GstTIMultiViddec2Channel *channel)
+{
+    gst_timultividdec2_flush_queue(channel);
+    g_queue_free(channel->queue);
+    gst_segment_free(channel->segment);
+    g_value_unset(&channel->framerate);
+
+    if (channel->codecHeader) {
+        gst_buffer_unref(channel->codecHeader);
+    }
+
+    g_free(channel);
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
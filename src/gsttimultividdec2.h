@@ -0,0 +1,185 @@
+/*
+ * gsttimultividdec2.h
+ *
+ * This file declares the "TIMultiViddec2" element, which decodes several
+ * xDM 1.2 video streams with one Codec Engine handle and one decode thread.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TIMULTIVIDDEC2_H__
+#define __GST_TIMULTIVIDDEC2_H__
+
+#include <pthread.h>
+
+#include <gst/gst.h>
+#include "gsttidmaibuftab.h"
+#include "gsttieventcount.h"
+
+#include <xdc/std.h>
+#include <ti/sdo/ce/Engine.h>
+
+#include <ti/sdo/dmai/Dmai.h>
+#include <ti/sdo/dmai/Buffer.h>
+#include <ti/sdo/dmai/BufTab.h>
+#include <ti/sdo/dmai/ColorSpace.h>
+#include <ti/sdo/dmai/ce/Vdec2.h>
+
+G_BEGIN_DECLS
+
+/* Standard macros for maniuplating TIMultiViddec2 objects */
+#define GST_TYPE_TIMULTIVIDDEC2 \
+  (gst_timultividdec2_get_type())
+#define GST_TIMULTIVIDDEC2(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_TIMULTIVIDDEC2, \
+  GstTIMultiViddec2))
+#define GST_TIMULTIVIDDEC2_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_TIMULTIVIDDEC2, \
+  GstTIMultiViddec2Class))
+#define GST_IS_TIMULTIVIDDEC2(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_TIMULTIVIDDEC2))
+#define GST_IS_TIMULTIVIDDEC2_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_TIMULTIVIDDEC2))
+
+typedef struct _GstTIMultiViddec2        GstTIMultiViddec2;
+typedef struct _GstTIMultiViddec2Class   GstTIMultiViddec2Class;
+typedef struct _GstTIMultiViddec2Channel GstTIMultiViddec2Channel;
+typedef struct _GstTIMultiViddec2Pool    GstTIMultiViddec2Pool;
+
+/* Values of the schedule property */
+#define GST_TIMULTIVIDDEC2_SCHEDULE_ROUND_ROBIN 0 /* take turns             */
+#define GST_TIMULTIVIDDEC2_SCHEDULE_DEADLINE    1 /* earliest running time  */
+
+/* An output BufTab, shared by the channels decoding the same picture size
+ * when sharePools is set.  Only the decode thread uses this.
+ */
+struct _GstTIMultiViddec2Pool
+{
+  GstTIDmaiBufTab *hBufTab;
+  Int32            bufSize;
+  Int32            width;
+  Int32            height;
+  ColorSpace_Type  colorSpace;
+  gint             numUsers;
+};
+
+/* One input stream, with its own sink and source pads and codec instance */
+struct _GstTIMultiViddec2Channel
+{
+  gint             index;
+  GstPad          *sinkpad;
+  GstPad          *srcpad;
+
+  /* Stream description, set by set_sink_caps */
+  const gchar     *codecName;
+  gint             width;
+  gint             height;
+  GValue           framerate;
+  GstBuffer       *codecHeader;
+  gboolean         capsChanged;
+
+  /* Input queue of buffers and serialized events, protected by
+   * channelMutex.
+   */
+  GQueue          *queue;
+  guint            queuedBufs;
+  gboolean         flushing;
+  gboolean         needReset;
+  gboolean         releasing;
+  gboolean         eos;
+  GstFlowReturn    lastFlow;
+  GstSegment      *segment;
+  gboolean         skip;          /* no free output buffer this round */
+
+  /* Codec state, only used by the decode thread */
+  Vdec2_Handle     hVd;
+  Buffer_Handle    hInBuf;
+  GstTIMultiViddec2Pool *pool;
+  GHashTable      *frameTimeStamps;
+  GHashTable      *heldBufs;
+  gboolean         firstFrame;
+  gboolean         headerSent;
+  GstClockTime     totalDuration;
+  gint             capsWidth;
+  gint             capsHeight;
+
+  /* Statistics, read with channelMutex held */
+  guint64          framesDecoded;
+  guint64          framesDropped;
+  guint64          bytesDecoded;
+  GstClockTime     decodeTime;
+  GstClockTime     maxDecodeTime;
+  guint64          queueWaits;
+  guint64          outputWaits;
+};
+
+/* _GstTIMultiViddec2 object */
+struct _GstTIMultiViddec2
+{
+  /* gStreamer infrastructure */
+  GstElement     element;
+
+  /* Element properties */
+  const gchar*   engineName;
+  gboolean       autoEngine;     /* engineName taken from the first codec */
+  const gchar*   codecName;
+  gint           numOutputBufs;
+  gint           schedule;
+  gboolean       sharePools;
+  gint           queueLength;
+  gboolean       genTimeStamps;
+  gboolean       rtCodecThread;
+
+  /* Channels, protected by channelMutex */
+  pthread_mutex_t  channelMutex;
+  GList           *channels;
+  gint             nextChannel;
+  GstTIMultiViddec2Channel *lastServed;
+
+  /* Decode thread */
+  pthread_t        decodeThread;
+  gboolean         threadRunning;
+  gboolean         threadStop;
+  GstTIEventCount  workEvent;     /* input, released buffers, stop     */
+  GstTIEventCount  spaceEvent;    /* queue space, channel torn down    */
+
+  /* Decode thread state */
+  Engine_Handle    hEngine;
+  GList           *pools;
+  GstClockTime     busyTime;
+  GstClockTime     threadStartTime;
+};
+
+/* _GstTIMultiViddec2Class object */
+struct _GstTIMultiViddec2Class
+{
+  GstElementClass parent_class;
+};
+
+/* External function declarations */
+GType gst_timultividdec2_get_type(void);
+
+G_END_DECLS
+
+#endif /* __GST_TIMULTIVIDDEC2_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -56,10 +56,16 @@ enum {
   PROP_0,
   PROP_CONTIG_INPUT_FRAME,  /*  contiguousInputFrame (boolean) */
   PROP_NUM_OUTPUT_BUFS,     /*  numOutputBufs        (gint)    */
+  PROP_MAX_OUTPUT_BUFS,     /*  maxOutputBufs        (gint)    */
+  PROP_BUF_IDLE_TIMEOUT,    /*  bufIdleTimeout       (gint)    */
+  PROP_CURRENT_OUTPUT_BUFS, /*  currentOutputBufs    (gint)    */
+  PROP_PEAK_OUTPUT_BUFS,    /*  peakOutputBufs       (gint)    */
+  PROP_BLOCKED_WAITS,       /*  blockedWaits         (guint)   */
 };
 
 /* Define property default */
 #define DEFAULT_NUM_OUTPUT_BUFS         2
+#define DEFAULT_BUF_IDLE_TIMEOUT        2000
 #define DEFAULT_CONTIGUOUS_INPUT_FRAME  FALSE
 #define gst_tiprepencbuf_invalid_device Cpu_Device_COUNT
 
@@ -104,6 +110,9 @@ static GstFlowReturn
 static void
   gst_tiprepencbuf_set_property(GObject *object, guint prop_id,
     const GValue *value, GParamSpec *pspec);
+static void
+  gst_tiprepencbuf_get_property(GObject *object, guint prop_id,
+    GValue *value, GParamSpec *pspec);
 static gboolean
   gst_tiprepencbuf_transform_size (GstBaseTransform *trans,
     GstPadDirection direction, GstCaps *caps, guint size, GstCaps *othercaps,
@@ -133,6 +142,8 @@ static gboolean
     GstCaps *out);
 static gboolean
   gst_tiprepencbuf_exit(GstTIPrepEncBuf *prepencbuf);
+static gboolean
+  gst_tiprepencbuf_alloc_outbufs(GstTIPrepEncBuf *prepencbuf);
 
 /******************************************************************************
  * gst_tiprepencbuf_get_type
@@ -178,6 +189,8 @@ static void gst_tiprepencbuf_init(GstTIPrepEncBuf * prepencbuf)
 
     prepencbuf->contiguousInputFrame = DEFAULT_CONTIGUOUS_INPUT_FRAME;
     prepencbuf->numOutputBufs        = DEFAULT_NUM_OUTPUT_BUFS;
+    prepencbuf->maxOutputBufs        = 0;
+    prepencbuf->bufIdleTimeout       = DEFAULT_BUF_IDLE_TIMEOUT;
     prepencbuf->hFc                  = NULL;
 
     /* Determine target board type */
@@ -227,6 +240,7 @@ static void gst_tiprepencbuf_class_init(GstTIPrepEncBufClass * klass)
     trans_class   = (GstBaseTransformClass *) klass;
 
     gobject_class->set_property = gst_tiprepencbuf_set_property;
+    gobject_class->get_property = gst_tiprepencbuf_get_property;
     gobject_class->finalize     = (GObjectFinalizeFunc) gst_tiprepencbuf_exit;
 
     trans_class->passthrough_on_same_caps = FALSE;
@@ -252,6 +266,39 @@ static void gst_tiprepencbuf_class_init(GstTIPrepEncBufClass * klass)
             "Number of output buffers to allocate", 1, G_MAXINT32,
             DEFAULT_NUM_OUTPUT_BUFS, G_PARAM_WRITABLE));
 
+    g_object_class_install_property(gobject_class, PROP_MAX_OUTPUT_BUFS,
+        g_param_spec_int("maxOutputBufs",
+            "Maximum number of output buffers",
+            "Create more output buffers, up to this number, rather than "
+            "wait when downstream holds all of them.  0 keeps numOutputBufs",
+            0, G_MAXINT32, 0, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_BUF_IDLE_TIMEOUT,
+        g_param_spec_int("bufIdleTimeout",
+            "Output buffer idle timeout",
+            "Milliseconds an output buffer beyond numOutputBufs may stay "
+            "unused before it is freed (0 = never)",
+            0, G_MAXINT32, DEFAULT_BUF_IDLE_TIMEOUT, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_CURRENT_OUTPUT_BUFS,
+        g_param_spec_int("currentOutputBufs",
+            "Current number of output buffers",
+            "Number of output buffers allocated now",
+            0, G_MAXINT32, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_PEAK_OUTPUT_BUFS,
+        g_param_spec_int("peakOutputBufs",
+            "Peak number of output buffers",
+            "Largest number of output buffers allocated at once",
+            0, G_MAXINT32, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_BLOCKED_WAITS,
+        g_param_spec_uint("blockedWaits",
+            "Blocked waits",
+            "Number of times the element waited for downstream to release "
+            "an output buffer",
+            0, G_MAXUINT32, 0, G_PARAM_READABLE));
+
     GST_LOG("initialized class init\n");
 }
 
@@ -268,6 +315,22 @@ gst_tiprepencbuf_prepare_output_buffer(GstBaseTransform * trans,
 
     GST_LOG("begin prepare output buffer\n");
 
+    /* A physically contiguous DMAI buffer that needs no color conversion is
+     * passed directly to the codec, so it doesn't take one of our buffers.
+     */
+    if (GST_IS_TIDMAIBUFFERTRANSPORT(inBuf) &&
+        prepencbuf->srcColorSpace == prepencbuf->dstColorSpace) {
+        GST_LOG("passing DMAI input buffer through\n");
+        *outBuf = gst_buffer_ref(inBuf);
+        return GST_FLOW_OK;
+    }
+
+    /* Our own buffers are only needed once we have to copy the input */
+    if (prepencbuf->hOutBufTab == NULL &&
+        !gst_tiprepencbuf_alloc_outbufs(prepencbuf)) {
+        return GST_FLOW_ERROR;
+    }
+
     /* Get free buffer from buftab */
     if (!(hOutBuf = gst_tidmaibuftab_get_buf(prepencbuf->hOutBufTab))) {
         GST_ELEMENT_ERROR(prepencbuf, RESOURCE, READ,
@@ -314,6 +377,16 @@ gst_tiprepencbuf_set_property(GObject * object, guint prop_id,
             GST_LOG("setting \"numOutputBufs\" to \"%d\"\n",
                 prepencbuf->numOutputBufs);
             break;
+        case PROP_MAX_OUTPUT_BUFS:
+            prepencbuf->maxOutputBufs = g_value_get_int(value);
+            GST_LOG("setting \"maxOutputBufs\" to \"%d\"\n",
+                prepencbuf->maxOutputBufs);
+            break;
+        case PROP_BUF_IDLE_TIMEOUT:
+            prepencbuf->bufIdleTimeout = g_value_get_int(value);
+            GST_LOG("setting \"bufIdleTimeout\" to \"%d\"\n",
+                prepencbuf->bufIdleTimeout);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -321,6 +394,43 @@ gst_tiprepencbuf_set_property(GObject * object, guint prop_id,
 
     GST_LOG("end set_property\n");
 }
+
+/******************************************************************************
+ * gst_tiprepencbuf_get_property
+ *     Return values for requested element property.
+ ******************************************************************************/
+static void gst_tiprepencbuf_get_property(GObject *object, guint prop_id,
+                GValue *value, GParamSpec *pspec)
+{
+    GstTIPrepEncBuf *prepencbuf = GST_TIPREPENCBUF(object);
+    gint  numBufs    = 0;
+    gint  peakBufs   = 0;
+    guint numBlocked = 0;
+
+    GST_LOG("begin get_property\n");
+
+    if (prepencbuf->hOutBufTab) {
+        gst_tidmaibuftab_get_stats(prepencbuf->hOutBufTab, &numBufs, &peakBufs,
+            &numBlocked);
+    }
+
+    switch (prop_id) {
+        case PROP_CURRENT_OUTPUT_BUFS:
+            g_value_set_int(value, numBufs);
+            break;
+        case PROP_PEAK_OUTPUT_BUFS:
+            g_value_set_int(value, peakBufs);
+            break;
+        case PROP_BLOCKED_WAITS:
+            g_value_set_uint(value, numBlocked);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+
+    GST_LOG("end get_property\n");
+}
        
 /******************************************************************************
  * gst_tiprepencbuf_transform_size
@@ -554,11 +664,10 @@ gst_tiprepencbuf_transform(GstBaseTransform * trans, GstBuffer * src,
     GstTIPrepEncBuf *prepencbuf = GST_TIPREPENCBUF(trans);
 
     /* If the input buffer is a physically contiguous DMAI buffer, it can
-     * be passed directly to the codec.
+     * be passed directly to the codec; prepare_output_buffer gave it back
+     * as the output buffer.
      */
-    if (GST_IS_TIDMAIBUFFERTRANSPORT(src)) {
-        gst_buffer_unref(dst);
-        dst = gst_buffer_ref(src);
+    if (dst == src) {
         return GST_FLOW_OK;
     }
 
@@ -674,10 +783,8 @@ gst_tiprepencbuf_set_caps(GstBaseTransform * trans, GstCaps * in,
     GstCaps * out)
 {
     GstTIPrepEncBuf *prepencbuf = GST_TIPREPENCBUF(trans);
-    BufferGfx_Attrs  gfxAttrs   = BufferGfx_Attrs_DEFAULT;
     gboolean         ret        = FALSE;
     guint32          fourcc;
-    guint            outBufSize;
 
     GST_LOG("begin set caps\n");
 
@@ -708,9 +815,32 @@ gst_tiprepencbuf_set_caps(GstBaseTransform * trans, GstCaps * in,
     prepencbuf->dstColorSpace = gst_tiprepencbuf_get_colorSpace(fourcc);
 
     /* calculate output buffer size */
-    outBufSize = gst_ti_calc_buffer_size(prepencbuf->dstWidth,
+    prepencbuf->outBufSize = gst_ti_calc_buffer_size(prepencbuf->dstWidth,
                      prepencbuf->dstHeight, 0, prepencbuf->dstColorSpace);
 
+    /* Output buffers are allocated with the first input that has to be
+     * copied.  Drop those of the previous caps.
+     */
+    if (prepencbuf->hOutBufTab) {
+        gst_tidmaibuftab_unref(prepencbuf->hOutBufTab);
+        prepencbuf->hOutBufTab = NULL;
+    }
+
+    ret = TRUE;
+
+exit:
+    GST_LOG("end set caps\n");
+    return ret;
+}
+
+/******************************************************************************
+ * gst_tiprepencbuf_alloc_outbufs
+ *    Create the table of buffers non-DMAI input is copied into.
+ *****************************************************************************/
+static gboolean gst_tiprepencbuf_alloc_outbufs(GstTIPrepEncBuf * prepencbuf)
+{
+    BufferGfx_Attrs gfxAttrs = BufferGfx_Attrs_DEFAULT;
+
     /* allocate output buffer */
     gfxAttrs.bAttrs.useMask = gst_tidmaibuffer_GST_FREE;
     gfxAttrs.colorSpace     = prepencbuf->dstColorSpace;
@@ -724,19 +854,24 @@ gst_tiprepencbuf_set_caps(GstBaseTransform * trans, GstCaps * in,
     }
 
     prepencbuf->hOutBufTab = gst_tidmaibuftab_new(prepencbuf->numOutputBufs,
-        outBufSize, BufferGfx_getBufferAttrs (&gfxAttrs));
+        prepencbuf->outBufSize, BufferGfx_getBufferAttrs (&gfxAttrs));
+    gst_tidmaibuftab_set_name(prepencbuf->hOutBufTab,
+        GST_ELEMENT_NAME(prepencbuf));
 
     if (prepencbuf->hOutBufTab == NULL) {
         GST_ELEMENT_ERROR(prepencbuf, RESOURCE, NO_SPACE_LEFT,
             ("failed to create output bufTab\n"), (NULL));
-        goto exit;
+        return FALSE;
     }
 
-    ret = TRUE;
+    /* Let the output buffers grow with downstream demand if asked to */
+    if (prepencbuf->maxOutputBufs > prepencbuf->numOutputBufs) {
+        gst_tidmaibuftab_set_elastic(prepencbuf->hOutBufTab,
+            prepencbuf->maxOutputBufs, prepencbuf->bufIdleTimeout ?
+            prepencbuf->bufIdleTimeout * GST_MSECOND : GST_CLOCK_TIME_NONE);
+    }
 
-exit:
-    GST_LOG("end set caps\n");
-    return ret;
+    return TRUE;
 }
 
 /******************************************************************************
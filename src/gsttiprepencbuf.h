@@ -67,6 +67,8 @@ struct _GstTIPrepEncBuf
   /* Element property */
   gboolean          contiguousInputFrame;
   gint              numOutputBufs;
+  gint              maxOutputBufs;
+  gint              bufIdleTimeout;
 
   /* Element state */
   gint              srcWidth;
@@ -77,7 +79,8 @@ struct _GstTIPrepEncBuf
   ColorSpace_Type   dstColorSpace;
   Framecopy_Handle  hFc;
   Ccv_Handle        hCcv;
-  GstTIDmaiBufTab  *hOutBufTab;
+  GstTIDmaiBufTab  *hOutBufTab;     /* only created for non-DMAI input */
+  guint             outBufSize;
   Cpu_Device        device;
 };
 
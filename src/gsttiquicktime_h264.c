@@ -33,6 +33,7 @@
 #include <ti/sdo/dmai/Fifo.h>
 
 #include "gsttiquicktime_h264.h"
+#include "gsttibitstream.h"
 #include "gstticodecs.h"
 
 /* NAL start code length (in byte) */
@@ -41,9 +42,19 @@
 /* NAL start code */
 static unsigned int NAL_START_CODE=0x1000000;
 
+/* Number of pieces gathered before queueing them into the circular buffer */
+#define MAX_QUEUE_SEGMENTS 64
+
+/* NAL unit types */
+#define NAL_TYPE_IDR_SLICE  5
+#define NAL_TYPE_SPS        7
+#define NAL_GET_TYPE(byte)  ((byte) & 0x1f)
+
 /* Local function declaration */
 static int gst_h264_sps_pps_calBufSize(GstBuffer *codec_data);
 static GstBuffer* gst_h264_get_avcc_header (GstBuffer *buf);
+static gboolean gst_h264_idr_needs_sps (GstBuffer *buf, guint8 nal_length);
+static gboolean gst_h264_convert_in_place (GstBuffer *buf);
 
 /******************************************************************************
  * gst_is_h264_decoder
@@ -174,7 +185,7 @@ GstBuffer* gst_h264_get_nal_prefix_code (void)
 
 /******************************************************************************
  * gst_h264_parse_and_queue  - This function adds sps and pps header data
- * before pushing input buffer in queue.
+ * where the decoder needs it and pushes the input buffer in queue.
  *
  * H264 in quicktime is what we call in gstreamer 'packtized' h264.
  * A codec_data is exchanged in the caps that contains, among other things,
@@ -188,59 +199,163 @@ GstBuffer* gst_h264_get_nal_prefix_code (void)
  * a packetized stream into a byte stream.
  *****************************************************************************/
 int gst_h264_parse_and_queue (GstTICircBuffer *circBuf, GstBuffer *buf, 
-    GstBuffer *sps_pps_data, GstBuffer *nal_code_prefix, guint8 nal_length)
+    GstBuffer *sps_pps_data, GstBuffer *nal_code_prefix, guint8 nal_length,
+    gboolean *sps_pps_needed, guint64 *sps_pps_bytes)
 {
-    int i, nal_size=0, avail = GST_BUFFER_SIZE(buf);
-    GstBuffer *subBuf;
+    GstTICircBufferSegment segments[MAX_QUEUE_SEGMENTS];
+    guint   numSegments = 0;
+    int     i, nal_size;
+    int     avail = GST_BUFFER_SIZE(buf);
     guint8 *inBuf = GST_BUFFER_DATA(buf);
-    int offset = 0;
+    GstClockTime timestamp = GST_BUFFER_TIMESTAMP(buf);
+    GstClockTime duration  = GST_BUFFER_DURATION(buf);
+
+    /* Put SPS and PPS data (prefixed with NAL code) in fifo, but only at the
+     * start of the stream, after a flush or codec_data change, or before an
+     * IDR picture that doesn't carry its own parameter sets.
+     */
+    if (*sps_pps_needed || gst_h264_idr_needs_sps(buf, nal_length)) {
+        segments[numSegments].data   = GST_BUFFER_DATA(sps_pps_data);
+        segments[numSegments++].size = GST_BUFFER_SIZE(sps_pps_data);
+        *sps_pps_bytes  += GST_BUFFER_SIZE(sps_pps_data);
+        *sps_pps_needed  = FALSE;
+    }
 
-    /* Put SPS and PPS data (prefixed with NAL code) in fifo */
-    if (!gst_ticircbuffer_queue_data(circBuf, sps_pps_data)) {
-        GST_ERROR("Failed to put SPS, PPS data in Fifo \n");
-        return FALSE;
+    /* With 4-byte NAL lengths the length fields can simply be overwritten by
+     * start codes, so the whole buffer is queued in one piece.
+     */
+    if (nal_length == NAL_START_CODE_LENGTH && gst_buffer_is_writable(buf)) {
+        if (!gst_h264_convert_in_place(buf)) {
+            return FALSE;
+        }
+
+        segments[numSegments].data   = GST_BUFFER_DATA(buf);
+        segments[numSegments++].size = GST_BUFFER_SIZE(buf);
+
+        if (!gst_ticircbuffer_queue_datav(circBuf, segments, numSegments,
+                timestamp, duration)) {
+            GST_ERROR("Failed to queue NAL units\n");
+            return FALSE;
+        }
+        return TRUE;
     }
 
+    /* Otherwise gather prefix codes and NAL payloads in a single pass */
     do {
+        if (avail < nal_length) {
+            GST_ERROR("truncated NAL length field\n");
+            return FALSE;
+        }
+
         nal_size = 0;
         for (i=0; i < nal_length; i++) {
             nal_size = (nal_size << 8) | inBuf[i];
         }
         inBuf += nal_length;
-        offset += nal_length;
-            
-        /* Put NAL prefix code in fifo */
-        if (!gst_ticircbuffer_queue_data(circBuf, nal_code_prefix)) {
-            GST_ERROR("Failed to put NAL code prefix\n");
+        avail -= nal_length;
+
+        if (nal_size < 0 || nal_size > avail) {
+            GST_ERROR("NAL size %d exceeds the %d bytes left in buffer\n",
+                nal_size, avail);
             return FALSE;
         }
 
-        /* Get a child buffer starting with offset and end at nal_size */
-        subBuf = gst_buffer_create_sub(buf, offset, nal_size);
-        if (subBuf == NULL) {
-            GST_ERROR("Failed to get nal_size=%d buffer from adapater\n", 
-                    nal_size);
+        /* Put NAL prefix code and nal_size data from input buffer in fifo */
+        segments[numSegments].data   = GST_BUFFER_DATA(nal_code_prefix);
+        segments[numSegments++].size = GST_BUFFER_SIZE(nal_code_prefix);
+        segments[numSegments].data   = inBuf;
+        segments[numSegments++].size = nal_size;
+
+        inBuf += nal_size;
+        avail -= nal_size;
+
+        /* Queue what we have so far if we run out of segments; only the
+         * first batch carries the buffer timestamp and duration.
+         */
+        if (numSegments > MAX_QUEUE_SEGMENTS - 2 || avail <= 0) {
+            if (!gst_ticircbuffer_queue_datav(circBuf, segments, numSegments,
+                    timestamp, duration)) {
+                GST_ERROR("Failed to queue NAL units\n");
+                return FALSE;
+            }
+            numSegments = 0;
+            timestamp   = GST_CLOCK_TIME_NONE;
+            duration    = 0;
+        }
+    }while (avail > 0);
+
+    return TRUE;
+}
+
+/******************************************************************************
+ * gst_h264_convert_in_place - Replace the 4-byte NAL length fields of a
+ * writable packetized buffer with start codes.
+ *****************************************************************************/
+static gboolean gst_h264_convert_in_place (GstBuffer *buf)
+{
+    guint8 *inBuf = GST_BUFFER_DATA(buf);
+    int     avail = GST_BUFFER_SIZE(buf);
+    int     nal_size;
+
+    while (avail > 0) {
+        if (avail < NAL_START_CODE_LENGTH) {
+            GST_ERROR("truncated NAL length field\n");
             return FALSE;
         }
 
-        /* Put nal_size data from input buffer in fifo */
-        if (!gst_ticircbuffer_queue_data(circBuf, subBuf)) {
-            GST_ERROR("Failed to put NAL code prefix\n");
-            gst_buffer_unref(subBuf);
+        nal_size = GST_READ_UINT32_BE(inBuf);
+        avail   -= NAL_START_CODE_LENGTH;
+
+        if (nal_size < 0 || nal_size > avail) {
+            GST_ERROR("NAL size %d exceeds the %d bytes left in buffer\n",
+                nal_size, avail);
             return FALSE;
         }
 
-        /* Unref the sub buffer */
-        gst_buffer_unref(subBuf);
+        memcpy(inBuf, &NAL_START_CODE, NAL_START_CODE_LENGTH);
 
-        offset += nal_size;
-        inBuf += nal_size;
-        avail -= (nal_size + nal_length);
-    }while (avail > 0);
+        inBuf += NAL_START_CODE_LENGTH + nal_size;
+        avail -= nal_size;
+    }
 
     return TRUE;
 }
 
+/******************************************************************************
+ * gst_h264_idr_needs_sps - Return TRUE if the packetized buffer holds an IDR
+ * slice that isn't preceded by an SPS in the same buffer.
+ *****************************************************************************/
+static gboolean gst_h264_idr_needs_sps (GstBuffer *buf, guint8 nal_length)
+{
+    guint8 *inBuf = GST_BUFFER_DATA(buf);
+    int     avail = GST_BUFFER_SIZE(buf);
+    int     i, nal_size;
+
+    while (avail > nal_length) {
+        nal_size = 0;
+        for (i=0; i < nal_length; i++) {
+            nal_size = (nal_size << 8) | inBuf[i];
+        }
+
+        /* Leave malformed lengths for the caller to report */
+        if (nal_size < 0 || nal_size > avail - nal_length) {
+            return FALSE;
+        }
+
+        switch (NAL_GET_TYPE(inBuf[nal_length])) {
+            case NAL_TYPE_SPS:
+                return FALSE;
+            case NAL_TYPE_IDR_SLICE:
+                return TRUE;
+        }
+
+        inBuf += nal_length + nal_size;
+        avail -= nal_length + nal_size;
+    }
+
+    return FALSE;
+}
+
 /******************************************************************************
  * gst_h264_get_nal_length - This function return the NAL length in avcC
  * header.
@@ -412,38 +527,17 @@ static int gst_h264_sps_pps_calBufSize (GstBuffer *codec_data)
 
 /******************************************************************************
  * gst_h264_find_next_nal_code
- *  Use Boyer-Moore string matching algorithm to find NAL start code.
+ *  Return the offset of the next 4-byte NAL start code, or size if none.
  *****************************************************************************/
 static guint gst_h264_find_next_nal_code (Int8 *data, gint size)
 {
-    guint offset = 3;
-    unsigned int shift;
-    
-    while (offset < size) {
-        if (1 == data[offset]) {
-            shift = offset;
-            if (0 == data[--shift]) {
-                if (0 == data[--shift]) {
-                    if (0 == data[--shift]) {
-                        return shift;
-                    }
-                }
-            } 
-        offset += 4;
-    } 
-    else if (0 == data[offset]) {
-        /* maybe next byte is 1? */
-        offset++;
-    } 
-    else {
-        /* can jump 4 bytes forward */
-        offset += 4;
-    }
-  }
+    guint offset = gst_ti_find_start_code4((const guint8*)data, 0, size);
 
-  GST_LOG ("Cannot find next NAL start code. returning %u\n", size);
+    if (offset == size) {
+        GST_LOG ("Cannot find next NAL start code. returning %u\n", size);
+    }
 
-  return size;
+    return offset;
 }
 
 /******************************************************************************
@@ -76,9 +76,14 @@ guint8 gst_h264_get_nal_length (GstBuffer *buf);
 /* Function to get predefind NAL prefix code */
 GstBuffer* gst_h264_get_nal_prefix_code (void);
 
-/* Function to parse input stream and put in circular buffer */
+/* Function to parse input stream and put in circular buffer.  SPS/PPS data
+ * is only queued when *sps_pps_needed is set or the buffer holds an IDR
+ * picture without in-band parameter sets; the number of parameter set bytes
+ * queued is added to *sps_pps_bytes.
+ */
 int gst_h264_parse_and_queue (GstTICircBuffer *circBuf, GstBuffer *buf, 
-    GstBuffer *sps_pps_data, GstBuffer *nal_code_prefix, guint8 nal_length );
+    GstBuffer *sps_pps_data, GstBuffer *nal_code_prefix, guint8 nal_length,
+    gboolean *sps_pps_needed, guint64 *sps_pps_bytes);
 
 /* Function to check if we are using h264 decoder */
 gboolean gst_is_h264_decoder (const gchar *name);
@@ -57,14 +57,16 @@ gboolean gst_is_mpeg4_decoder (const gchar *name)
 int gst_mpeg4_parse_and_queue (GstTICircBuffer *circBuf, GstBuffer *buf, 
         GstBuffer *mpeg4_header)
 {
-    /* Put quicktime MPEG4 header in queue */
-    if (gst_ticircbuffer_queue_data(circBuf, mpeg4_header) < 0) {
-        GST_ERROR("Failed to put MPEG4 header data in Fifo \n");
-        return FALSE;
-    }
+    GstTICircBufferSegment segments[2];
+
+    /* Put quicktime MPEG4 header and encoded buffer in queue */
+    segments[0].data = GST_BUFFER_DATA(mpeg4_header);
+    segments[0].size = GST_BUFFER_SIZE(mpeg4_header);
+    segments[1].data = GST_BUFFER_DATA(buf);
+    segments[1].size = GST_BUFFER_SIZE(buf);
 
-    /* Put encoded buffer in queue */
-    if (gst_ticircbuffer_queue_data(circBuf, buf)<0) {
+    if (!gst_ticircbuffer_queue_datav(circBuf, segments, 2,
+            GST_BUFFER_TIMESTAMP(buf), GST_BUFFER_DURATION(buf))) {
         GST_ERROR("Failed to queue input buffer\n");
         return FALSE;
     }
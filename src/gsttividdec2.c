@@ -57,12 +57,23 @@
 #include "gsttithreadprops.h"
 #include "gsttiquicktime_h264.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 #include "gsttiquicktime_mpeg4.h"
 
 /* Declare variable used to categorize GST_LOG output */
 GST_DEBUG_CATEGORY_STATIC (gst_tividdec2_debug);
 #define GST_CAT_DEFAULT gst_tividdec2_debug
 
+/* How late the next frame may be before QoS skips to the next keyframe
+ * instead of dropping non-reference frames.
+ */
+#define QOS_KEYFRAME_LATENESS (GST_SECOND / 2)
+
+/* Without frameInput, how far into each input window to look for a sequence
+ * header announcing a new picture size.
+ */
+#define SIZE_SCAN_BYTES 4096
+
 /* Element property identifiers */
 enum
 {
@@ -74,7 +85,25 @@ enum
   PROP_DISPLAY_BUFFER,  /* displayBuffer  (boolean) */
   PROP_GEN_TIMESTAMPS,  /* genTimeStamps  (boolean) */
   PROP_RTCODECTHREAD,   /* rtCodecThread (boolean) */
-  PROP_PAD_ALLOC_OUTBUFS /* padAllocOutbufs (boolean) */
+  PROP_PAD_ALLOC_OUTBUFS, /* padAllocOutbufs (boolean) */
+  PROP_MIRROR_INPUT_BUFFER, /* mirrorInputBuffer (boolean) */
+  PROP_ZERO_COPY_INPUT, /* zeroCopyInput  (boolean) */
+  PROP_FRAME_INPUT,     /* frameInput     (boolean) */
+  PROP_PARAM_SET_BYTES, /* paramSetBytes  (uint64)  */
+  PROP_ERROR_RECOVERY,  /* errorRecovery  (int)     */
+  PROP_RESYNC_BYTES,    /* resyncBytes    (uint64)  */
+  PROP_RESYNC_COUNT,    /* resyncCount    (uint)    */
+  PROP_FAST_START,      /* fastStart      (boolean) */
+  PROP_QOS,             /* qos            (boolean) */
+  PROP_FRAMES_DECODED,  /* framesDecoded  (uint64)  */
+  PROP_FRAMES_DROPPED,  /* framesDropped  (uint64)  */
+  PROP_KEYFRAMES_ONLY,  /* keyframesOnly  (boolean) */
+  PROP_KEYFRAME_INTERVAL, /* keyframeInterval (uint64) */
+  PROP_OUTPUT_QUEUE,    /* outputQueue    (boolean) */
+  PROP_QUEUE_DEPTH,     /* queueDepth     (uint)    */
+  PROP_PUSH_STALL_TIME, /* pushStallTime  (uint64)  */
+  PROP_ASYNC_START,     /* asyncStart     (boolean) */
+  PROP_REUSE_CODEC      /* reuseCodec     (boolean) */
 };
 
 /* Define sink (input) pad capabilities.  Currently, MPEG and H264 are 
@@ -159,6 +188,8 @@ static GstFlowReturn
  gst_tividdec2_chain(GstPad *pad, GstBuffer *buf);
 static gboolean
  gst_tividdec2_init_video(GstTIViddec2 *viddec2);
+static gboolean
+ gst_tividdec2_wait_video(GstTIViddec2 *viddec2);
 static gboolean
  gst_tividdec2_exit_video(GstTIViddec2 *viddec2);
 static GstStateChangeReturn
@@ -175,12 +206,89 @@ static gboolean
     gst_tividdec2_codec_start (GstTIViddec2  *viddec2, GstBuffer **padBuffer);
 static gboolean 
     gst_tividdec2_codec_stop (GstTIViddec2  *viddec2);
+static gboolean
+    gst_tividdec2_codec_park(GstTIViddec2 *viddec2);
+static gboolean
+    gst_tividdec2_codec_unpark(GstTIViddec2 *viddec2,
+        VIDDEC2_Params *params, ColorSpace_Type colorSpace, Int numBufs);
+static void
+    gst_tividdec2_free_parked(GstTIViddec2 *viddec2);
+static gboolean
+    gst_tividdec2_codec_flush (GstTIViddec2  *viddec2, gboolean pushFrames);
+static gboolean
+    gst_tividdec2_push_display_bufs(GstTIViddec2 *viddec2,
+        GstClockTime frameDuration);
+static gboolean
+    gst_tividdec2_get_codec_params(GstTIViddec2 *viddec2,
+        VIDDEC2_Params *params, ColorSpace_Type *colorSpace,
+        Int *defaultNumBufs);
+static GstTISizeParser
+    gst_tividdec2_get_size_parser(GstTIViddec2 *viddec2);
+static gboolean
+    gst_tividdec2_check_size(GstTIViddec2 *viddec2, GstBuffer *encDataWindow,
+        gboolean *usePadBufs);
+static gboolean
+    gst_tividdec2_codec_reconfigure(GstTIViddec2 *viddec2, gint width,
+        gint height);
+static gboolean
+    gst_tividdec2_start_push_thread(GstTIViddec2 *viddec2);
+static void
+    gst_tividdec2_stop_push_thread(GstTIViddec2 *viddec2);
+static void*
+    gst_tividdec2_push_thread(void *arg);
+static gboolean
+    gst_tividdec2_queue_output(GstTIViddec2 *viddec2, GstBuffer *outBuf);
+static void
+    gst_tividdec2_flush_output(GstTIViddec2 *viddec2);
 static void 
     gst_tividdec2_init_env(GstTIViddec2 *viddec2);
 static void
     gst_tividdec2_dispose(GObject * object);
+static void
+    gst_tividdec2_finalize(GObject * object);
 static gboolean 
     gst_tividdec2_set_query_pad(GstPad * pad, GstQuery * query);
+static gboolean
+    gst_tividdec2_src_event(GstPad *pad, GstEvent *event);
+static void
+    gst_tividdec2_update_sps_pps(GstTIViddec2 *viddec2, GstBuffer *buf);
+static void
+    gst_tividdec2_set_frame_timestamp(GstTIViddec2 *viddec2,
+        Buffer_Handle hBuf, GstClockTime timestamp);
+static GstClockTime
+    gst_tividdec2_get_frame_timestamp(GstTIViddec2 *viddec2,
+        Buffer_Handle hBuf);
+static gboolean
+    gst_tividdec2_is_mpeg2_decoder(GstTIViddec2 *viddec2);
+static GstTIFramer
+    gst_tividdec2_get_framer(GstTIViddec2 *viddec2);
+static GstTISyncFinder
+    gst_tividdec2_get_sync_finder(GstTIViddec2 *viddec2);
+static GstTISyncFinder
+    gst_tividdec2_get_keyframe_finder(GstTIViddec2 *viddec2);
+static GstTIDroppableCheck
+    gst_tividdec2_get_droppable_check(GstTIViddec2 *viddec2);
+static gboolean
+    gst_tividdec2_skip_to_keyframe(GstTIViddec2 *viddec2,
+        GstBuffer *encDataWindow);
+static gboolean
+    gst_tividdec2_skip_keyframe(GstTIViddec2 *viddec2,
+        GstBuffer *encDataWindow);
+static void
+    gst_tividdec2_reset_qos(GstTIViddec2 *viddec2);
+static gboolean
+    gst_tividdec2_qos_drop(GstTIViddec2 *viddec2, GstBuffer *encDataWindow,
+        GstClockTime frameDuration);
+static void
+    gst_tividdec2_start_first_frame(GstTIViddec2 *viddec2);
+static void
+    gst_tividdec2_post_first_frame(GstTIViddec2 *viddec2,
+        GstClockTime timestamp);
+static void
+    gst_tividdec2_post_codec_ready(GstTIViddec2 *viddec2);
+static Int32
+    gst_tividdec2_resync(GstTIViddec2 *viddec2, GstBuffer *encDataWindow,
+        Int32 encDataConsumed);
 
 /******************************************************************************
  * gst_tividdec2_class_init_trampoline
@@ -266,10 +374,25 @@ static void gst_tividdec2_dispose(GObject * object)
         viddec2->segment = NULL;
     }
 
+    gst_tividdec2_free_parked(viddec2);
+
     G_OBJECT_CLASS(parent_class)->dispose (object);
 }
 
 
+/******************************************************************************
+ * gst_tividdec2_finalize
+ *****************************************************************************/
+static void gst_tividdec2_finalize(GObject * object)
+{
+    GstTIViddec2 *viddec2 = GST_TIVIDDEC2(object);
+
+    pthread_mutex_destroy(&viddec2->outQueueMutex);
+
+    G_OBJECT_CLASS(parent_class)->finalize (object);
+}
+
+
 
 /******************************************************************************
  * gst_tividdec2_class_init
@@ -287,6 +410,7 @@ static void gst_tividdec2_class_init(GstTIViddec2Class *klass)
     gobject_class->set_property = gst_tividdec2_set_property;
     gobject_class->get_property = gst_tividdec2_get_property;
     gobject_class->dispose      = GST_DEBUG_FUNCPTR(gst_tividdec2_dispose);
+    gobject_class->finalize     = GST_DEBUG_FUNCPTR(gst_tividdec2_finalize);
 
     gstelement_class->change_state = gst_tividdec2_change_state;
 
@@ -330,6 +454,113 @@ static void gst_tividdec2_class_init(GstTIViddec2Class *klass)
         g_param_spec_boolean("padAllocOutbufs", "Use pad allocation",
             "Try to allocate buffers with pad allocation",
             FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_MIRROR_INPUT_BUFFER,
+        g_param_spec_boolean("mirrorInputBuffer", "Mirror input buffer",
+            "Map the circular input buffer twice so input wraps without "
+            "shifting (windows that cross the wrap are still copied)",
+            FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_ZERO_COPY_INPUT,
+        g_param_spec_boolean("zeroCopyInput", "Zero-copy input",
+            "Decode DMAI input buffers in place instead of copying them into "
+            "the circular buffer (input buffers must hold whole frames)",
+            FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_FRAME_INPUT,
+        g_param_spec_boolean("frameInput", "Frame input",
+            "Pass the codec one access unit at a time (H.264 byte-stream, "
+            "MPEG-4 and MPEG-2) instead of waiting for a full input window",
+            FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_PARAM_SET_BYTES,
+        g_param_spec_uint64("paramSetBytes", "Parameter set bytes",
+            "Number of bytes of H.264 SPS/PPS data inserted into a "
+            "packetized stream",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_ERROR_RECOVERY,
+        g_param_spec_int("errorRecovery", "Error recovery",
+            "What to skip when the codec fails to decode: 0 - one byte, "
+            "1 - up to the next start code, 2 - up to the next keyframe",
+            GST_TIVIDDEC2_RECOVERY_NONE, GST_TIVIDDEC2_RECOVERY_KEYFRAME,
+            GST_TIVIDDEC2_RECOVERY_NONE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_RESYNC_BYTES,
+        g_param_spec_uint64("resyncBytes", "Resync bytes",
+            "Number of input bytes skipped to recover from decode errors",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_RESYNC_COUNT,
+        g_param_spec_uint("resyncCount", "Resync count",
+            "Number of times the input was skipped to recover from a decode "
+            "error",
+            0, G_MAXUINT, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_FAST_START,
+        g_param_spec_boolean("fastStart", "Fast start",
+            "After starting or seeking, drop input until the first keyframe "
+            "instead of decoding from an arbitrary point",
+            FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_QOS,
+        g_param_spec_boolean("qos", "Quality of service",
+            "Drop frames before decoding when downstream reports they "
+            "will be late",
+            TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_FRAMES_DECODED,
+        g_param_spec_uint64("framesDecoded", "Frames decoded",
+            "Number of frames decoded",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_FRAMES_DROPPED,
+        g_param_spec_uint64("framesDropped", "Frames dropped",
+            "Number of access units dropped before decoding, because they "
+            "were late or preceded the first keyframe",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_KEYFRAMES_ONLY,
+        g_param_spec_boolean("keyframesOnly", "Keyframes only",
+            "Decode only keyframes, each on its own, for thumbnails and "
+            "trick play",
+            FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_KEYFRAME_INTERVAL,
+        g_param_spec_uint64("keyframeInterval", "Keyframe interval",
+            "In keyframesOnly mode, skip keyframes less than this many "
+            "nanoseconds of stream time (scaled by the playback rate) after "
+            "the last one decoded",
+            0, G_MAXUINT64, 0, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_OUTPUT_QUEUE,
+        g_param_spec_boolean("outputQueue", "Output queue",
+            "Push decoded frames from a separate thread, so the codec can "
+            "decode the next frame while downstream is busy",
+            FALSE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_QUEUE_DEPTH,
+        g_param_spec_uint("queueDepth", "Queue depth",
+            "Number of decoded frames waiting in the output queue",
+            0, G_MAXUINT, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_PUSH_STALL_TIME,
+        g_param_spec_uint64("pushStallTime", "Push stall time",
+            "Total nanoseconds the output queue thread spent waiting for "
+            "downstream to accept frames",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_ASYNC_START,
+        g_param_spec_boolean("asyncStart", "Asynchronous start",
+            "Start creating the codec as soon as the stream format is known, "
+            "instead of when the first buffer arrives",
+            TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_REUSE_CODEC,
+        g_param_spec_boolean("reuseCodec", "Reuse codec",
+            "Keep the codec and its buffers when the stream stops, and reuse "
+            "them for the next stream if it fits",
+            TRUE, G_PARAM_WRITABLE));
 }
 
 /******************************************************************************
@@ -400,6 +631,80 @@ static void gst_tividdec2_init_env(GstTIViddec2 *viddec2)
                     viddec2->padAllocOutbufs ? "TRUE" : "FALSE");
     }
 
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_mirrorInputBuffer")) {
+        viddec2->mirrorInputBuffer = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_mirrorInputBuffer");
+        GST_LOG("Setting mirrorInputBuffer =%s\n", 
+                    viddec2->mirrorInputBuffer ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_zeroCopyInput")) {
+        viddec2->zeroCopyInput = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_zeroCopyInput");
+        GST_LOG("Setting zeroCopyInput =%s\n", 
+                    viddec2->zeroCopyInput ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_frameInput")) {
+        viddec2->frameInput = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_frameInput");
+        GST_LOG("Setting frameInput =%s\n", 
+                    viddec2->frameInput ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_errorRecovery")) {
+        viddec2->errorRecovery = 
+                gst_ti_env_get_int("GST_TI_TIViddec2_errorRecovery");
+        GST_LOG("Setting errorRecovery=%d\n", viddec2->errorRecovery);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_fastStart")) {
+        viddec2->fastStart = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_fastStart");
+        GST_LOG("Setting fastStart =%s\n", 
+                    viddec2->fastStart ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_qos")) {
+        viddec2->qos = gst_ti_env_get_boolean("GST_TI_TIViddec2_qos");
+        GST_LOG("Setting qos =%s\n", viddec2->qos ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_keyframesOnly")) {
+        viddec2->keyframesOnly = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_keyframesOnly");
+        GST_LOG("Setting keyframesOnly =%s\n", 
+                    viddec2->keyframesOnly ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_keyframeInterval")) {
+        viddec2->keyframeInterval = 
+                gst_ti_env_get_int("GST_TI_TIViddec2_keyframeInterval");
+        GST_LOG("Setting keyframeInterval=%llu\n",
+                    viddec2->keyframeInterval);
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_outputQueue")) {
+        viddec2->outputQueue = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_outputQueue");
+        GST_LOG("Setting outputQueue =%s\n", 
+                    viddec2->outputQueue ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_asyncStart")) {
+        viddec2->asyncStart = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_asyncStart");
+        GST_LOG("Setting asyncStart =%s\n", 
+                    viddec2->asyncStart ? "TRUE" : "FALSE");
+    }
+
+    if (gst_ti_env_is_defined("GST_TI_TIViddec2_reuseCodec")) {
+        viddec2->reuseCodec = 
+                gst_ti_env_get_boolean("GST_TI_TIViddec2_reuseCodec");
+        GST_LOG("Setting reuseCodec =%s\n", 
+                    viddec2->reuseCodec ? "TRUE" : "FALSE");
+    }
+
     GST_LOG("gst_tividdec2_init_env - end\n");
 }
 
@@ -439,6 +744,8 @@ static void gst_tividdec2_init(GstTIViddec2 *viddec2, GstTIViddec2Class *gclass)
             gst_caps_copy(gst_pad_get_pad_template_caps(viddec2->srcpad))));
     gst_pad_set_query_function(viddec2->srcpad,
             GST_DEBUG_FUNCPTR(gst_tividdec2_set_query_pad));
+    gst_pad_set_event_function(viddec2->srcpad,
+            GST_DEBUG_FUNCPTR(gst_tividdec2_src_event));
 
     /* Add pads to TIViddec2 element */
     gst_element_add_pad(GST_ELEMENT(viddec2), viddec2->sinkpad);
@@ -458,18 +765,59 @@ static void gst_tividdec2_init(GstTIViddec2 *viddec2, GstTIViddec2Class *gclass)
 
     viddec2->waitOnDecodeThread = NULL;
     viddec2->waitOnDecodeDrain  = NULL;
+    viddec2->asyncStart         = TRUE;
+    viddec2->codecStarting      = FALSE;
+    viddec2->codecStartTime     = GST_CLOCK_TIME_NONE;
 
     viddec2->numOutputBufs      = 0UL;
     viddec2->hOutBufTab         = NULL;
     viddec2->padAllocOutbufs    = FALSE;
+    viddec2->mirrorInputBuffer  = FALSE;
+    viddec2->zeroCopyInput      = FALSE;
+    viddec2->frameInput         = FALSE;
+    viddec2->errorRecovery      = GST_TIVIDDEC2_RECOVERY_NONE;
+    viddec2->syncFinder         = NULL;
+    viddec2->resyncBytes        = 0;
+    viddec2->resyncCount        = 0;
+    viddec2->fastStart          = FALSE;
+    viddec2->waitForKeyframe    = FALSE;
+    viddec2->keyframeFinder     = NULL;
+    viddec2->firstFramePending  = FALSE;
+    viddec2->firstFrameStart    = GST_CLOCK_TIME_NONE;
+    viddec2->firstFrameSkipped  = 0;
+    viddec2->qos                = TRUE;
+    viddec2->qosEarliest        = GST_CLOCK_TIME_NONE;
+    viddec2->isDroppable        = NULL;
+    viddec2->framesDecoded      = 0;
+    viddec2->framesDropped      = 0;
+    viddec2->keyframesOnly      = FALSE;
+    viddec2->keyframeInterval   = 0;
+    viddec2->lastKeyframeTime   = GST_CLOCK_TIME_NONE;
+    viddec2->outputQueue        = FALSE;
+    viddec2->outQueue           = NULL;
+    viddec2->pushThreadRunning  = FALSE;
+    viddec2->pushThreadStop     = FALSE;
+    viddec2->pushing            = FALSE;
+    viddec2->pushFailed         = FALSE;
+    viddec2->queueDepth         = 0;
+    viddec2->pushStallTime      = 0;
+
+    /* The output queue statistics are read under this lock even when no
+     * push thread is running.
+     */
+    pthread_mutex_init(&viddec2->outQueueMutex, NULL);
     viddec2->circBuf            = NULL;
 
     viddec2->sps_pps_data       = NULL;
     viddec2->nal_code_prefix    = NULL;
     viddec2->nal_length         = 0;
+    viddec2->sps_pps_caps       = NULL;
+    viddec2->sps_pps_needed     = FALSE;
+    viddec2->sps_pps_bytes      = 0;
 
     viddec2->segment            = gst_segment_new();
     viddec2->totalDuration      = 0;
+    viddec2->frameTimeStamps    = NULL;
     viddec2->totalBytes         = 0;
 
     viddec2->mpeg4_quicktime_header = NULL;
@@ -478,6 +826,21 @@ static void gst_tividdec2_init(GstTIViddec2 *viddec2, GstTIViddec2Class *gclass)
 
     viddec2->width              = 0;
     viddec2->height             = 0;
+    viddec2->sizeParser         = NULL;
+    viddec2->streamWidth        = 0;
+    viddec2->streamHeight       = 0;
+    viddec2->codecMaxWidth      = 0;
+    viddec2->codecMaxHeight     = 0;
+
+    viddec2->reuseCodec         = TRUE;
+    viddec2->hParkedEngine      = NULL;
+    viddec2->hParkedVd          = NULL;
+    viddec2->parkedCircBuf      = NULL;
+    viddec2->hParkedOutBufTab   = NULL;
+    viddec2->parkedEngineName   = NULL;
+    viddec2->parkedCodecName    = NULL;
+    viddec2->codecColorSpace    = ColorSpace_NOTSET;
+    viddec2->outBufSize         = 0;
 
     /* Initialize GValue members */
     memset(&viddec2->framerate, 0, sizeof(GValue));
@@ -508,6 +871,57 @@ static gboolean gst_tividdec2_set_query_pad(GstPad *pad, GstQuery *query)
 }
 
 
+/******************************************************************************
+ * gst_tividdec2_src_event
+ *     Handle events from downstream.  QoS events tell us how late the last
+ *     frame was; remember when the next frame has to be ready by.
+ ******************************************************************************/
+static gboolean gst_tividdec2_src_event(GstPad *pad, GstEvent *event)
+{
+    GstTIViddec2     *viddec2;
+    GstClockTimeDiff  diff;
+    GstClockTime      timestamp;
+    gdouble           proportion;
+    gboolean          ret;
+
+    viddec2 = GST_TIVIDDEC2(gst_pad_get_parent(pad));
+
+    switch (GST_EVENT_TYPE(event)) {
+
+        case GST_EVENT_QOS:
+            gst_event_parse_qos(event, &proportion, &diff, &timestamp);
+
+            /* When late, allow for the next frame being as late again */
+            GST_OBJECT_LOCK(viddec2);
+            if (!GST_CLOCK_TIME_IS_VALID(timestamp)) {
+                viddec2->qosEarliest = GST_CLOCK_TIME_NONE;
+            }
+            else if (diff > 0) {
+                viddec2->qosEarliest = timestamp + 2 * diff;
+            }
+            else {
+                viddec2->qosEarliest = timestamp + diff;
+            }
+            GST_OBJECT_UNLOCK(viddec2);
+
+            GST_LOG("qos: proportion %g, diff %" G_GINT64_FORMAT
+                ", timestamp %" GST_TIME_FORMAT "\n", proportion, diff,
+                GST_TIME_ARGS(timestamp));
+
+            ret = gst_pad_push_event(viddec2->sinkpad, event);
+            break;
+
+        default:
+            ret = gst_pad_event_default(pad, event);
+            break;
+    }
+
+    gst_object_unref(viddec2);
+
+    return ret;
+}
+
+
 /******************************************************************************
  * gst_tividdec2_set_property
  *     Set element properties when requested.
@@ -571,6 +985,61 @@ static void gst_tividdec2_set_property(GObject *object, guint prop_id,
             GST_LOG("setting \"padAllocOutbufs\" to \"%s\"\n",
                 viddec2->padAllocOutbufs ? "TRUE" : "FALSE");
             break;
+        case PROP_MIRROR_INPUT_BUFFER:
+            viddec2->mirrorInputBuffer = g_value_get_boolean(value);
+            GST_LOG("setting \"mirrorInputBuffer\" to \"%s\"\n",
+                viddec2->mirrorInputBuffer ? "TRUE" : "FALSE");
+            break;
+        case PROP_ZERO_COPY_INPUT:
+            viddec2->zeroCopyInput = g_value_get_boolean(value);
+            GST_LOG("setting \"zeroCopyInput\" to \"%s\"\n",
+                viddec2->zeroCopyInput ? "TRUE" : "FALSE");
+            break;
+        case PROP_FRAME_INPUT:
+            viddec2->frameInput = g_value_get_boolean(value);
+            GST_LOG("setting \"frameInput\" to \"%s\"\n",
+                viddec2->frameInput ? "TRUE" : "FALSE");
+            break;
+        case PROP_ERROR_RECOVERY:
+            viddec2->errorRecovery = g_value_get_int(value);
+            GST_LOG("setting \"errorRecovery\" to \"%d\"\n",
+                viddec2->errorRecovery);
+            break;
+        case PROP_FAST_START:
+            viddec2->fastStart = g_value_get_boolean(value);
+            GST_LOG("setting \"fastStart\" to \"%s\"\n",
+                viddec2->fastStart ? "TRUE" : "FALSE");
+            break;
+        case PROP_QOS:
+            viddec2->qos = g_value_get_boolean(value);
+            GST_LOG("setting \"qos\" to \"%s\"\n",
+                viddec2->qos ? "TRUE" : "FALSE");
+            break;
+        case PROP_KEYFRAMES_ONLY:
+            viddec2->keyframesOnly = g_value_get_boolean(value);
+            GST_LOG("setting \"keyframesOnly\" to \"%s\"\n",
+                viddec2->keyframesOnly ? "TRUE" : "FALSE");
+            break;
+        case PROP_KEYFRAME_INTERVAL:
+            viddec2->keyframeInterval = g_value_get_uint64(value);
+            GST_LOG("setting \"keyframeInterval\" to \"%llu\"\n",
+                viddec2->keyframeInterval);
+            break;
+        case PROP_OUTPUT_QUEUE:
+            viddec2->outputQueue = g_value_get_boolean(value);
+            GST_LOG("setting \"outputQueue\" to \"%s\"\n",
+                viddec2->outputQueue ? "TRUE" : "FALSE");
+            break;
+        case PROP_ASYNC_START:
+            viddec2->asyncStart = g_value_get_boolean(value);
+            GST_LOG("setting \"asyncStart\" to \"%s\"\n",
+                viddec2->asyncStart ? "TRUE" : "FALSE");
+            break;
+        case PROP_REUSE_CODEC:
+            viddec2->reuseCodec = g_value_get_boolean(value);
+            GST_LOG("setting \"reuseCodec\" to \"%s\"\n",
+                viddec2->reuseCodec ? "TRUE" : "FALSE");
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -600,6 +1069,31 @@ static void gst_tividdec2_get_property(GObject *object, guint prop_id,
         case PROP_FRAMERATE:
             g_value_copy(&viddec2->framerate, value);
             break;
+        case PROP_PARAM_SET_BYTES:
+            g_value_set_uint64(value, viddec2->sps_pps_bytes);
+            break;
+        case PROP_RESYNC_BYTES:
+            g_value_set_uint64(value, viddec2->resyncBytes);
+            break;
+        case PROP_RESYNC_COUNT:
+            g_value_set_uint(value, viddec2->resyncCount);
+            break;
+        case PROP_FRAMES_DECODED:
+            g_value_set_uint64(value, viddec2->framesDecoded);
+            break;
+        case PROP_FRAMES_DROPPED:
+            g_value_set_uint64(value, viddec2->framesDropped);
+            break;
+        case PROP_QUEUE_DEPTH:
+            pthread_mutex_lock(&viddec2->outQueueMutex);
+            g_value_set_uint(value, viddec2->queueDepth);
+            pthread_mutex_unlock(&viddec2->outQueueMutex);
+            break;
+        case PROP_PUSH_STALL_TIME:
+            pthread_mutex_lock(&viddec2->outQueueMutex);
+            g_value_set_uint64(value, viddec2->pushStallTime);
+            pthread_mutex_unlock(&viddec2->outQueueMutex);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -725,6 +1219,14 @@ static gboolean gst_tividdec2_set_sink_caps(GstPad *pad, GstCaps *caps)
     if (!viddec2->codecName) {
         viddec2->codecName = codec->CE_CodecName;
     }
+
+    /* Start creating the codec now, so it overlaps with the rest of the
+     * pipeline starting up.  The first buffer waits for it to finish.
+     */
+    if (viddec2->asyncStart && !gst_tividdec2_init_video(viddec2)) {
+        gst_object_unref(viddec2);
+        return FALSE;
+    }
     
     gst_object_unref(viddec2);
 
@@ -835,9 +1337,13 @@ static gboolean gst_tividdec2_sink_event(GstPad *pad, GstEvent *event)
     switch (GST_EVENT_TYPE(event)) {
 
         case GST_EVENT_NEWSEGMENT:
-            /* if event format is byte then convert in time format */
+            /* if event format is byte then convert in time format.  The
+             * decode thread reads the segment for QoS.
+             */
+            GST_OBJECT_LOCK(viddec2);
             gst_ti_parse_newsegment(&event, viddec2->segment, 
                 &viddec2->totalDuration, viddec2->totalBytes);
+            GST_OBJECT_UNLOCK(viddec2);
 
             /* Propagate NEWSEGMENT to downstream elements */
             ret = gst_pad_push_event(viddec2->srcpad, event);
@@ -855,7 +1361,30 @@ static gboolean gst_tividdec2_sink_event(GstPad *pad, GstEvent *event)
             ret = gst_pad_push_event(viddec2->srcpad, event);
             break;
 
+        case GST_EVENT_FLUSH_START:
+            /* Refuse new input and make the decode thread stop and reset
+             * the codec.  Downstream must flush too, so a push blocked
+             * there returns.
+             */
+            gst_ticircbuffer_flush_start(viddec2->circBuf);
+
+            ret = gst_pad_push_event(viddec2->srcpad, event);
+            break;
+
         case GST_EVENT_FLUSH_STOP:
+            /* The decoder needs parameter sets again after a seek, and
+             * lateness reported before it no longer applies.
+             */
+            viddec2->sps_pps_needed = TRUE;
+            gst_tividdec2_reset_qos(viddec2);
+
+            /* Discard the input queued before the seek once the decode
+             * thread has reset the codec.  Downstream only stops flushing
+             * after that, so a frame decoded from before the seek can't
+             * reach it.
+             */
+            gst_ticircbuffer_flush_stop(viddec2->circBuf);
+
             ret = gst_pad_push_event(viddec2->srcpad, event);
             break;
 
@@ -866,7 +1395,6 @@ static gboolean gst_tividdec2_sink_event(GstPad *pad, GstEvent *event)
         case GST_EVENT_CUSTOM_DOWNSTREAM:
         case GST_EVENT_CUSTOM_DOWNSTREAM_OOB:
         case GST_EVENT_CUSTOM_UPSTREAM:
-        case GST_EVENT_FLUSH_START:
         case GST_EVENT_NAVIGATION:
         case GST_EVENT_QOS:
         case GST_EVENT_SEEK:
@@ -902,6 +1430,8 @@ static gboolean gst_tividdec2_populate_codec_header (GstTIViddec2 *viddec2,
         viddec2->nal_length = gst_h264_get_nal_length(buf);
         viddec2->sps_pps_data = gst_h264_get_sps_pps_data(buf);
         viddec2->nal_code_prefix = gst_h264_get_nal_prefix_code();
+        viddec2->sps_pps_caps = gst_caps_ref(caps);
+        viddec2->sps_pps_needed = TRUE;
     }
 
     if (gst_is_mpeg4_decoder(viddec2->codecName) && 
@@ -913,24 +1443,68 @@ static gboolean gst_tividdec2_populate_codec_header (GstTIViddec2 *viddec2,
     return TRUE;
 }
 
+/******************************************************************************
+ * gst_tividdec2_update_sps_pps
+ *  Called when a packetized H.264 buffer arrives with new caps.  If the SPS
+ *  and PPS in codec_data changed, use the new ones and re-insert them before
+ *  the next buffer.
+ *****************************************************************************/
+static void gst_tividdec2_update_sps_pps (GstTIViddec2 *viddec2,
+    GstBuffer *buf)
+{
+    GstBuffer *sps_pps_data;
+
+    gst_caps_unref(viddec2->sps_pps_caps);
+    viddec2->sps_pps_caps = gst_caps_ref(GST_BUFFER_CAPS(buf));
+
+    if (!gst_h264_valid_quicktime_header(buf)) {
+        return;
+    }
+
+    sps_pps_data = gst_h264_get_sps_pps_data(buf);
+    if (sps_pps_data == NULL) {
+        return;
+    }
+
+    if (GST_BUFFER_SIZE(sps_pps_data) == GST_BUFFER_SIZE(viddec2->sps_pps_data)
+        && !memcmp(GST_BUFFER_DATA(sps_pps_data),
+                   GST_BUFFER_DATA(viddec2->sps_pps_data),
+                   GST_BUFFER_SIZE(sps_pps_data))) {
+        gst_buffer_unref(sps_pps_data);
+        return;
+    }
+
+    GST_LOG("codec_data changed; queueing new SPS and PPS\n");
+    gst_buffer_unref(viddec2->sps_pps_data);
+    viddec2->sps_pps_data   = sps_pps_data;
+    viddec2->nal_length     = gst_h264_get_nal_length(buf);
+    viddec2->sps_pps_needed = TRUE;
+}
+
 /******************************************************************************
  * gst_tividdec2_parse_and_queue_buffer
  *  If needed then this function will parse the input buffer before putting
- *  in circular buffer.
+ *  in circular buffer.  Returns FALSE if the data could not be queued; the
+ *  caller reports the error.
  *****************************************************************************/
 static gboolean gst_tividdec2_parse_and_queue_buffer(GstTIViddec2 *viddec2,
     GstBuffer *buf)
 {
     if (viddec2->sps_pps_data) {
+        /* Pick up new parameter sets if the codec_data changed */
+        if (GST_BUFFER_CAPS(buf) && 
+                GST_BUFFER_CAPS(buf) != viddec2->sps_pps_caps) {
+            gst_tividdec2_update_sps_pps(viddec2, buf);
+        }
+
         /* If demuxer has passed SPS and PPS NAL unit dump in codec_data field,
          * then we have a packetized h264 stream. We need to transform this 
          * stream into byte-stream.
          */
-        if (gst_h264_parse_and_queue(viddec2->circBuf, buf, 
+        if (!gst_h264_parse_and_queue(viddec2->circBuf, buf, 
                 viddec2->sps_pps_data, viddec2->nal_code_prefix,
-                viddec2->nal_length) < 0) {
-            GST_ELEMENT_ERROR(viddec2, RESOURCE, WRITE,
-            ("Failed to queue input buffer into circular buffer\n"), (NULL));
+                viddec2->nal_length, &viddec2->sps_pps_needed,
+                &viddec2->sps_pps_bytes)) {
             return FALSE;
         }
     }
@@ -938,18 +1512,14 @@ static gboolean gst_tividdec2_parse_and_queue_buffer(GstTIViddec2 *viddec2,
         /* If demuxer has passed codec_data field then we need to prefix this
          * codec data in input stream.
          */
-        if (gst_mpeg4_parse_and_queue(viddec2->circBuf, buf, 
-                viddec2->mpeg4_quicktime_header) < 0) {
-            GST_ELEMENT_ERROR(viddec2, RESOURCE, WRITE,
-            ("Failed to queue input buffer into circular buffer\n"), (NULL));
+        if (!gst_mpeg4_parse_and_queue(viddec2->circBuf, buf, 
+                viddec2->mpeg4_quicktime_header)) {
             return FALSE;
         }
     }
     else {
         /* Queue up the encoded data stream into a circular buffer */
         if (!gst_ticircbuffer_queue_data(viddec2->circBuf, buf)) {
-            GST_ELEMENT_ERROR(viddec2, RESOURCE, WRITE,
-            ("Failed to queue input buffer into circular buffer\n"), (NULL));
             return FALSE;
         }
     }
@@ -983,15 +1553,25 @@ static GstFlowReturn gst_tividdec2_chain(GstPad * pad, GstBuffer * buf)
      * buffer or the upstream element has re-negotiated our capabilities which
      * resulted in our engine being closed.  In either case, we need to
      * initialize (or re-initialize) our video decoder to handle the new
-     * stream.
+     * stream, unless set_sink_caps has already started doing so.
      */
-    if (viddec2->hEngine == NULL) {
+    if (!viddec2->codecStarting && viddec2->hEngine == NULL) {
         if (!gst_tividdec2_init_video(viddec2)) {
             GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
             ("unable to initialize video\n"), (NULL));
             flow = GST_FLOW_UNEXPECTED;
             goto exit;
         }
+    }
+
+    if (viddec2->codecStarting) {
+        if (!gst_tividdec2_wait_video(viddec2)) {
+            GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
+            ("decode thread failed to create circbuf handles\n"),
+            (NULL));
+            flow = GST_FLOW_UNEXPECTED;
+            goto exit;
+        }
 
         /* Populate extra codec headers */
         if (gst_tividdec2_populate_codec_header(viddec2, buf)) {
@@ -1005,6 +1585,13 @@ static GstFlowReturn gst_tividdec2_chain(GstPad * pad, GstBuffer * buf)
 
     /* Parse and queue the encoded data stream into a circular buffer */
     if (!gst_tividdec2_parse_and_queue_buffer(viddec2, buf)) {
+
+        /* Input is refused while a seek flushes the pipeline */
+        if (gst_ticircbuffer_is_flushing(viddec2->circBuf)) {
+            flow = GST_FLOW_WRONG_STATE;
+            goto exit;
+        }
+
         GST_ELEMENT_ERROR(viddec2, RESOURCE, WRITE,
         ("Failed to queue input buffer into circular buffer\n"), (NULL));
         flow = GST_FLOW_UNEXPECTED;
@@ -1019,7 +1606,9 @@ exit:
 
 /******************************************************************************
  * gst_tividdec2_init_video
- *     Initialize or re-initializes the video stream
+ *     Initialize or re-initializes the video stream.  The decode thread
+ *     creates the codec in the background; gst_tividdec2_wait_video must be
+ *     called before any data is queued.
  ******************************************************************************/
 static gboolean gst_tividdec2_init_video(GstTIViddec2 *viddec2)
 {
@@ -1051,7 +1640,8 @@ static gboolean gst_tividdec2_init_video(GstTIViddec2 *viddec2)
     }
 
     /* Initialize thread status management */
-    viddec2->threadStatus = 0UL;
+    viddec2->threadStatus   = 0UL;
+    viddec2->codecStartTime = gst_util_get_timestamp();
     pthread_mutex_init(&viddec2->threadStatusMutex, NULL);
 
     /* Initialize rendezvous objects for making threads wait on conditions */
@@ -1103,6 +1693,7 @@ static gboolean gst_tividdec2_init_video(GstTIViddec2 *viddec2)
         return FALSE;
     }
     gst_tithread_set_status(viddec2, TIThread_CODEC_CREATED);
+    viddec2->codecStarting = TRUE;
 
     /* Destroy the custom thread attributes */
     if (pthread_attr_destroy(&attr)) {
@@ -1111,20 +1702,28 @@ static gboolean gst_tividdec2_init_video(GstTIViddec2 *viddec2)
         return FALSE;
     }
 
-    /* Make sure circular buffer and display buffer handles are created by 
-     * decoder thread.
-     */
+    GST_LOG("end init_video\n");
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_wait_video
+ *     Wait for the decode thread started by gst_tividdec2_init_video to
+ *     create the codec, circular buffer and display buffers.  Returns FALSE
+ *     if it failed to.
+ ******************************************************************************/
+static gboolean gst_tividdec2_wait_video(GstTIViddec2 *viddec2)
+{
+    GstClockTime waitStart = gst_util_get_timestamp();
+
     Rendezvous_meet(viddec2->waitOnDecodeThread);
+    viddec2->codecStarting = FALSE;
 
-    if (viddec2->circBuf == NULL) {
-        GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
-        ("decode thread failed to create circbuf handles\n"),
-        (NULL));
-        return FALSE;
-    }
+    GST_INFO("waited %" GST_TIME_FORMAT " for the codec to start\n",
+        GST_TIME_ARGS(gst_util_get_timestamp() - waitStart));
 
-    GST_LOG("end init_video\n");
-    return TRUE;
+    return viddec2->circBuf != NULL;
 }
 
 
@@ -1178,6 +1777,11 @@ static gboolean gst_tividdec2_exit_video(GstTIViddec2 *viddec2)
         viddec2->sps_pps_data = NULL;
     }
 
+    if (viddec2->sps_pps_caps) {
+        gst_caps_unref(viddec2->sps_pps_caps);
+        viddec2->sps_pps_caps = NULL;
+    }
+
     if (viddec2->nal_code_prefix) {
         GST_LOG("freeing nal code prefix buffers\n");
         gst_buffer_unref(viddec2->nal_code_prefix);
@@ -1231,14 +1835,20 @@ static GstStateChangeReturn gst_tividdec2_change_state(GstElement *element,
     /* Handle ramp-down state changes */
     switch (transition) {
         case GST_STATE_CHANGE_READY_TO_NULL:
-            /* Shut down any running video decoder */
+            /* Shut down any running video decoder, and the one kept for
+             * reuse.
+             */
             if (!gst_tividdec2_exit_video(viddec2)) {
                 return GST_STATE_CHANGE_FAILURE;
             }
+            gst_tividdec2_free_parked(viddec2);
             break;
 
         case GST_STATE_CHANGE_READY_TO_PAUSED:
             gst_segment_init(viddec2->segment, GST_FORMAT_TIME);
+            gst_tividdec2_reset_qos(viddec2);
+            viddec2->framesDecoded    = 0;
+            viddec2->framesDropped    = 0;
             break;
 
         case GST_STATE_CHANGE_PAUSED_TO_READY:
@@ -1260,6 +1870,17 @@ static GstStateChangeReturn gst_tividdec2_change_state(GstElement *element,
  *****************************************************************************/
 static gboolean gst_tividdec2_codec_stop (GstTIViddec2  *viddec2)
 {
+    if (viddec2->frameTimeStamps) {
+        g_hash_table_destroy(viddec2->frameTimeStamps);
+        viddec2->frameTimeStamps = NULL;
+    }
+
+    /* Keep the codec for the next stream if we can */
+    if (gst_tividdec2_codec_park(viddec2)) {
+        gst_value_set_fraction(&viddec2->framerate, 0, 1);
+        return TRUE;
+    }
+
     if (viddec2->circBuf) {
         GstTICircBuffer *circBuf;
 
@@ -1286,137 +1907,349 @@ static gboolean gst_tividdec2_codec_stop (GstTIViddec2  *viddec2)
 
     if (viddec2->hEngine) {
         GST_LOG("closing codec engine\n");
-        Engine_close(viddec2->hEngine);
+        gst_tiengine_close(viddec2->hEngine);
         viddec2->hEngine = NULL;
     }
 
     return TRUE;
 }
 
+
 /******************************************************************************
- * gst_tividdec2_codec_start
- *     Initialize codec engine
+ * gst_tividdec2_codec_park
+ *    Keep the codec, circular buffer and output BufTab for the next call to
+ *    codec_start instead of deleting them.  Returns FALSE if reuseCodec is
+ *    off, the codec is writing to a downstream BufTab, or the decode thread
+ *    failed and the codec may be left in a bad state.
  *****************************************************************************/
-static gboolean gst_tividdec2_codec_start (GstTIViddec2  *viddec2,
-           GstBuffer **padBuffer)
+static gboolean gst_tividdec2_codec_park(GstTIViddec2 *viddec2)
 {
-    VIDDEC2_Params         params      = Vdec2_Params_DEFAULT;
-    VIDDEC2_DynamicParams  dynParams   = Vdec2_DynamicParams_DEFAULT;
-    BufferGfx_Attrs        gfxAttrs    = BufferGfx_Attrs_DEFAULT;
-    BufTab_Handle          codecBufTab = NULL;
-    Cpu_Device             device;
-    ColorSpace_Type        colorSpace;
-    Int                    defaultNumBufs;
-
-    /* Open the codec engine */
-    GST_LOG("opening codec engine \"%s\"\n", viddec2->engineName);
-    viddec2->hEngine = Engine_open((Char *) viddec2->engineName, NULL, NULL);
+    gboolean checkResult;
 
-    if (viddec2->hEngine == NULL) {
-        GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
-        ("failed to open codec engine \"%s\"\n", viddec2->engineName), (NULL));
+    if (!viddec2->reuseCodec || !viddec2->hVd || !viddec2->circBuf ||
+        !viddec2->hOutBufTab) {
         return FALSE;
     }
 
-    /* Determine which device the application is running on */
-    if (Cpu_getDevice(NULL, &device) < 0) {
-        GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
-        ("Failed to determine target board\n"), (NULL));
+    if (gst_tithread_check_status(viddec2, TIThread_CODEC_ABORTED,
+            checkResult)) {
+        GST_LOG("not keeping video decoder after a decode failure\n");
         return FALSE;
     }
 
-    /* Set up codec parameters depending on device */
-    switch(device) {
-        case Cpu_Device_DM6467:
-            #if defined(Platform_dm6467t)
-            params.forceChromaFormat = XDM_YUV_420SP;
-            params.maxFrameRate      = 60000;
-            params.maxBitRate        = 30000000;
-            #else
-            params.forceChromaFormat = XDM_YUV_420P;
-            #endif
-            params.maxWidth          = VideoStd_1080I_WIDTH;
-            params.maxHeight         = VideoStd_1080I_HEIGHT + 8;
-            colorSpace               = ColorSpace_YUV420PSEMI;
-            defaultNumBufs           = 5;
-            break;
-        #if defined(Platform_dm365)
-        case Cpu_Device_DM365:
-            params.forceChromaFormat = XDM_YUV_420SP;
-            params.maxWidth          = VideoStd_720P_WIDTH;
-            params.maxHeight         = VideoStd_720P_HEIGHT;
-            colorSpace               = ColorSpace_YUV420PSEMI;
-            defaultNumBufs           = 4;
-            break;
-        #endif
-        #if defined(Platform_dm368)
-        case Cpu_Device_DM368:
-            params.forceChromaFormat = XDM_YUV_420SP;
-            params.maxWidth          = VideoStd_720P_WIDTH;
-            params.maxHeight         = VideoStd_720P_HEIGHT;
-            colorSpace               = ColorSpace_YUV420PSEMI;
-            defaultNumBufs           = 4;
-            break;
-        #endif
-        #if defined(Platform_omapl138)
-        case Cpu_Device_OMAPL138:
-            params.forceChromaFormat = XDM_YUV_420P;
-            params.maxWidth          = VideoStd_D1_WIDTH;
-            params.maxHeight         = VideoStd_D1_PAL_HEIGHT;
-            colorSpace               = ColorSpace_YUV420P;
-            defaultNumBufs           = 3;
-            break;
-        #endif
-        #if defined(Platform_dm3730)
-        case Cpu_Device_DM3730:
-            params.maxWidth          = VideoStd_720P_WIDTH;
-            params.maxHeight         = VideoStd_720P_HEIGHT;
-            params.forceChromaFormat = XDM_YUV_422ILE;
-            colorSpace               = ColorSpace_UYVY;
-            defaultNumBufs           = 3;
-            break;
-        #endif
-        default:
-            params.forceChromaFormat = XDM_YUV_422ILE;
-            params.maxWidth          = VideoStd_D1_WIDTH;
-            params.maxHeight         = VideoStd_D1_PAL_HEIGHT;
-            colorSpace               = ColorSpace_UYVY;
-            defaultNumBufs           = 3;
-            break;
-    }
+    /* Only one codec is kept */
+    gst_tividdec2_free_parked(viddec2);
 
-    /* If height and width is passed then configure codec params with this information */
-    if (viddec2->width > 0 && viddec2->height > 0) {
-        params.maxWidth = viddec2->width;
-        params.maxHeight = viddec2->height;
-    }
+    GST_LOG("keeping video decoder \"%s\" for reuse\n", viddec2->codecName);
 
-    GST_LOG("opening video decoder \"%s\"\n", viddec2->codecName);
-    viddec2->hVd = Vdec2_create(viddec2->hEngine, (Char*)viddec2->codecName,
-                      &params, &dynParams);
+    viddec2->hParkedEngine    = viddec2->hEngine;
+    viddec2->hParkedVd        = viddec2->hVd;
+    viddec2->parkedCircBuf    = viddec2->circBuf;
+    viddec2->hParkedOutBufTab = viddec2->hOutBufTab;
+    viddec2->parkedEngineName = g_strdup(viddec2->engineName);
+    viddec2->parkedCodecName  = g_strdup(viddec2->codecName);
+    gst_tiengine_park(viddec2->hParkedEngine);
 
-    if (viddec2->hVd == NULL) {
-        GST_ELEMENT_ERROR(viddec2, STREAM, CODEC_NOT_FOUND,
-        ("failed to create video decoder: %s\n", viddec2->codecName), (NULL));
-        GST_LOG("closing codec engine\n");
-        return FALSE;
-    }
+    viddec2->hEngine          = NULL;
+    viddec2->hVd              = NULL;
+    viddec2->circBuf          = NULL;
+    viddec2->hOutBufTab       = NULL;
 
-    /* Record that we haven't processed the first frame yet */
-    viddec2->firstFrame = TRUE;
+    return TRUE;
+}
 
-    /* Create a circular input buffer */
-    viddec2->circBuf =
-        gst_ticircbuffer_new(Vdec2_getInBufSize(viddec2->hVd), 3, FALSE);
 
-    if (viddec2->circBuf == NULL) {
-        GST_ELEMENT_ERROR(viddec2, RESOURCE, NO_SPACE_LEFT,
-        ("failed to create circular input buffer\n"), (NULL));
+/******************************************************************************
+ * gst_tividdec2_codec_unpark
+ *    Take back the codec kept by codec_park if it is the same codec, can
+ *    decode pictures of the size in params and outputs colorSpace, and reset
+ *    it for a new stream.  Returns FALSE, after freeing the kept codec if
+ *    there was one, if codec_start has to create a new one.
+ *****************************************************************************/
+static gboolean gst_tividdec2_codec_unpark(GstTIViddec2 *viddec2,
+                    VIDDEC2_Params *params, ColorSpace_Type colorSpace,
+                    Int numBufs)
+{
+    BufTab_Handle hBufTab;
+
+    if (!viddec2->hParkedVd) {
         return FALSE;
     }
 
-    /* Display buffer contents if displayBuffer=TRUE was specified */
-    gst_ticircbuffer_set_display(viddec2->circBuf, viddec2->displayBuffer);
+    /* A downstream BufTab can't be combined with our own */
+    if (!viddec2->reuseCodec || viddec2->padAllocOutbufs ||
+        strcmp(viddec2->parkedEngineName, viddec2->engineName) ||
+        strcmp(viddec2->parkedCodecName, viddec2->codecName) ||
+        params->maxWidth  > viddec2->codecMaxWidth  ||
+        params->maxHeight > viddec2->codecMaxHeight ||
+        colorSpace != viddec2->codecColorSpace ||
+        !gst_tiengine_unpark(viddec2->hParkedEngine)) {
+        GST_INFO("can't reuse video decoder \"%s\" (%dx%d) for \"%s\" "
+            "(%dx%d)\n", viddec2->parkedCodecName, viddec2->codecMaxWidth,
+            viddec2->codecMaxHeight, viddec2->codecName,
+            (gint)params->maxWidth, (gint)params->maxHeight);
+        gst_tividdec2_free_parked(viddec2);
+        return FALSE;
+    }
+
+    GST_INFO("reusing video decoder \"%s\"\n", viddec2->codecName);
+
+    viddec2->hEngine          = viddec2->hParkedEngine;
+    viddec2->hVd              = viddec2->hParkedVd;
+    viddec2->circBuf          = viddec2->parkedCircBuf;
+    viddec2->hOutBufTab       = viddec2->hParkedOutBufTab;
+
+    viddec2->hParkedEngine    = NULL;
+    viddec2->hParkedVd        = NULL;
+    viddec2->parkedCircBuf    = NULL;
+    viddec2->hParkedOutBufTab = NULL;
+    gst_tividdec2_free_parked(viddec2);
+
+    /* Forget the last stream */
+    gst_ticircbuffer_reset(viddec2->circBuf);
+    gst_tividdec2_codec_flush(viddec2, FALSE);
+
+    /* Replace the output buffers if resizeBufTab cut them down to the last
+     * stream's picture size, or there are now too few of them.
+     */
+    hBufTab = GST_TIDMAIBUFTAB_BUFTAB(viddec2->hOutBufTab);
+    if (Buffer_getSize(BufTab_getBuf(hBufTab, 0)) < viddec2->outBufSize ||
+        BufTab_getNumBufs(hBufTab) < numBufs) {
+        GST_LOG("replacing output buffer table\n");
+        gst_tidmaibuftab_unref(viddec2->hOutBufTab);
+        viddec2->hOutBufTab = NULL;
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_free_parked
+ *    Delete the codec kept by codec_park, if any.
+ *****************************************************************************/
+static void gst_tividdec2_free_parked(GstTIViddec2 *viddec2)
+{
+    if (viddec2->parkedCircBuf) {
+        gst_ticircbuffer_unref(viddec2->parkedCircBuf);
+        viddec2->parkedCircBuf = NULL;
+    }
+
+    if (viddec2->hParkedOutBufTab) {
+        gst_tidmaibuftab_unref(viddec2->hParkedOutBufTab);
+        viddec2->hParkedOutBufTab = NULL;
+    }
+
+    if (viddec2->hParkedVd) {
+        GST_LOG("closing kept video decoder\n");
+        Vdec2_delete(viddec2->hParkedVd);
+        viddec2->hParkedVd = NULL;
+    }
+
+    if (viddec2->hParkedEngine) {
+        gst_tiengine_close_parked(viddec2->hParkedEngine);
+        viddec2->hParkedEngine = NULL;
+    }
+
+    g_free(viddec2->parkedEngineName);
+    g_free(viddec2->parkedCodecName);
+    viddec2->parkedEngineName = NULL;
+    viddec2->parkedCodecName  = NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_codec_flush
+ *    Discard the frames held by the codec and reset it, so decoding can
+ *    resume at a new stream position without re-creating the codec.  Called
+ *    by the decode thread during a flushing seek, and with pushFrames set
+ *    after each keyframe in keyframesOnly mode to output the held frames
+ *    instead.  Returns FALSE if pushing them failed.
+ *****************************************************************************/
+static gboolean gst_tividdec2_codec_flush (GstTIViddec2  *viddec2,
+                    gboolean pushFrames)
+{
+    VIDDEC2_DynamicParams  dynParams = Vdec2_DynamicParams_DEFAULT;
+    VIDDEC2_Status         decStatus;
+    Buffer_Attrs           bAttrs    = Buffer_Attrs_DEFAULT;
+    BufTab_Handle          hBufTab;
+    Buffer_Handle          hDummyInputBuf;
+    Buffer_Handle          hDstBuf;
+    Int                    bufIdx;
+    gboolean               ret       = TRUE;
+
+    GST_LOG("flushing video decoder\n");
+
+    if (viddec2->hOutBufTab) {
+        hBufTab = GST_TIDMAIBUFTAB_BUFTAB(viddec2->hOutBufTab);
+
+        /* Make the codec give back the frames it holds for display.  After
+         * a flush the codec ignores the input buffer, but it has to exist.
+         */
+        Vdec2_flush(viddec2->hVd);
+
+        hDummyInputBuf = Buffer_create(1, &bAttrs);
+        Buffer_setNumBytesUsed(hDummyInputBuf, 1);
+
+        if ((hDstBuf = BufTab_getFreeBuf(hBufTab))) {
+            BufferGfx_resetDimensions(hDstBuf);
+            if (Vdec2_process(viddec2->hVd, hDummyInputBuf, hDstBuf) < 0) {
+                BufTab_freeBuf(hDstBuf);
+            }
+        }
+        Buffer_delete(hDummyInputBuf);
+
+        /* Drop them unless asked to push them downstream */
+        if (pushFrames) {
+            ret = gst_tividdec2_push_display_bufs(viddec2,
+                      gst_tividdec2_frame_duration(viddec2));
+        }
+        while ((hDstBuf = Vdec2_getDisplayBuf(viddec2->hVd))) {
+            gst_buffer_unref(
+                gst_tidmaibuffertransport_new(hDstBuf, viddec2->hOutBufTab));
+        }
+    }
+
+    /* Reset the codec so it no longer references frames from before the
+     * seek.
+     */
+    decStatus.size            = sizeof(VIDDEC2_Status);
+    decStatus.data.buf        = NULL;
+    decStatus.data.bufSize    = 0;
+
+    if (VIDDEC2_control(Vdec2_getVisaHandle(viddec2->hVd), XDM_RESET,
+            &dynParams, &decStatus) != VIDDEC2_EOK) {
+        GST_WARNING("failed to reset video decoder\n");
+    }
+
+    /* Re-claim any buffers owned by the codec */
+    if (viddec2->hOutBufTab) {
+        bufIdx = BufTab_getNumBufs(hBufTab);
+
+        while (bufIdx-- > 0) {
+            gst_tidmaibuftab_free_use_mask(viddec2->hOutBufTab,
+                BufTab_getBuf(hBufTab, bufIdx), gst_tidmaibuffer_CODEC_FREE);
+        }
+    }
+
+    g_hash_table_remove_all(viddec2->frameTimeStamps);
+
+    return ret;
+}
+
+/******************************************************************************
+ * gst_tividdec2_get_codec_params
+ *    Fill in the codec creation parameters, output colorspace and default
+ *    number of output buffers for the device we are running on.
+ ******************************************************************************/
+static gboolean gst_tividdec2_get_codec_params(GstTIViddec2 *viddec2,
+                    VIDDEC2_Params *params, ColorSpace_Type *colorSpace,
+                    Int *defaultNumBufs)
+{
+    Cpu_Device device;
+
+    /* Determine which device the application is running on */
+    if (Cpu_getDevice(NULL, &device) < 0) {
+        GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
+        ("Failed to determine target board\n"), (NULL));
+        return FALSE;
+    }
+
+    /* Set up codec parameters depending on device */
+    switch(device) {
+        case Cpu_Device_DM6467:
+            #if defined(Platform_dm6467t)
+            params->forceChromaFormat = XDM_YUV_420SP;
+            params->maxFrameRate      = 60000;
+            params->maxBitRate        = 30000000;
+            #else
+            params->forceChromaFormat = XDM_YUV_420P;
+            #endif
+            params->maxWidth          = VideoStd_1080I_WIDTH;
+            params->maxHeight         = VideoStd_1080I_HEIGHT + 8;
+            *colorSpace               = ColorSpace_YUV420PSEMI;
+            *defaultNumBufs           = 5;
+            break;
+        #if defined(Platform_dm365)
+        case Cpu_Device_DM365:
+            params->forceChromaFormat = XDM_YUV_420SP;
+            params->maxWidth          = VideoStd_720P_WIDTH;
+            params->maxHeight         = VideoStd_720P_HEIGHT;
+            *colorSpace               = ColorSpace_YUV420PSEMI;
+            *defaultNumBufs           = 4;
+            break;
+        #endif
+        #if defined(Platform_dm368)
+        case Cpu_Device_DM368:
+            params->forceChromaFormat = XDM_YUV_420SP;
+            params->maxWidth          = VideoStd_720P_WIDTH;
+            params->maxHeight         = VideoStd_720P_HEIGHT;
+            *colorSpace               = ColorSpace_YUV420PSEMI;
+            *defaultNumBufs           = 4;
+            break;
+        #endif
+        #if defined(Platform_omapl138)
+        case Cpu_Device_OMAPL138:
+            params->forceChromaFormat = XDM_YUV_420P;
+            params->maxWidth          = VideoStd_D1_WIDTH;
+            params->maxHeight         = VideoStd_D1_PAL_HEIGHT;
+            *colorSpace               = ColorSpace_YUV420P;
+            *defaultNumBufs           = 3;
+            break;
+        #endif
+        #if defined(Platform_dm3730)
+        case Cpu_Device_DM3730:
+            params->maxWidth          = VideoStd_720P_WIDTH;
+            params->maxHeight         = VideoStd_720P_HEIGHT;
+            params->forceChromaFormat = XDM_YUV_422ILE;
+            *colorSpace               = ColorSpace_UYVY;
+            *defaultNumBufs           = 3;
+            break;
+        #endif
+        default:
+            params->forceChromaFormat = XDM_YUV_422ILE;
+            params->maxWidth          = VideoStd_D1_WIDTH;
+            params->maxHeight         = VideoStd_D1_PAL_HEIGHT;
+            *colorSpace               = ColorSpace_UYVY;
+            *defaultNumBufs           = 3;
+            break;
+    }
+
+    /* If height and width is passed then configure codec params with this information */
+    if (viddec2->width > 0 && viddec2->height > 0) {
+        params->maxWidth = viddec2->width;
+        params->maxHeight = viddec2->height;
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_codec_start
+ *     Initialize codec engine
+ *****************************************************************************/
+static gboolean gst_tividdec2_codec_start (GstTIViddec2  *viddec2,
+           GstBuffer **padBuffer)
+{
+    VIDDEC2_Params         params      = Vdec2_Params_DEFAULT;
+    VIDDEC2_DynamicParams  dynParams   = Vdec2_DynamicParams_DEFAULT;
+    BufferGfx_Attrs        gfxAttrs    = BufferGfx_Attrs_DEFAULT;
+    BufTab_Handle          codecBufTab = NULL;
+    ColorSpace_Type        colorSpace;
+    Int                    defaultNumBufs;
+    GstClockTime           startTime   = gst_util_get_timestamp();
+    gboolean               reused;
+
+    /* Create the table used to carry input timestamps to decoded frames */
+    viddec2->frameTimeStamps = g_hash_table_new_full(g_direct_hash,
+                                   g_direct_equal, NULL, g_free);
+
+    /* Choose the codec parameters and output format for this device */
+    if (!gst_tividdec2_get_codec_params(viddec2, &params, &colorSpace,
+            &defaultNumBufs)) {
+        return FALSE;
+    }
 
     /* Define the number of display buffers to allocate.  This number must be
      * at least 2, but should be more if codecs don't return a display buffer
@@ -1427,6 +2260,92 @@ static gboolean gst_tividdec2_codec_start (GstTIViddec2  *viddec2,
         viddec2->numOutputBufs = defaultNumBufs;
     }
 
+    /* Reuse the codec kept from the last stream if this one fits it */
+    reused = gst_tividdec2_codec_unpark(viddec2, &params, colorSpace,
+                 viddec2->numOutputBufs);
+    if (!reused) {
+
+        /* Open the codec engine */
+        GST_LOG("opening codec engine \"%s\"\n", viddec2->engineName);
+        viddec2->hEngine = gst_tiengine_open(viddec2->engineName);
+
+        if (viddec2->hEngine == NULL) {
+            GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
+            ("failed to open codec engine \"%s\"\n", viddec2->engineName),
+            (NULL));
+            return FALSE;
+        }
+
+        GST_LOG("opening video decoder \"%s\"\n", viddec2->codecName);
+        viddec2->hVd = Vdec2_create(viddec2->hEngine,
+                          (Char*)viddec2->codecName, &params, &dynParams);
+
+        if (viddec2->hVd == NULL) {
+            GST_ELEMENT_ERROR(viddec2, STREAM, CODEC_NOT_FOUND,
+            ("failed to create video decoder: %s\n", viddec2->codecName),
+            (NULL));
+            GST_LOG("closing codec engine\n");
+            return FALSE;
+        }
+
+        /* Remember the largest picture this codec instance can decode */
+        viddec2->codecMaxWidth   = params.maxWidth;
+        viddec2->codecMaxHeight  = params.maxHeight;
+        viddec2->codecColorSpace = colorSpace;
+        viddec2->outBufSize      = Vdec2_getOutBufSize(viddec2->hVd);
+
+        /* Create a circular input buffer.  A mirrored buffer doesn't need
+         * the extra window used for shifting data.
+         */
+        if (viddec2->mirrorInputBuffer) {
+            viddec2->circBuf = gst_ticircbuffer_new_mirrored(
+                                   Vdec2_getInBufSize(viddec2->hVd), 2);
+        }
+        else {
+            viddec2->circBuf = gst_ticircbuffer_new(
+                                   Vdec2_getInBufSize(viddec2->hVd), 3, FALSE);
+        }
+
+        if (viddec2->circBuf == NULL) {
+            GST_ELEMENT_ERROR(viddec2, RESOURCE, NO_SPACE_LEFT,
+            ("failed to create circular input buffer\n"), (NULL));
+            return FALSE;
+        }
+    }
+
+    viddec2->streamWidth    = 0;
+    viddec2->streamHeight   = 0;
+
+    /* Record that we haven't processed the first frame yet */
+    viddec2->firstFrame = TRUE;
+
+    /* Display buffer contents if displayBuffer=TRUE was specified */
+    gst_ticircbuffer_set_display(viddec2->circBuf, viddec2->displayBuffer);
+
+    /* Pass whole-frame DMAI input buffers to the codec without copying */
+    gst_ticircbuffer_set_zero_copy(viddec2->circBuf, viddec2->zeroCopyInput);
+
+    /* Choose how to skip corrupt input, and how to find the first frame */
+    viddec2->keyframeFinder = gst_tividdec2_get_keyframe_finder(viddec2);
+    viddec2->syncFinder     = gst_tividdec2_get_sync_finder(viddec2);
+    viddec2->isDroppable    = gst_tividdec2_get_droppable_check(viddec2);
+    viddec2->sizeParser     = gst_tividdec2_get_size_parser(viddec2);
+
+    if (viddec2->fastStart && !viddec2->keyframeFinder) {
+        GST_WARNING("fastStart is not supported by %s\n", viddec2->codecName);
+    }
+    if (viddec2->keyframesOnly && !viddec2->keyframeFinder) {
+        GST_WARNING("keyframesOnly is not supported by %s\n",
+            viddec2->codecName);
+    }
+    gst_tividdec2_start_first_frame(viddec2);
+
+    /* Hand the codec one access unit at a time if requested */
+    if (viddec2->frameInput) {
+        gst_ticircbuffer_set_framer(viddec2->circBuf,
+            gst_tividdec2_get_framer(viddec2));
+    }
+
     /* Try to allocate a buffer from downstream.  To do this, we must first
      * set the framerate to a reasonable default if one hasn't been specified,
      * and we need to set the source pad caps with the stream information we
@@ -1466,9 +2385,12 @@ static gboolean gst_tividdec2_codec_start (GstTIViddec2  *viddec2,
     }
 
     /* If we can't use pad-allocated buffers, allocate our own BufTab for
-     * output buffers to push downstream.
+     * output buffers to push downstream, unless we are reusing one.
      */
-    if (!(*padBuffer)) {
+    if (!(*padBuffer) && viddec2->hOutBufTab) {
+        codecBufTab = GST_TIDMAIBUFTAB_BUFTAB(viddec2->hOutBufTab);
+    }
+    else if (!(*padBuffer)) {
 
         GST_LOG("creating output buffer table\n");
         gfxAttrs.colorSpace     = colorSpace;
@@ -1481,8 +2403,10 @@ static gboolean gst_tividdec2_codec_start (GstTIViddec2  *viddec2,
         gfxAttrs.bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
 
         viddec2->hOutBufTab = gst_tidmaibuftab_new(
-            viddec2->numOutputBufs, Vdec2_getOutBufSize(viddec2->hVd),
+            viddec2->numOutputBufs, viddec2->outBufSize,
             BufferGfx_getBufferAttrs(&gfxAttrs));
+        gst_tidmaibuftab_set_name(viddec2->hOutBufTab,
+            GST_ELEMENT_NAME(viddec2));
 
         codecBufTab = GST_TIDMAIBUFTAB_BUFTAB(viddec2->hOutBufTab);
     }
@@ -1499,6 +2423,10 @@ static gboolean gst_tividdec2_codec_start (GstTIViddec2  *viddec2,
     /* Tell the Vdec module what BufTab it will be using for its output */
     Vdec2_setBufTab(viddec2->hVd, codecBufTab);
 
+    GST_INFO("%s video decoder \"%s\" in %" GST_TIME_FORMAT "\n",
+        reused ? "reused" : "created", viddec2->codecName,
+        GST_TIME_ARGS(gst_util_get_timestamp() - startTime));
+
     return TRUE;
 }
 
@@ -1525,7 +2453,6 @@ static void* gst_tividdec2_decode_thread(void *arg)
     GstClockTime   encDataTime;
     GstClockTime   frameDuration;
     Buffer_Handle  hEncDataWindow;
-    GstBuffer     *outBuf;
     Int            bufIdx;
     Int            ret, codecRet;
 
@@ -1535,6 +2462,10 @@ static void* gst_tividdec2_decode_thread(void *arg)
     ret = gst_tividdec2_codec_start(viddec2, &padBuffer);
     usePadBufs = (padBuffer != NULL);
 
+    if (ret) {
+        gst_tividdec2_post_codec_ready(viddec2);
+    }
+
     /* Notify main thread that is ok to continue initialization */
     Rendezvous_meet(viddec2->waitOnDecodeThread);
     Rendezvous_reset(viddec2->waitOnDecodeThread);
@@ -1548,11 +2479,29 @@ static void* gst_tividdec2_decode_thread(void *arg)
     /* Calculate the duration of a single frame in this stream */
     frameDuration = gst_tividdec2_frame_duration(viddec2);
 
+    /* Hand decoded frames to a separate thread for pushing if requested */
+    if (viddec2->outputQueue && !gst_tividdec2_start_push_thread(viddec2)) {
+        GST_ELEMENT_ERROR(viddec2, RESOURCE, FAILED,
+        ("failed to create output queue thread\n"), (NULL));
+        goto thread_failure;
+    }
+
     /* Main thread loop */
     while (TRUE) {
 
         /* Obtain an encoded data frame */
         encDataWindow  = gst_ticircbuffer_get_data(viddec2->circBuf);
+
+        /* A seek is flushing the pipeline.  Drop what the codec holds, then
+         * wait for data from the new position.
+         */
+        if (encDataWindow == NULL) {
+            gst_tividdec2_flush_output(viddec2);
+            gst_tividdec2_codec_flush(viddec2, FALSE);
+            gst_tividdec2_start_first_frame(viddec2);
+            continue;
+        }
+
         encDataTime    = GST_BUFFER_TIMESTAMP(encDataWindow);
         hEncDataWindow = GST_TIDMAIBUFFERTRANSPORT_DMAIBUF(encDataWindow);
 
@@ -1588,6 +2537,44 @@ static void* gst_tividdec2_decode_thread(void *arg)
             }
         }
 
+        /* Drop frames that downstream would discard as late anyway */
+        if (!codecFlushed &&
+            gst_tividdec2_qos_drop(viddec2, encDataWindow, frameDuration)) {
+            encDataWindow = NULL;
+            continue;
+        }
+
+        /* In fast start mode, or when far behind, drop input until the next
+         * keyframe.
+         */
+        if (viddec2->waitForKeyframe && !codecFlushed &&
+            !gst_tividdec2_skip_to_keyframe(viddec2, encDataWindow)) {
+            encDataWindow = NULL;
+            continue;
+        }
+
+        /* In keyframesOnly mode, thin out keyframes that are too close */
+        if (viddec2->keyframesOnly && viddec2->keyframeFinder &&
+            !codecFlushed &&
+            gst_tividdec2_skip_keyframe(viddec2, encDataWindow)) {
+            encDataWindow = NULL;
+            continue;
+        }
+
+        /* Adapt to a new picture size before the codec sees the sequence
+         * header announcing it.
+         */
+        if (!codecFlushed && viddec2->sizeParser &&
+            !gst_tividdec2_check_size(viddec2, encDataWindow, &usePadBufs)) {
+            goto thread_failure;
+        }
+
+        /* A downstream buffer sized for the old picture is no use now */
+        if (!usePadBufs && padBuffer) {
+            gst_buffer_unref(padBuffer);
+            padBuffer = NULL;
+        }
+
         /* Obtain a free output buffer for the decoded data */
         if (usePadBufs) {
 
@@ -1599,9 +2586,21 @@ static void* gst_tividdec2_decode_thread(void *arg)
                 if (gst_pad_alloc_buffer(viddec2->srcpad, 0, 0,
                         GST_PAD_CAPS(viddec2->srcpad), &padBuffer)
                         != GST_FLOW_OK) {
+                    padBuffer = NULL;
+
+                    /* Downstream refuses to allocate while a seek is
+                     * flushing; give the window back and pick up the
+                     * flush on the next get_data.
+                     */
+                    if (gst_ticircbuffer_is_flushing(viddec2->circBuf)) {
+                        gst_ticircbuffer_data_consumed(viddec2->circBuf,
+                            encDataWindow, 0);
+                        encDataWindow = NULL;
+                        continue;
+                    }
+
                     GST_ELEMENT_ERROR(viddec2, RESOURCE, READ,
                         ("failed to allocate a downstream buffer\n"), (NULL));
-                    padBuffer = NULL;
                     goto thread_exit;
                 }
             }
@@ -1633,7 +2632,7 @@ static void* gst_tividdec2_decode_thread(void *arg)
                           Buffer_getNumBytesUsed(hEncDataWindow);
 
         if (codecRet < 0) {
-            if (encDataConsumed <= 0) {
+            if (encDataConsumed <= 0 && !viddec2->syncFinder) {
                 encDataConsumed = 1;
             }
 
@@ -1650,8 +2649,11 @@ static void* gst_tividdec2_decode_thread(void *arg)
             if (codecRet == Dmai_EBITERROR) {
                 BufTab_freeBuf(hDstBuf);
 
-                /* If no encoded data was used we cannot find the next frame */
-                if (encDataConsumed == 0 && !codecFlushed) {
+                /* If no encoded data was used we cannot find the next frame,
+                 * unless we search for it ourselves.
+                 */
+                if (encDataConsumed == 0 && !codecFlushed &&
+                    !viddec2->syncFinder) {
                     GST_ELEMENT_ERROR(viddec2, STREAM, DECODE,
                     ("fatal bit error\n"), (NULL));
                     goto thread_failure;
@@ -1659,6 +2661,15 @@ static void* gst_tividdec2_decode_thread(void *arg)
             }
         }
 
+        /* Skip ahead to where the codec can pick up the stream again,
+         * rather than retrying one byte further on each time.
+         */
+        if ((codecRet < 0 || codecRet == Dmai_EBITERROR) && !codecFlushed &&
+            viddec2->syncFinder) {
+            encDataConsumed = gst_tividdec2_resync(viddec2, encDataWindow,
+                                  MAX(encDataConsumed, 0));
+        }
+
         /* Increment total bytes recieved */
         viddec2->totalBytes += encDataConsumed;
 
@@ -1680,6 +2691,16 @@ static void* gst_tividdec2_decode_thread(void *arg)
             continue;
         }
 
+        if (!codecFlushed) {
+            viddec2->framesDecoded++;
+        }
+
+        /* Remember the input timestamp of the frame we just decoded so it
+         * can be applied when the codec releases this buffer for display.
+         */
+        gst_tividdec2_set_frame_timestamp(viddec2, hDstBuf,
+            GST_TICIRCBUFFER_CONSUMED_TIMESTAMP(viddec2->circBuf));
+
         /* Resize the BufTab after the first frame has been processed.  The
          * codec may not know it's buffer requirements before the first frame
          * has been decoded.
@@ -1694,64 +2715,31 @@ static void* gst_tividdec2_decode_thread(void *arg)
             viddec2->firstFrame = FALSE;
         }
 
-        /* Obtain the display buffer returned by the codec (it may be a
-         * different one than the one we passed it.
-         */
-        hDstBuf = Vdec2_getDisplayBuf(viddec2->hVd);
-
-        /* If we were given back decoded frame, push it to the source pad */
-        while (hDstBuf) {
-
-            /* Set the source pad capabilities based on the decoded frame
-             * properties.
-             */
-            gst_tividdec2_set_source_caps(viddec2, hDstBuf);
-
-            /* Create a DMAI transport buffer object to carry a DMAI buffer to
-             * the source pad.  The transport buffer knows how to release the
-             * buffer for re-use in this element when the source pad calls
-             * gst_buffer_unref().
-             */
-            outBuf = gst_tidmaibuffertransport_new(
-                hDstBuf, viddec2->hOutBufTab);
-            gst_buffer_set_data(outBuf, GST_BUFFER_DATA(outBuf),
-                gst_ti_correct_display_bufSize(hDstBuf));
-            gst_buffer_set_caps(outBuf, GST_PAD_CAPS(viddec2->srcpad));
-
-            /* Set output buffer timestamp */ 
-            if (viddec2->genTimeStamps) {
-                GST_BUFFER_TIMESTAMP(outBuf) = viddec2->totalDuration;
-                GST_BUFFER_DURATION(outBuf)  = frameDuration; 
-                viddec2->totalDuration       += GST_BUFFER_DURATION(outBuf);
-            }
-            else {
-                GST_BUFFER_TIMESTAMP(outBuf) = GST_CLOCK_TIME_NONE;
-            }
-
-            /* Tell circular buffer how much time we consumed */
-            gst_ticircbuffer_time_consumed(viddec2->circBuf, frameDuration);
-
-            /* Push the transport buffer to the source pad */
-            GST_LOG("pushing buffer to source pad with timestamp : %" 
-                    GST_TIME_FORMAT ", duration: %" GST_TIME_FORMAT,
-                    GST_TIME_ARGS (GST_BUFFER_TIMESTAMP(outBuf)),
-                    GST_TIME_ARGS (GST_BUFFER_DURATION(outBuf)));
-
-            if (gst_pad_push(viddec2->srcpad, outBuf) != GST_FLOW_OK) {
-                GST_DEBUG("push to source pad failed\n");
-                goto thread_failure;
-            }
-
-            hDstBuf = Vdec2_getDisplayBuf(viddec2->hVd);
+        /* Push the frames the codec is done with to the source pad */
+        if (!gst_tividdec2_push_display_bufs(viddec2, frameDuration)) {
+            goto thread_failure;
         }
 
         /* Release buffers no longer in use by the codec */
         hFreeBuf = Vdec2_getFreeBuf(viddec2->hVd);
         while (hFreeBuf) {
-            Buffer_freeUseMask(hFreeBuf, gst_tidmaibuffer_CODEC_FREE);
+            gst_tidmaibuftab_free_use_mask(viddec2->hOutBufTab, hFreeBuf,
+                gst_tidmaibuffer_CODEC_FREE);
             hFreeBuf = Vdec2_getFreeBuf(viddec2->hVd);
         }
 
+        /* In keyframesOnly mode, get the keyframe out of the codec now and
+         * reset it, so the next keyframe is decoded on its own and the input
+         * up to it can be dropped.
+         */
+        if (viddec2->keyframesOnly && viddec2->keyframeFinder &&
+            !codecFlushed) {
+            if (!gst_tividdec2_codec_flush(viddec2, TRUE)) {
+                goto thread_failure;
+            }
+            viddec2->waitForKeyframe = TRUE;
+        }
+
     }
 
 thread_failure:
@@ -1762,6 +2750,18 @@ thread_failure:
 
 thread_exit:
 
+    /* Push what is left in the output queue, unless we failed */
+    if (threadRet == GstTIThreadFailure) {
+        gst_tividdec2_flush_output(viddec2);
+    }
+    gst_tividdec2_stop_push_thread(viddec2);
+
+    /* Drop a downstream buffer the loop never got to use */
+    if (padBuffer) {
+        gst_buffer_unref(padBuffer);
+        padBuffer = NULL;
+    }
+
     /* Re-claim any buffers owned by the codec */
     if (viddec2->hOutBufTab) {
         bufIdx =
@@ -1770,7 +2770,8 @@ thread_exit:
         while (bufIdx-- > 0) {
             Buffer_Handle hBuf = BufTab_getBuf(
                 GST_TIDMAIBUFTAB_BUFTAB(viddec2->hOutBufTab), bufIdx);
-            Buffer_freeUseMask(hBuf, gst_tidmaibuffer_CODEC_FREE);
+            gst_tidmaibuftab_free_use_mask(viddec2->hOutBufTab, hBuf,
+                gst_tidmaibuffer_CODEC_FREE);
         }
     }
 
@@ -1808,18 +2809,314 @@ thread_exit:
 
 
 /******************************************************************************
- * gst_tividdec2_drain_pipeline
- *    Wait for the decode thread to finish processing queued input data.
+ * gst_tividdec2_push_display_bufs
+ *    Push every buffer the codec has released for display to the source pad.
+ *    Returns FALSE if downstream refused a buffer other than while flushing.
  ******************************************************************************/
-static void gst_tividdec2_drain_pipeline(GstTIViddec2 *viddec2)
+static gboolean gst_tividdec2_push_display_bufs(GstTIViddec2 *viddec2,
+                    GstClockTime frameDuration)
 {
-    gboolean checkResult;
+    Buffer_Handle  hDstBuf;
+    GstClockTime   encDataTime;
+    GstBuffer     *outBuf;
 
-    /* If the decode thread hasn't been created, there is nothing to drain. */
-    if (!gst_tithread_check_status(
-             viddec2, TIThread_CODEC_CREATED, checkResult)) {
-        return;
-    }
+    /* Obtain the display buffer returned by the codec (it may be a
+     * different one than the one we passed it.
+     */
+    hDstBuf = Vdec2_getDisplayBuf(viddec2->hVd);
+
+    /* If we were given back decoded frame, push it to the source pad */
+    while (hDstBuf) {
+
+        /* A frame that comes out while a seek is flushing was decoded from
+         * input before the seek, so it is dropped.
+         */
+        if (gst_ticircbuffer_is_flushing(viddec2->circBuf)) {
+            GST_LOG("dropping frame decoded before the seek\n");
+            gst_buffer_unref(
+                gst_tidmaibuffertransport_new(hDstBuf, viddec2->hOutBufTab));
+            hDstBuf = Vdec2_getDisplayBuf(viddec2->hVd);
+            continue;
+        }
+
+        /* Set the source pad capabilities based on the decoded frame
+         * properties.
+         */
+        gst_tividdec2_set_source_caps(viddec2, hDstBuf);
+
+        /* Create a DMAI transport buffer object to carry a DMAI buffer to
+         * the source pad.  The transport buffer knows how to release the
+         * buffer for re-use in this element when the source pad calls
+         * gst_buffer_unref().
+         */
+        outBuf = gst_tidmaibuffertransport_new(
+            hDstBuf, viddec2->hOutBufTab);
+        gst_buffer_set_data(outBuf, GST_BUFFER_DATA(outBuf),
+            gst_ti_correct_display_bufSize(hDstBuf));
+        gst_buffer_set_caps(outBuf, GST_PAD_CAPS(viddec2->srcpad));
+
+        /* Set output buffer timestamp.  Use the upstream timestamp of
+         * the frame if there was one, and synthesize timestamps from
+         * there otherwise.
+         */ 
+        if (viddec2->genTimeStamps) {
+            encDataTime = gst_tividdec2_get_frame_timestamp(viddec2,
+                              hDstBuf);
+            if (GST_CLOCK_TIME_IS_VALID(encDataTime)) {
+                viddec2->totalDuration = encDataTime;
+            }
+            GST_BUFFER_TIMESTAMP(outBuf) = viddec2->totalDuration;
+            GST_BUFFER_DURATION(outBuf)  = frameDuration; 
+            viddec2->totalDuration       += GST_BUFFER_DURATION(outBuf);
+        }
+        else {
+            GST_BUFFER_TIMESTAMP(outBuf) = GST_CLOCK_TIME_NONE;
+        }
+
+        /* Tell circular buffer how much time we consumed */
+        gst_ticircbuffer_time_consumed(viddec2->circBuf, frameDuration);
+
+        /* Push the transport buffer to the source pad */
+        GST_LOG("pushing buffer to source pad with timestamp : %" 
+                GST_TIME_FORMAT ", duration: %" GST_TIME_FORMAT,
+                GST_TIME_ARGS (GST_BUFFER_TIMESTAMP(outBuf)),
+                GST_TIME_ARGS (GST_BUFFER_DURATION(outBuf)));
+
+        /* Report how long the first frame took to come out */
+        if (viddec2->firstFramePending) {
+            gst_tividdec2_post_first_frame(viddec2,
+                GST_BUFFER_TIMESTAMP(outBuf));
+        }
+
+        if (viddec2->pushThreadRunning) {
+            if (!gst_tividdec2_queue_output(viddec2, outBuf)) {
+                return FALSE;
+            }
+        }
+
+        /* Downstream refuses buffers while a seek is flushing; the
+         * frames are dropped and the decode thread carries on.
+         */
+        else if (gst_pad_push(viddec2->srcpad, outBuf) != GST_FLOW_OK &&
+            !gst_ticircbuffer_is_flushing(viddec2->circBuf)) {
+            GST_DEBUG("push to source pad failed\n");
+            return FALSE;
+        }
+
+        hDstBuf = Vdec2_getDisplayBuf(viddec2->hVd);
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_start_push_thread
+ *    Create the output queue and the thread that pushes it to the source
+ *    pad.  The queue needs no limit of its own:  every frame in it holds an
+ *    output buffer, so the decode thread stops when the BufTab runs dry.
+ ******************************************************************************/
+static gboolean gst_tividdec2_start_push_thread(GstTIViddec2 *viddec2)
+{
+    pthread_mutex_lock(&viddec2->outQueueMutex);
+    viddec2->outQueue       = g_queue_new();
+    viddec2->pushThreadStop = FALSE;
+    viddec2->pushing        = FALSE;
+    viddec2->pushFailed     = FALSE;
+    viddec2->queueDepth     = 0;
+    pthread_mutex_unlock(&viddec2->outQueueMutex);
+    gst_tieventcount_init(&viddec2->outQueueEvent);
+
+    if (pthread_create(&viddec2->pushThread, NULL,
+            gst_tividdec2_push_thread, (void*)viddec2)) {
+        gst_tieventcount_destroy(&viddec2->outQueueEvent);
+        g_queue_free(viddec2->outQueue);
+        viddec2->outQueue = NULL;
+        return FALSE;
+    }
+
+    viddec2->pushThreadRunning = TRUE;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_stop_push_thread
+ *    Wait for the push thread to empty the output queue, then shut it down.
+ ******************************************************************************/
+static void gst_tividdec2_stop_push_thread(GstTIViddec2 *viddec2)
+{
+    if (!viddec2->pushThreadRunning) {
+        return;
+    }
+
+    pthread_mutex_lock(&viddec2->outQueueMutex);
+    viddec2->pushThreadStop = TRUE;
+    pthread_mutex_unlock(&viddec2->outQueueMutex);
+    gst_tieventcount_notify(&viddec2->outQueueEvent);
+
+    pthread_join(viddec2->pushThread, NULL);
+    viddec2->pushThreadRunning = FALSE;
+
+    gst_tieventcount_destroy(&viddec2->outQueueEvent);
+    g_queue_free(viddec2->outQueue);
+    viddec2->outQueue = NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_push_thread
+ *    Push queued frames to the source pad until told to stop and the queue
+ *    is empty.  After a push fails, the rest are dropped.
+ ******************************************************************************/
+static void* gst_tividdec2_push_thread(void *arg)
+{
+    GstTIViddec2  *viddec2 = GST_TIVIDDEC2(arg);
+    GstBuffer     *outBuf;
+    GstClockTime   pushStart;
+    GstClockTime   pushTime;
+    GstFlowReturn  flowRet;
+    gboolean       failed;
+    gboolean       stop;
+    gint           key;
+
+    GST_LOG("init output queue thread\n");
+
+    while (TRUE) {
+        key = gst_tieventcount_prepare_wait(&viddec2->outQueueEvent);
+
+        pthread_mutex_lock(&viddec2->outQueueMutex);
+        outBuf = g_queue_pop_head(viddec2->outQueue);
+        viddec2->pushing    = (outBuf != NULL);
+        viddec2->queueDepth = g_queue_get_length(viddec2->outQueue);
+        stop   = viddec2->pushThreadStop;
+        failed = viddec2->pushFailed;
+        pthread_mutex_unlock(&viddec2->outQueueMutex);
+
+        if (outBuf == NULL) {
+            if (stop) {
+                break;
+            }
+            gst_tieventcount_wait(&viddec2->outQueueEvent, key);
+            continue;
+        }
+
+        /* Frames queued before a seek are dropped while it flushes */
+        if (failed || gst_ticircbuffer_is_flushing(viddec2->circBuf)) {
+            gst_buffer_unref(outBuf);
+            flowRet  = GST_FLOW_OK;
+            pushTime = 0;
+        }
+        else {
+            pushStart = gst_util_get_timestamp();
+            flowRet   = gst_pad_push(viddec2->srcpad, outBuf);
+            pushTime  = gst_util_get_timestamp() - pushStart;
+        }
+
+        /* Downstream refuses buffers while a seek is flushing; that is not
+         * an error.
+         */
+        pthread_mutex_lock(&viddec2->outQueueMutex);
+        if (flowRet != GST_FLOW_OK &&
+            !gst_ticircbuffer_is_flushing(viddec2->circBuf)) {
+            GST_DEBUG("push to source pad failed\n");
+            viddec2->pushFailed = TRUE;
+        }
+        viddec2->pushStallTime += pushTime;
+        viddec2->pushing        = FALSE;
+        pthread_mutex_unlock(&viddec2->outQueueMutex);
+
+        /* The decode thread may be waiting for the push to finish */
+        gst_tieventcount_notify(&viddec2->outQueueEvent);
+    }
+
+    GST_LOG("exit output queue thread\n");
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_queue_output
+ *    Add a decoded frame to the output queue.  Returns FALSE if an earlier
+ *    push failed, in which case the decode thread should stop.
+ ******************************************************************************/
+static gboolean gst_tividdec2_queue_output(GstTIViddec2 *viddec2,
+                    GstBuffer *outBuf)
+{
+    gboolean failed;
+
+    pthread_mutex_lock(&viddec2->outQueueMutex);
+    failed = viddec2->pushFailed;
+    if (!failed) {
+        g_queue_push_tail(viddec2->outQueue, outBuf);
+        viddec2->queueDepth = g_queue_get_length(viddec2->outQueue);
+    }
+    pthread_mutex_unlock(&viddec2->outQueueMutex);
+
+    if (failed) {
+        gst_buffer_unref(outBuf);
+        return FALSE;
+    }
+
+    gst_tieventcount_notify(&viddec2->outQueueEvent);
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_flush_output
+ *    Drop the frames waiting in the output queue, and wait for a push in
+ *    progress to finish, so nothing from before a seek is pushed after it.
+ ******************************************************************************/
+static void gst_tividdec2_flush_output(GstTIViddec2 *viddec2)
+{
+    GstBuffer *outBuf;
+    gboolean   pushing;
+    gint       key;
+
+    if (!viddec2->pushThreadRunning) {
+        return;
+    }
+
+    while (TRUE) {
+        key = gst_tieventcount_prepare_wait(&viddec2->outQueueEvent);
+
+        pthread_mutex_lock(&viddec2->outQueueMutex);
+        while ((outBuf = g_queue_pop_head(viddec2->outQueue))) {
+            gst_buffer_unref(outBuf);
+        }
+        viddec2->queueDepth = 0;
+        pushing = viddec2->pushing;
+        pthread_mutex_unlock(&viddec2->outQueueMutex);
+
+        if (!pushing) {
+            break;
+        }
+        gst_tieventcount_wait(&viddec2->outQueueEvent, key);
+    }
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_drain_pipeline
+ *    Wait for the decode thread to finish processing queued input data.
+ ******************************************************************************/
+static void gst_tividdec2_drain_pipeline(GstTIViddec2 *viddec2)
+{
+    gboolean checkResult;
+
+    /* If the decode thread hasn't been created, there is nothing to drain. */
+    if (!gst_tithread_check_status(
+             viddec2, TIThread_CODEC_CREATED, checkResult)) {
+        return;
+    }
+
+    /* Let a decode thread that is still starting up finish creating the
+     * circular buffer, as if the first buffer had arrived.
+     */
+    if (viddec2->codecStarting) {
+        gst_tividdec2_wait_video(viddec2);
+    }
 
     viddec2->drainingEOS = TRUE;
     gst_ticircbuffer_drain(viddec2->circBuf, TRUE);
@@ -1852,6 +3149,595 @@ static GstClockTime gst_tividdec2_frame_duration(GstTIViddec2 *viddec2)
 }
 
 
+/******************************************************************************
+ * gst_tividdec2_set_frame_timestamp
+ *    Associate an input timestamp with an output buffer given to the codec.
+ ******************************************************************************/
+static void gst_tividdec2_set_frame_timestamp(GstTIViddec2 *viddec2,
+                Buffer_Handle hBuf, GstClockTime timestamp)
+{
+    GstClockTime *value;
+
+    if (!GST_CLOCK_TIME_IS_VALID(timestamp)) {
+        g_hash_table_remove(viddec2->frameTimeStamps, hBuf);
+        return;
+    }
+
+    value  = g_new(GstClockTime, 1);
+    *value = timestamp;
+    g_hash_table_insert(viddec2->frameTimeStamps, hBuf, value);
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_get_frame_timestamp
+ *    Return (and forget) the input timestamp of the frame decoded into hBuf.
+ ******************************************************************************/
+static GstClockTime gst_tividdec2_get_frame_timestamp(GstTIViddec2 *viddec2,
+                        Buffer_Handle hBuf)
+{
+    GstClockTime  timestamp = GST_CLOCK_TIME_NONE;
+    GstClockTime *value;
+
+    value = g_hash_table_lookup(viddec2->frameTimeStamps, hBuf);
+    if (value) {
+        timestamp = *value;
+        g_hash_table_remove(viddec2->frameTimeStamps, hBuf);
+    }
+
+    return timestamp;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_get_framer
+ *    Return the access unit framer for the stream being decoded, or NULL if
+ *    the codec's input can't be framed.
+ ******************************************************************************/
+static GstTIFramer gst_tividdec2_get_framer(GstTIViddec2 *viddec2)
+{
+    if (gst_is_h264_decoder(viddec2->codecName)) {
+        return gst_ti_frame_h264;
+    }
+
+    if (gst_is_mpeg4_decoder(viddec2->codecName)) {
+        return gst_ti_frame_mpeg4;
+    }
+
+    if (gst_tividdec2_is_mpeg2_decoder(viddec2)) {
+        return gst_ti_frame_mpeg2;
+    }
+
+    GST_WARNING("frameInput is not supported by %s\n", viddec2->codecName);
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_is_mpeg2_decoder
+ ******************************************************************************/
+static gboolean gst_tividdec2_is_mpeg2_decoder(GstTIViddec2 *viddec2)
+{
+    GstTICodec *mpeg2Codec;
+
+    mpeg2Codec = gst_ticodec_get_codec("MPEG2 Video Decoder");
+
+    return mpeg2Codec &&
+           !strcmp(mpeg2Codec->CE_CodecName, viddec2->codecName);
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_get_sync_finder
+ *    Return the function used to find where to resume after a decode error,
+ *    or NULL to leave it to the codec.
+ ******************************************************************************/
+static GstTISyncFinder gst_tividdec2_get_sync_finder(GstTIViddec2 *viddec2)
+{
+    switch (viddec2->errorRecovery) {
+        case GST_TIVIDDEC2_RECOVERY_START_CODE:
+            return gst_ti_find_start_code;
+
+        case GST_TIVIDDEC2_RECOVERY_KEYFRAME:
+            if (viddec2->keyframeFinder) {
+                return viddec2->keyframeFinder;
+            }
+            GST_WARNING("keyframe recovery is not supported by %s; "
+                "resynchronizing on start codes\n", viddec2->codecName);
+            return gst_ti_find_start_code;
+
+        default:
+            return NULL;
+    }
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_get_keyframe_finder
+ *    Return the function that finds the next keyframe in the stream being
+ *    decoded, or NULL if the codec's input can't be parsed.
+ ******************************************************************************/
+static GstTISyncFinder gst_tividdec2_get_keyframe_finder(
+                           GstTIViddec2 *viddec2)
+{
+    if (gst_is_h264_decoder(viddec2->codecName)) {
+        return gst_ti_find_keyframe_h264;
+    }
+
+    if (gst_is_mpeg4_decoder(viddec2->codecName)) {
+        return gst_ti_find_keyframe_mpeg4;
+    }
+
+    if (gst_tividdec2_is_mpeg2_decoder(viddec2)) {
+        return gst_ti_find_keyframe_mpeg2;
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_get_droppable_check
+ *    Return the function that tells whether an access unit can be dropped
+ *    without affecting other frames, or NULL if the codec's input can't be
+ *    parsed.
+ ******************************************************************************/
+static GstTIDroppableCheck gst_tividdec2_get_droppable_check(
+                               GstTIViddec2 *viddec2)
+{
+    if (gst_is_h264_decoder(viddec2->codecName)) {
+        return gst_ti_is_droppable_h264;
+    }
+
+    if (gst_is_mpeg4_decoder(viddec2->codecName)) {
+        return gst_ti_is_droppable_mpeg4;
+    }
+
+    if (gst_tividdec2_is_mpeg2_decoder(viddec2)) {
+        return gst_ti_is_droppable_mpeg2;
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_get_size_parser
+ *    Return the function that reads the picture size from the stream's
+ *    sequence headers, or NULL if the codec's input can't be parsed.
+ ******************************************************************************/
+static GstTISizeParser gst_tividdec2_get_size_parser(GstTIViddec2 *viddec2)
+{
+    if (gst_is_h264_decoder(viddec2->codecName)) {
+        return gst_ti_parse_size_h264;
+    }
+
+    if (gst_is_mpeg4_decoder(viddec2->codecName)) {
+        return gst_ti_parse_size_mpeg4;
+    }
+
+    if (gst_tividdec2_is_mpeg2_decoder(viddec2)) {
+        return gst_ti_parse_size_mpeg2;
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_check_size
+ *    Look for a sequence header at the start of encDataWindow that changes
+ *    the picture size.  If the codec instance can decode the new size, the
+ *    frames decoded at the old size are pushed and the codec is reset;
+ *    otherwise the codec is re-created for it.  The source caps follow the
+ *    decoded frames.  Returns FALSE on failure.
+ ******************************************************************************/
+static gboolean gst_tividdec2_check_size(GstTIViddec2 *viddec2,
+                    GstBuffer *encDataWindow, gboolean *usePadBufs)
+{
+    GstTIFrameState  frameState = { 0, FALSE };
+    const guint8    *data       = GST_BUFFER_DATA(encDataWindow);
+    Int32            size;
+    gint             width, height, offset;
+    gboolean         firstHeader;
+
+    size = GST_TICIRCBUFFER_FRAME_SIZE(viddec2->circBuf);
+    if (size <= 0) {
+        size = MIN(GST_BUFFER_SIZE(encDataWindow), SIZE_SCAN_BYTES);
+    }
+
+    offset = viddec2->sizeParser(data, size, &width, &height);
+
+    if (offset < 0 ||
+        (width == viddec2->streamWidth && height == viddec2->streamHeight)) {
+        return TRUE;
+    }
+
+    /* If whole frames come before the header, let the codec have them
+     * first; the header will be at the start of a later window.
+     */
+    if (offset > 0 &&
+        gst_tividdec2_get_framer(viddec2)(data, offset + 4, &frameState) > 0) {
+        return TRUE;
+    }
+
+    firstHeader           = (viddec2->streamWidth == 0);
+    viddec2->streamWidth  = width;
+    viddec2->streamHeight = height;
+
+    if (width <= viddec2->codecMaxWidth && height <= viddec2->codecMaxHeight) {
+        if (firstHeader) {
+            return TRUE;
+        }
+
+        GST_INFO("picture size changed to %dx%d\n", width, height);
+        return gst_tividdec2_codec_flush(viddec2, TRUE);
+    }
+
+    GST_INFO("picture size changed to %dx%d, larger than the %dx%d the codec "
+        "was created for\n", width, height, viddec2->codecMaxWidth,
+        viddec2->codecMaxHeight);
+
+    /* Downstream buffers are sized for the old picture */
+    *usePadBufs = FALSE;
+
+    return gst_tividdec2_codec_reconfigure(viddec2, width, height);
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_codec_reconfigure
+ *    Push the frames held by the codec, then replace the codec instance and
+ *    the output BufTab with ones large enough for width x height.  The
+ *    Engine, the circular buffer and the threads are kept.  Output buffers
+ *    still held downstream keep the old BufTab alive until released.
+ ******************************************************************************/
+static gboolean gst_tividdec2_codec_reconfigure(GstTIViddec2 *viddec2,
+                    gint width, gint height)
+{
+    VIDDEC2_Params         params    = Vdec2_Params_DEFAULT;
+    VIDDEC2_DynamicParams  dynParams = Vdec2_DynamicParams_DEFAULT;
+    BufferGfx_Attrs        gfxAttrs  = BufferGfx_Attrs_DEFAULT;
+    GstTIDmaiBufTab       *hOldBufTab;
+    ColorSpace_Type        colorSpace;
+    Int                    defaultNumBufs;
+
+    if (!gst_tividdec2_codec_flush(viddec2, TRUE)) {
+        return FALSE;
+    }
+
+    if (!gst_tividdec2_get_codec_params(viddec2, &params, &colorSpace,
+            &defaultNumBufs)) {
+        return FALSE;
+    }
+
+    /* Codecs work in whole macroblocks */
+    params.maxWidth  = (width  + 15) & ~15;
+    params.maxHeight = (height + 15) & ~15;
+
+    GST_LOG("re-creating video decoder \"%s\" for %dx%d\n",
+        viddec2->codecName, (gint)params.maxWidth, (gint)params.maxHeight);
+
+    Vdec2_delete(viddec2->hVd);
+    viddec2->hVd = Vdec2_create(viddec2->hEngine, (Char*)viddec2->codecName,
+                      &params, &dynParams);
+
+    if (viddec2->hVd == NULL) {
+        GST_ELEMENT_ERROR(viddec2, STREAM, CODEC_NOT_FOUND,
+        ("failed to re-create video decoder: %s\n", viddec2->codecName),
+        (NULL));
+        return FALSE;
+    }
+
+    viddec2->codecMaxWidth   = params.maxWidth;
+    viddec2->codecMaxHeight  = params.maxHeight;
+    viddec2->codecColorSpace = colorSpace;
+    viddec2->outBufSize      = Vdec2_getOutBufSize(viddec2->hVd);
+
+    /* Allocate output buffers for the new size */
+    gfxAttrs.colorSpace     = colorSpace;
+    gfxAttrs.dim.width      = params.maxWidth;
+    gfxAttrs.dim.height     = params.maxHeight;
+    gfxAttrs.dim.lineLength = BufferGfx_calcLineLength(
+                                  gfxAttrs.dim.width, gfxAttrs.colorSpace);
+    gfxAttrs.bAttrs.useMask = gst_tidmaibuffer_CODEC_FREE;
+
+    hOldBufTab          = viddec2->hOutBufTab;
+    viddec2->hOutBufTab = gst_tidmaibuftab_new(
+        viddec2->numOutputBufs, viddec2->outBufSize,
+        BufferGfx_getBufferAttrs(&gfxAttrs));
+    gst_tidmaibuftab_set_name(viddec2->hOutBufTab, GST_ELEMENT_NAME(viddec2));
+
+    if (hOldBufTab) {
+        gst_tidmaibuftab_unref(hOldBufTab);
+    }
+
+    if (viddec2->hOutBufTab == NULL) {
+        GST_ELEMENT_ERROR(viddec2, RESOURCE, NO_SPACE_LEFT,
+            ("failed to allocate output buffers for the new picture size\n"),
+            (NULL));
+        return FALSE;
+    }
+
+    Vdec2_setBufTab(viddec2->hVd, GST_TIDMAIBUFTAB_BUFTAB(viddec2->hOutBufTab));
+
+    /* Let the BufTab be re-partitioned once the codec knows its needs */
+    viddec2->firstFrame = TRUE;
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_skip_to_keyframe
+ *    In fast start mode, drop the input before the first keyframe.  Returns
+ *    TRUE if encDataWindow starts with a keyframe and should be decoded;
+ *    otherwise the data before the next keyframe (or most of the window if
+ *    there is none) is consumed and FALSE is returned.
+ ******************************************************************************/
+static gboolean gst_tividdec2_skip_to_keyframe(GstTIViddec2 *viddec2,
+                    GstBuffer *encDataWindow)
+{
+    Int32 size = GST_BUFFER_SIZE(encDataWindow);
+    Int32 skip;
+
+    skip = viddec2->keyframeFinder(GST_BUFFER_DATA(encDataWindow), 0, size);
+
+    if (skip == 0) {
+        GST_LOG("found keyframe after skipping %llu bytes\n",
+            viddec2->firstFrameSkipped);
+        viddec2->waitForKeyframe = FALSE;
+        return TRUE;
+    }
+
+    /* Keep the last few bytes, which may hold the start of a keyframe */
+    if (skip >= size) {
+        skip = MAX(size - 5, 1);
+    }
+
+    /* A framed window holds one access unit, so this drops a frame */
+    if (GST_TICIRCBUFFER_FRAME_SIZE(viddec2->circBuf) > 0) {
+        viddec2->framesDropped++;
+    }
+
+    viddec2->firstFrameSkipped += skip;
+    gst_ticircbuffer_data_consumed(viddec2->circBuf, encDataWindow, skip);
+
+    return FALSE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_skip_keyframe
+ *    In keyframesOnly mode, encDataWindow starts with a keyframe.  If it is
+ *    less than keyframeInterval (scaled by the segment rate, so trick play
+ *    at any speed gives about the same number of frames per second) from
+ *    the last keyframe decoded, consume its start so the search moves on to
+ *    the next one and return TRUE.
+ ******************************************************************************/
+static gboolean gst_tividdec2_skip_keyframe(GstTIViddec2 *viddec2,
+                    GstBuffer *encDataWindow)
+{
+    GstClockTime timestamp;
+    GstClockTime interval;
+    Int32        frameSize;
+
+    if (viddec2->keyframeInterval == 0) {
+        return FALSE;
+    }
+
+    frameSize = GST_TICIRCBUFFER_FRAME_SIZE(viddec2->circBuf);
+    timestamp = gst_ticircbuffer_peek_timestamp(viddec2->circBuf,
+                    frameSize > 0 ? frameSize : GST_BUFFER_SIZE(encDataWindow));
+
+    if (!GST_CLOCK_TIME_IS_VALID(timestamp)) {
+        return FALSE;
+    }
+
+    /* Timestamps decrease when playing backwards */
+    interval = viddec2->keyframeInterval * ABS(viddec2->segment->rate);
+
+    if (!GST_CLOCK_TIME_IS_VALID(viddec2->lastKeyframeTime) ||
+        (GstClockTime) ABS(GST_CLOCK_DIFF(viddec2->lastKeyframeTime,
+            timestamp)) >= interval) {
+        viddec2->lastKeyframeTime = timestamp;
+        return FALSE;
+    }
+
+    GST_LOG("skipping keyframe at %" GST_TIME_FORMAT "\n",
+        GST_TIME_ARGS(timestamp));
+
+    if (frameSize > 0) {
+        viddec2->framesDropped++;
+    }
+
+    viddec2->waitForKeyframe = TRUE;
+    gst_ticircbuffer_data_consumed(viddec2->circBuf, encDataWindow,
+        frameSize > 0 ? frameSize : 1);
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_reset_qos
+ *    Forget the lateness reported by downstream.
+ ******************************************************************************/
+static void gst_tividdec2_reset_qos(GstTIViddec2 *viddec2)
+{
+    GST_OBJECT_LOCK(viddec2);
+    viddec2->qosEarliest = GST_CLOCK_TIME_NONE;
+    GST_OBJECT_UNLOCK(viddec2);
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_qos_drop
+ *    Decide whether the next frame is too late to be worth decoding.  If it
+ *    is only a little late and nothing references it, the access unit in
+ *    encDataWindow is consumed and TRUE is returned.  If it is far behind,
+ *    input is skipped up to the next keyframe instead.  Dropping single
+ *    frames needs frameInput so that the window holds one access unit.
+ ******************************************************************************/
+static gboolean gst_tividdec2_qos_drop(GstTIViddec2 *viddec2,
+                    GstBuffer *encDataWindow, GstClockTime frameDuration)
+{
+    GstClockTime earliest;
+    GstClockTime nextTime;
+    Int32        frameSize;
+
+    /* Without generated timestamps we can't tell when the next frame is due */
+    if (!viddec2->qos || !viddec2->genTimeStamps) {
+        return FALSE;
+    }
+
+    /* QoS reports running time, so compare the next frame in running time
+     * too.  Frames outside the segment are left to downstream to clip.
+     */
+    GST_OBJECT_LOCK(viddec2);
+    earliest = viddec2->qosEarliest;
+    nextTime = gst_segment_to_running_time(viddec2->segment, GST_FORMAT_TIME,
+                   viddec2->totalDuration);
+    GST_OBJECT_UNLOCK(viddec2);
+
+    if (!GST_CLOCK_TIME_IS_VALID(earliest) ||
+        !GST_CLOCK_TIME_IS_VALID(nextTime) ||
+        nextTime + frameDuration > earliest) {
+        return FALSE;
+    }
+
+    /* Too far behind to catch up by dropping the odd frame; the frames up
+     * to the next keyframe would only be decoded to be thrown away.
+     */
+    if (earliest - nextTime > QOS_KEYFRAME_LATENESS &&
+        viddec2->keyframeFinder && !viddec2->waitForKeyframe) {
+        GST_DEBUG("%" GST_TIME_FORMAT " late; skipping to the next "
+            "keyframe\n", GST_TIME_ARGS(earliest - nextTime));
+        viddec2->waitForKeyframe = TRUE;
+        return FALSE;
+    }
+
+    frameSize = GST_TICIRCBUFFER_FRAME_SIZE(viddec2->circBuf);
+
+    if (frameSize <= 0 || !viddec2->isDroppable ||
+        !viddec2->isDroppable(GST_BUFFER_DATA(encDataWindow), frameSize)) {
+        return FALSE;
+    }
+
+    GST_LOG("dropping late frame at running time %" GST_TIME_FORMAT "\n",
+        GST_TIME_ARGS(nextTime));
+
+    viddec2->framesDropped++;
+    viddec2->totalDuration += frameDuration;
+    viddec2->totalBytes    += frameSize;
+    gst_ticircbuffer_data_consumed(viddec2->circBuf, encDataWindow,
+        frameSize);
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_start_first_frame
+ *    Start timing the first frame after the codec is started or flushed, and
+ *    drop input until a keyframe if fastStart is set.
+ ******************************************************************************/
+static void gst_tividdec2_start_first_frame(GstTIViddec2 *viddec2)
+{
+    viddec2->firstFrameStart   = gst_util_get_timestamp();
+    viddec2->firstFrameSkipped = 0;
+    viddec2->firstFramePending = TRUE;
+    viddec2->waitForKeyframe   = (viddec2->fastStart ||
+                                  viddec2->keyframesOnly) &&
+                                 viddec2->keyframeFinder != NULL;
+    viddec2->lastKeyframeTime  = GST_CLOCK_TIME_NONE;
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_post_first_frame
+ *    Post a "first-frame" element message with the time it took to produce
+ *    the first frame since the codec was started or flushed.
+ ******************************************************************************/
+static void gst_tividdec2_post_first_frame(GstTIViddec2 *viddec2,
+                GstClockTime timestamp)
+{
+    GstClockTime  latency;
+    GstStructure *s;
+
+    viddec2->firstFramePending = FALSE;
+    latency = gst_util_get_timestamp() - viddec2->firstFrameStart;
+
+    GST_INFO("first frame after %" GST_TIME_FORMAT " (%llu bytes skipped)\n",
+        GST_TIME_ARGS(latency), viddec2->firstFrameSkipped);
+
+    s = gst_structure_new("first-frame",
+            "latency",       G_TYPE_UINT64, latency,
+            "bytes-skipped", G_TYPE_UINT64, viddec2->firstFrameSkipped,
+            "timestamp",     G_TYPE_UINT64, timestamp,
+            NULL);
+
+    gst_element_post_message(GST_ELEMENT(viddec2),
+        gst_message_new_element(GST_OBJECT(viddec2), s));
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_post_codec_ready
+ *    Post a "codec-ready" element message with the time it took to create
+ *    the codec and its buffers since the decode thread was started.
+ ******************************************************************************/
+static void gst_tividdec2_post_codec_ready(GstTIViddec2 *viddec2)
+{
+    GstClockTime  setupTime;
+    GstStructure *s;
+
+    setupTime = gst_util_get_timestamp() - viddec2->codecStartTime;
+
+    GST_INFO("codec \"%s\" ready after %" GST_TIME_FORMAT "\n",
+        viddec2->codecName, GST_TIME_ARGS(setupTime));
+
+    s = gst_structure_new("codec-ready",
+            "codec",      G_TYPE_STRING, viddec2->codecName,
+            "setup-time", G_TYPE_UINT64, setupTime,
+            NULL);
+
+    gst_element_post_message(GST_ELEMENT(viddec2),
+        gst_message_new_element(GST_OBJECT(viddec2), s));
+}
+
+
+/******************************************************************************
+ * gst_tividdec2_resync
+ *    Called after the codec failed to decode encDataWindow.  Return how many
+ *    bytes to consume so that decoding resumes at the next sync point after
+ *    what the codec consumed.  If there is none in the window, everything but
+ *    the last few bytes (which may hold the start of one) is skipped.
+ ******************************************************************************/
+static Int32 gst_tividdec2_resync(GstTIViddec2 *viddec2,
+                 GstBuffer *encDataWindow, Int32 encDataConsumed)
+{
+    const guint8 *data = GST_BUFFER_DATA(encDataWindow);
+    Int32         size = GST_BUFFER_SIZE(encDataWindow);
+    Int32         skip;
+
+    /* Always make progress, and don't find the sync point we failed on */
+    skip = viddec2->syncFinder(data, MAX(encDataConsumed, 1), size);
+
+    if (skip >= size) {
+        skip = MAX(size - 5, MAX(encDataConsumed, 1));
+    }
+
+    viddec2->resyncCount++;
+    viddec2->resyncBytes += skip - encDataConsumed;
+
+    GST_LOG("resynchronizing: skipping %ld bytes (codec consumed %ld)\n",
+        skip, encDataConsumed);
+
+    return skip;
+}
+
+
 /******************************************************************************
  * gst_tividdec2_resizeBufTab
  ******************************************************************************/
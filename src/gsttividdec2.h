@@ -56,6 +56,11 @@ G_BEGIN_DECLS
 typedef struct _GstTIViddec2      GstTIViddec2;
 typedef struct _GstTIViddec2Class GstTIViddec2Class;
 
+/* Values of the errorRecovery property */
+#define GST_TIVIDDEC2_RECOVERY_NONE       0 /* skip one byte per failure   */
+#define GST_TIVIDDEC2_RECOVERY_START_CODE 1 /* skip to the next start code */
+#define GST_TIVIDDEC2_RECOVERY_KEYFRAME   2 /* skip to the next keyframe   */
+
 /* _GstTIViddec2 object */
 struct _GstTIViddec2
 {
@@ -80,10 +85,16 @@ struct _GstTIViddec2
   gboolean         firstFrame;
   gint             width, height;
 
-  /* Decode thread */
+  /* Decode thread.  With asyncStart set, the thread is created as soon as
+   * the sink caps are known and codecStarting stays set until the first
+   * buffer waits for it to finish creating the codec.
+   */
   pthread_t          decodeThread;
   Rendezvous_Handle  waitOnDecodeThread;
   Rendezvous_Handle  waitOnDecodeDrain;
+  gboolean           asyncStart;
+  gboolean           codecStarting;
+  GstClockTime       codecStartTime;
 
   /* Framerate */
   GValue             framerate;
@@ -93,11 +104,41 @@ struct _GstTIViddec2
   GstTIDmaiBufTab *hOutBufTab;
   GstTICircBuffer *circBuf;
   gboolean         padAllocOutbufs;
+  gboolean         mirrorInputBuffer;
+  gboolean         zeroCopyInput;
+  gboolean         frameInput;
+
+  /* Picture size.  streamWidth/streamHeight come from the last sequence
+   * header seen, codecMax* from the parameters the codec was created with.
+   */
+  GstTISizeParser  sizeParser;
+  gint             streamWidth, streamHeight;
+  gint             codecMaxWidth, codecMaxHeight;
+
+  /* Codec reuse.  When reuseCodec is set, codec_stop keeps the codec, its
+   * circular buffer and output BufTab here, with the settings they were
+   * created with, and codec_start reuses them if the new stream fits.
+   * codecColorSpace is the output format of the codec, and outBufSize the
+   * size its output buffers were created with, before resizeBufTab chunked
+   * them for the stream.
+   */
+  gboolean         reuseCodec;
+  Engine_Handle    hParkedEngine;
+  Vdec2_Handle     hParkedVd;
+  GstTICircBuffer *parkedCircBuf;
+  GstTIDmaiBufTab *hParkedOutBufTab;
+  gchar           *parkedEngineName;
+  gchar           *parkedCodecName;
+  ColorSpace_Type  codecColorSpace;
+  Int32            outBufSize;
 
   /* Quicktime h264 header  */
   GstBuffer       *sps_pps_data;
   GstBuffer       *nal_code_prefix;
   guint           nal_length;
+  GstCaps         *sps_pps_caps;
+  gboolean        sps_pps_needed;
+  guint64         sps_pps_bytes;
 
   /* Segment handling */
   GstSegment      *segment;
@@ -106,8 +147,60 @@ struct _GstTIViddec2
   gint64          totalDuration;
   guint64         totalBytes;
 
+  /* Input timestamp of the frame decoded into each output buffer, so it can
+   * be restored when the codec returns the buffer for display.
+   */
+  GHashTable      *frameTimeStamps;
+
   /* Quicktime MPEG4 header */
   GstBuffer       *mpeg4_quicktime_header;
+
+  /* Error recovery */
+  gint             errorRecovery;
+  GstTISyncFinder  syncFinder;
+  guint64          resyncBytes;
+  guint            resyncCount;
+
+  /* Fast start: drop input until the first keyframe after starting or
+   * flushing, and report how long the first frame took.
+   */
+  gboolean         fastStart;
+  gboolean         waitForKeyframe;
+  GstTISyncFinder  keyframeFinder;
+  gboolean         firstFramePending;
+  GstClockTime     firstFrameStart;
+  guint64          firstFrameSkipped;
+
+  /* Quality of service.  qosEarliest is set by the source pad event handler
+   * and protected by the object lock.
+   */
+  gboolean             qos;
+  GstClockTime         qosEarliest;
+  GstTIDroppableCheck  isDroppable;
+  guint64              framesDecoded;
+  guint64              framesDropped;
+
+  /* Keyframe-only decoding for thumbnails and trick play */
+  gboolean             keyframesOnly;
+  guint64              keyframeInterval;
+  GstClockTime         lastKeyframeTime;
+
+  /* Output queue.  When outputQueue is set, the decode thread queues
+   * decoded frames and pushThread pushes them to the source pad.  The queue
+   * and the flags below are protected by outQueueMutex; outQueueEvent is
+   * notified whenever they change.
+   */
+  gboolean             outputQueue;
+  GQueue              *outQueue;
+  pthread_mutex_t      outQueueMutex;
+  GstTIEventCount      outQueueEvent;
+  pthread_t            pushThread;
+  gboolean             pushThreadRunning;
+  gboolean             pushThreadStop;
+  gboolean             pushing;
+  gboolean             pushFailed;
+  guint                queueDepth;
+  guint64              pushStallTime;
 };
 
 /* _GstTIViddec2Class object */
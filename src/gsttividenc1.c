@@ -48,6 +48,7 @@
 #include "gstticodecs.h"
 #include "gsttithreadprops.h"
 #include "gstticommonutils.h"
+#include "gsttiengine.h"
 #include "gsttiquicktime_h264.h"
 
 /* Declare variable used to categorize GST_LOG output */
@@ -72,8 +73,8 @@ enum
   PROP_GEN_TIMESTAMPS,  /* genTimeStamps  (boolean) */
   PROP_RATE_CTRL_PRESET,/* rateControlPreset  (gint) */
   PROP_ENCODING_PRESET, /* encodingPreset  (gint) */
-  PROP_BYTE_STREAM      /* byteStream      (gboolean) */
-
+  PROP_BYTE_STREAM,     /* byteStream      (gboolean) */
+  PROP_REUSE_CODEC      /* reuseCodec      (gboolean) */
 };
 
 /* Define source (output) pad capabilities.  Currently, MPEG2/4 and H264 are 
@@ -162,6 +163,13 @@ static gboolean
  gst_tividenc1_codec_start (GstTIVidenc1 *videnc1);
 static gboolean
  gst_tividenc1_codec_stop (GstTIVidenc1 *videnc1);
+static gboolean
+ gst_tividenc1_codec_park (GstTIVidenc1 *videnc1);
+static gboolean
+ gst_tividenc1_codec_unpark (GstTIVidenc1 *videnc1, VIDENC1_Params *params,
+     VIDENC1_DynamicParams *dynParams);
+static void
+ gst_tividenc1_free_parked (GstTIVidenc1 *videnc1);
 
 /******************************************************************************
  * gst_tividenc1_class_init_trampoline
@@ -313,6 +321,12 @@ static void gst_tividenc1_class_init(GstTIVidenc1Class *klass)
         g_param_spec_boolean("genTimeStamps", "Generate Time Stamps",
             "Set timestamps on output buffers",
             TRUE, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_REUSE_CODEC,
+        g_param_spec_boolean("reuseCodec", "Reuse codec",
+            "Keep the codec when the stream stops, and reuse it for the next "
+            "stream if it uses the same codec settings",
+            TRUE, G_PARAM_WRITABLE));
 }
 
 /******************************************************************************
@@ -376,6 +390,13 @@ static void gst_tividenc1_init(GstTIVidenc1 *videnc1, GstTIVidenc1Class *gclass)
     videnc1->hInBufRef              = NULL;
     videnc1->zeroCopyEncode         = FALSE;
 
+    videnc1->reuseCodec             = TRUE;
+    videnc1->hParkedEngine          = NULL;
+    videnc1->hParkedVe1             = NULL;
+    videnc1->hParkedEncOutBuf       = NULL;
+    videnc1->parkedEngineName       = NULL;
+    videnc1->parkedCodecName        = NULL;
+
     videnc1->width                  = 0;
     videnc1->height                 = 0;
     videnc1->bitRate                = -1;
@@ -497,6 +518,11 @@ static void gst_tividenc1_set_property(GObject *object, guint prop_id,
             GST_LOG("setting \"byteStream\" to \"%s\"\n",
                 videnc1->byteStream ? "TRUE" : "FALSE");
             break;
+        case PROP_REUSE_CODEC:
+            videnc1->reuseCodec = g_value_get_boolean(value);
+            GST_LOG("setting \"reuseCodec\" to \"%s\"\n",
+                videnc1->reuseCodec ? "TRUE" : "FALSE");
+            break;
         case PROP_GEN_TIMESTAMPS:
             videnc1->genTimeStamps = g_value_get_boolean(value);
             GST_LOG("setting \"genTimeStamps\" to \"%s\"\n",
@@ -1088,10 +1114,13 @@ static GstStateChangeReturn gst_tividenc1_change_state(GstElement *element,
     /* Handle ramp-down state changes */
     switch (transition) {
         case GST_STATE_CHANGE_READY_TO_NULL:
-            /* Shut down any running video encoder */
+            /* Shut down any running video encoder, and the one kept for
+             * reuse.
+             */
             if (!gst_tividenc1_exit_video(videnc1)) {
                 return GST_STATE_CHANGE_FAILURE;
             }
+            gst_tividenc1_free_parked(videnc1);
             break;
 
         default:
@@ -1120,6 +1149,11 @@ static gboolean gst_tividenc1_codec_stop (GstTIVidenc1 *videnc1)
 
     videnc1->zeroCopyEncode = FALSE;
 
+    /* Keep the codec for the next stream if we can */
+    if (gst_tividenc1_codec_park(videnc1)) {
+        return TRUE;
+    }
+
     if (videnc1->hEncOutBuf) {
         Buffer_delete(videnc1->hEncOutBuf);
         videnc1->hEncOutBuf = NULL;
@@ -1133,13 +1167,132 @@ static gboolean gst_tividenc1_codec_stop (GstTIVidenc1 *videnc1)
 
     if (videnc1->hEngine) {
         GST_LOG("closing codec engine\n");
-        Engine_close(videnc1->hEngine);
+        gst_tiengine_close(videnc1->hEngine);
         videnc1->hEngine = NULL;
     }
 
     return TRUE;
 }
 
+/******************************************************************************
+ * gst_tividenc1_codec_park
+ *   Keep the codec and its output buffer for the next call to codec_start
+ *   instead of deleting them.  Returns FALSE if reuseCodec is off.
+ *****************************************************************************/
+static gboolean gst_tividenc1_codec_park (GstTIVidenc1 *videnc1)
+{
+    if (!videnc1->reuseCodec || !videnc1->hVe1 || !videnc1->hEncOutBuf) {
+        return FALSE;
+    }
+
+    /* Only one codec is kept */
+    gst_tividenc1_free_parked(videnc1);
+
+    GST_LOG("keeping video encoder \"%s\" for reuse\n", videnc1->codecName);
+
+    videnc1->hParkedEngine    = videnc1->hEngine;
+    videnc1->hParkedVe1       = videnc1->hVe1;
+    videnc1->hParkedEncOutBuf = videnc1->hEncOutBuf;
+    videnc1->parkedEngineName = g_strdup(videnc1->engineName);
+    videnc1->parkedCodecName  = g_strdup(videnc1->codecName);
+    gst_tiengine_park(videnc1->hParkedEngine);
+
+    videnc1->hEngine          = NULL;
+    videnc1->hVe1             = NULL;
+    videnc1->hEncOutBuf       = NULL;
+
+    return TRUE;
+}
+
+/******************************************************************************
+ * gst_tividenc1_codec_unpark
+ *   Take back the codec kept by codec_park if it was created with the same
+ *   codec and parameters, and reset it for a new stream.  Returns FALSE,
+ *   after freeing the kept codec if there was one, if codec_start has to
+ *   create a new one.
+ *****************************************************************************/
+static gboolean gst_tividenc1_codec_unpark (GstTIVidenc1 *videnc1,
+                    VIDENC1_Params *params, VIDENC1_DynamicParams *dynParams)
+{
+    VIDENC1_Params *oldParams = &videnc1->codecParams;
+    VIDENC1_Status  encStatus;
+
+    if (!videnc1->hParkedVe1) {
+        return FALSE;
+    }
+
+    /* The output buffer was sized and shaped for the old frame size, so
+     * the frame size has to match as well as the codec.
+     */
+    if (!videnc1->reuseCodec ||
+        strcmp(videnc1->parkedEngineName, videnc1->engineName) ||
+        strcmp(videnc1->parkedCodecName, videnc1->codecName) ||
+        params->maxWidth          != oldParams->maxWidth ||
+        params->maxHeight         != oldParams->maxHeight ||
+        params->maxBitRate        != oldParams->maxBitRate ||
+        params->inputChromaFormat != oldParams->inputChromaFormat ||
+        params->reconChromaFormat != oldParams->reconChromaFormat ||
+        params->rateControlPreset != oldParams->rateControlPreset ||
+        params->encodingPreset    != oldParams->encodingPreset ||
+        !gst_tiengine_unpark(videnc1->hParkedEngine)) {
+        GST_INFO("can't reuse video encoder \"%s\"\n",
+            videnc1->parkedCodecName);
+        gst_tividenc1_free_parked(videnc1);
+        return FALSE;
+    }
+
+    GST_INFO("reusing video encoder \"%s\"\n", videnc1->codecName);
+
+    videnc1->hEngine          = videnc1->hParkedEngine;
+    videnc1->hVe1             = videnc1->hParkedVe1;
+    videnc1->hEncOutBuf       = videnc1->hParkedEncOutBuf;
+
+    videnc1->hParkedEngine    = NULL;
+    videnc1->hParkedVe1       = NULL;
+    videnc1->hParkedEncOutBuf = NULL;
+    gst_tividenc1_free_parked(videnc1);
+
+    /* Start the new stream from a clean codec state */
+    encStatus.size         = sizeof(VIDENC1_Status);
+    encStatus.data.buf     = NULL;
+    encStatus.data.bufSize = 0;
+
+    if (VIDENC1_control(Venc1_getVisaHandle(videnc1->hVe1), XDM_RESET,
+            dynParams, &encStatus) != VIDENC1_EOK) {
+        GST_WARNING("failed to reset video encoder\n");
+    }
+
+    return TRUE;
+}
+
+/******************************************************************************
+ * gst_tividenc1_free_parked
+ *   Delete the codec kept by codec_park, if any.
+ *****************************************************************************/
+static void gst_tividenc1_free_parked (GstTIVidenc1 *videnc1)
+{
+    if (videnc1->hParkedEncOutBuf) {
+        Buffer_delete(videnc1->hParkedEncOutBuf);
+        videnc1->hParkedEncOutBuf = NULL;
+    }
+
+    if (videnc1->hParkedVe1) {
+        GST_LOG("closing kept video encoder\n");
+        Venc1_delete(videnc1->hParkedVe1);
+        videnc1->hParkedVe1 = NULL;
+    }
+
+    if (videnc1->hParkedEngine) {
+        gst_tiengine_close_parked(videnc1->hParkedEngine);
+        videnc1->hParkedEngine = NULL;
+    }
+
+    g_free(videnc1->parkedEngineName);
+    g_free(videnc1->parkedCodecName);
+    videnc1->parkedEngineName = NULL;
+    videnc1->parkedCodecName  = NULL;
+}
+
 /******************************************************************************
  * gst_tividenc1_codec_start
  *   start codec engine
@@ -1151,16 +1304,8 @@ static gboolean gst_tividenc1_codec_start (GstTIVidenc1 *videnc1)
     BufferGfx_Attrs       gfxAttrsOut = BufferGfx_Attrs_DEFAULT;
     VIDENC1_Params        params      = Venc1_Params_DEFAULT;
     Int                   inBufSize;
-
-    /* Open the codec engine */
-    GST_LOG("opening codec engine \"%s\"\n", videnc1->engineName);
-    videnc1->hEngine = Engine_open((Char *) videnc1->engineName, NULL, NULL);
-
-    if (videnc1->hEngine == NULL) {
-        GST_ELEMENT_ERROR(videnc1, RESOURCE, FAILED,
-        ("failed to open codec engine \"%s\"\n", videnc1->engineName), (NULL));
-        return FALSE;
-    }
+    GstClockTime          startTime   = gst_util_get_timestamp();
+    gboolean              reused;
 
     /* setup codec parameters depending on device */
     switch(videnc1->device) {
@@ -1262,16 +1407,36 @@ static gboolean gst_tividenc1_codec_start (GstTIVidenc1 *videnc1)
     GST_LOG("configuring video encode width=%ld, height=%ld, bitrate=%ld\n", 
             params.maxWidth, params.maxHeight, params.maxBitRate);
 
-    GST_LOG("opening video encoder \"%s\"\n", videnc1->codecName);
-    videnc1->hVe1 = Venc1_create(videnc1->hEngine, (Char*)videnc1->codecName,
-                      &params, &dynParams);
+    /* Reuse the codec kept from the last stream if there is one */
+    reused = gst_tividenc1_codec_unpark(videnc1, &params, &dynParams);
+    if (!reused) {
 
-    if (videnc1->hVe1 == NULL) {
-        GST_ELEMENT_ERROR(videnc1, STREAM, CODEC_NOT_FOUND,
-        ("failed to create video encoder: %s\n", videnc1->codecName), (NULL));
-        GST_LOG("closing codec engine\n");
-        gst_tividenc1_exit_video(videnc1);
-        return FALSE;
+        /* Open the codec engine */
+        GST_LOG("opening codec engine \"%s\"\n", videnc1->engineName);
+        videnc1->hEngine = gst_tiengine_open(videnc1->engineName);
+
+        if (videnc1->hEngine == NULL) {
+            GST_ELEMENT_ERROR(videnc1, RESOURCE, FAILED,
+            ("failed to open codec engine \"%s\"\n", videnc1->engineName),
+            (NULL));
+            return FALSE;
+        }
+
+        GST_LOG("opening video encoder \"%s\"\n", videnc1->codecName);
+        videnc1->hVe1 = Venc1_create(videnc1->hEngine,
+                          (Char*)videnc1->codecName, &params, &dynParams);
+
+        if (videnc1->hVe1 == NULL) {
+            GST_ELEMENT_ERROR(videnc1, STREAM, CODEC_NOT_FOUND,
+            ("failed to create video encoder: %s\n", videnc1->codecName),
+            (NULL));
+            GST_LOG("closing codec engine\n");
+            gst_tividenc1_exit_video(videnc1);
+            return FALSE;
+        }
+
+        /* Remember how the codec was created, for codec_unpark */
+        videnc1->codecParams = params;
     }
 
     /* Determine the size of the physically contiguous input buffer.  If
@@ -1307,7 +1472,11 @@ static gboolean gst_tividenc1_codec_start (GstTIVidenc1 *videnc1)
         }
     }
 
-    /* Create codec output buffers */
+    /* Create codec output buffers, unless we are reusing them */
+    if (videnc1->hEncOutBuf) {
+        return TRUE;
+    }
+
     GST_LOG("creating output buffer table\n");
     gfxAttrsOut.colorSpace     = videnc1->colorSpace;
     gfxAttrsOut.dim.width      = videnc1->width;
@@ -1320,6 +1489,10 @@ static gboolean gst_tividenc1_codec_start (GstTIVidenc1 *videnc1)
     videnc1->hEncOutBuf = Buffer_create(Venc1_getOutBufSize(videnc1->hVe1),
         BufferGfx_getBufferAttrs(&gfxAttrsOut));
 
+    GST_INFO("%s video encoder \"%s\" in %" GST_TIME_FORMAT "\n",
+        reused ? "reused" : "created", videnc1->codecName,
+        GST_TIME_ARGS(gst_util_get_timestamp() - startTime));
+
     return TRUE;
 }
 
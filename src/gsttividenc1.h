@@ -105,6 +105,18 @@ struct _GstTIVidenc1
   Buffer_Handle    hInBufRef;
   gboolean         zeroCopyEncode;
 
+  /* Codec reuse.  When reuseCodec is set, codec_stop keeps the codec and its
+   * output buffer here, and codec_start reuses them if the next stream uses
+   * the same codec and creation parameters.
+   */
+  gboolean         reuseCodec;
+  Engine_Handle    hParkedEngine;
+  Venc1_Handle     hParkedVe1;
+  Buffer_Handle    hParkedEncOutBuf;
+  gchar           *parkedEngineName;
+  gchar           *parkedCodecName;
+  VIDENC1_Params   codecParams;       /* params the codec was created with */
+
   /* H.264 header */
   GstBuffer  *codec_data;
   gboolean   byteStream;
@@ -62,7 +62,13 @@ enum {
   PROP_HORZ_WINDOW_TYPE,         /*  hWindowType             (gint)      */
   PROP_VERT_WINDOW_TYPE,         /*  vWindowType             (gint)      */
   PROP_HORZ_FILTER_TYPE,         /*  hFilterType             (gint)      */
-  PROP_VERT_FILTER_TYPE          /*  vFilterType             (gint)      */
+  PROP_VERT_FILTER_TYPE,         /*  vFilterType             (gint)      */
+  PROP_MAX_OUTPUT_BUFS,          /*  maxOutputBufs           (gint)      */
+  PROP_BUF_IDLE_TIMEOUT,         /*  bufIdleTimeout          (gint)      */
+  PROP_CURRENT_OUTPUT_BUFS,      /*  currentOutputBufs       (gint)      */
+  PROP_PEAK_OUTPUT_BUFS,         /*  peakOutputBufs          (gint)      */
+  PROP_BLOCKED_WAITS,            /*  blockedWaits            (guint)     */
+  PROP_PAD_ALLOC_OUTBUFS         /*  padAllocOutbufs         (boolean)   */
 };
 
 /* Define property default */
@@ -71,6 +77,7 @@ enum {
 #define DEFAULT_HORZ_FILTER_TYPE        Resize_FilterType_LOWPASS
 #define DEFAULT_VERT_FILTER_TYPE        Resize_FilterType_LOWPASS
 #define DEFAULT_NUM_OUTPUT_BUFS         2
+#define DEFAULT_BUF_IDLE_TIMEOUT        2000
 #define DEFAULT_CONTIGUOUS_INPUT_FRAME  FALSE
 
 /* Define sink and src pad capabilities.  Currently, UYVY and Y8C8
@@ -134,10 +141,15 @@ static gboolean gst_tividresize_get_unit_size (GstBaseTransform *trans,
 static ColorSpace_Type gst_tividresize_get_colorSpace (guint32 fourcc);
 static void gst_tividresize_set_property(GObject *object, guint prop_id,
  const GValue *value, GParamSpec *pspec);
+static void gst_tividresize_get_property(GObject *object, guint prop_id,
+ GValue *value, GParamSpec *pspec);
 static GstFlowReturn gst_tividresize_prepare_output_buffer (GstBaseTransform
  *trans, GstBuffer *inBuf, gint size, GstCaps *caps, GstBuffer **outBuf);
 static Buffer_Handle gst_tividresize_gfx_buffer_create (gint width, 
  gint height, ColorSpace_Type colorSpace, gint size, gboolean is_reference);
+static gboolean gst_tividresize_alloc_outbufs (GstTIVidresize *vidresize);
+static GstFlowReturn gst_tividresize_pad_alloc (GstTIVidresize *vidresize,
+ guint size, GstCaps *caps, GstBuffer **outBuf);
 
 /******************************************************************************
  * gst_tividresize_init
@@ -152,7 +164,12 @@ static void gst_tividresize_init (GstTIVidresize *vidresize)
     vidresize->vFilterType              =  Resize_FilterType_LOWPASS;
     vidresize->contiguousInputFrame     =  DEFAULT_CONTIGUOUS_INPUT_FRAME;
     vidresize->numOutputBufs            =  DEFAULT_NUM_OUTPUT_BUFS;
+    vidresize->maxOutputBufs            =  0;
+    vidresize->bufIdleTimeout           =  DEFAULT_BUF_IDLE_TIMEOUT;
+    vidresize->padAllocOutbufs          =  FALSE;
     vidresize->hResize                  =  NULL;
+    vidresize->hOutBufTab               =  NULL;
+    vidresize->usePadBufs               =  FALSE;
 }
 
 /******************************************************************************
@@ -227,6 +244,7 @@ static void gst_tividresize_class_init(GstTIVidresizeClass *klass)
     trans_class      = (GstBaseTransformClass *) klass;
 
     gobject_class->set_property = gst_tividresize_set_property;
+    gobject_class->get_property = gst_tividresize_get_property;
 
     gobject_class->finalize = (GObjectFinalizeFunc)gst_tividresize_exit_resize;
 
@@ -253,6 +271,45 @@ static void gst_tividresize_class_init(GstTIVidresizeClass *klass)
             "Number of output buffers to allocate for resizer",
             1, G_MAXINT32, DEFAULT_NUM_OUTPUT_BUFS, G_PARAM_WRITABLE));
 
+    g_object_class_install_property(gobject_class, PROP_MAX_OUTPUT_BUFS,
+        g_param_spec_int("maxOutputBufs",
+            "Maximum number of output buffers",
+            "Create more output buffers, up to this number, rather than "
+            "wait when downstream holds all of them.  0 keeps numOutputBufs",
+            0, G_MAXINT32, 0, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_BUF_IDLE_TIMEOUT,
+        g_param_spec_int("bufIdleTimeout",
+            "Output buffer idle timeout",
+            "Milliseconds an output buffer beyond numOutputBufs may stay "
+            "unused before it is freed (0 = never)",
+            0, G_MAXINT32, DEFAULT_BUF_IDLE_TIMEOUT, G_PARAM_WRITABLE));
+
+    g_object_class_install_property(gobject_class, PROP_CURRENT_OUTPUT_BUFS,
+        g_param_spec_int("currentOutputBufs",
+            "Current number of output buffers",
+            "Number of output buffers allocated now",
+            0, G_MAXINT32, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_PEAK_OUTPUT_BUFS,
+        g_param_spec_int("peakOutputBufs",
+            "Peak number of output buffers",
+            "Largest number of output buffers allocated at once",
+            0, G_MAXINT32, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_BLOCKED_WAITS,
+        g_param_spec_uint("blockedWaits",
+            "Blocked waits",
+            "Number of times the element waited for downstream to release "
+            "an output buffer",
+            0, G_MAXUINT32, 0, G_PARAM_READABLE));
+
+    g_object_class_install_property(gobject_class, PROP_PAD_ALLOC_OUTBUFS,
+        g_param_spec_boolean("padAllocOutbufs", "Use pad allocation",
+            "Write into the buffers of a downstream TI element that shares "
+            "them, instead of allocating output buffers",
+            FALSE, G_PARAM_WRITABLE));
+
     g_object_class_install_property(gobject_class, PROP_HORZ_WINDOW_TYPE,
         g_param_spec_int("hWindowType",
             "Horizontal  video type ",
@@ -328,9 +385,33 @@ static GstFlowReturn gst_tividresize_prepare_output_buffer (GstBaseTransform
 {
     GstTIVidresize *vidresize = GST_TIVIDRESIZE(trans);
     Buffer_Handle   hOutBuf;
+    GstFlowReturn   ret;
 
     GST_LOG("begin prepare output buffer\n");
 
+    /* Write into a buffer of downstream's table if it shares them */
+    if (vidresize->usePadBufs) {
+        ret = gst_tividresize_pad_alloc(vidresize, vidresize->outBufSize,
+                  caps, outBuf);
+        if (ret != GST_FLOW_OK || *outBuf) {
+            return ret;
+        }
+
+        GST_INFO("downstream buffers don't fit; using our own\n");
+        vidresize->usePadBufs = FALSE;
+
+        /* The resizer was configured for the pitch of downstream's buffers */
+        if (vidresize->hResize) {
+            Resize_delete(vidresize->hResize);
+            vidresize->hResize = NULL;
+        }
+    }
+
+    if (vidresize->hOutBufTab == NULL &&
+        !gst_tividresize_alloc_outbufs(vidresize)) {
+        return GST_FLOW_ERROR;
+    }
+
     /* Get free buffer from buftab */
     if (!(hOutBuf = gst_tidmaibuftab_get_buf(vidresize->hOutBufTab))) {
         GST_ELEMENT_ERROR(vidresize, RESOURCE, READ,
@@ -376,6 +457,21 @@ static void gst_tividresize_set_property(GObject *object, guint prop_id,
             GST_LOG("setting \"numOutputBufs\" to \"%d\"\n",
                 vidresize->numOutputBufs);
             break;
+        case PROP_MAX_OUTPUT_BUFS:
+            vidresize->maxOutputBufs = g_value_get_int(value);
+            GST_LOG("setting \"maxOutputBufs\" to \"%d\"\n",
+                vidresize->maxOutputBufs);
+            break;
+        case PROP_BUF_IDLE_TIMEOUT:
+            vidresize->bufIdleTimeout = g_value_get_int(value);
+            GST_LOG("setting \"bufIdleTimeout\" to \"%d\"\n",
+                vidresize->bufIdleTimeout);
+            break;
+        case PROP_PAD_ALLOC_OUTBUFS:
+            vidresize->padAllocOutbufs = g_value_get_boolean(value);
+            GST_LOG("setting \"padAllocOutbufs\" to \"%s\"\n",
+                vidresize->padAllocOutbufs ? "TRUE" : "FALSE");
+            break;
         case PROP_HORZ_WINDOW_TYPE:
             vidresize->hWindowType = g_value_get_int(value);
             GST_LOG("setting \"hWindowType\" to \"%d\"\n",
@@ -398,6 +494,43 @@ static void gst_tividresize_set_property(GObject *object, guint prop_id,
 
     GST_LOG("end set_property\n");
 }
+
+/******************************************************************************
+ * gst_tividresize_get_property
+ *     Return values for requested element property.
+ ******************************************************************************/
+static void gst_tividresize_get_property(GObject *object, guint prop_id,
+                GValue *value, GParamSpec *pspec)
+{
+    GstTIVidresize *vidresize = GST_TIVIDRESIZE(object);
+    gint  numBufs    = 0;
+    gint  peakBufs   = 0;
+    guint numBlocked = 0;
+
+    GST_LOG("begin get_property\n");
+
+    if (vidresize->hOutBufTab) {
+        gst_tidmaibuftab_get_stats(vidresize->hOutBufTab, &numBufs, &peakBufs,
+            &numBlocked);
+    }
+
+    switch (prop_id) {
+        case PROP_CURRENT_OUTPUT_BUFS:
+            g_value_set_int(value, numBufs);
+            break;
+        case PROP_PEAK_OUTPUT_BUFS:
+            g_value_set_int(value, peakBufs);
+            break;
+        case PROP_BLOCKED_WAITS:
+            g_value_set_uint(value, numBlocked);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+
+    GST_LOG("end get_property\n");
+}
        
 /******************************************************************************
  * gst_tividresize_get_unit_size
@@ -427,6 +560,43 @@ static gboolean gst_tividresize_get_unit_size (GstBaseTransform *trans,
     return TRUE; 
 }
 
+/******************************************************************************
+ * gst_tividresize_pad_alloc
+ *    Get an output buffer from downstream.  *outBuf is left NULL if the
+ *    buffer we got can't hold our output frame; its pitch may be larger
+ *    than ours, but not its width, height or color space.
+ *****************************************************************************/
+static GstFlowReturn gst_tividresize_pad_alloc (GstTIVidresize *vidresize,
+    guint size, GstCaps *caps, GstBuffer **outBuf)
+{
+    BufferGfx_Dimensions dim;
+    Buffer_Handle        hOutBuf;
+    GstFlowReturn        ret;
+
+    ret = gst_tidmaibuftab_pad_alloc(
+              GST_BASE_TRANSFORM_SRC_PAD(vidresize), size, caps, outBuf);
+    if (ret != GST_FLOW_OK || *outBuf == NULL) {
+        return ret;
+    }
+
+    hOutBuf = GST_TIDMAIBUFFERTRANSPORT_DMAIBUF(*outBuf);
+    BufferGfx_getDimensions(hOutBuf, &dim);
+
+    if (BufferGfx_getColorSpace(hOutBuf) != vidresize->dstColorSpace ||
+        dim.width < vidresize->dstWidth || dim.height < vidresize->dstHeight) {
+        gst_buffer_unref(*outBuf);
+        *outBuf = NULL;
+        return GST_FLOW_OK;
+    }
+
+    dim.width  = vidresize->dstWidth;
+    dim.height = vidresize->dstHeight;
+    BufferGfx_setDimensions(hOutBuf, &dim);
+
+    return GST_FLOW_OK;
+}
+
+
 /******************************************************************************
  * gst_tividresize_transform 
  *    Transforms one incoming buffer to one outgoing buffer.
@@ -658,10 +828,9 @@ static gboolean gst_tividresize_set_caps (GstBaseTransform *trans,
     GstCaps *in, GstCaps *out)
 {
     GstTIVidresize      *vidresize  = GST_TIVIDRESIZE(trans);
-    BufferGfx_Attrs     gfxAttrs    = BufferGfx_Attrs_DEFAULT;
     gboolean            ret         = FALSE;
     guint32             fourcc;
-    guint               outBufSize;
+    gint                numBufs;
 
     GST_LOG("begin set caps\n");
 
@@ -692,9 +861,54 @@ static gboolean gst_tividresize_set_caps (GstBaseTransform *trans,
     vidresize->dstColorSpace = gst_tividresize_get_colorSpace(fourcc);
 
     /* calculate output buffer size */
-    outBufSize = gst_ti_calc_buffer_size(vidresize->dstWidth,
+    vidresize->outBufSize = gst_ti_calc_buffer_size(vidresize->dstWidth,
         vidresize->dstHeight, 0, vidresize->dstColorSpace);
 
+    /* Drop what was set up for the previous caps */
+    if (vidresize->hResize) {
+        Resize_delete(vidresize->hResize);
+        vidresize->hResize = NULL;
+    }
+
+    if (vidresize->hOutBufTab) {
+        gst_tidmaibuftab_unref(vidresize->hOutBufTab);
+        vidresize->hOutBufTab = NULL;
+    }
+
+    /* If downstream shares its buffers, write our output into them instead
+     * of allocating our own.  Ask downstream for as many buffers beyond its
+     * display queue as we would have allocated, so we can still work ahead.
+     */
+    if (vidresize->numOutputBufs == 0) {
+        vidresize->numOutputBufs = 2;
+    }
+
+    vidresize->usePadBufs = vidresize->padAllocOutbufs &&
+        gst_tidmaibuftab_query_peer(GST_BASE_TRANSFORM_SRC_PAD(trans),
+            vidresize->numOutputBufs, &numBufs);
+
+    if (vidresize->usePadBufs) {
+        GST_INFO("writing into downstream's %d buffers\n", numBufs);
+    }
+    else if (!gst_tividresize_alloc_outbufs(vidresize)) {
+        goto exit;
+    }
+
+    ret = TRUE;
+
+exit:
+    GST_LOG("end set caps\n");
+    return ret;
+}
+
+/******************************************************************************
+ * gst_tividresize_alloc_outbufs
+ *    Create our own table of output buffers for the current output caps.
+ *****************************************************************************/
+static gboolean gst_tividresize_alloc_outbufs (GstTIVidresize *vidresize)
+{
+    BufferGfx_Attrs gfxAttrs = BufferGfx_Attrs_DEFAULT;
+
     /* allocate output buffer */
     gfxAttrs.bAttrs.useMask = gst_tidmaibuffer_GST_FREE;
     gfxAttrs.colorSpace = vidresize->dstColorSpace;
@@ -708,19 +922,24 @@ static gboolean gst_tividresize_set_caps (GstBaseTransform *trans,
     }
  
    vidresize->hOutBufTab = gst_tidmaibuftab_new(vidresize->numOutputBufs,
-       outBufSize, BufferGfx_getBufferAttrs (&gfxAttrs));
+       vidresize->outBufSize, BufferGfx_getBufferAttrs (&gfxAttrs));
+    gst_tidmaibuftab_set_name(vidresize->hOutBufTab,
+        GST_ELEMENT_NAME(vidresize));
 
     if (vidresize->hOutBufTab == NULL) {
         GST_ELEMENT_ERROR(vidresize, RESOURCE, NO_SPACE_LEFT,
         ("failed to create output bufTab\n"), (NULL));
-        goto exit;
+        return FALSE;
     }
 
-    ret = TRUE;
+    /* Let the output buffers grow with downstream demand if asked to */
+    if (vidresize->maxOutputBufs > vidresize->numOutputBufs) {
+        gst_tidmaibuftab_set_elastic(vidresize->hOutBufTab,
+            vidresize->maxOutputBufs, vidresize->bufIdleTimeout ?
+            vidresize->bufIdleTimeout * GST_MSECOND : GST_CLOCK_TIME_NONE);
+    }
 
-exit:
-    GST_LOG("end set caps\n");
-    return ret;
+    return TRUE;
 }
 
 /******************************************************************************
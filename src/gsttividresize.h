@@ -68,6 +68,9 @@ struct _GstTIVidresize
   /* Element property */
   gboolean          contiguousInputFrame;
   gint              numOutputBufs;
+  gint              maxOutputBufs;
+  gint              bufIdleTimeout;
+  gboolean          padAllocOutbufs;
   gint              hWindowType;
   gint              vWindowType;
   gint              hFilterType;
@@ -82,6 +85,8 @@ struct _GstTIVidresize
   ColorSpace_Type   srcColorSpace;
   ColorSpace_Type   dstColorSpace;
   GstTIDmaiBufTab  *hOutBufTab;
+  guint             outBufSize;
+  gboolean          usePadBufs;     /* downstream shares its buffers */
   Cpu_Handle        hCpu;
   Cpu_Device        device;
 };
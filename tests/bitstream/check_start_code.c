@@ -0,0 +1,411 @@
+/*
+ * check_start_code.c
+ *
+ * This file checks the start code scanners in gsttibitstream.c against a
+ * naive byte-by-byte reference, and measures their throughput.  It is built
+ * on the host, once with the SIMD path the compiler targets and once with
+ * the scalar path (see the Makefile in this directory).
+ *
+ * Usage:  check_start_code [--bench] [bitstream files...]
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "gsttibitstream.h"
+
+/* Must match the selection in gsttibitstream.c */
+#if defined(__ARM_NEON__)
+#  define SCAN_PATH "neon"
+#elif defined(__SSE2__)
+#  define SCAN_PATH "sse2"
+#else
+#  define SCAN_PATH "scalar"
+#endif
+
+/* Sizes used by the benchmark */
+#define BENCH_SIZE   (8 * 1024 * 1024)
+#define BENCH_ROUNDS 20
+
+static int numChecks   = 0;
+static int numFailures = 0;
+
+
+/******************************************************************************
+ * ref_find_start_code
+ *    Reference for gst_ti_find_start_code:  the first 00 00 01 at or after
+ *    offset, or size.
+ ******************************************************************************/
+static gint ref_find_start_code(const guint8 *data, gint offset, gint size)
+{
+    gint i;
+
+    for (i = offset; i + 2 < size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * ref_find_start_code4
+ *    Reference for gst_ti_find_start_code4:  the first 00 00 00 01 at or
+ *    after offset, or size.
+ ******************************************************************************/
+static gint ref_find_start_code4(const guint8 *data, gint offset, gint size)
+{
+    gint i;
+
+    for (i = offset; i + 3 < size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 0 &&
+            data[i + 3] == 1) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+
+/******************************************************************************
+ * check_all_offsets
+ *    Compare both scanners with the references from every offset.
+ ******************************************************************************/
+static void check_all_offsets(const guint8 *data, gint size,
+                const char *what)
+{
+    gint offset, got, want;
+
+    for (offset = 0; offset <= size; offset++) {
+        numChecks++;
+        got  = gst_ti_find_start_code(data, offset, size);
+        want = ref_find_start_code(data, offset, size);
+        if (got != want) {
+            if (numFailures++ < 10) {
+                printf("FAIL %s: find_start_code(offset %d, size %d) = %d, "
+                    "expected %d\n", what, offset, size, got, want);
+            }
+        }
+
+        numChecks++;
+        got  = gst_ti_find_start_code4(data, offset, size);
+        want = ref_find_start_code4(data, offset, size);
+        if (got != want) {
+            if (numFailures++ < 10) {
+                printf("FAIL %s: find_start_code4(offset %d, size %d) = %d, "
+                    "expected %d\n", what, offset, size, got, want);
+            }
+        }
+    }
+}
+
+
+/******************************************************************************
+ * fill_random
+ *    Fill a buffer with bytes that are zero or one often enough to form
+ *    prefixes, partial prefixes and runs of zeros.
+ ******************************************************************************/
+static void fill_random(guint8 *data, gint size, gint density)
+{
+    gint i, r;
+
+    for (i = 0; i < size; i++) {
+        r = rand() % 100;
+        if (r < density) {
+            data[i] = 0;
+        }
+        else if (r < density + density / 2) {
+            data[i] = 1;
+        }
+        else {
+            data[i] = 2 + rand() % 254;
+        }
+    }
+}
+
+
+/******************************************************************************
+ * check_random
+ *    Random buffers of every small size, at every alignment.
+ ******************************************************************************/
+static void check_random(void)
+{
+    static const gint densities[] = { 0, 5, 30, 60, 90 };
+    guint8 store[256 + 16];
+    guint8 *data;
+    gint   size, align, d, round;
+
+    for (round = 0; round < 20; round++) {
+        for (d = 0; d < (gint)(sizeof(densities) / sizeof(densities[0]));
+             d++) {
+            for (align = 0; align < 16; align++) {
+                for (size = 0; size <= 80; size++) {
+                    data = store + align;
+                    fill_random(data, size, densities[d]);
+                    check_all_offsets(data, size, "random");
+                }
+            }
+        }
+    }
+}
+
+
+/******************************************************************************
+ * check_placed
+ *    A single prefix at every position of a buffer that is otherwise free of
+ *    start codes, including positions straddling a vector block and the last
+ *    bytes of the buffer.
+ ******************************************************************************/
+static void check_placed(void)
+{
+    static const guint8 prefix4[] = { 0, 0, 0, 1 };
+    guint8 store[128 + 16];
+    guint8 *data;
+    gint   size, pos, align, len;
+
+    for (align = 0; align < 16; align += 3) {
+        data = store + align;
+        for (size = 3; size <= 70; size++) {
+            for (len = 3; len <= 4; len++) {
+                for (pos = 0; pos + len <= size; pos++) {
+                    memset(data, 0xff, size);
+                    memcpy(data + pos, prefix4 + 4 - len, len);
+                    check_all_offsets(data, size, "placed");
+                }
+            }
+        }
+    }
+
+    /* All zeros, with and without a trailing 01 */
+    for (size = 0; size <= 70; size++) {
+        memset(store, 0, size);
+        check_all_offsets(store, size, "zeros");
+        if (size > 0) {
+            store[size - 1] = 1;
+            check_all_offsets(store, size, "zeros+01");
+        }
+    }
+}
+
+
+/******************************************************************************
+ * check_page_end
+ *    Buffers that end right before an unreadable page, to catch reads past
+ *    size.
+ ******************************************************************************/
+static void check_page_end(void)
+{
+    long    pageSize = sysconf(_SC_PAGESIZE);
+    guint8 *pages;
+    guint8 *data;
+    gint    size;
+
+    pages = mmap(NULL, pageSize * 2, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED || mprotect(pages + pageSize, pageSize,
+                                   PROT_NONE) != 0) {
+        printf("SKIP page-end checks: can't set up a guard page\n");
+        return;
+    }
+
+    for (size = 0; size <= 80; size++) {
+        data = pages + pageSize - size;
+        fill_random(data, size, 60);
+        check_all_offsets(data, size, "page-end");
+
+        memset(data, 0xff, size);
+        check_all_offsets(data, size, "page-end");
+    }
+
+    munmap(pages, pageSize * 2);
+}
+
+
+/******************************************************************************
+ * check_file
+ *    Compare the scanners on a real bitstream.
+ ******************************************************************************/
+static void check_file(const char *name)
+{
+    FILE   *file;
+    guint8 *data;
+    long    size;
+    gint    pos, got, want, step;
+
+    if (!(file = fopen(name, "rb"))) {
+        printf("FAIL can't open %s\n", name);
+        numFailures++;
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    data = malloc(size > 0 ? size : 1);
+    if (fread(data, 1, size, file) != (size_t)size) {
+        printf("FAIL can't read %s\n", name);
+        numFailures++;
+        size = 0;
+    }
+    fclose(file);
+
+    /* Walk the start codes the way the framers do */
+    for (step = 0; step < 2; step++) {
+        pos = 0;
+        while (pos < size) {
+            numChecks++;
+            got  = step ? gst_ti_find_start_code4(data, pos, size) :
+                          gst_ti_find_start_code(data, pos, size);
+            want = step ? ref_find_start_code4(data, pos, size) :
+                          ref_find_start_code(data, pos, size);
+            if (got != want) {
+                if (numFailures++ < 10) {
+                    printf("FAIL %s: scan from %d = %d, expected %d\n", name,
+                        pos, got, want);
+                }
+                break;
+            }
+            pos = got + 1;
+        }
+    }
+
+    printf("checked %s (%ld bytes)\n", name, size);
+    free(data);
+}
+
+
+/******************************************************************************
+ * now
+ ******************************************************************************/
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/******************************************************************************
+ * bench_one
+ *    Time scanning a buffer for every start code, and report MB/s.
+ ******************************************************************************/
+static void bench_one(const char *label, const guint8 *data, gint size,
+                gint (*scan)(const guint8 *data, gint offset, gint size))
+{
+    double start, elapsed;
+    gint   round, pos, found = 0;
+
+    start = now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        pos = 0;
+        while ((pos = scan(data, pos, size)) < size) {
+            found++;
+            pos++;
+        }
+    }
+    elapsed = now() - start;
+
+    printf("  %-26s %8.1f MB/s  (%d start codes)\n", label,
+        (double)size * BENCH_ROUNDS / elapsed / (1024 * 1024),
+        found / BENCH_ROUNDS);
+}
+
+
+/******************************************************************************
+ * bench
+ *    Compare the scanner with the reference on payload-like data with
+ *    start codes every 4 KB (slices at high bitrate) and every 64 bytes.
+ ******************************************************************************/
+static void bench(void)
+{
+    static const gint spacings[] = { 4096, 64 };
+    guint8 *data = malloc(BENCH_SIZE);
+    gint    i, s;
+    char    label[64];
+
+    for (s = 0; s < 2; s++) {
+        for (i = 0; i < BENCH_SIZE; i++) {
+            data[i] = rand() & 0xff;
+        }
+        for (i = 0; i + 4 <= BENCH_SIZE; i += spacings[s]) {
+            data[i] = data[i + 1] = data[i + 2] = 0;
+            data[i + 3] = 1;
+        }
+
+        printf("start code every %d bytes:\n", spacings[s]);
+        snprintf(label, sizeof(label), "find_start_code (%s)", SCAN_PATH);
+        bench_one(label, data, BENCH_SIZE, gst_ti_find_start_code);
+        bench_one("reference", data, BENCH_SIZE, ref_find_start_code);
+        snprintf(label, sizeof(label), "find_start_code4 (%s)", SCAN_PATH);
+        bench_one(label, data, BENCH_SIZE, gst_ti_find_start_code4);
+        bench_one("reference4", data, BENCH_SIZE, ref_find_start_code4);
+    }
+
+    free(data);
+}
+
+
+/******************************************************************************
+ * main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    int doBench = 0;
+    int i;
+
+    srand(1);
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--bench")) {
+            doBench = 1;
+        }
+        else {
+            check_file(argv[i]);
+        }
+    }
+
+    check_random();
+    check_placed();
+    check_page_end();
+
+    printf("%s scan: %d checks, %d failures\n", SCAN_PATH, numChecks,
+        numFailures);
+
+    if (doBench) {
+        bench();
+    }
+
+    return numFailures ? 1 : 0;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
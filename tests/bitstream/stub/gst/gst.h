@@ -0,0 +1,52 @@
+/*
+ * gst.h
+ *
+ * This file is a minimal stand-in for the GStreamer header, so that the
+ * bitstream helpers can be built and checked on a host without GStreamer.
+ * It only declares what gsttibitstream.c uses.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_GST_H__
+#define __GST_TI_STUB_GST_H__
+
+#include <stdint.h>
+
+typedef int           gint;
+typedef int           gboolean;
+typedef int32_t       gint32;
+typedef uint8_t       guint8;
+typedef uint32_t      guint32;
+
+#define TRUE  1
+#define FALSE 0
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#define G_BEGIN_DECLS
+#define G_END_DECLS
+
+#endif /* __GST_TI_STUB_GST_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,274 @@
+/*
+ * bench_buftab.c
+ *
+ * This file counts how many transport buffers gst_tidmaibuffertransport_new
+ * allocates for a stream of frames from a GstTIDmaiBufTab, with transport
+ * buffer recycling turned off (GST_TI_BufTabRecycle=FALSE) and on, and
+ * times a frame's wrap and release.  The real gsttidmaibuftab.c and
+ * gsttidmaibuffertransport.c are built against the stand-ins in stub/.
+ *
+ * Frames are taken from a table of NUM_BUFS buffers, wrapped, and held
+ * downstream QUEUE_DEPTH at a time before they are released, either by the
+ * same thread or by a sink thread.
+ *
+ * Usage:  bench_buftab [frames]
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "gsttidmaibuftab.h"
+#include "gsttidmaibuffertransport.h"
+#include "gstticommonutils.h"
+
+#define NUM_BUFS     4
+#define QUEUE_DEPTH  2
+#define BUF_SIZE     (320 * 240 * 2)
+
+extern gint gst_ti_stub_num_freed;
+
+static gint numFailures = 0;
+
+/* Frames in flight between the producer and the sink thread */
+typedef struct _Queue {
+    pthread_mutex_t  mutex;
+    pthread_cond_t   cond;
+    GstBuffer       *bufs[QUEUE_DEPTH + 1];
+    gint             head;
+    gint             count;
+    gboolean         done;
+} Queue;
+
+
+/******************************************************************************
+ * gst_ti_env_is_defined / gst_ti_env_get_boolean
+ *    Copies of the helpers in gstticommonutils.c, which needs DMAI.
+ ******************************************************************************/
+gboolean gst_ti_env_is_defined(gchar *env)
+{
+    return getenv(env) != NULL;
+}
+
+gboolean gst_ti_env_get_boolean(gchar *env)
+{
+    gchar *value = getenv(env);
+
+    return value && !strcmp(value, "TRUE");
+}
+
+
+/******************************************************************************
+ * new_table
+ ******************************************************************************/
+static GstTIDmaiBufTab* new_table(void)
+{
+    BufferGfx_Attrs gfxAttrs = { { Buffer_Type_GRAPHICS,
+                                   gst_tidmaibuffer_GST_FREE } };
+
+    return gst_tidmaibuftab_new(NUM_BUFS, BUF_SIZE,
+               BufferGfx_getBufferAttrs(&gfxAttrs));
+}
+
+
+/******************************************************************************
+ * wrap_frame
+ *    Take a free buffer and wrap it, as a decoder does for each frame.
+ ******************************************************************************/
+static GstBuffer* wrap_frame(GstTIDmaiBufTab *table, gint frame)
+{
+    Buffer_Handle  hBuf = gst_tidmaibuftab_get_buf(table);
+    GstBuffer     *buf;
+
+    buf = gst_tidmaibuffertransport_new(hBuf, table);
+    if (buf == NULL || GST_TIDMAIBUFFERTRANSPORT_DMAIBUF(buf) != hBuf ||
+        GST_BUFFER_TIMESTAMP(buf) != GST_CLOCK_TIME_NONE) {
+        printf("FAIL frame %d: bad transport buffer\n", frame);
+        numFailures++;
+    }
+
+    GST_BUFFER_TIMESTAMP(buf) = frame;
+    return buf;
+}
+
+
+/******************************************************************************
+ * sink_thread
+ *    Release frames as they arrive.
+ ******************************************************************************/
+static void* sink_thread(void *arg)
+{
+    Queue     *queue = (Queue*)arg;
+    GstBuffer *buf;
+
+    pthread_mutex_lock(&queue->mutex);
+    while (TRUE) {
+        while (queue->count == 0 && !queue->done) {
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+        }
+        if (queue->count == 0) {
+            break;
+        }
+
+        buf = queue->bufs[queue->head];
+        queue->head = (queue->head + 1) % (QUEUE_DEPTH + 1);
+        queue->count--;
+        pthread_cond_broadcast(&queue->cond);
+
+        pthread_mutex_unlock(&queue->mutex);
+        gst_buffer_unref(buf);
+        pthread_mutex_lock(&queue->mutex);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * run_one_thread
+ *    Wrap every frame and release it QUEUE_DEPTH frames later.
+ ******************************************************************************/
+static void run_one_thread(GstTIDmaiBufTab *table, gint numFrames)
+{
+    GstBuffer *held[QUEUE_DEPTH];
+    gint       frame;
+
+    for (frame = 0; frame < numFrames; frame++) {
+        if (frame >= QUEUE_DEPTH) {
+            gst_buffer_unref(held[frame % QUEUE_DEPTH]);
+        }
+        held[frame % QUEUE_DEPTH] = wrap_frame(table, frame);
+    }
+
+    for (frame = MAX(numFrames - QUEUE_DEPTH, 0); frame < numFrames;
+         frame++) {
+        gst_buffer_unref(held[frame % QUEUE_DEPTH]);
+    }
+}
+
+
+/******************************************************************************
+ * run_sink_thread
+ *    Wrap every frame and hand it to a sink thread that releases it.
+ ******************************************************************************/
+static void run_sink_thread(GstTIDmaiBufTab *table, gint numFrames)
+{
+    Queue     queue;
+    pthread_t sink;
+    GstBuffer *buf;
+    gint      frame;
+
+    memset(&queue, 0, sizeof(queue));
+    pthread_mutex_init(&queue.mutex, NULL);
+    pthread_cond_init(&queue.cond, NULL);
+    pthread_create(&sink, NULL, sink_thread, &queue);
+
+    for (frame = 0; frame < numFrames; frame++) {
+        buf = wrap_frame(table, frame);
+
+        pthread_mutex_lock(&queue.mutex);
+        while (queue.count == QUEUE_DEPTH) {
+            pthread_cond_wait(&queue.cond, &queue.mutex);
+        }
+        queue.bufs[(queue.head + queue.count) % (QUEUE_DEPTH + 1)] = buf;
+        queue.count++;
+        pthread_cond_broadcast(&queue.cond);
+        pthread_mutex_unlock(&queue.mutex);
+    }
+
+    pthread_mutex_lock(&queue.mutex);
+    queue.done = TRUE;
+    pthread_cond_broadcast(&queue.cond);
+    pthread_mutex_unlock(&queue.mutex);
+
+    pthread_join(sink, NULL);
+    pthread_cond_destroy(&queue.cond);
+    pthread_mutex_destroy(&queue.mutex);
+}
+
+
+/******************************************************************************
+ * bench_one
+ ******************************************************************************/
+static void bench_one(const char *label, gboolean recycle, gboolean threaded,
+                gint numFrames)
+{
+    GType            type = GST_TYPE_TIDMAIBUFFERTRANSPORT;
+    GstTIDmaiBufTab *table;
+    guint            created;
+    GstClockTime     start, elapsed;
+
+    setenv("GST_TI_BufTabRecycle", recycle ? "TRUE" : "FALSE", 1);
+
+    created = type->numCreated;
+    table   = new_table();
+
+    start = gst_util_get_timestamp();
+    if (threaded) {
+        run_sink_thread(table, numFrames);
+    }
+    else {
+        run_one_thread(table, numFrames);
+    }
+    elapsed = gst_util_get_timestamp() - start;
+
+    gst_tidmaibuftab_unref(table);
+    created = type->numCreated - created;
+
+    printf("  %-12s recycle %-5s %8u allocated for %d frames  %6.0f ns/frame"
+        "\n", label, recycle ? "TRUE" : "FALSE", created, numFrames,
+        (double)elapsed / numFrames);
+}
+
+
+/******************************************************************************
+ * main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    gint numFrames = argc > 1 ? atoi(argv[1]) : 100000;
+    gint numCreated;
+
+    printf("%d buffers in the table, %d frames held downstream\n", NUM_BUFS,
+        QUEUE_DEPTH);
+
+    bench_one("one thread", FALSE, FALSE, numFrames);
+    bench_one("one thread", TRUE, FALSE, numFrames);
+    bench_one("sink thread", FALSE, TRUE, numFrames);
+    bench_one("sink thread", TRUE, TRUE, numFrames);
+
+    /* Every transport buffer and table must have been freed */
+    numCreated = GST_TYPE_TIDMAIBUFFERTRANSPORT->numCreated +
+                 GST_TYPE_TIDMAIBUFTAB->numCreated;
+    if (numCreated != gst_ti_stub_num_freed) {
+        printf("FAIL %d mini objects created, %d freed\n", numCreated,
+            gst_ti_stub_num_freed);
+        numFailures++;
+    }
+
+    return numFailures ? 1 : 0;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
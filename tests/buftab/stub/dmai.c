@@ -0,0 +1,161 @@
+/*
+ * dmai.c
+ *
+ * This file implements the stand-in for the DMAI Buffer and BufTab modules
+ * declared in stub/ti/sdo/dmai.  Buffers are plain heap memory.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <ti/sdo/dmai/Buffer.h>
+#include <ti/sdo/dmai/BufTab.h>
+
+struct Buffer_Object {
+    Int8          *userPtr;
+    Int32          size;
+    UInt16         useMask;
+    UInt16         origMask;
+    BufTab_Handle  hBufTab;
+};
+
+struct BufTab_Object {
+    Int            numBufs;
+    Buffer_Handle *bufs;
+};
+
+
+/******************************************************************************
+ * Buffer
+ ******************************************************************************/
+Buffer_Handle Buffer_create(Int32 size, Buffer_Attrs *attrs)
+{
+    Buffer_Handle hBuf = calloc(1, sizeof(struct Buffer_Object));
+
+    hBuf->userPtr  = malloc(size);
+    hBuf->size     = size;
+    hBuf->useMask  = attrs->useMask;
+    hBuf->origMask = attrs->useMask;
+    return hBuf;
+}
+
+Int Buffer_delete(Buffer_Handle hBuf)
+{
+    free(hBuf->userPtr);
+    free(hBuf);
+    return 0;
+}
+
+Int32 Buffer_getSize(Buffer_Handle hBuf)
+{
+    return hBuf->size;
+}
+
+Int8* Buffer_getUserPtr(Buffer_Handle hBuf)
+{
+    return hBuf->userPtr;
+}
+
+UInt16 Buffer_getUseMask(Buffer_Handle hBuf)
+{
+    return hBuf->useMask;
+}
+
+Void Buffer_setUseMask(Buffer_Handle hBuf, UInt16 useMask)
+{
+    hBuf->useMask = useMask;
+}
+
+Void Buffer_freeUseMask(Buffer_Handle hBuf, UInt16 useMask)
+{
+    __atomic_and_fetch(&hBuf->useMask, (UInt16) ~useMask, __ATOMIC_SEQ_CST);
+}
+
+Void Buffer_resetUseMask(Buffer_Handle hBuf)
+{
+    hBuf->useMask = hBuf->origMask;
+}
+
+Bool Buffer_inUse(Buffer_Handle hBuf)
+{
+    return __atomic_load_n(&hBuf->useMask, __ATOMIC_SEQ_CST) != 0;
+}
+
+BufTab_Handle Buffer_getBufTab(Buffer_Handle hBuf)
+{
+    return hBuf->hBufTab;
+}
+
+
+/******************************************************************************
+ * BufTab
+ ******************************************************************************/
+BufTab_Handle BufTab_create(Int numBufs, Int32 size, Buffer_Attrs *attrs)
+{
+    BufTab_Handle hBufTab = calloc(1, sizeof(struct BufTab_Object));
+    Int           i;
+
+    hBufTab->numBufs = numBufs;
+    hBufTab->bufs    = calloc(numBufs, sizeof(Buffer_Handle));
+
+    for (i = 0; i < numBufs; i++) {
+        hBufTab->bufs[i] = Buffer_create(size, attrs);
+        hBufTab->bufs[i]->hBufTab = hBufTab;
+        hBufTab->bufs[i]->useMask = 0;
+    }
+
+    return hBufTab;
+}
+
+Int BufTab_delete(BufTab_Handle hBufTab)
+{
+    Int i;
+
+    for (i = 0; i < hBufTab->numBufs; i++) {
+        Buffer_delete(hBufTab->bufs[i]);
+    }
+    free(hBufTab->bufs);
+    free(hBufTab);
+    return 0;
+}
+
+Buffer_Handle BufTab_getFreeBuf(BufTab_Handle hBufTab)
+{
+    Int i;
+
+    for (i = 0; i < hBufTab->numBufs; i++) {
+        if (!Buffer_inUse(hBufTab->bufs[i])) {
+            Buffer_resetUseMask(hBufTab->bufs[i]);
+            return hBufTab->bufs[i];
+        }
+    }
+
+    return NULL;
+}
+
+Int BufTab_getNumBufs(BufTab_Handle hBufTab)
+{
+    return hBufTab->numBufs;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,469 @@
+/*
+ * gst.c
+ *
+ * This file implements the stand-in for GStreamer and GLib declared in
+ * stub/gst/gst.h:  types, mini objects and buffers, plus the list, hash
+ * table and string helpers GstTIDmaiBufTab uses.  Pads and queries are
+ * never answered.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <stdarg.h>
+
+#include <gst/gst.h>
+
+/* A hash table entry */
+typedef struct _GstTIStubPair {
+    gpointer key;
+    gpointer value;
+} GstTIStubPair;
+
+struct _GHashTable {
+    GList          *pairs;
+    GDestroyNotify  keyDestroy;
+    GDestroyNotify  valueDestroy;
+};
+
+/* Number of mini objects freed, of every type */
+gint gst_ti_stub_num_freed = 0;
+
+
+/******************************************************************************
+ * Lists
+ ******************************************************************************/
+GList* g_list_prepend(GList *list, gpointer data)
+{
+    GList *item = g_new(GList, 1);
+
+    item->data = data;
+    item->next = list;
+    return item;
+}
+
+GList* g_list_delete_link(GList *list, GList *link)
+{
+    GList **prev;
+
+    for (prev = &list; *prev; prev = &(*prev)->next) {
+        if (*prev == link) {
+            *prev = link->next;
+            g_free(link);
+            break;
+        }
+    }
+
+    return list;
+}
+
+void g_list_free(GList *list)
+{
+    GList *next;
+
+    for (; list; list = next) {
+        next = list->next;
+        g_free(list);
+    }
+}
+
+
+/******************************************************************************
+ * Hash tables
+ ******************************************************************************/
+guint g_direct_hash(gconstpointer key)
+{
+    return (guint) (uintptr_t) key;
+}
+
+gboolean g_direct_equal(gconstpointer a, gconstpointer b)
+{
+    return a == b;
+}
+
+GHashTable* g_hash_table_new_full(GHashFunc hash, GEqualFunc equal,
+                GDestroyNotify key_destroy, GDestroyNotify value_destroy)
+{
+    GHashTable *table = g_new0(GHashTable, 1);
+
+    table->keyDestroy   = key_destroy;
+    table->valueDestroy = value_destroy;
+    return table;
+}
+
+static GList* gst_ti_stub_hash_find(GHashTable *table, gconstpointer key)
+{
+    GList *item;
+
+    for (item = table->pairs; item; item = item->next) {
+        if (((GstTIStubPair*) item->data)->key == key) {
+            return item;
+        }
+    }
+
+    return NULL;
+}
+
+static void gst_ti_stub_hash_free(GHashTable *table, GstTIStubPair *pair)
+{
+    if (table->keyDestroy) {
+        table->keyDestroy(pair->key);
+    }
+    if (table->valueDestroy) {
+        table->valueDestroy(pair->value);
+    }
+    g_free(pair);
+}
+
+gpointer g_hash_table_lookup(GHashTable *table, gconstpointer key)
+{
+    GList *item = gst_ti_stub_hash_find(table, key);
+
+    return item ? ((GstTIStubPair*) item->data)->value : NULL;
+}
+
+void g_hash_table_insert(GHashTable *table, gpointer key, gpointer value)
+{
+    GstTIStubPair *pair;
+    GList         *item = gst_ti_stub_hash_find(table, key);
+
+    if (item) {
+        pair = item->data;
+        if (table->valueDestroy) {
+            table->valueDestroy(pair->value);
+        }
+        pair->value = value;
+        return;
+    }
+
+    pair         = g_new(GstTIStubPair, 1);
+    pair->key    = key;
+    pair->value  = value;
+    table->pairs = g_list_prepend(table->pairs, pair);
+}
+
+gboolean g_hash_table_steal(GHashTable *table, gconstpointer key)
+{
+    GList *item = gst_ti_stub_hash_find(table, key);
+
+    if (item == NULL) {
+        return FALSE;
+    }
+
+    g_free(item->data);
+    table->pairs = g_list_delete_link(table->pairs, item);
+    return TRUE;
+}
+
+gboolean g_hash_table_remove(GHashTable *table, gconstpointer key)
+{
+    GList *item = gst_ti_stub_hash_find(table, key);
+
+    if (item == NULL) {
+        return FALSE;
+    }
+
+    gst_ti_stub_hash_free(table, item->data);
+    table->pairs = g_list_delete_link(table->pairs, item);
+    return TRUE;
+}
+
+void g_hash_table_destroy(GHashTable *table)
+{
+    GList *item;
+
+    for (item = table->pairs; item; item = item->next) {
+        gst_ti_stub_hash_free(table, item->data);
+    }
+    g_list_free(table->pairs);
+    g_free(table);
+}
+
+void g_hash_table_iter_init(GHashTableIter *iter, GHashTable *table)
+{
+    iter->next = table->pairs;
+}
+
+gboolean g_hash_table_iter_next(GHashTableIter *iter, gpointer *key,
+             gpointer *value)
+{
+    GstTIStubPair *pair;
+
+    if (iter->next == NULL) {
+        return FALSE;
+    }
+
+    pair       = iter->next->data;
+    iter->next = iter->next->next;
+    *key       = pair->key;
+    *value     = pair->value;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ * Strings
+ ******************************************************************************/
+GString* g_string_new(const gchar *init)
+{
+    GString *string = g_new(GString, 1);
+
+    string->str = strdup(init ? init : "");
+    return string;
+}
+
+void g_string_append_printf(GString *string, const gchar *format, ...)
+{
+    va_list  args;
+    gchar   *text;
+    size_t   len = strlen(string->str);
+    gint     n;
+
+    va_start(args, format);
+    n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    text = malloc(len + n + 1);
+    memcpy(text, string->str, len);
+
+    va_start(args, format);
+    vsnprintf(text + len, n + 1, format, args);
+    va_end(args);
+
+    g_free(string->str);
+    string->str = text;
+}
+
+gchar* g_string_free(GString *string, gboolean free_segment)
+{
+    gchar *str = string->str;
+
+    g_free(string);
+    if (free_segment) {
+        g_free(str);
+        return NULL;
+    }
+
+    return str;
+}
+
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+void gst_ti_stub_type_register(GType type)
+{
+    type->klass = calloc(1, type->classSize);
+
+    if (type->parent) {
+        memcpy(type->klass, type->parent->klass, type->parent->classSize);
+    }
+    ((GTypeClass*) type->klass)->g_type = type;
+}
+
+gboolean gst_ti_stub_type_is_a(GType type, GType ancestor)
+{
+    for (; type; type = type->parent) {
+        if (type == ancestor) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+gpointer g_type_class_peek_parent(gpointer klass)
+{
+    GType parent = ((GTypeClass*) klass)->g_type->parent;
+
+    return parent ? parent->klass : NULL;
+}
+
+
+/******************************************************************************
+ * Mini objects
+ ******************************************************************************/
+static void gst_mini_object_finalize(GstMiniObject *obj)
+{
+}
+
+GType gst_mini_object_get_type(void)
+{
+    static struct _GstTIStubType type;
+
+    if (type.klass == NULL) {
+        type.name         = "GstMiniObject";
+        type.classSize    = sizeof(GstMiniObjectClass);
+        type.instanceSize = sizeof(GstMiniObject);
+        gst_ti_stub_type_register(&type);
+        GST_MINI_OBJECT_CLASS(type.klass)->finalize = gst_mini_object_finalize;
+    }
+
+    return &type;
+}
+
+static void gst_ti_stub_instance_init(GType type, gpointer instance)
+{
+    if (type->parent) {
+        gst_ti_stub_instance_init(type->parent, instance);
+    }
+    if (type->instanceInit) {
+        type->instanceInit(instance);
+    }
+}
+
+GstMiniObject* gst_mini_object_new(GType type)
+{
+    GstMiniObject *obj = calloc(1, type->instanceSize);
+
+    obj->instance.g_class = type->klass;
+    obj->refcount         = 1;
+    gst_ti_stub_instance_init(type, obj);
+
+    g_atomic_int_inc(&type->numCreated);
+    return obj;
+}
+
+GstMiniObject* gst_mini_object_ref(GstMiniObject *obj)
+{
+    g_atomic_int_inc(&obj->refcount);
+    return obj;
+}
+
+/* As in GStreamer 0.10.24 and later:  finalize runs with a reference held,
+ * and the object is only freed if finalize didn't take another one.
+ */
+void gst_mini_object_unref(GstMiniObject *obj)
+{
+    GstMiniObjectClass *klass;
+
+    if (__atomic_sub_fetch(&obj->refcount, 1, __ATOMIC_SEQ_CST) != 0) {
+        return;
+    }
+
+    g_atomic_int_inc(&obj->refcount);
+    klass = (GstMiniObjectClass*) obj->instance.g_class;
+    klass->finalize(obj);
+
+    if (__atomic_sub_fetch(&obj->refcount, 1, __ATOMIC_SEQ_CST) == 0) {
+        g_atomic_int_inc(&gst_ti_stub_num_freed);
+        free(obj);
+    }
+}
+
+
+/******************************************************************************
+ * Buffers and caps
+ ******************************************************************************/
+static void gst_buffer_init(GstBuffer *buf)
+{
+    buf->timestamp  = GST_CLOCK_TIME_NONE;
+    buf->duration   = GST_CLOCK_TIME_NONE;
+    buf->offset     = GST_BUFFER_OFFSET_NONE;
+    buf->offset_end = GST_BUFFER_OFFSET_NONE;
+}
+
+static void gst_buffer_finalize(GstMiniObject *obj)
+{
+    gst_caps_replace(&GST_BUFFER_CAPS(obj), NULL);
+    g_free(GST_BUFFER_MALLOCDATA(obj));
+}
+
+GType gst_buffer_get_type(void)
+{
+    static struct _GstTIStubType type;
+
+    if (type.klass == NULL) {
+        type.name         = "GstBuffer";
+        type.parent       = GST_TYPE_MINI_OBJECT;
+        type.classSize    = sizeof(GstBufferClass);
+        type.instanceSize = sizeof(GstBuffer);
+        type.instanceInit = (void (*)(gpointer)) gst_buffer_init;
+        gst_ti_stub_type_register(&type);
+        GST_MINI_OBJECT_CLASS(type.klass)->finalize = gst_buffer_finalize;
+    }
+
+    return &type;
+}
+
+void gst_caps_replace(GstCaps **caps, GstCaps *newcaps)
+{
+    *caps = newcaps;
+}
+
+gboolean gst_caps_is_equal(const GstCaps *a, const GstCaps *b)
+{
+    return a == b;
+}
+
+
+/******************************************************************************
+ * Pads, queries and structures
+ ******************************************************************************/
+GstQueryType gst_query_type_register(const gchar *nick,
+                 const gchar *description)
+{
+    return 1;
+}
+
+GstQuery* gst_query_new_application(GstQueryType type,
+              GstStructure *structure)
+{
+    return NULL;
+}
+
+GstStructure* gst_query_get_structure(GstQuery *query)
+{
+    return NULL;
+}
+
+void gst_query_unref(GstQuery *query)
+{
+}
+
+GstStructure* gst_structure_new(const gchar *name, const gchar *field, ...)
+{
+    return NULL;
+}
+
+void gst_structure_set(GstStructure *structure, const gchar *field, ...)
+{
+}
+
+gboolean gst_structure_get_int(const GstStructure *structure,
+             const gchar *field, gint *value)
+{
+    return FALSE;
+}
+
+gboolean gst_pad_peer_query(GstPad *pad, GstQuery *query)
+{
+    return FALSE;
+}
+
+GstFlowReturn gst_pad_alloc_buffer(GstPad *pad, guint64 offset, gint size,
+                  GstCaps *caps, GstBuffer **buf)
+{
+    *buf = NULL;
+    return -1;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,312 @@
+/*
+ * gst.h
+ *
+ * This file is a minimal stand-in for the GStreamer and GLib headers, so
+ * that GstTIDmaiBufTab and GstTIDmaiBufferTransport can be built and
+ * measured on a host without GStreamer.  It only declares what those files
+ * use; gst.c implements it.  Mini objects are freed the way GStreamer
+ * 0.10.24 and later free them, so finalize can keep one alive, and the
+ * number created of each type is counted.  Logging is compiled out.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_GST_H__
+#define __GST_TI_STUB_GST_H__
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef char          gchar;
+typedef int           gint;
+typedef unsigned int  guint;
+typedef int           gboolean;
+typedef void*         gpointer;
+typedef const void*   gconstpointer;
+typedef uint8_t       guint8;
+typedef int32_t       gint32;
+typedef uint32_t      guint32;
+typedef int64_t       gint64;
+typedef uint64_t      guint64;
+typedef guint64       GstClockTime;
+typedef int           GstFormat;
+typedef int           GstFlowReturn;
+typedef int           GstQueryType;
+
+typedef void     (*GDestroyNotify)(gpointer data);
+typedef guint    (*GHashFunc)(gconstpointer key);
+typedef gboolean (*GEqualFunc)(gconstpointer a, gconstpointer b);
+
+#define TRUE  1
+#define FALSE 0
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#define G_BEGIN_DECLS
+#define G_END_DECLS
+
+#define G_GUINT64_FORMAT  PRIu64
+#define G_TYPE_INT        1
+
+#define g_return_val_if_fail(expr, val) \
+    do { if (!(expr)) return (val); } while (0)
+
+/* Atomics, with the full barriers GLib gives them */
+#define g_atomic_int_get(p)      __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define g_atomic_int_set(p, v)   __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define g_atomic_int_inc(p)      ((void) __atomic_add_fetch((p), 1, \
+                                     __ATOMIC_SEQ_CST))
+#define g_atomic_int_add(p, v)   ((void) __atomic_add_fetch((p), (v), \
+                                     __ATOMIC_SEQ_CST))
+#define g_atomic_pointer_get(p)  __atomic_load_n((p), __ATOMIC_SEQ_CST)
+
+/* Memory */
+#define g_new(type, n)   ((type*) malloc(sizeof(type) * (n)))
+#define g_new0(type, n)  ((type*) calloc((n), sizeof(type)))
+#define g_free           free
+#define g_strdup(str)    ((str) ? strdup(str) : NULL)
+
+/* Lists */
+typedef struct _GList GList;
+struct _GList {
+    gpointer  data;
+    GList    *next;
+};
+
+#define g_list_next(item) ((item) ? (item)->next : NULL)
+
+GList*      g_list_prepend(GList *list, gpointer data);
+GList*      g_list_delete_link(GList *list, GList *link);
+void        g_list_free(GList *list);
+
+/* Hash tables, kept as lists */
+typedef struct _GHashTable GHashTable;
+typedef struct _GHashTableIter {
+    GList *next;
+} GHashTableIter;
+
+guint       g_direct_hash(gconstpointer key);
+gboolean    g_direct_equal(gconstpointer a, gconstpointer b);
+GHashTable* g_hash_table_new_full(GHashFunc hash, GEqualFunc equal,
+                GDestroyNotify key_destroy, GDestroyNotify value_destroy);
+gpointer    g_hash_table_lookup(GHashTable *table, gconstpointer key);
+void        g_hash_table_insert(GHashTable *table, gpointer key,
+                gpointer value);
+gboolean    g_hash_table_steal(GHashTable *table, gconstpointer key);
+gboolean    g_hash_table_remove(GHashTable *table, gconstpointer key);
+void        g_hash_table_destroy(GHashTable *table);
+void        g_hash_table_iter_init(GHashTableIter *iter, GHashTable *table);
+gboolean    g_hash_table_iter_next(GHashTableIter *iter, gpointer *key,
+                gpointer *value);
+
+/* Strings */
+typedef struct _GString {
+    gchar *str;
+} GString;
+
+GString*    g_string_new(const gchar *init);
+void        g_string_append_printf(GString *string, const gchar *format,
+                ...);
+gchar*      g_string_free(GString *string, gboolean free_segment);
+
+/* Types.  A class starts with its type, and an instance with its class. */
+typedef struct _GstTIStubType *GType;
+
+typedef struct _GTypeClass {
+    GType g_type;
+} GTypeClass;
+
+typedef struct _GTypeInstance {
+    GTypeClass *g_class;
+} GTypeInstance;
+
+struct _GstTIStubType {
+    const gchar  *name;
+    GType         parent;
+    size_t        classSize;
+    size_t        instanceSize;
+    gpointer      klass;
+    void        (*instanceInit)(gpointer instance);
+    guint         numCreated;
+};
+
+void        gst_ti_stub_type_register(GType type);
+gboolean    gst_ti_stub_type_is_a(GType type, GType ancestor);
+gpointer    g_type_class_peek_parent(gpointer klass);
+
+#define G_TYPE_CHECK_INSTANCE_CAST(obj, type, ctype) ((ctype*) (obj))
+#define G_TYPE_CHECK_INSTANCE_TYPE(obj, type) \
+    ((obj) && gst_ti_stub_type_is_a( \
+        ((GTypeInstance*) (obj))->g_class->g_type, (type)))
+#define G_TYPE_CHECK_CLASS_CAST(klass, type, ctype) ((ctype*) (klass))
+#define G_TYPE_CHECK_CLASS_TYPE(klass, type) \
+    gst_ti_stub_type_is_a(((GTypeClass*) (klass))->g_type, (type))
+#define G_TYPE_INSTANCE_GET_CLASS(obj, type, ctype) \
+    ((ctype*) ((GTypeInstance*) (obj))->g_class)
+
+/* Not thread-safe; the first call must come from a single thread */
+#define G_DEFINE_TYPE_WITH_CODE(TN, t_n, T_P, _C_) \
+static void t_n##_init(TN *self); \
+static void t_n##_class_init(TN##Class *klass); \
+GType t_n##_get_type(void) \
+{ \
+    static struct _GstTIStubType type; \
+    if (type.klass == NULL) { \
+        type.name         = #TN; \
+        type.parent       = (T_P); \
+        type.classSize    = sizeof(TN##Class); \
+        type.instanceSize = sizeof(TN); \
+        type.instanceInit = (void (*)(gpointer)) t_n##_init; \
+        gst_ti_stub_type_register(&type); \
+        { _C_; } \
+        t_n##_class_init((TN##Class*) type.klass); \
+    } \
+    return &type; \
+}
+
+/* Mini objects */
+typedef struct _GstMiniObject GstMiniObject;
+typedef void (*GstMiniObjectFinalizeFunction)(GstMiniObject *obj);
+
+struct _GstMiniObject {
+    GTypeInstance  instance;
+    gint           refcount;
+    guint          flags;
+};
+
+typedef struct _GstMiniObjectClass {
+    GTypeClass                     type_class;
+    GstMiniObjectFinalizeFunction  finalize;
+} GstMiniObjectClass;
+
+#define GST_TYPE_MINI_OBJECT          (gst_mini_object_get_type())
+#define GST_MINI_OBJECT(obj)          ((GstMiniObject*) (obj))
+#define GST_MINI_OBJECT_CLASS(klass)  ((GstMiniObjectClass*) (klass))
+#define GST_MINI_OBJECT_FLAGS(obj)    (GST_MINI_OBJECT(obj)->flags)
+#define GST_MINI_OBJECT_REFCOUNT_VALUE(obj) \
+    g_atomic_int_get(&GST_MINI_OBJECT(obj)->refcount)
+
+GType          gst_mini_object_get_type(void);
+GstMiniObject* gst_mini_object_new(GType type);
+GstMiniObject* gst_mini_object_ref(GstMiniObject *obj);
+void           gst_mini_object_unref(GstMiniObject *obj);
+
+/* Buffers and caps */
+typedef struct _GstCaps GstCaps;
+
+typedef struct _GstBuffer {
+    GstMiniObject  mini_object;
+    guint8        *data;
+    guint          size;
+    GstClockTime   timestamp;
+    GstClockTime   duration;
+    GstCaps       *caps;
+    guint64        offset;
+    guint64        offset_end;
+    guint8        *malloc_data;
+} GstBuffer;
+
+typedef struct _GstBufferClass {
+    GstMiniObjectClass mini_object_class;
+} GstBufferClass;
+
+#define GST_TYPE_BUFFER               (gst_buffer_get_type())
+#define GST_BUFFER(obj)               ((GstBuffer*) (obj))
+#define GST_BUFFER_CLASS(klass)       ((GstBufferClass*) (klass))
+#define GST_BUFFER_DATA(buf)          (GST_BUFFER(buf)->data)
+#define GST_BUFFER_SIZE(buf)          (GST_BUFFER(buf)->size)
+#define GST_BUFFER_TIMESTAMP(buf)     (GST_BUFFER(buf)->timestamp)
+#define GST_BUFFER_DURATION(buf)      (GST_BUFFER(buf)->duration)
+#define GST_BUFFER_CAPS(buf)          (GST_BUFFER(buf)->caps)
+#define GST_BUFFER_OFFSET(buf)        (GST_BUFFER(buf)->offset)
+#define GST_BUFFER_OFFSET_END(buf)    (GST_BUFFER(buf)->offset_end)
+#define GST_BUFFER_MALLOCDATA(buf)    (GST_BUFFER(buf)->malloc_data)
+#define GST_BUFFER_OFFSET_NONE        ((guint64) -1)
+
+#define gst_buffer_unref(buf)         gst_mini_object_unref(GST_MINI_OBJECT(buf))
+
+GType          gst_buffer_get_type(void);
+void           gst_caps_replace(GstCaps **caps, GstCaps *newcaps);
+gboolean       gst_caps_is_equal(const GstCaps *a, const GstCaps *b);
+
+/* Pads, queries and structures; nothing in the benchmark answers them */
+typedef struct _GstPad       GstPad;
+typedef struct _GstQuery     GstQuery;
+typedef struct _GstStructure GstStructure;
+typedef struct _GstEvent     GstEvent;
+typedef struct _GstSegment   GstSegment;
+
+#define GST_FLOW_OK     0
+#define GST_QUERY_NONE  0
+
+GstQueryType   gst_query_type_register(const gchar *nick,
+                   const gchar *description);
+GstQuery*      gst_query_new_application(GstQueryType type,
+                   GstStructure *structure);
+GstStructure*  gst_query_get_structure(GstQuery *query);
+void           gst_query_unref(GstQuery *query);
+GstStructure*  gst_structure_new(const gchar *name, const gchar *field, ...);
+void           gst_structure_set(GstStructure *structure,
+                   const gchar *field, ...);
+gboolean       gst_structure_get_int(const GstStructure *structure,
+                   const gchar *field, gint *value);
+gboolean       gst_pad_peer_query(GstPad *pad, GstQuery *query);
+GstFlowReturn  gst_pad_alloc_buffer(GstPad *pad, guint64 offset, gint size,
+                   GstCaps *caps, GstBuffer **buf);
+
+/* Time */
+#define GST_MSECOND                    ((GstClockTime) 1000000)
+#define GST_CLOCK_TIME_NONE            ((GstClockTime) -1)
+#define GST_CLOCK_TIME_IS_VALID(time)  ((time) != GST_CLOCK_TIME_NONE)
+#define GST_TIME_FORMAT                PRIu64
+#define GST_TIME_ARGS(t)               ((guint64) (t))
+
+static inline GstClockTime gst_util_get_timestamp(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (GstClockTime) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* The mini objects above behave like those of 0.10.24 and later */
+#define GST_CHECK_VERSION(major, minor, micro)  1
+
+/* Logging.  The arguments are type-checked but never evaluated. */
+#define GST_TI_STUB_LOG(...)  ((void) sizeof(printf(__VA_ARGS__)))
+#define GST_DEBUG_CATEGORY_STATIC(cat)       static int cat
+#define GST_DEBUG_CATEGORY_INIT(cat, ...)    ((void) (cat))
+#define GST_ERROR(...)                       GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_WARNING(...)                     GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_INFO(...)                        GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_DEBUG(...)                       GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_LOG(...)                         GST_TI_STUB_LOG(__VA_ARGS__)
+
+#endif /* __GST_TI_STUB_GST_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,41 @@
+/*
+ * BufTab.h
+ *
+ * This file is a minimal stand-in for the DMAI BufTab header; dmai.c
+ * implements it.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_BUFTAB_H__
+#define __GST_TI_STUB_BUFTAB_H__
+
+#include <ti/sdo/dmai/Buffer.h>
+
+BufTab_Handle  BufTab_create(Int numBufs, Int32 size, Buffer_Attrs *attrs);
+Int            BufTab_delete(BufTab_Handle hBufTab);
+Buffer_Handle  BufTab_getFreeBuf(BufTab_Handle hBufTab);
+Int            BufTab_getNumBufs(BufTab_Handle hBufTab);
+
+#endif /* __GST_TI_STUB_BUFTAB_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
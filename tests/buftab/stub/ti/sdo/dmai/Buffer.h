@@ -0,0 +1,62 @@
+/*
+ * Buffer.h
+ *
+ * This file is a minimal stand-in for the DMAI Buffer header; dmai.c
+ * implements it.  As in DMAI, a buffer is in use while any bit of its use
+ * mask is set, and resetting the mask restores the one it was created
+ * with.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_BUFFER_H__
+#define __GST_TI_STUB_BUFFER_H__
+
+#include <xdc/std.h>
+
+typedef struct Buffer_Object *Buffer_Handle;
+typedef struct BufTab_Object *BufTab_Handle;
+
+typedef enum {
+    Buffer_Type_BASIC,
+    Buffer_Type_GRAPHICS
+} Buffer_Type;
+
+typedef struct Buffer_Attrs {
+    Buffer_Type  type;
+    UInt16       useMask;
+} Buffer_Attrs;
+
+Buffer_Handle  Buffer_create(Int32 size, Buffer_Attrs *attrs);
+Int            Buffer_delete(Buffer_Handle hBuf);
+Int32          Buffer_getSize(Buffer_Handle hBuf);
+Int8*          Buffer_getUserPtr(Buffer_Handle hBuf);
+UInt16         Buffer_getUseMask(Buffer_Handle hBuf);
+Void           Buffer_setUseMask(Buffer_Handle hBuf, UInt16 useMask);
+Void           Buffer_freeUseMask(Buffer_Handle hBuf, UInt16 useMask);
+Void           Buffer_resetUseMask(Buffer_Handle hBuf);
+Bool           Buffer_inUse(Buffer_Handle hBuf);
+BufTab_Handle  Buffer_getBufTab(Buffer_Handle hBuf);
+
+#endif /* __GST_TI_STUB_BUFFER_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
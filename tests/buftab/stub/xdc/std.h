@@ -0,0 +1,42 @@
+/*
+ * std.h
+ *
+ * This file is a minimal stand-in for the XDC types header.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_XDC_STD_H__
+#define __GST_TI_STUB_XDC_STD_H__
+
+typedef void            Void;
+typedef char            Char;
+typedef signed char     Int8;
+typedef int             Int;
+typedef int             Int32;
+typedef unsigned short  UInt16;
+typedef unsigned int    UInt32;
+typedef int             Bool;
+
+#endif /* __GST_TI_STUB_XDC_STD_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
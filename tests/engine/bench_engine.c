@@ -0,0 +1,379 @@
+/*
+ * bench_engine.c
+ *
+ * This file counts how often the TI elements open a Codec Engine, with and
+ * without the engine cache in gsttiengine.c, and measures what the cache
+ * itself costs per open.  Engine_open and Engine_close are stubs that count
+ * their calls, so the time a real Engine_open takes on the target (loading
+ * and starting the DSP server) is not part of these numbers; multiply the
+ * open counts by it.
+ *
+ * Each scenario is run with every element calling Engine_open itself, as
+ * before the cache, and with gst_tiengine_open:
+ *
+ *   one thread   four elements started from the same thread
+ *   4 threads    four elements started from their own streaming threads,
+ *                holding the engine at the same time
+ *   rebuild      the one-thread pipeline torn down and built 10 times
+ *   playlist     one decoder restarted from a new thread for 10 items,
+ *                parking its engine with its idle codec in between
+ *
+ * Usage:  bench_engine
+ *         GST_TI_EngineCache_lingerTime=100 bench_engine
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "gsttiengine.h"
+#include "gstticommonutils.h"
+
+#define ENGINE_NAME   "codecServer"
+#define NUM_ELEMENTS  4
+#define NUM_REPEATS   10
+#define HIT_ROUNDS    1000000
+
+struct Engine_Obj {
+    gint dummy;
+};
+
+static volatile gint numOpens    = 0;
+static volatile gint numCloses   = 0;
+static gint          numFailures = 0;
+static guint         lingerTime  = 0;
+
+/* What one streaming thread does in the 4-threads scenario */
+typedef struct _ThreadArgs {
+    gboolean            cached;
+    pthread_barrier_t  *barrier;
+    Engine_Handle       hEngine;
+} ThreadArgs;
+
+
+/******************************************************************************
+ * Engine_open / Engine_close
+ *    Stubs that count the calls.
+ ******************************************************************************/
+Engine_Handle Engine_open(Char *name, void *attrs, void *status)
+{
+    __atomic_add_fetch(&numOpens, 1, __ATOMIC_SEQ_CST);
+    return calloc(1, sizeof(struct Engine_Obj));
+}
+
+void Engine_close(Engine_Handle hEngine)
+{
+    __atomic_add_fetch(&numCloses, 1, __ATOMIC_SEQ_CST);
+    free(hEngine);
+}
+
+
+/******************************************************************************
+ * gst_ti_env_is_defined / gst_ti_env_get_int
+ *    Copies of the helpers in gstticommonutils.c, which needs DMAI.
+ ******************************************************************************/
+gboolean gst_ti_env_is_defined(gchar *env)
+{
+    return getenv(env) != NULL;
+}
+
+gint gst_ti_env_get_int(gchar *env)
+{
+    gchar *value = getenv(env);
+
+    return value ? atoi(value) : 0;
+}
+
+
+/******************************************************************************
+ * element_open / element_close / element_park / element_unpark
+ *    What a TI element does when its codec starts and stops, with or
+ *    without the cache.
+ ******************************************************************************/
+static Engine_Handle element_open(gboolean cached)
+{
+    return cached ? gst_tiengine_open(ENGINE_NAME) :
+                    Engine_open(ENGINE_NAME, NULL, NULL);
+}
+
+static void element_close(gboolean cached, Engine_Handle hEngine)
+{
+    if (cached) {
+        gst_tiengine_close(hEngine);
+    }
+    else {
+        Engine_close(hEngine);
+    }
+}
+
+static Engine_Handle element_park(gboolean cached, Engine_Handle hEngine)
+{
+    if (cached) {
+        gst_tiengine_park(hEngine);
+        return hEngine;
+    }
+
+    Engine_close(hEngine);
+    return NULL;
+}
+
+static Engine_Handle element_unpark(gboolean cached, Engine_Handle hEngine)
+{
+    if (hEngine == NULL) {
+        return element_open(cached);
+    }
+
+    if (gst_tiengine_unpark(hEngine)) {
+        return hEngine;
+    }
+
+    gst_tiengine_close_parked(hEngine);
+    return element_open(cached);
+}
+
+
+/******************************************************************************
+ * now
+ ******************************************************************************/
+static double now(void)
+{
+    return gst_util_get_timestamp() / 1e9;
+}
+
+
+/******************************************************************************
+ * report
+ ******************************************************************************/
+static void report(const char *scenario, gboolean cached, gint opens,
+                double elapsed)
+{
+    printf("  %-12s %-8s %3d opens  %8.1f us\n", scenario,
+        cached ? "cache" : "direct", opens, elapsed * 1e6);
+}
+
+
+/******************************************************************************
+ * bench_one_thread
+ *    Start and stop NUM_ELEMENTS elements from one thread.
+ ******************************************************************************/
+static void bench_one_thread(gboolean cached, gboolean print)
+{
+    Engine_Handle hEngine[NUM_ELEMENTS];
+    gint          i, opens = numOpens;
+    double        start = now();
+
+    for (i = 0; i < NUM_ELEMENTS; i++) {
+        hEngine[i] = element_open(cached);
+        if (cached && hEngine[i] != hEngine[0]) {
+            printf("FAIL one thread: element %d got another handle\n", i);
+            numFailures++;
+        }
+    }
+
+    for (i = NUM_ELEMENTS - 1; i >= 0; i--) {
+        element_close(cached, hEngine[i]);
+    }
+
+    if (print) {
+        report("one thread", cached, numOpens - opens, now() - start);
+    }
+}
+
+
+/******************************************************************************
+ * streaming_thread
+ *    Open the engine, hold it while the other threads open theirs, and
+ *    close it.
+ ******************************************************************************/
+static void* streaming_thread(void *arg)
+{
+    ThreadArgs *args = (ThreadArgs*)arg;
+
+    args->hEngine = element_open(args->cached);
+    pthread_barrier_wait(args->barrier);
+    pthread_barrier_wait(args->barrier);
+    element_close(args->cached, args->hEngine);
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * bench_threads
+ *    Start NUM_ELEMENTS elements from their own threads.  A handle must not
+ *    be shared between threads that use it at the same time.
+ ******************************************************************************/
+static void bench_threads(gboolean cached)
+{
+    pthread_barrier_t barrier;
+    pthread_t         thread[NUM_ELEMENTS];
+    ThreadArgs        args[NUM_ELEMENTS];
+    gint              i, j, opens = numOpens;
+    double            start = now();
+
+    pthread_barrier_init(&barrier, NULL, NUM_ELEMENTS + 1);
+
+    for (i = 0; i < NUM_ELEMENTS; i++) {
+        args[i].cached  = cached;
+        args[i].barrier = &barrier;
+        pthread_create(&thread[i], NULL, streaming_thread, &args[i]);
+    }
+
+    /* Everybody holds its engine now */
+    pthread_barrier_wait(&barrier);
+    for (i = 0; i < NUM_ELEMENTS; i++) {
+        for (j = 0; j < i; j++) {
+            if (args[i].hEngine == args[j].hEngine) {
+                printf("FAIL 4 threads: threads %d and %d share a handle\n",
+                    j, i);
+                numFailures++;
+            }
+        }
+    }
+    pthread_barrier_wait(&barrier);
+
+    for (i = 0; i < NUM_ELEMENTS; i++) {
+        pthread_join(thread[i], NULL);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    report("4 threads", cached, numOpens - opens, now() - start);
+}
+
+
+/******************************************************************************
+ * bench_rebuild
+ *    Build and tear down the one-thread pipeline NUM_REPEATS times.
+ ******************************************************************************/
+static void bench_rebuild(gboolean cached)
+{
+    gint   i, opens = numOpens;
+    double start = now();
+
+    for (i = 0; i < NUM_REPEATS; i++) {
+        bench_one_thread(cached, FALSE);
+    }
+
+    report("rebuild", cached, numOpens - opens, now() - start);
+}
+
+
+/******************************************************************************
+ * playlist_item
+ *    Start the decoder on a new streaming thread and stop it again, keeping
+ *    the engine parked with the codec.
+ ******************************************************************************/
+static void* playlist_item(void *arg)
+{
+    ThreadArgs *args = (ThreadArgs*)arg;
+
+    args->hEngine = element_unpark(args->cached, args->hEngine);
+    args->hEngine = element_park(args->cached, args->hEngine);
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * bench_playlist
+ *    Play NUM_REPEATS items, each from a new streaming thread.
+ ******************************************************************************/
+static void bench_playlist(gboolean cached)
+{
+    ThreadArgs args = { cached, NULL, NULL };
+    pthread_t  thread;
+    gint       i, opens = numOpens;
+    double     start = now();
+
+    for (i = 0; i < NUM_REPEATS; i++) {
+        pthread_create(&thread, NULL, playlist_item, &args);
+        pthread_join(thread, NULL);
+    }
+
+    if (args.hEngine) {
+        gst_tiengine_close_parked(args.hEngine);
+    }
+
+    report("playlist", cached, numOpens - opens, now() - start);
+}
+
+
+/******************************************************************************
+ * bench_hit
+ *    Time an open and close served from the cache while another element on
+ *    the same thread holds the engine.
+ ******************************************************************************/
+static void bench_hit(void)
+{
+    Engine_Handle hEngine = gst_tiengine_open(ENGINE_NAME);
+    double        start;
+    gint          i;
+
+    start = now();
+    for (i = 0; i < HIT_ROUNDS; i++) {
+        gst_tiengine_close(gst_tiengine_open(ENGINE_NAME));
+    }
+    printf("  cached open+close: %.0f ns\n",
+        (now() - start) * 1e9 / HIT_ROUNDS);
+
+    gst_tiengine_close(hEngine);
+}
+
+
+/******************************************************************************
+ * main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    gint cached;
+
+    if (gst_ti_env_is_defined("GST_TI_EngineCache_lingerTime")) {
+        lingerTime = gst_ti_env_get_int("GST_TI_EngineCache_lingerTime");
+    }
+
+    printf("%d elements, %d repeats, lingerTime %u ms\n", NUM_ELEMENTS,
+        NUM_REPEATS, lingerTime);
+
+    for (cached = FALSE; cached <= TRUE; cached++) {
+        bench_one_thread(cached, TRUE);
+        bench_threads(cached);
+        bench_rebuild(cached);
+        bench_playlist(cached);
+    }
+
+    bench_hit();
+
+    /* Let lingering engines close */
+    usleep((lingerTime + 100) * 1000);
+
+    if (numOpens != numCloses) {
+        printf("FAIL %d engines opened, %d closed\n", numOpens, numCloses);
+        numFailures++;
+    }
+
+    return numFailures ? 1 : 0;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,126 @@
+/*
+ * gst.h
+ *
+ * This file is a minimal stand-in for the GStreamer and GLib headers, so
+ * that the engine cache can be built and measured on a host without
+ * GStreamer.  It only declares what gsttiengine.c and gstticommonutils.h
+ * use.  Logging is compiled out.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_GST_H__
+#define __GST_TI_STUB_GST_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef char          gchar;
+typedef int           gint;
+typedef unsigned int  guint;
+typedef int           gboolean;
+typedef void*         gpointer;
+typedef int64_t       gint64;
+typedef uint64_t      guint64;
+typedef guint64       GstClockTime;
+typedef int           GstFormat;
+
+typedef struct _GstEvent   GstEvent;
+typedef struct _GstSegment GstSegment;
+typedef struct _GstPad     GstPad;
+typedef struct _GstQuery   GstQuery;
+
+#define TRUE  1
+#define FALSE 0
+
+#define G_BEGIN_DECLS
+#define G_END_DECLS
+
+/* Lists */
+typedef struct _GList GList;
+struct _GList {
+    gpointer  data;
+    GList    *next;
+};
+
+#define g_list_next(item) ((item) ? (item)->next : NULL)
+
+static inline GList* g_list_prepend(GList *list, gpointer data)
+{
+    GList *item = malloc(sizeof(GList));
+
+    item->data = data;
+    item->next = list;
+    return item;
+}
+
+static inline GList* g_list_remove(GList *list, gpointer data)
+{
+    GList **link;
+    GList  *item;
+
+    for (link = &list; *link; link = &(*link)->next) {
+        if ((*link)->data == data) {
+            item  = *link;
+            *link = item->next;
+            free(item);
+            break;
+        }
+    }
+
+    return list;
+}
+
+/* Memory */
+#define g_slice_new(type)        ((type*) calloc(1, sizeof(type)))
+#define g_slice_free(type, mem)  free(mem)
+#define g_strdup(str)            strdup(str)
+#define g_free(mem)              free(mem)
+
+/* Time */
+#define GST_TIME_FORMAT   "llu ns"
+#define GST_TIME_ARGS(t)  ((unsigned long long) (t))
+
+static inline GstClockTime gst_util_get_timestamp(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (GstClockTime) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Logging.  The arguments are type-checked but never evaluated. */
+#define GST_TI_STUB_LOG(...)  ((void) sizeof(printf(__VA_ARGS__)))
+#define GST_DEBUG_CATEGORY_STATIC(cat)       static int cat
+#define GST_DEBUG_CATEGORY_INIT(cat, ...)    ((void) (cat))
+#define GST_ERROR(...)                       GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_WARNING(...)                     GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_INFO(...)                        GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_DEBUG(...)                       GST_TI_STUB_LOG(__VA_ARGS__)
+#define GST_LOG(...)                         GST_TI_STUB_LOG(__VA_ARGS__)
+
+#endif /* __GST_TI_STUB_GST_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
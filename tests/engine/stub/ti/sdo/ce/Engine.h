@@ -0,0 +1,42 @@
+/*
+ * Engine.h
+ *
+ * This file is a minimal stand-in for the Codec Engine header.  The
+ * benchmark defines Engine_open and Engine_close itself, and counts the
+ * calls.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_ENGINE_H__
+#define __GST_TI_STUB_ENGINE_H__
+
+#include <xdc/std.h>
+
+typedef struct Engine_Obj *Engine_Handle;
+
+Engine_Handle Engine_open(Char *name, void *attrs, void *status);
+void          Engine_close(Engine_Handle hEngine);
+
+#endif /* __GST_TI_STUB_ENGINE_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
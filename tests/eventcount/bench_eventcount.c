@@ -0,0 +1,330 @@
+/*
+ * bench_eventcount.c
+ *
+ * This file measures how many items per second one producer thread can hand
+ * to one consumer thread through a ring, the way the chain function hands
+ * data to the decode thread through GstTICircBuffer.  The ring is driven
+ * with GstTIEventCount, and with a copy of the DMAI Rendezvous used the way
+ * gstticircbuffer.c used it before (reset before checking, meet to wait,
+ * force after every change).
+ *
+ * A depth of 1 is a strict ping-pong where every item has to wake the other
+ * side; deeper rings show the common case where neither side is blocked.
+ *
+ * Usage:  bench_eventcount [items]
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "gsttieventcount.h"
+
+/* Largest ring depth measured */
+#define MAX_DEPTH 256
+
+/* Copy of the DMAI Rendezvous object, created with a count no thread ever
+ * reaches so that meet only returns after a force, as in the old
+ * GstTICircBuffer.
+ */
+typedef struct _Rendezvous {
+    gint             orig;
+    gint             count;
+    pthread_mutex_t  mutex;
+    pthread_cond_t   cond;
+} Rendezvous;
+
+/* The ring, and what each side waits on */
+typedef struct _Ring {
+    gint             depth;
+    gint             numItems;
+    volatile gint    writePos;
+    volatile gint    readPos;
+    gint             slots[MAX_DEPTH];
+    gboolean         useRendezvous;
+    GstTIEventCount  waitOnProducer;
+    GstTIEventCount  waitOnConsumer;
+    Rendezvous       rzvProducer;
+    Rendezvous       rzvConsumer;
+    gint             numErrors;
+} Ring;
+
+
+/******************************************************************************
+ * rendezvous_init
+ ******************************************************************************/
+static void rendezvous_init(Rendezvous *rzv, gint count)
+{
+    rzv->orig  = count;
+    rzv->count = count;
+    pthread_mutex_init(&rzv->mutex, NULL);
+    pthread_cond_init(&rzv->cond, NULL);
+}
+
+
+/******************************************************************************
+ * rendezvous_destroy
+ ******************************************************************************/
+static void rendezvous_destroy(Rendezvous *rzv)
+{
+    pthread_cond_destroy(&rzv->cond);
+    pthread_mutex_destroy(&rzv->mutex);
+}
+
+
+/******************************************************************************
+ * rendezvous_meet
+ ******************************************************************************/
+static void rendezvous_meet(Rendezvous *rzv)
+{
+    pthread_mutex_lock(&rzv->mutex);
+    if (rzv->count > 0) {
+        if (--rzv->count == 0) {
+            pthread_cond_broadcast(&rzv->cond);
+        }
+        else {
+            while (rzv->count != 0) {
+                pthread_cond_wait(&rzv->cond, &rzv->mutex);
+            }
+        }
+    }
+    pthread_mutex_unlock(&rzv->mutex);
+}
+
+
+/******************************************************************************
+ * rendezvous_force
+ ******************************************************************************/
+static void rendezvous_force(Rendezvous *rzv)
+{
+    pthread_mutex_lock(&rzv->mutex);
+    rzv->count = 0;
+    pthread_cond_broadcast(&rzv->cond);
+    pthread_mutex_unlock(&rzv->mutex);
+}
+
+
+/******************************************************************************
+ * rendezvous_reset
+ ******************************************************************************/
+static void rendezvous_reset(Rendezvous *rzv)
+{
+    pthread_mutex_lock(&rzv->mutex);
+    rzv->count = rzv->orig;
+    pthread_mutex_unlock(&rzv->mutex);
+}
+
+
+/******************************************************************************
+ * ring_full / ring_empty
+ ******************************************************************************/
+static gboolean ring_full(Ring *ring)
+{
+    return g_atomic_int_get(&ring->writePos) -
+           g_atomic_int_get(&ring->readPos) == ring->depth;
+}
+
+static gboolean ring_empty(Ring *ring)
+{
+    return g_atomic_int_get(&ring->writePos) ==
+           g_atomic_int_get(&ring->readPos);
+}
+
+
+/******************************************************************************
+ * producer_thread
+ *    The chain function:  queue numItems items, waiting while the ring is
+ *    full.
+ ******************************************************************************/
+static void* producer_thread(void *arg)
+{
+    Ring *ring = (Ring*)arg;
+    gint  i, key;
+
+    for (i = 0; i < ring->numItems; i++) {
+        if (ring->useRendezvous) {
+            rendezvous_reset(&ring->rzvConsumer);
+            while (ring_full(ring)) {
+                rendezvous_meet(&ring->rzvConsumer);
+                rendezvous_reset(&ring->rzvConsumer);
+            }
+        }
+        else {
+            while (ring_full(ring)) {
+                key = gst_tieventcount_prepare_wait(&ring->waitOnConsumer);
+                if (!ring_full(ring)) {
+                    break;
+                }
+                gst_tieventcount_wait(&ring->waitOnConsumer, key);
+            }
+        }
+
+        ring->slots[ring->writePos % ring->depth] = i;
+        g_atomic_int_inc(&ring->writePos);
+
+        if (ring->useRendezvous) {
+            rendezvous_force(&ring->rzvProducer);
+        }
+        else {
+            gst_tieventcount_notify(&ring->waitOnProducer);
+        }
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * consumer_thread
+ *    The decode thread:  take numItems items in order, waiting while the
+ *    ring is empty.
+ ******************************************************************************/
+static void* consumer_thread(void *arg)
+{
+    Ring *ring = (Ring*)arg;
+    gint  i, key;
+
+    for (i = 0; i < ring->numItems; i++) {
+        if (ring->useRendezvous) {
+            rendezvous_reset(&ring->rzvProducer);
+            while (ring_empty(ring)) {
+                rendezvous_meet(&ring->rzvProducer);
+                rendezvous_reset(&ring->rzvProducer);
+            }
+        }
+        else {
+            while (ring_empty(ring)) {
+                key = gst_tieventcount_prepare_wait(&ring->waitOnProducer);
+                if (!ring_empty(ring)) {
+                    break;
+                }
+                gst_tieventcount_wait(&ring->waitOnProducer, key);
+            }
+        }
+
+        if (ring->slots[ring->readPos % ring->depth] != i) {
+            ring->numErrors++;
+        }
+        g_atomic_int_inc(&ring->readPos);
+
+        if (ring->useRendezvous) {
+            rendezvous_force(&ring->rzvConsumer);
+        }
+        else {
+            gst_tieventcount_notify(&ring->waitOnConsumer);
+        }
+    }
+
+    return NULL;
+}
+
+
+/******************************************************************************
+ * now
+ ******************************************************************************/
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/******************************************************************************
+ * bench_one
+ *    Run one producer and one consumer over the ring and report items per
+ *    second.  Returns the number of items received out of order.
+ ******************************************************************************/
+static gint bench_one(gint depth, gboolean useRendezvous, gint numItems)
+{
+    Ring      *ring = calloc(1, sizeof(Ring));
+    pthread_t  producer, consumer;
+    double     start, elapsed;
+    gint       numErrors;
+
+    ring->depth         = depth;
+    ring->numItems      = numItems;
+    ring->useRendezvous = useRendezvous;
+    gst_tieventcount_init(&ring->waitOnProducer);
+    gst_tieventcount_init(&ring->waitOnConsumer);
+    rendezvous_init(&ring->rzvProducer, 100);
+    rendezvous_init(&ring->rzvConsumer, 100);
+
+    start = now();
+    pthread_create(&consumer, NULL, consumer_thread, ring);
+    pthread_create(&producer, NULL, producer_thread, ring);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    elapsed = now() - start;
+
+    if (useRendezvous) {
+        printf("  depth %3d  %-11s %11.0f items/s\n", depth, "rendezvous",
+            numItems / elapsed);
+    }
+    else {
+        printf("  depth %3d  %-11s %11.0f items/s  (parked %d+%d times, "
+            "%d wakeups)\n", depth, "eventcount", numItems / elapsed,
+            ring->waitOnProducer.numParked, ring->waitOnConsumer.numParked,
+            ring->waitOnProducer.numWakeups + ring->waitOnConsumer.numWakeups);
+    }
+
+    numErrors = ring->numErrors;
+
+    rendezvous_destroy(&ring->rzvConsumer);
+    rendezvous_destroy(&ring->rzvProducer);
+    gst_tieventcount_destroy(&ring->waitOnConsumer);
+    gst_tieventcount_destroy(&ring->waitOnProducer);
+    free(ring);
+
+    return numErrors;
+}
+
+
+/******************************************************************************
+ * main
+ ******************************************************************************/
+int main(int argc, char *argv[])
+{
+    static const gint depths[] = { 1, 4, 16, 64, 256 };
+    gint numItems  = argc > 1 ? atoi(argv[1]) : 2000000;
+    gint numErrors = 0;
+    gint d;
+
+    printf("%d items per run\n", numItems);
+
+    for (d = 0; d < (gint)(sizeof(depths) / sizeof(depths[0])); d++) {
+        numErrors += bench_one(depths[d], TRUE, numItems);
+        numErrors += bench_one(depths[d], FALSE, numItems);
+    }
+
+    if (numErrors) {
+        printf("FAIL %d items received out of order\n", numErrors);
+    }
+
+    return numErrors ? 1 : 0;
+}
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif
@@ -0,0 +1,52 @@
+/*
+ * gst.h
+ *
+ * This file is a minimal stand-in for the GStreamer header, so that the
+ * event count can be built and measured on a host without GStreamer.  It
+ * only declares what gsttieventcount.c uses; the atomics are the GCC
+ * builtins with the full barriers GLib gives them.
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation version 2.1 of the License.
+ *
+ * This program is distributed #as is# WITHOUT ANY WARRANTY of any kind,
+ * whether express or implied; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ */
+
+#ifndef __GST_TI_STUB_GST_H__
+#define __GST_TI_STUB_GST_H__
+
+typedef int           gint;
+typedef int           gboolean;
+
+#define TRUE  1
+#define FALSE 0
+
+#define g_atomic_int_get(p)    __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define g_atomic_int_set(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define g_atomic_int_inc(p)    ((void) __atomic_add_fetch((p), 1, \
+                                   __ATOMIC_SEQ_CST))
+#define g_atomic_int_add(p, v) ((void) __atomic_add_fetch((p), (v), \
+                                   __ATOMIC_SEQ_CST))
+
+#define G_BEGIN_DECLS
+#define G_END_DECLS
+
+#endif /* __GST_TI_STUB_GST_H__ */
+
+
+/******************************************************************************
+ * Custom ViM Settings for editing this file
+ ******************************************************************************/
+#if 0
+ Tabs (use 4 spaces for indentation)
+ vim:set tabstop=4:      /* Use 4 spaces for tabs          */
+ vim:set shiftwidth=4:   /* Use 4 spaces for >> operations */
+ vim:set expandtab:      /* Expand tabs into white spaces  */
+#endif